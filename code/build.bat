@@ -24,9 +24,26 @@ del *.pdb > NUL 2> NUL
 REM USING GLSL IN VK USING GLSLANGVALIDATOR
 call glslangValidator -DVERTEX_SHADER=1 -S vert -e main -g -V -o %DataDir%\shader_forward_vert.spv %CodeDir%\forward_shader.cpp
 call glslangValidator -DFRAGMENT_SHADER=1 -S frag -e main -g -V -o %DataDir%\shader_forward_frag.spv %CodeDir%\forward_shader.cpp
+call glslangValidator -DBUILD_LIGHT_CLUSTERS=1 -S comp -e main -g -V -o %DataDir%\shader_light_clusters.spv %CodeDir%\forward_shader.cpp
+call glslangValidator -DSHADOW_VERTEX_SHADER=1 -S vert -e main -g -V -o %DataDir%\shader_shadow_vert.spv %CodeDir%\forward_shader.cpp
+call glslangValidator -DDEPTH_PREPASS_VERTEX_SHADER=1 -S vert -e main -g -V -o %DataDir%\shader_depth_prepass_vert.spv %CodeDir%\forward_shader.cpp
+call glslangValidator -DFAR_FIELD_VERTEX_SHADER=1 -S vert -e main -g -V -o %DataDir%\shader_far_field_vert.spv %CodeDir%\forward_shader.cpp
+call glslangValidator -DFAR_FIELD_FRAGMENT_SHADER=1 -S frag -e main -g -V -o %DataDir%\shader_far_field_frag.spv %CodeDir%\forward_shader.cpp
+
+call glslangValidator -DVERTEX_SHADER=1 -S vert -e main -g -V -o %DataDir%\shader_copy_to_swap_vert.spv %CodeDir%\shader_copy_to_swap.cpp
+call glslangValidator -DFRAGMENT_SHADER=1 -S frag -e main -g -V -o %DataDir%\shader_copy_to_swap_frag.spv %CodeDir%\shader_copy_to_swap.cpp
 
 call glslangValidator -DGENERATE_3D_TERRAIN=1 -S comp -e main -g -V -o %DataDir%\shader_generate_3d_terrain.spv %CodeDir%\procedural_3d_terrain_shaders.cpp
 call glslangValidator -DGENERATE_TRIANGLES=1 -S comp -e main -g -V -o %DataDir%\shader_generate_triangles.spv %CodeDir%\procedural_3d_terrain_shaders.cpp
+call glslangValidator -DFUSED_GENERATE=1 -S comp -e main -g -V -o %DataDir%\shader_fused_generate.spv %CodeDir%\procedural_3d_terrain_shaders.cpp
+call glslangValidator -DGENERATE_3D_TERRAIN_FP16=1 -S comp -e main -g -V -o %DataDir%\shader_generate_3d_terrain_fp16.spv %CodeDir%\procedural_3d_terrain_shaders.cpp
+call glslangValidator -DGENERATE_TRIANGLES_FP16=1 -S comp -e main -g -V -o %DataDir%\shader_generate_triangles_fp16.spv %CodeDir%\procedural_3d_terrain_shaders.cpp
+call glslangValidator -DGENERATE_SURFACE_NETS=1 -S comp -e main -g -V -o %DataDir%\shader_generate_surface_nets.spv %CodeDir%\procedural_3d_terrain_shaders.cpp
+call glslangValidator -DFUSED_GENERATE_FP16=1 -S comp -e main -g -V -o %DataDir%\shader_fused_generate_fp16.spv %CodeDir%\procedural_3d_terrain_shaders.cpp
+call glslangValidator -DFP16_ERROR_PROBE=1 -S comp -e main -g -V -o %DataDir%\shader_fp16_error_probe.spv %CodeDir%\procedural_3d_terrain_shaders.cpp
+call glslangValidator -DBUILD_DENSITY_BRICKS=1 -S comp -e main -g -V -o %DataDir%\shader_density_bricks.spv %CodeDir%\procedural_3d_terrain_shaders.cpp
+call glslangValidator -DBUILD_DENSITY_PYRAMID=1 -S comp -e main -g -V -o %DataDir%\shader_density_pyramid.spv %CodeDir%\procedural_3d_terrain_shaders.cpp
+call glslangValidator -DFAR_FIELD_DOWNSAMPLE=1 -S comp -e main -g -V -o %DataDir%\shader_far_field_downsample.spv %CodeDir%\procedural_3d_terrain_shaders.cpp
 
 REM USING HLSL IN VK USING DXC
 REM set DxcDir=C:\Tools\DirectXShaderCompiler\build\Debug\bin
@@ -0,0 +1,152 @@
+
+inline void DensityPyramidCreate(density_pyramid* Pyramid, gpu_allocator* Allocator, linear_arena* Arena, u32 NumSlots)
+{
+    *Pyramid = {};
+    Pyramid->Dirty = true;
+    Pyramid->NumSlots = NumSlots;
+    Pyramid->Nodes = GpuBufferCreate(Allocator, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(v2)*DENSITY_PYRAMID_NODES_PER_SLOT*NumSlots,
+                                     GpuMemoryCategory_Density);
+    Pyramid->Readback = GpuBufferCreate(Allocator, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                        (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+                                         VK_MEMORY_PROPERTY_HOST_CACHED_BIT),
+                                        sizeof(v2)*NumSlots, GpuMemoryCategory_Readback);
+
+    // NOTE: The chunk node is the first node of every slot, gather them into one tight array
+    Pyramid->ReadbackRegions = PushArray(Arena, VkBufferCopy, NumSlots);
+    Pyramid->SlotSurface = PushArray(Arena, b32, NumSlots);
+    for (u32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        VkBufferCopy* Region = Pyramid->ReadbackRegions + Slot;
+        Region->srcOffset = sizeof(v2)*DENSITY_PYRAMID_NODES_PER_SLOT*Slot;
+        Region->dstOffset = sizeof(v2)*Slot;
+        Region->size = sizeof(v2);
+        Pyramid->SlotSurface[Slot] = true;
+    }
+    Pyramid->NumSurfaceSlots = NumSlots;
+}
+
+inline u64 DensityPyramidMemorySize(density_pyramid* Pyramid)
+{
+    u64 Result = sizeof(v2)*DENSITY_PYRAMID_NODES_PER_SLOT*u64(Pyramid->NumSlots);
+    return Result;
+}
+
+// NOTE: The slot is getting new density, we don't know anything about it until its readback comes back
+inline void DensityPyramidSlotReset(density_pyramid* Pyramid, u32 Slot)
+{
+    Pyramid->SlotSurface[Slot] = true;
+}
+
+// NOTE: Every node of the slot becomes (Density, Density), for slots we know are empty without generating them. The caller puts the
+// nodes in transfer write
+inline void DensityPyramidSlotFill(density_pyramid* Pyramid, vk_commands* Commands, u32 Slot, f32 Density)
+{
+    u32 DensityBits;
+    Copy(&Density, &DensityBits, sizeof(u32));
+    vkCmdFillBuffer(Commands->Buffer, Pyramid->Nodes.Buffer, sizeof(v2)*DENSITY_PYRAMID_NODES_PER_SLOT*Slot,
+                    sizeof(v2)*DENSITY_PYRAMID_NODES_PER_SLOT, DensityBits);
+    Pyramid->SlotSurface[Slot] = false;
+}
+
+inline void DensityPyramidBindPipeline(vk_commands* Commands, vk_pipeline* Pipeline, VkDescriptorSet TerrainDescriptor,
+                                       chunk_push_constants* PushConstants)
+{
+    vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Handle);
+    vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Layout, 0, 1, &TerrainDescriptor, 0, 0);
+    vkCmdPushConstants(Commands->Buffer, Pipeline->Layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(*PushConstants), PushConstants);
+}
+
+// NOTE: Last frames triangles, trace and readback may still read the nodes, call before anything writes bricks
+inline void DensityPyramidWriteBarrier(density_pyramid* Pyramid, vk_commands* Commands)
+{
+    VkBarrierBufferAdd(Commands, Pyramid->Nodes.Buffer,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkCommandsBarrierFlush(Commands);
+}
+
+// NOTE: Builds the levels above the bricks, FUSED_GENERATE writes its bricks itself and only needs this part
+inline void DensityPyramidReduceRecord(density_pyramid* Pyramid, vk_commands* Commands, vk_pipeline* ReducePso,
+                                       VkDescriptorSet TerrainDescriptor, chunk_push_constants* PushConstants, u32 NumJobs)
+{
+    VkBarrierBufferAdd(Commands, Pyramid->Nodes.Buffer,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    DensityPyramidBindPipeline(Commands, ReducePso, TerrainDescriptor, PushConstants);
+    vkCmdDispatch(Commands->Buffer, 1, 1, NumJobs);
+
+    VkBarrierBufferAdd(Commands, Pyramid->Nodes.Buffer,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkCommandsBarrierFlush(Commands);
+}
+
+/*
+  NOTE: Expects the atlas to be readable by compute. Builds the pyramid for NumJobs jobs starting at PushConstants->JobOffset, the
+        bricks either go out through the batches brick dispatch args or as a direct dispatch when DispatchArgs is VK_NULL_HANDLE
+ */
+inline void DensityPyramidBuildRecord(density_pyramid* Pyramid, vk_commands* Commands, vk_pipeline* BricksPso, vk_pipeline* ReducePso,
+                                      VkDescriptorSet TerrainDescriptor, chunk_push_constants* PushConstants, u32 NumJobs,
+                                      VkBuffer DispatchArgs, VkDeviceSize DispatchArgsOffset)
+{
+    DensityPyramidWriteBarrier(Pyramid, Commands);
+
+    DensityPyramidBindPipeline(Commands, BricksPso, TerrainDescriptor, PushConstants);
+    if (DispatchArgs != VK_NULL_HANDLE)
+    {
+        vkCmdDispatchIndirect(Commands->Buffer, DispatchArgs, DispatchArgsOffset);
+    }
+    else
+    {
+        u32 BrickGroups = DENSITY_PYRAMID_CHUNK_RES / DENSITY_BRICK_RES;
+        vkCmdDispatch(Commands->Buffer, BrickGroups, BrickGroups, BrickGroups*NumJobs);
+    }
+
+    DensityPyramidReduceRecord(Pyramid, Commands, ReducePso, TerrainDescriptor, PushConstants, NumJobs);
+}
+
+// NOTE: Call once all of this frames builds are recorded
+inline void DensityPyramidReadbackRecord(density_pyramid* Pyramid, vk_commands* Commands)
+{
+    vkCmdCopyBuffer(Commands->Buffer, Pyramid->Nodes.Buffer, Pyramid->Readback.Buffer, Pyramid->NumSlots, Pyramid->ReadbackRegions);
+    VkBarrierBufferAdd(Commands, Pyramid->Readback.Buffer,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    Pyramid->Dirty = false;
+    Pyramid->ReadbackPending = true;
+}
+
+// NOTE: Called after VkCommandsBegin waited on last frames fence
+inline void DensityPyramidReadbackRead(density_pyramid* Pyramid)
+{
+    if (!Pyramid->ReadbackPending)
+    {
+        return;
+    }
+    Pyramid->ReadbackPending = false;
+
+    v2* ChunkNodes = (v2*)Pyramid->Readback.Allocation.Mapped;
+    Pyramid->NumSurfaceSlots = 0;
+    for (u32 Slot = 0; Slot < Pyramid->NumSlots; ++Slot)
+    {
+        // NOTE: Same test as DensityHasSurface, >= 0 is solid
+        Pyramid->SlotSurface[Slot] = ChunkNodes[Slot].x < 0.0f && ChunkNodes[Slot].y >= 0.0f;
+        Pyramid->NumSurfaceSlots += Pyramid->SlotSurface[Slot] ? 1 : 0;
+    }
+}
+
+inline void DensityPyramidPanel(ui_panel* Panel, density_pyramid* Pyramid)
+{
+    char Text[256];
+    snprintf(Text, sizeof(Text), "Density Pyramid: %u / %u chunk slots hold surface, %.2fMB", Pyramid->NumSurfaceSlots, Pyramid->NumSlots,
+             f32(DensityPyramidMemorySize(Pyramid)) / f32(MegaBytes(1)));
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+}
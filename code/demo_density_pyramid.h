@@ -0,0 +1,38 @@
+#pragma once
+
+/*
+
+  NOTE: Density min/max pyramid. After generation every chunk slot gets a small tree of (min, max) density nodes over its cells, the
+        chunk itself, 2^3 and 4^3 children, then 8^3 bricks of DENSITY_BRICK_RES^3 cells. Bricks include their high side corners so a
+        brick covers every sample its cells read.
+
+        - GENERATE_TRIANGLES runs one work group per brick and leaves before loading any corners when the chunk or brick node can't
+          hold any surface (min >= 0 or max < 0)
+        - The far field trace walks the nodes under its sample and jumps over nodes that are all air
+        - The chunk nodes are read back (8 bytes per slot) so the CPU can skip draws for slots without surface, without reading back
+          the volume. Until a slots readback arrives it counts as having surface
+
+        The bricks kernel reuses the triangles dispatch shape, one reduce group per chunk builds the levels above it. FUSED_GENERATE
+        has the density in shared memory anyway so it writes the bricks of its tile itself and only the reduce runs after it.
+
+ */
+
+// IMPORTANT: Has to match shader_density_pyramid.cpp, the levels cover exactly TERRAIN_CHUNK_RES cells
+#define DENSITY_BRICK_RES 4
+#define DENSITY_PYRAMID_LEVELS 4
+#define DENSITY_PYRAMID_NODES_PER_SLOT (1 + 8 + 64 + 512)
+#define DENSITY_PYRAMID_CHUNK_RES (DENSITY_BRICK_RES << (DENSITY_PYRAMID_LEVELS - 1))
+
+struct density_pyramid
+{
+    b32 Dirty;
+    u32 NumSlots;
+    gpu_buffer Nodes;
+
+    // NOTE: Chunk nodes only
+    gpu_buffer Readback;
+    VkBufferCopy* ReadbackRegions;
+    b32 ReadbackPending;
+    b32* SlotSurface;
+    u32 NumSurfaceSlots;
+};
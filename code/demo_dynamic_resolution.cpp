@@ -0,0 +1,100 @@
+
+inline u32 DynamicResolutionAlign(f32 Size, u32 MaxSize)
+{
+    u32 Result = (u32(Size) / DYNAMIC_RES_ALIGNMENT) * DYNAMIC_RES_ALIGNMENT;
+    Result = Result < DYNAMIC_RES_ALIGNMENT ? DYNAMIC_RES_ALIGNMENT : Result;
+    Result = Result > MaxSize ? MaxSize : Result;
+    return Result;
+}
+
+inline void DynamicResolutionResize(dynamic_resolution* DynamicRes, u32 MaxWidth, u32 MaxHeight)
+{
+    DynamicRes->MaxWidth = MaxWidth;
+    DynamicRes->MaxHeight = MaxHeight;
+    DynamicRes->Width = DynamicResolutionAlign(DynamicRes->Scale*f32(MaxWidth), MaxWidth);
+    DynamicRes->Height = DynamicResolutionAlign(DynamicRes->Scale*f32(MaxHeight), MaxHeight);
+}
+
+inline dynamic_resolution DynamicResolutionCreate(u32 MaxWidth, u32 MaxHeight)
+{
+    dynamic_resolution Result = {};
+    Result.Enabled = true;
+    Result.TargetMs = DYNAMIC_RES_TARGET_MS;
+    Result.Scale = DYNAMIC_RES_MAX_SCALE;
+    Result.Sharpness = DYNAMIC_RES_SHARPNESS;
+    DynamicResolutionResize(&Result, MaxWidth, MaxHeight);
+
+    return Result;
+}
+
+inline void DynamicResolutionUpdate(dynamic_resolution* DynamicRes, f64 GpuFrameMs)
+{
+    if (GpuFrameMs <= 0.0)
+    {
+        // NOTE: No timings yet (first frame or timer overflow)
+        return;
+    }
+    
+    if (DynamicRes->FilteredMs == 0.0f)
+    {
+        DynamicRes->FilteredMs = f32(GpuFrameMs);
+    }
+    DynamicRes->FilteredMs += DYNAMIC_RES_FILTER*(f32(GpuFrameMs) - DynamicRes->FilteredMs);
+
+    f32 NewScale = DynamicRes->Scale;
+    if (!DynamicRes->Enabled)
+    {
+        NewScale = DYNAMIC_RES_MAX_SCALE;
+    }
+    else if (DynamicRes->FilteredMs > DynamicRes->TargetMs || DynamicRes->FilteredMs < DYNAMIC_RES_HEADROOM*DynamicRes->TargetMs)
+    {
+        // NOTE: Pixel cost goes with area so the scale that would hit the target is sqrt of the time ratio
+        f32 IdealScale = DynamicRes->Scale * sqrtf(DynamicRes->TargetMs / DynamicRes->FilteredMs);
+        f32 Step = IdealScale - DynamicRes->Scale;
+        Step = Step < -DYNAMIC_RES_MAX_STEP_DOWN ? -DYNAMIC_RES_MAX_STEP_DOWN : Step;
+        Step = Step > DYNAMIC_RES_MAX_STEP_UP ? DYNAMIC_RES_MAX_STEP_UP : Step;
+        NewScale = DynamicRes->Scale + Step;
+    }
+
+    NewScale = NewScale < DYNAMIC_RES_MIN_SCALE ? DYNAMIC_RES_MIN_SCALE : NewScale;
+    NewScale = NewScale > DYNAMIC_RES_MAX_SCALE ? DYNAMIC_RES_MAX_SCALE : NewScale;
+    DynamicRes->Scale = NewScale;
+    DynamicResolutionResize(DynamicRes, DynamicRes->MaxWidth, DynamicRes->MaxHeight);
+}
+
+inline void DynamicResolutionViewportSet(dynamic_resolution* DynamicRes, vk_commands* Commands)
+{
+    VkViewport Viewport = {};
+    Viewport.width = f32(DynamicRes->Width);
+    Viewport.height = f32(DynamicRes->Height);
+    Viewport.minDepth = 0.0f;
+    Viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(Commands->Buffer, 0, 1, &Viewport);
+
+    VkRect2D Scissor = {};
+    Scissor.extent.width = DynamicRes->Width;
+    Scissor.extent.height = DynamicRes->Height;
+    vkCmdSetScissor(Commands->Buffer, 0, 1, &Scissor);
+}
+
+inline copy_to_swap_constants DynamicResolutionCopyConstants(dynamic_resolution* DynamicRes)
+{
+    copy_to_swap_constants Result = {};
+    Result.UvScale = V2(f32(DynamicRes->Width) / f32(DynamicRes->MaxWidth), f32(DynamicRes->Height) / f32(DynamicRes->MaxHeight));
+    Result.InvInputSize = V2(1.0f / f32(DynamicRes->MaxWidth), 1.0f / f32(DynamicRes->MaxHeight));
+    
+    // NOTE: Nothing to sharpen at native resolution
+    b32 Native = DynamicRes->Width == DynamicRes->MaxWidth && DynamicRes->Height == DynamicRes->MaxHeight;
+    Result.Sharpness = Native ? 0.0f : DynamicRes->Sharpness;
+
+    return Result;
+}
+
+inline void DynamicResolutionPanel(ui_panel* Panel, dynamic_resolution* DynamicRes)
+{
+    char Text[256];
+    snprintf(Text, sizeof(Text), "Render Resolution: %ux%u (%.0f%%), GPU %.2fms / %.2fms target", DynamicRes->Width, DynamicRes->Height,
+             100.0f*DynamicRes->Scale, DynamicRes->FilteredMs, DynamicRes->TargetMs);
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+}
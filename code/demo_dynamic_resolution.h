@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+
+  NOTE: Dynamic resolution. The forward targets are always allocated at the window size and we render into a top left sub rect of them
+        through the viewport, so changing the internal resolution never recreates an image. Copy to swap then upscales that rect with a
+        bilinear fetch + optional sharpening.
+
+        The controller looks at last frames GPU time (timestamps are one frame behind) and treats pixel bound cost as scale^2. It drops
+        resolution fast when we are over budget and only creeps back up once we have clear headroom, so it doesn't oscillate around the
+        target. Sizes snap to DYNAMIC_RES_ALIGNMENT pixels so the viewport doesn't change every frame.
+
+ */
+
+#define DYNAMIC_RES_TARGET_MS 14.0f // NOTE: Leave some room under 16.6ms for the CPU side and present
+#define DYNAMIC_RES_MIN_SCALE 0.5f
+#define DYNAMIC_RES_MAX_SCALE 1.0f
+#define DYNAMIC_RES_HEADROOM 0.85f // NOTE: Only scale up when below this fraction of the target
+#define DYNAMIC_RES_MAX_STEP_DOWN 0.1f
+#define DYNAMIC_RES_MAX_STEP_UP 0.02f
+#define DYNAMIC_RES_FILTER 0.2f // NOTE: Weight of the newest sample in the GPU time average
+#define DYNAMIC_RES_ALIGNMENT 8
+#define DYNAMIC_RES_SHARPNESS 0.25f
+
+struct dynamic_resolution
+{
+    b32 Enabled;
+    f32 TargetMs;
+    f32 Scale;
+    f32 FilteredMs;
+    f32 Sharpness;
+
+    // NOTE: Size of the allocated targets and the rect we currently render into
+    u32 MaxWidth;
+    u32 MaxHeight;
+    u32 Width;
+    u32 Height;
+};
+
+// NOTE: Has to match shader_copy_to_swap.cpp
+struct copy_to_swap_constants
+{
+    v2 UvScale;
+    v2 InvInputSize;
+    f32 Sharpness;
+};
@@ -0,0 +1,153 @@
+
+inline void FarFieldCreate(far_field* FarField, gpu_allocator* Allocator, u32 TerrainResX, u32 TerrainResY, u32 TerrainResZ)
+{
+    *FarField = {};
+    FarField->Enabled = true;
+    FarField->Dirty = true;
+    FarField->CutoverDistance = FAR_FIELD_CUTOVER_DISTANCE;
+    FarField->ResX = TerrainResX / 2;
+    FarField->ResY = TerrainResY / 2;
+    FarField->ResZ = TerrainResZ / 2;
+
+    for (u32 LevelId = 0; LevelId < FAR_FIELD_NUM_LEVELS; ++LevelId)
+    {
+        FarField->Levels[LevelId] = GpuImageCreate(Allocator, FarField->ResX >> LevelId, FarField->ResY >> LevelId, FarField->ResZ >> LevelId,
+                                                   VK_FORMAT_R16_SFLOAT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                                   VK_IMAGE_ASPECT_COLOR_BIT, GpuMemoryCategory_Density);
+    }
+}
+
+inline u64 FarFieldMemorySize(far_field* FarField)
+{
+    u64 Result = 0;
+    for (u32 LevelId = 0; LevelId < FAR_FIELD_NUM_LEVELS; ++LevelId)
+    {
+        Result += u64(FarField->ResX >> LevelId)*u64(FarField->ResY >> LevelId)*u64(FarField->ResZ >> LevelId)*sizeof(u16);
+    }
+    return Result;
+}
+
+inline void FarFieldInitLayout(far_field* FarField, vk_commands* Commands)
+{
+    for (u32 LevelId = 0; LevelId < FAR_FIELD_NUM_LEVELS; ++LevelId)
+    {
+        VkBarrierImageAdd(Commands, FarField->Levels[LevelId].Image, VK_IMAGE_ASPECT_COLOR_BIT,
+                          VK_ACCESS_MEMORY_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL);
+    }
+    VkCommandsBarrierFlush(Commands);
+}
+
+// NOTE: Levels are written as storage images by the terrain set and sampled by the forward set
+inline void FarFieldDescriptorWrite(vk_descriptor_manager* Manager, far_field* FarField, VkDescriptorSet TerrainSet, u32 TerrainBinding,
+                                    VkDescriptorSet ForwardSet, u32 ForwardBinding, VkSampler Sampler)
+{
+    for (u32 LevelId = 0; LevelId < FAR_FIELD_NUM_LEVELS; ++LevelId)
+    {
+        VkDescriptorImageWrite(Manager, TerrainSet, TerrainBinding, LevelId, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, FarField->Levels[LevelId].View,
+                               Sampler, VK_IMAGE_LAYOUT_GENERAL);
+        VkDescriptorImageWrite(Manager, ForwardSet, ForwardBinding, LevelId, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                               FarField->Levels[LevelId].View, Sampler, VK_IMAGE_LAYOUT_GENERAL);
+    }
+}
+
+inline void FarFieldBuildRecord(far_field* FarField, vk_commands* Commands, vk_pipeline* Pipeline, VkDescriptorSet TerrainDescriptor,
+                                VkImage DensityAtlas)
+{
+    // NOTE: Last frames trace read the levels, the atlas was just written by generation or an upload
+    VkBarrierImageAdd(Commands, DensityAtlas, VK_IMAGE_ASPECT_COLOR_BIT,
+                      VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                      VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL);
+    for (u32 LevelId = 0; LevelId < FAR_FIELD_NUM_LEVELS; ++LevelId)
+    {
+        VkBarrierImageAdd(Commands, FarField->Levels[LevelId].Image, VK_IMAGE_ASPECT_COLOR_BIT,
+                          VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                          VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL);
+    }
+    VkCommandsBarrierFlush(Commands);
+
+    vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Handle);
+    vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Layout, 0, 1, &TerrainDescriptor, 0, 0);
+    for (u32 LevelId = 0; LevelId < FAR_FIELD_NUM_LEVELS; ++LevelId)
+    {
+        far_field_build_constants PushConstants = {};
+        PushConstants.Level = LevelId;
+        vkCmdPushConstants(Commands->Buffer, Pipeline->Layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &PushConstants);
+        vkCmdDispatch(Commands->Buffer, CeilU32(f32(FarField->ResX >> LevelId) / 4.0f), CeilU32(f32(FarField->ResY >> LevelId) / 4.0f),
+                      CeilU32(f32(FarField->ResZ >> LevelId) / 4.0f));
+
+        // NOTE: The next level reads this one, the last one is read by the trace
+        b32 LastLevel = LevelId == FAR_FIELD_NUM_LEVELS - 1;
+        VkBarrierImageAdd(Commands, FarField->Levels[LevelId].Image, VK_IMAGE_ASPECT_COLOR_BIT,
+                          VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                          VK_ACCESS_SHADER_READ_BIT, 
+                          LastLevel ? VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT : (VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT),
+                          VK_IMAGE_LAYOUT_GENERAL);
+        VkCommandsBarrierFlush(Commands);
+    }
+
+    FarField->Dirty = false;
+}
+
+inline void FarFieldFrameBegin(far_field* FarField)
+{
+    FarField->NumChunksCulled = 0;
+    FarField->CulledMeshSize = 0;
+}
+
+// NOTE: Only chunks that are entirely past the cutover are left to the trace
+inline b32 FarFieldChunkCulled(far_field* FarField, v3 CameraPos, v3 WorldMin, v3 WorldMax, u64 MeshSize)
+{
+    if (!FarField->Enabled)
+    {
+        return false;
+    }
+    
+    v3 Closest = CameraPos;
+    Closest.x = Closest.x < WorldMin.x ? WorldMin.x : (Closest.x > WorldMax.x ? WorldMax.x : Closest.x);
+    Closest.y = Closest.y < WorldMin.y ? WorldMin.y : (Closest.y > WorldMax.y ? WorldMax.y : Closest.y);
+    Closest.z = Closest.z < WorldMin.z ? WorldMin.z : (Closest.z > WorldMax.z ? WorldMax.z : Closest.z);
+    b32 Result = Length(Closest - CameraPos) > FarField->CutoverDistance;
+    if (Result)
+    {
+        FarField->NumChunksCulled += 1;
+        FarField->CulledMeshSize += MeshSize;
+    }
+
+    return Result;
+}
+
+inline far_field_constants FarFieldConstants(far_field* FarField, v3 TerrainMin, v3 TerrainMax, v3 GeneratorRadius, u32 NoiseDim)
+{
+    far_field_constants Result = {};
+    Result.TerrainMin = TerrainMin;
+    Result.TerrainSize = TerrainMax - TerrainMin;
+    Result.CutoverDistance = FarField->CutoverDistance;
+    Result.TexelOffset = V3(0.5f / f32(2*FarField->ResX), 0.5f / f32(2*FarField->ResY), 0.5f / f32(2*FarField->ResZ));
+    Result.Level0TexelSize = Result.TerrainSize.x / f32(FarField->ResX);
+    Result.LodBias = FAR_FIELD_LOD_BIAS;
+
+    // NOTE: Gradient bound of the density per unit of generator uv (see GENERATE_3D_TERRAIN), uv spans the terrain size
+    f32 DensityPerUv = GeneratorRadius.y + f32(NoiseDim)*FAR_FIELD_NOISE_GRADIENT_SUM;
+    f32 MinSize = Result.TerrainSize.x;
+    MinSize = Result.TerrainSize.y < MinSize ? Result.TerrainSize.y : MinSize;
+    MinSize = Result.TerrainSize.z < MinSize ? Result.TerrainSize.z : MinSize;
+    Result.WorldPerDensity = FAR_FIELD_STEP_SCALE * 0.5f * MinSize / DensityPerUv;
+
+    return Result;
+}
+
+inline void FarFieldPanel(ui_panel* Panel, far_field* FarField)
+{
+    if (!FarField->Enabled)
+    {
+        return;
+    }
+    
+    char Text[256];
+    snprintf(Text, sizeof(Text), "Far Field: cutover %.1f, %u chunks traced instead of meshed (%.2fMB of mesh), volume %.2fMB",
+             FarField->CutoverDistance, FarField->NumChunksCulled, f32(FarField->CulledMeshSize) / f32(MegaBytes(1)),
+             f32(FarFieldMemorySize(FarField)) / f32(MegaBytes(1)));
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+}
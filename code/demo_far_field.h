@@ -0,0 +1,62 @@
+#pragma once
+
+/*
+
+  NOTE: Far field. Past FAR_FIELD_CUTOVER_DISTANCE we stop drawing chunk meshes and sphere trace a downsampled copy of the density
+        instead, so distant terrain costs no triangles. The copy is a chain of FAR_FIELD_NUM_LEVELS volumes, level 0 averages 2^3
+        samples of the atlas and every level after that halves again. It is rebuilt whenever the atlas changes.
+
+        The trace runs as a full screen triangle at the end of the forward pass and writes depth, so it composites with the near mesh
+        through the normal depth test. Chunks are only culled when their whole box is past the cutover and the trace starts at the
+        cutover, so the two overlap slightly instead of leaving a gap.
+
+        Density isn't a distance but it is Lipschitz, the -y term plus every noise octave (linear filtered [0, 1] noise changes by at most
+        NoiseDim per unit of uv per unit of frequency). Stepping |density| / bound can't skip over a surface.
+
+ */
+
+#define FAR_FIELD_NUM_LEVELS 4
+#define FAR_FIELD_CUTOVER_DISTANCE 12.0f
+#define FAR_FIELD_LOD_BIAS 0.0f
+#define FAR_FIELD_STEP_SCALE 1.0f // NOTE: > 1 over relaxes the sphere trace, faster but can miss thin features
+// IMPORTANT: Sum of amplitude * frequency over the octaves in GENERATE_3D_TERRAIN
+#define FAR_FIELD_NOISE_GRADIENT_SUM 6.36f
+
+struct far_field
+{
+    b32 Enabled;
+    b32 Dirty;
+    f32 CutoverDistance;
+    u32 ResX; // NOTE: Level 0 resolution
+    u32 ResY;
+    u32 ResZ;
+    gpu_image Levels[FAR_FIELD_NUM_LEVELS];
+
+    // NOTE: Stats for the last frame
+    b32 PrevFrameEnabled;
+    u32 NumChunksCulled;
+    u64 CulledMeshSize;
+};
+
+// NOTE: Has to match FAR_FIELD_DOWNSAMPLE in procedural_3d_terrain_shaders.cpp
+struct far_field_build_constants
+{
+    u32 Level;
+};
+
+// NOTE: Has to match forward_shader.cpp
+struct far_field_constants
+{
+    v3 TerrainMin;
+    f32 CutoverDistance;
+    v3 TerrainSize;
+    f32 WorldPerDensity;
+    v3 TexelOffset; // NOTE: Uvw of terrain sample i is i / Res, level texel centers sit half a sample higher
+    f32 Level0TexelSize;
+    f32 LodBias;
+    f32 Pad;
+    u32 NumChunksX; // NOTE: Chunk i of the grid is density pyramid slot i
+    u32 NumChunksY;
+    u32 NumChunksZ;
+    b32 EmptySpaceSkip;
+};
@@ -0,0 +1,695 @@
+
+global char* GlobalGpuMemoryCategoryNames[GpuMemoryCategory_Count] =
+{
+    "terrain",
+    "density",
+    "noise",
+    "tables",
+    "uniforms",
+    "chunk_cache",
+    "readback",
+    "staging",
+    "lights",
+    "shadows",
+    "debug",
+};
+
+//
+// NOTE: Helpers
+//
+
+inline u32 GpuCeilLog2(u64 Value)
+{
+    u32 Result = 0;
+    while ((u64(1) << Result) < Value)
+    {
+        Result += 1;
+    }
+
+    return Result;
+}
+
+inline u32 GpuNodeLevel(u32 NodeId)
+{
+    u32 Result = 0;
+    while (NodeId > 1)
+    {
+        NodeId >>= 1;
+        Result += 1;
+    }
+
+    return Result;
+}
+
+inline u64 GpuOrderSize(u32 Order)
+{
+    u64 Result = u64(GPU_ALLOCATOR_MIN_NODE_SIZE) << Order;
+    return Result;
+}
+
+inline u64 GpuNodeOffset(u32 NodeId)
+{
+    u32 Level = GpuNodeLevel(NodeId);
+    u64 Result = u64(NodeId - (1 << Level)) * (u64(GPU_ALLOCATOR_BLOCK_SIZE) >> Level);
+    return Result;
+}
+
+inline u32 GpuMemoryTypeFind(gpu_allocator* Allocator, u32 TypeBits, VkMemoryPropertyFlags Flags)
+{
+    u32 Result = GPU_ALLOCATOR_INVALID;
+    for (u32 TypeId = 0; TypeId < Allocator->MemoryProperties.memoryTypeCount; ++TypeId)
+    {
+        if ((TypeBits & (1 << TypeId)) && (Allocator->MemoryProperties.memoryTypes[TypeId].propertyFlags & Flags) == Flags)
+        {
+            Result = TypeId;
+            break;
+        }
+    }
+
+    return Result;
+}
+
+inline b32 GpuMemoryTypeIsHostVisible(gpu_allocator* Allocator, u32 TypeId)
+{
+    b32 Result = (Allocator->MemoryProperties.memoryTypes[TypeId].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+    return Result;
+}
+
+inline VkDeviceMemory GpuDeviceMemoryAllocate(gpu_allocator* Allocator, u64 Size, u32 TypeId, u8** OutMapped)
+{
+    VkMemoryAllocateInfo AllocateInfo = {};
+    AllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    AllocateInfo.allocationSize = Size;
+    AllocateInfo.memoryTypeIndex = TypeId;
+
+    VkDeviceMemory Result = VK_NULL_HANDLE;
+    if (vkAllocateMemory(Allocator->Device, &AllocateInfo, 0, &Result) != VK_SUCCESS)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    *OutMapped = 0;
+    if (GpuMemoryTypeIsHostVisible(Allocator, TypeId))
+    {
+        VkCheckResult(vkMapMemory(Allocator->Device, Result, 0, VK_WHOLE_SIZE, 0, (void**)OutMapped));
+    }
+
+    Allocator->Stats.ReservedSize += Size;
+    return Result;
+}
+
+//
+// NOTE: Buddy Blocks
+//
+
+inline void GpuBlockFreeListPush(gpu_memory_block* Block, u32 Order, u32 NodeId)
+{
+    Block->NodeStates[NodeId] = GpuNodeState_Free;
+    Block->FreeListPos[NodeId] = Block->NumFree[Order];
+    Block->FreeLists[Order][Block->NumFree[Order]++] = NodeId;
+}
+
+inline void GpuBlockFreeListRemove(gpu_memory_block* Block, u32 Order, u32 NodeId)
+{
+    u32 Pos = Block->FreeListPos[NodeId];
+    u32 LastNodeId = Block->FreeLists[Order][--Block->NumFree[Order]];
+    Block->FreeLists[Order][Pos] = LastNodeId;
+    Block->FreeListPos[LastNodeId] = Pos;
+    Block->FreeListPos[NodeId] = GPU_ALLOCATOR_INVALID;
+}
+
+inline u32 GpuBlockCreate(gpu_allocator* Allocator, u32 TypeId, b32 IsImage)
+{
+    // NOTE: Reuse the slot of a block that was released before growing the array
+    u32 Result = GPU_ALLOCATOR_INVALID;
+    for (u32 BlockId = 0; BlockId < Allocator->NumBlocks; ++BlockId)
+    {
+        if (Allocator->Blocks[BlockId].Memory == VK_NULL_HANDLE)
+        {
+            Result = BlockId;
+            break;
+        }
+    }
+
+    if (Result == GPU_ALLOCATOR_INVALID)
+    {
+        if (Allocator->NumBlocks == GPU_ALLOCATOR_MAX_BLOCKS)
+        {
+            return GPU_ALLOCATOR_INVALID;
+        }
+        Result = Allocator->NumBlocks;
+    }
+
+    gpu_memory_block* Block = Allocator->Blocks + Result;
+    VkDeviceMemory Memory = GpuDeviceMemoryAllocate(Allocator, GPU_ALLOCATOR_BLOCK_SIZE, TypeId, &Block->Mapped);
+    if (Memory == VK_NULL_HANDLE)
+    {
+        return GPU_ALLOCATOR_INVALID;
+    }
+    Block->Memory = Memory;
+    Block->MemoryTypeId = TypeId;
+    Block->IsImage = IsImage;
+
+    // NOTE: Bookkeeping lives in the arena and is reused for the lifetime of the program, a released slot keeps its arrays
+    u32 NumNodes = 1 << GPU_ALLOCATOR_NUM_ORDERS;
+    if (!Block->NodeStates)
+    {
+        Block->NodeStates = PushArray(Allocator->Arena, u8, NumNodes);
+        Block->FreeListPos = PushArray(Allocator->Arena, u32, NumNodes);
+        for (u32 Order = 0; Order < GPU_ALLOCATOR_NUM_ORDERS; ++Order)
+        {
+            Block->FreeLists[Order] = PushArray(Allocator->Arena, u32, 1 << (GPU_ALLOCATOR_NUM_ORDERS - 1 - Order));
+        }
+    }
+    for (u32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+    {
+        Block->NodeStates[NodeId] = GpuNodeState_Unused;
+        Block->FreeListPos[NodeId] = GPU_ALLOCATOR_INVALID;
+    }
+    for (u32 Order = 0; Order < GPU_ALLOCATOR_NUM_ORDERS; ++Order)
+    {
+        Block->NumFree[Order] = 0;
+    }
+    GpuBlockFreeListPush(Block, GPU_ALLOCATOR_NUM_ORDERS - 1, 1);
+
+    Allocator->NumBlocks = Result == Allocator->NumBlocks ? Allocator->NumBlocks + 1 : Allocator->NumBlocks;
+    return Result;
+}
+
+inline b32 GpuBlockIsEmpty(gpu_memory_block* Block)
+{
+    b32 Result = Block->Memory != VK_NULL_HANDLE && Block->NodeStates[1] == GpuNodeState_Free;
+    return Result;
+}
+
+/*
+
+  NOTE: Called when a free left the block without any allocations. We keep one empty block per memory type around so a buffer that
+        gets destroyed and recreated (bake readbacks, upload ring overflow) doesn't hit vkAllocateMemory every time, any other empty
+        block goes back to the driver.
+
+ */
+inline void GpuBlockRelease(gpu_allocator* Allocator, u32 BlockId)
+{
+    gpu_memory_block* Block = Allocator->Blocks + BlockId;
+    b32 KeepBlock = true;
+    for (u32 OtherId = 0; OtherId < Allocator->NumBlocks; ++OtherId)
+    {
+        gpu_memory_block* Other = Allocator->Blocks + OtherId;
+        if (OtherId != BlockId && Other->MemoryTypeId == Block->MemoryTypeId && Other->IsImage == Block->IsImage && GpuBlockIsEmpty(Other))
+        {
+            KeepBlock = false;
+            break;
+        }
+    }
+
+    if (KeepBlock)
+    {
+        return;
+    }
+
+    if (Block->Mapped)
+    {
+        vkUnmapMemory(Allocator->Device, Block->Memory);
+    }
+    vkFreeMemory(Allocator->Device, Block->Memory, 0);
+    Allocator->Stats.ReservedSize -= GPU_ALLOCATOR_BLOCK_SIZE;
+
+    Block->Memory = VK_NULL_HANDLE;
+    Block->Mapped = 0;
+    GpuBlockFreeListRemove(Block, GPU_ALLOCATOR_NUM_ORDERS - 1, 1);
+    Block->NodeStates[1] = GpuNodeState_Unused;
+}
+
+inline u32 GpuBlockAllocate(gpu_memory_block* Block, u32 Order)
+{
+    u32 FoundOrder = Order;
+    while (FoundOrder < GPU_ALLOCATOR_NUM_ORDERS && Block->NumFree[FoundOrder] == 0)
+    {
+        FoundOrder += 1;
+    }
+
+    if (FoundOrder == GPU_ALLOCATOR_NUM_ORDERS)
+    {
+        return GPU_ALLOCATOR_INVALID;
+    }
+
+    u32 NodeId = Block->FreeLists[FoundOrder][Block->NumFree[FoundOrder] - 1];
+    GpuBlockFreeListRemove(Block, FoundOrder, NodeId);
+
+    // NOTE: Split down to the order we want, the right halves go on the free lists
+    while (FoundOrder > Order)
+    {
+        Block->NodeStates[NodeId] = GpuNodeState_Split;
+        FoundOrder -= 1;
+        NodeId = 2*NodeId;
+        GpuBlockFreeListPush(Block, FoundOrder, NodeId + 1);
+    }
+
+    Block->NodeStates[NodeId] = GpuNodeState_Allocated;
+    return NodeId;
+}
+
+inline void GpuBlockFree(gpu_memory_block* Block, u32 NodeId)
+{
+    Assert(Block->NodeStates[NodeId] == GpuNodeState_Allocated);
+
+    u32 Order = GPU_ALLOCATOR_NUM_ORDERS - 1 - GpuNodeLevel(NodeId);
+    while (NodeId > 1)
+    {
+        u32 BuddyId = NodeId ^ 1;
+        if (Block->NodeStates[BuddyId] != GpuNodeState_Free)
+        {
+            break;
+        }
+
+        GpuBlockFreeListRemove(Block, Order, BuddyId);
+        Block->NodeStates[BuddyId] = GpuNodeState_Unused;
+        Block->NodeStates[NodeId] = GpuNodeState_Unused;
+        NodeId >>= 1;
+        Order += 1;
+    }
+
+    GpuBlockFreeListPush(Block, Order, NodeId);
+}
+
+inline b32 GpuBuddyAllocate(gpu_allocator* Allocator, u32 TypeId, b32 IsImage, u32 Order, u32* OutBlockId, u32* OutNodeId)
+{
+    for (u32 BlockId = 0; BlockId < Allocator->NumBlocks; ++BlockId)
+    {
+        gpu_memory_block* Block = Allocator->Blocks + BlockId;
+        if (Block->Memory != VK_NULL_HANDLE && Block->MemoryTypeId == TypeId && Block->IsImage == IsImage)
+        {
+            u32 NodeId = GpuBlockAllocate(Block, Order);
+            if (NodeId != GPU_ALLOCATOR_INVALID)
+            {
+                *OutBlockId = BlockId;
+                *OutNodeId = NodeId;
+                return true;
+            }
+        }
+    }
+
+    u32 BlockId = GpuBlockCreate(Allocator, TypeId, IsImage);
+    if (BlockId == GPU_ALLOCATOR_INVALID)
+    {
+        return false;
+    }
+
+    *OutBlockId = BlockId;
+    *OutNodeId = GpuBlockAllocate(Allocator->Blocks + BlockId, Order);
+    return true;
+}
+
+//
+// NOTE: Size Class Slabs
+//
+
+inline u32 GpuSlabNumSlots(u32 SizeClass)
+{
+    u32 Result = GPU_ALLOCATOR_MAX_SLOTS >> SizeClass;
+    return Result;
+}
+
+inline b32 GpuSlabAllocate(gpu_allocator* Allocator, u32 TypeId, b32 IsImage, u32 SizeClass, u32* OutSlabId, u32* OutSlotId)
+{
+    u32 SlabId = Allocator->SlabLists[SizeClass];
+    while (SlabId != GPU_ALLOCATOR_INVALID)
+    {
+        gpu_slab* Slab = Allocator->Slabs + SlabId;
+        gpu_memory_block* Block = Allocator->Blocks + Slab->BlockId;
+        if (Slab->NumFree > 0 && Block->MemoryTypeId == TypeId && Block->IsImage == IsImage)
+        {
+            break;
+        }
+        SlabId = Slab->NextSlab;
+    }
+
+    if (SlabId == GPU_ALLOCATOR_INVALID)
+    {
+        // NOTE: No slab with space left, carve a new one out of a min size buddy node
+        if (Allocator->FreeSlab != GPU_ALLOCATOR_INVALID)
+        {
+            SlabId = Allocator->FreeSlab;
+            Allocator->FreeSlab = Allocator->Slabs[SlabId].NextSlab;
+        }
+        else if (Allocator->NumSlabs < GPU_ALLOCATOR_MAX_SLABS)
+        {
+            SlabId = Allocator->NumSlabs++;
+        }
+        else
+        {
+            return false;
+        }
+
+        gpu_slab* Slab = Allocator->Slabs + SlabId;
+        if (!GpuBuddyAllocate(Allocator, TypeId, IsImage, 0, &Slab->BlockId, &Slab->NodeId))
+        {
+            Slab->NextSlab = Allocator->FreeSlab;
+            Allocator->FreeSlab = SlabId;
+            return false;
+        }
+
+        Slab->SizeClass = SizeClass;
+        Slab->NumFree = GpuSlabNumSlots(SizeClass);
+        for (u32 SlotId = 0; SlotId < Slab->NumFree; ++SlotId)
+        {
+            Slab->FreeSlots[SlotId] = u16(Slab->NumFree - 1 - SlotId);
+        }
+
+        Slab->NextSlab = Allocator->SlabLists[SizeClass];
+        Allocator->SlabLists[SizeClass] = SlabId;
+        Allocator->Stats.NumSlabs += 1;
+    }
+
+    gpu_slab* Slab = Allocator->Slabs + SlabId;
+    *OutSlabId = SlabId;
+    *OutSlotId = Slab->FreeSlots[--Slab->NumFree];
+    return true;
+}
+
+inline void GpuSlabFree(gpu_allocator* Allocator, u32 SlabId, u32 SlotId)
+{
+    gpu_slab* Slab = Allocator->Slabs + SlabId;
+    Slab->FreeSlots[Slab->NumFree++] = u16(SlotId);
+
+    if (Slab->NumFree == GpuSlabNumSlots(Slab->SizeClass))
+    {
+        // NOTE: Slab is empty, give the node back to the buddy allocator so it can merge
+        u32* PrevNext = Allocator->SlabLists + Slab->SizeClass;
+        while (*PrevNext != SlabId)
+        {
+            PrevNext = &Allocator->Slabs[*PrevNext].NextSlab;
+        }
+        *PrevNext = Slab->NextSlab;
+
+        GpuBlockFree(Allocator->Blocks + Slab->BlockId, Slab->NodeId);
+        if (GpuBlockIsEmpty(Allocator->Blocks + Slab->BlockId))
+        {
+            GpuBlockRelease(Allocator, Slab->BlockId);
+        }
+        Slab->NextSlab = Allocator->FreeSlab;
+        Allocator->FreeSlab = SlabId;
+        Allocator->Stats.NumSlabs -= 1;
+    }
+}
+
+//
+// NOTE: Allocator API
+//
+
+inline void GpuAllocatorCreate(gpu_allocator* Allocator, linear_arena* Arena, VkInstance Instance, VkDevice Device,
+                               VkPhysicalDevice PhysicalDevice)
+{
+    *Allocator = {};
+    Allocator->Device = Device;
+    Allocator->PhysicalDevice = PhysicalDevice;
+    Allocator->Arena = Arena;
+    vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &Allocator->MemoryProperties);
+
+    Allocator->FreeSlab = GPU_ALLOCATOR_INVALID;
+    Allocator->Slabs = PushArray(Arena, gpu_slab, GPU_ALLOCATOR_MAX_SLABS);
+    for (u32 SizeClass = 0; SizeClass < GPU_ALLOCATOR_NUM_SIZE_CLASSES; ++SizeClass)
+    {
+        Allocator->SlabLists[SizeClass] = GPU_ALLOCATOR_INVALID;
+    }
+
+    // NOTE: Budget numbers are optional, we only report them if the device exposes VK_EXT_memory_budget
+    {
+        u32 NumExtensions = 0;
+        vkEnumerateDeviceExtensionProperties(PhysicalDevice, 0, &NumExtensions, 0);
+        VkExtensionProperties* Extensions = (VkExtensionProperties*)DemoMemoryAlloc(sizeof(VkExtensionProperties)*NumExtensions);
+        vkEnumerateDeviceExtensionProperties(PhysicalDevice, 0, &NumExtensions, Extensions);
+        for (u32 ExtensionId = 0; ExtensionId < NumExtensions; ++ExtensionId)
+        {
+            if (strcmp(Extensions[ExtensionId].extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+            {
+                Allocator->Stats.BudgetSupported = true;
+                break;
+            }
+        }
+        DemoMemoryFree(Extensions, sizeof(VkExtensionProperties)*NumExtensions);
+
+        Allocator->GetMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2)vkGetInstanceProcAddr(Instance, "vkGetPhysicalDeviceMemoryProperties2");
+        if (!Allocator->GetMemoryProperties2)
+        {
+            Allocator->GetMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2)vkGetInstanceProcAddr(Instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+        }
+        Allocator->Stats.BudgetSupported = Allocator->Stats.BudgetSupported && Allocator->GetMemoryProperties2;
+    }
+}
+
+inline gpu_allocation GpuAllocate(gpu_allocator* Allocator, VkMemoryRequirements Requirements, VkMemoryPropertyFlags Flags, b32 IsImage,
+                                  gpu_memory_category Category)
+{
+    // IMPORTANT: Not thread safe, all allocations happen on the main thread
+    gpu_allocation Result = {};
+    Result.Category = Category;
+    Result.Size = Requirements.size;
+    Result.BlockId = GPU_ALLOCATOR_INVALID;
+    Result.NodeId = GPU_ALLOCATOR_INVALID;
+    Result.SlabId = GPU_ALLOCATOR_INVALID;
+    Result.SlotId = GPU_ALLOCATOR_INVALID;
+
+    u32 TypeId = GpuMemoryTypeFind(Allocator, Requirements.memoryTypeBits, Flags);
+    if (TypeId == GPU_ALLOCATOR_INVALID && (Flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT))
+    {
+        // NOTE: Cached is a preference for readbacks, not every device has it
+        TypeId = GpuMemoryTypeFind(Allocator, Requirements.memoryTypeBits, Flags & ~VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    }
+    if (TypeId == GPU_ALLOCATOR_INVALID && (Flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && (Flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+    {
+        // NOTE: Same for device local + host visible (BAR), fall back to plain host memory
+        TypeId = GpuMemoryTypeFind(Allocator, Requirements.memoryTypeBits, Flags & ~VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+    Assert(TypeId != GPU_ALLOCATOR_INVALID);
+
+    u64 Size = Requirements.size > Requirements.alignment ? Requirements.size : Requirements.alignment;
+    b32 Allocated = false;
+    if (Size <= GPU_ALLOCATOR_BLOCK_SIZE / 2)
+    {
+        u32 SizeLog2 = GpuCeilLog2(Size);
+        u32 MinSlotLog2 = GpuCeilLog2(GPU_ALLOCATOR_MIN_SLOT_SIZE);
+        u32 SizeClass = SizeLog2 > MinSlotLog2 ? SizeLog2 - MinSlotLog2 : 0;
+        if (SizeClass < GPU_ALLOCATOR_NUM_SIZE_CLASSES)
+        {
+            Allocated = GpuSlabAllocate(Allocator, TypeId, IsImage, SizeClass, &Result.SlabId, &Result.SlotId);
+            if (Allocated)
+            {
+                gpu_slab* Slab = Allocator->Slabs + Result.SlabId;
+                Result.BlockId = Slab->BlockId;
+                Result.UsedSize = u64(GPU_ALLOCATOR_MIN_SLOT_SIZE) << SizeClass;
+                Result.Offset = GpuNodeOffset(Slab->NodeId) + Result.SlotId*Result.UsedSize;
+            }
+        }
+        else
+        {
+            u32 Order = SizeLog2 - GpuCeilLog2(GPU_ALLOCATOR_MIN_NODE_SIZE);
+            Allocated = GpuBuddyAllocate(Allocator, TypeId, IsImage, Order, &Result.BlockId, &Result.NodeId);
+            if (Allocated)
+            {
+                Result.UsedSize = GpuOrderSize(Order);
+                Result.Offset = GpuNodeOffset(Result.NodeId);
+            }
+        }
+    }
+
+    if (Allocated)
+    {
+        gpu_memory_block* Block = Allocator->Blocks + Result.BlockId;
+        Result.Memory = Block->Memory;
+        Result.Mapped = Block->Mapped ? Block->Mapped + Result.Offset : 0;
+    }
+    else
+    {
+        // NOTE: Too big for a block (or we ran out of blocks), give it its own allocation
+        Result.BlockId = GPU_ALLOCATOR_INVALID;
+        Result.UsedSize = Requirements.size;
+        Result.Offset = 0;
+        Result.Memory = GpuDeviceMemoryAllocate(Allocator, Requirements.size, TypeId, &Result.Mapped);
+        Assert(Result.Memory != VK_NULL_HANDLE);
+        Allocator->Stats.NumDedicated += 1;
+    }
+
+    Allocator->Stats.NumAllocations += 1;
+    Allocator->Stats.AllocatedSize += Result.Size;
+    Allocator->Stats.UsedSize += Result.UsedSize;
+    Allocator->Stats.CategorySize[Category] += Result.Size;
+
+    return Result;
+}
+
+inline void GpuFree(gpu_allocator* Allocator, gpu_allocation* Allocation)
+{
+    if (Allocation->Memory == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    if (Allocation->BlockId == GPU_ALLOCATOR_INVALID)
+    {
+        if (Allocation->Mapped)
+        {
+            vkUnmapMemory(Allocator->Device, Allocation->Memory);
+        }
+        vkFreeMemory(Allocator->Device, Allocation->Memory, 0);
+        Allocator->Stats.ReservedSize -= Allocation->Size;
+        Allocator->Stats.NumDedicated -= 1;
+    }
+    else if (Allocation->SlabId != GPU_ALLOCATOR_INVALID)
+    {
+        GpuSlabFree(Allocator, Allocation->SlabId, Allocation->SlotId);
+    }
+    else
+    {
+        GpuBlockFree(Allocator->Blocks + Allocation->BlockId, Allocation->NodeId);
+        if (GpuBlockIsEmpty(Allocator->Blocks + Allocation->BlockId))
+        {
+            GpuBlockRelease(Allocator, Allocation->BlockId);
+        }
+    }
+
+    Allocator->Stats.NumAllocations -= 1;
+    Allocator->Stats.AllocatedSize -= Allocation->Size;
+    Allocator->Stats.UsedSize -= Allocation->UsedSize;
+    Allocator->Stats.CategorySize[Allocation->Category] -= Allocation->Size;
+
+    *Allocation = {};
+}
+
+inline void GpuAllocatorUpdateStats(gpu_allocator* Allocator)
+{
+    gpu_memory_stats* Stats = &Allocator->Stats;
+    Stats->NumBlocks = 0;
+    Stats->FreeSize = 0;
+    Stats->LargestFreeSize = 0;
+    for (u32 BlockId = 0; BlockId < Allocator->NumBlocks; ++BlockId)
+    {
+        gpu_memory_block* Block = Allocator->Blocks + BlockId;
+        Stats->NumBlocks += Block->Memory != VK_NULL_HANDLE ? 1 : 0;
+        for (u32 Order = 0; Order < GPU_ALLOCATOR_NUM_ORDERS; ++Order)
+        {
+            Stats->FreeSize += Block->NumFree[Order]*GpuOrderSize(Order);
+            if (Block->NumFree[Order] > 0 && GpuOrderSize(Order) > Stats->LargestFreeSize)
+            {
+                Stats->LargestFreeSize = GpuOrderSize(Order);
+            }
+        }
+    }
+
+    u64 SlabSlack = 0;
+    for (u32 SizeClass = 0; SizeClass < GPU_ALLOCATOR_NUM_SIZE_CLASSES; ++SizeClass)
+    {
+        for (u32 SlabId = Allocator->SlabLists[SizeClass]; SlabId != GPU_ALLOCATOR_INVALID; SlabId = Allocator->Slabs[SlabId].NextSlab)
+        {
+            SlabSlack += u64(Allocator->Slabs[SlabId].NumFree)*(u64(GPU_ALLOCATOR_MIN_SLOT_SIZE) << SizeClass);
+        }
+    }
+
+    Stats->FragmentedSize = (Stats->UsedSize - Stats->AllocatedSize) + SlabSlack;
+    Stats->FragmentationRatio = Stats->FreeSize > 0 ? 1.0f - f32(f64(Stats->LargestFreeSize) / f64(Stats->FreeSize)) : 0.0f;
+
+    if (Stats->BudgetSupported)
+    {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT Budget = {};
+        Budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2 Properties = {};
+        Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        Properties.pNext = &Budget;
+        Allocator->GetMemoryProperties2(Allocator->PhysicalDevice, &Properties);
+
+        Stats->NumHeaps = Properties.memoryProperties.memoryHeapCount;
+        for (u32 HeapId = 0; HeapId < Stats->NumHeaps; ++HeapId)
+        {
+            Stats->HeapBudget[HeapId] = Budget.heapBudget[HeapId];
+            Stats->HeapUsage[HeapId] = Budget.heapUsage[HeapId];
+        }
+    }
+}
+
+//
+// NOTE: Buffers + Images
+//
+
+inline gpu_buffer GpuBufferCreate(gpu_allocator* Allocator, VkBufferUsageFlags Usage, VkMemoryPropertyFlags MemoryFlags, u64 Size,
+                                  gpu_memory_category Category)
+{
+    gpu_buffer Result = {};
+
+    VkBufferCreateInfo BufferCreateInfo = {};
+    BufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    BufferCreateInfo.size = Size;
+    BufferCreateInfo.usage = Usage;
+    BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VkCheckResult(vkCreateBuffer(Allocator->Device, &BufferCreateInfo, 0, &Result.Buffer));
+
+    VkMemoryRequirements MemoryRequirements;
+    vkGetBufferMemoryRequirements(Allocator->Device, Result.Buffer, &MemoryRequirements);
+    Result.Allocation = GpuAllocate(Allocator, MemoryRequirements, MemoryFlags, false, Category);
+    VkCheckResult(vkBindBufferMemory(Allocator->Device, Result.Buffer, Result.Allocation.Memory, Result.Allocation.Offset));
+
+    return Result;
+}
+
+inline void GpuBufferDestroy(gpu_allocator* Allocator, gpu_buffer* Buffer)
+{
+    if (Buffer->Buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(Allocator->Device, Buffer->Buffer, 0);
+        GpuFree(Allocator, &Buffer->Allocation);
+    }
+
+    *Buffer = {};
+}
+
+inline gpu_image GpuImageCreate(gpu_allocator* Allocator, u32 Width, u32 Height, u32 Depth, VkFormat Format, VkImageUsageFlags Usage,
+                                VkImageAspectFlags AspectMask, gpu_memory_category Category)
+{
+    gpu_image Result = {};
+
+    VkImageCreateInfo ImageCreateInfo = {};
+    ImageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    ImageCreateInfo.imageType = Depth > 1 ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D;
+    ImageCreateInfo.format = Format;
+    ImageCreateInfo.extent.width = Width;
+    ImageCreateInfo.extent.height = Height;
+    ImageCreateInfo.extent.depth = Depth;
+    ImageCreateInfo.mipLevels = 1;
+    ImageCreateInfo.arrayLayers = 1;
+    ImageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    ImageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ImageCreateInfo.usage = Usage;
+    ImageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ImageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkCheckResult(vkCreateImage(Allocator->Device, &ImageCreateInfo, 0, &Result.Image));
+
+    VkMemoryRequirements MemoryRequirements;
+    vkGetImageMemoryRequirements(Allocator->Device, Result.Image, &MemoryRequirements);
+    Result.Allocation = GpuAllocate(Allocator, MemoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true, Category);
+    VkCheckResult(vkBindImageMemory(Allocator->Device, Result.Image, Result.Allocation.Memory, Result.Allocation.Offset));
+
+    VkImageViewCreateInfo ViewCreateInfo = {};
+    ViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    ViewCreateInfo.image = Result.Image;
+    ViewCreateInfo.viewType = Depth > 1 ? VK_IMAGE_VIEW_TYPE_3D : VK_IMAGE_VIEW_TYPE_2D;
+    ViewCreateInfo.format = Format;
+    ViewCreateInfo.subresourceRange.aspectMask = AspectMask;
+    ViewCreateInfo.subresourceRange.levelCount = 1;
+    ViewCreateInfo.subresourceRange.layerCount = 1;
+    VkCheckResult(vkCreateImageView(Allocator->Device, &ViewCreateInfo, 0, &Result.View));
+
+    return Result;
+}
+
+inline void GpuImageDestroy(gpu_allocator* Allocator, gpu_image* Image)
+{
+    if (Image->Image != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(Allocator->Device, Image->View, 0);
+        vkDestroyImage(Allocator->Device, Image->Image, 0);
+        GpuFree(Allocator, &Image->Allocation);
+    }
+
+    *Image = {};
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+/*
+
+  NOTE: GPU Suballocator
+
+    Instead of one linear arena that only ever grows, device memory is reserved in GPU_ALLOCATOR_BLOCK_SIZE blocks and handed out by:
+
+    - A buddy allocator per block for anything >= GPU_ALLOCATOR_MIN_NODE_SIZE. Nodes are naturally aligned to their size so any
+      alignment up to the node size is free. Freeing merges with the buddy when it is also free. A block that ends up empty goes back
+      to the driver (except one spare per memory type) and its slot is reused by the next block.
+    - Size class slabs for small allocations (uniforms, lookup tables). A slab is one min size buddy node split into power of two
+      slots with a free slot stack, so small buffers don't each burn a 64KB node.
+    - Dedicated vkAllocateMemory for anything larger than half a block (TerrainTriangles, readbacks of the whole volume).
+
+    Buffers and optimal tiling images never share a block so we never have to care about bufferImageGranularity. Host visible blocks
+    are persistently mapped.
+
+    Every allocation is tagged with a category so the UI/benchmark can show where memory goes. If VK_EXT_memory_budget is available
+    we also report the drivers view of per heap budget/usage.
+
+ */
+
+#define GPU_ALLOCATOR_BLOCK_SIZE MegaBytes(256)
+#define GPU_ALLOCATOR_MIN_NODE_SIZE KiloBytes(64)
+#define GPU_ALLOCATOR_NUM_ORDERS 13 // NOTE: 64KB << 12 = 256MB
+#define GPU_ALLOCATOR_MAX_BLOCKS 32
+#define GPU_ALLOCATOR_MAX_SLABS 512
+
+#define GPU_ALLOCATOR_MIN_SLOT_SIZE 256
+#define GPU_ALLOCATOR_NUM_SIZE_CLASSES 8 // NOTE: 256B -> 32KB
+#define GPU_ALLOCATOR_MAX_SLOTS (GPU_ALLOCATOR_MIN_NODE_SIZE / GPU_ALLOCATOR_MIN_SLOT_SIZE)
+
+#define GPU_ALLOCATOR_INVALID 0xFFFFFFFF
+
+enum gpu_memory_category
+{
+    GpuMemoryCategory_Terrain,
+    GpuMemoryCategory_Density,
+    GpuMemoryCategory_Noise,
+    GpuMemoryCategory_Tables,
+    GpuMemoryCategory_Uniforms,
+    GpuMemoryCategory_ChunkCache,
+    GpuMemoryCategory_Readback,
+    GpuMemoryCategory_Staging,
+    GpuMemoryCategory_Lights,
+    GpuMemoryCategory_Shadows,
+    GpuMemoryCategory_Debug,
+
+    GpuMemoryCategory_Count,
+};
+
+enum gpu_node_state : u8
+{
+    GpuNodeState_Unused, // NOTE: Part of a larger free/allocated node
+    GpuNodeState_Free,
+    GpuNodeState_Split,
+    GpuNodeState_Allocated,
+};
+
+struct gpu_memory_block
+{
+    VkDeviceMemory Memory; // NOTE: VK_NULL_HANDLE once the block was released
+    u8* Mapped;
+    u32 MemoryTypeId;
+    b32 IsImage;
+
+    // NOTE: Buddy tree, node 1 is the whole block and node i has children 2i, 2i + 1
+    u8* NodeStates;
+    u32* FreeListPos;
+    u32* FreeLists[GPU_ALLOCATOR_NUM_ORDERS];
+    u32 NumFree[GPU_ALLOCATOR_NUM_ORDERS];
+};
+
+struct gpu_slab
+{
+    u32 BlockId;
+    u32 NodeId;
+    u32 SizeClass;
+    u32 NextSlab;
+    u32 NumFree;
+    u16 FreeSlots[GPU_ALLOCATOR_MAX_SLOTS];
+};
+
+struct gpu_allocation
+{
+    VkDeviceMemory Memory;
+    u64 Offset;
+    u64 Size;
+    u64 UsedSize;
+    u8* Mapped;
+
+    gpu_memory_category Category;
+    u32 BlockId; // NOTE: GPU_ALLOCATOR_INVALID for dedicated allocations
+    u32 NodeId;
+    u32 SlabId; // NOTE: GPU_ALLOCATOR_INVALID for buddy allocations
+    u32 SlotId;
+};
+
+struct gpu_memory_stats
+{
+    u64 ReservedSize; // NOTE: What we got from vkAllocateMemory
+    u64 AllocatedSize; // NOTE: What was asked for
+    u64 UsedSize; // NOTE: Allocated + rounding to node/slot sizes
+    u64 FreeSize;
+    u64 LargestFreeSize;
+    u64 FragmentedSize; // NOTE: Rounding waste + empty slab slots
+    f32 FragmentationRatio; // NOTE: 1 - LargestFree / Free, 0 means all free memory is one node
+    u32 NumAllocations;
+    u32 NumDedicated;
+    u32 NumBlocks;
+    u32 NumSlabs;
+    u64 CategorySize[GpuMemoryCategory_Count];
+
+    b32 BudgetSupported;
+    u32 NumHeaps;
+    u64 HeapBudget[VK_MAX_MEMORY_HEAPS];
+    u64 HeapUsage[VK_MAX_MEMORY_HEAPS];
+};
+
+struct gpu_allocator
+{
+    VkDevice Device;
+    VkPhysicalDevice PhysicalDevice;
+    VkPhysicalDeviceMemoryProperties MemoryProperties;
+    PFN_vkGetPhysicalDeviceMemoryProperties2 GetMemoryProperties2;
+    linear_arena* Arena;
+
+    u32 NumBlocks;
+    gpu_memory_block Blocks[GPU_ALLOCATOR_MAX_BLOCKS];
+
+    u32 NumSlabs;
+    u32 FreeSlab;
+    gpu_slab* Slabs;
+    u32 SlabLists[GPU_ALLOCATOR_NUM_SIZE_CLASSES];
+
+    gpu_memory_stats Stats;
+};
+
+struct gpu_buffer
+{
+    VkBuffer Buffer;
+    gpu_allocation Allocation;
+};
+
+struct gpu_image
+{
+    VkImage Image;
+    VkImageView View;
+    gpu_allocation Allocation;
+};
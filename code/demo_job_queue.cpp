@@ -0,0 +1,125 @@
+
+inline b32 JobQueueDoNextEntry(job_queue* Queue, u32 ThreadId)
+{
+    b32 ShouldSleep = false;
+
+    u32 OriginalNextEntryToRead = Queue->NextEntryToRead;
+    u32 NewNextEntryToRead = (OriginalNextEntryToRead + 1) % JOB_QUEUE_MAX_ENTRIES;
+    if (OriginalNextEntryToRead != Queue->NextEntryToWrite)
+    {
+        u32 Index = DemoAtomicCompareExchangeU32(&Queue->NextEntryToRead, NewNextEntryToRead, OriginalNextEntryToRead);
+        if (Index == OriginalNextEntryToRead)
+        {
+            job_entry Entry = Queue->Entries[Index];
+            Entry.Callback(Entry.Data, ThreadId);
+            DemoAtomicAddU32(&Queue->CompletionCount, 1);
+        }
+    }
+    else
+    {
+        ShouldSleep = true;
+    }
+
+    return ShouldSleep;
+}
+
+inline void JobQueueThreadProc(void* Data)
+{
+    job_worker* Worker = (job_worker*)Data;
+    job_queue* Queue = Worker->Queue;
+    while (!Queue->Stopping)
+    {
+        if (JobQueueDoNextEntry(Queue, Worker->ThreadId))
+        {
+            DemoSemaphoreWait(&Queue->Semaphore);
+        }
+    }
+
+    DemoAtomicAddU32(&Queue->NumExited, 1);
+}
+
+inline void JobQueueStart(job_queue* Queue)
+{
+    if (Queue->Running)
+    {
+        return;
+    }
+
+    Queue->Stopping = false;
+    Queue->NumExited = 0;
+    Queue->Running = true;
+    for (u32 ThreadId = 0; ThreadId < Queue->NumThreads; ++ThreadId)
+    {
+        job_worker* Worker = Queue->Workers + ThreadId;
+        Worker->Queue = Queue;
+        Worker->ThreadId = ThreadId + 1;
+        DemoThreadCreate(Queue->Threads + ThreadId, JobQueueThreadProc, Worker);
+    }
+}
+
+inline void JobQueueCreate(job_queue* Queue, u32 NumThreads)
+{
+    *Queue = {};
+    Queue->NumThreads = NumThreads < JOB_QUEUE_MAX_THREADS ? NumThreads : JOB_QUEUE_MAX_THREADS;
+    DemoSemaphoreCreate(&Queue->Semaphore, Queue->NumThreads);
+    JobQueueStart(Queue);
+}
+
+inline void JobQueueAdd(job_queue* Queue, job_callback* Callback, void* Data)
+{
+    u32 NewNextEntryToWrite = (Queue->NextEntryToWrite + 1) % JOB_QUEUE_MAX_ENTRIES;
+    Assert(NewNextEntryToWrite != Queue->NextEntryToRead);
+
+    job_entry* Entry = Queue->Entries + Queue->NextEntryToWrite;
+    Entry->Callback = Callback;
+    Entry->Data = Data;
+    Queue->CompletionGoal += 1;
+
+    // NOTE: The entry has to be visible before we publish it
+    DemoMemoryFence();
+    Queue->NextEntryToWrite = NewNextEntryToWrite;
+    DemoSemaphoreSignal(&Queue->Semaphore);
+}
+
+inline b32 JobQueueIsIdle(job_queue* Queue)
+{
+    b32 Result = Queue->CompletionGoal == Queue->CompletionCount;
+    return Result;
+}
+
+inline void JobQueueCompleteAll(job_queue* Queue)
+{
+    while (!JobQueueIsIdle(Queue))
+    {
+        JobQueueDoNextEntry(Queue, 0);
+    }
+
+    Queue->CompletionGoal = 0;
+    Queue->CompletionCount = 0;
+}
+
+// NOTE: Finishes every queued job and joins the workers, jobs added while stopped run on the main thread in JobQueueCompleteAll
+inline void JobQueueStop(job_queue* Queue)
+{
+    if (!Queue->Running)
+    {
+        return;
+    }
+
+    JobQueueCompleteAll(Queue);
+    Queue->Stopping = true;
+    DemoMemoryFence();
+
+    // NOTE: Every sleeping worker needs a wake up to see the flag. Wakes can get lost to a full semaphore or be eaten by a worker that
+    //       hadn't seen the flag yet, so keep signaling until all of them left
+    while (Queue->NumExited < Queue->NumThreads)
+    {
+        DemoSemaphoreSignal(&Queue->Semaphore);
+        DemoSleepMs(1);
+    }
+    for (u32 ThreadId = 0; ThreadId < Queue->NumThreads; ++ThreadId)
+    {
+        DemoThreadJoin(Queue->Threads + ThreadId);
+    }
+    Queue->Running = false;
+}
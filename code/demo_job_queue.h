@@ -0,0 +1,47 @@
+#pragma once
+
+/*
+
+  NOTE: Work queue shared by all the CPU side terrain work (pipeline creation, baking, queries). Jobs are added from the main thread
+        only, any number of worker threads pull from it, and the main thread helps out while it waits in JobQueueCompleteAll.
+
+  IMPORTANT: The worker threads run code from the demo DLL, so they can't be alive while the DLL gets unloaded. JobQueueStop drains the
+             queue and joins them, JobQueueStart brings them back up with the callbacks of the new DLL (see DemoCodeWatchThreadProc).
+
+ */
+
+#define JOB_QUEUE_MAX_ENTRIES 1024
+#define JOB_QUEUE_MAX_THREADS 64
+
+// NOTE: ThreadId is 0 for the main thread and 1 + the worker index for the workers, for per thread state like the residency epochs
+typedef void job_callback(void* Data, u32 ThreadId);
+
+struct job_entry
+{
+    job_callback* Callback;
+    void* Data;
+};
+
+struct job_queue;
+struct job_worker
+{
+    job_queue* Queue;
+    u32 ThreadId;
+};
+
+struct job_queue
+{
+    volatile u32 CompletionGoal;
+    volatile u32 CompletionCount;
+    volatile u32 NextEntryToWrite;
+    volatile u32 NextEntryToRead;
+    volatile u32 Stopping;
+    volatile u32 NumExited;
+    demo_semaphore Semaphore;
+    job_entry Entries[JOB_QUEUE_MAX_ENTRIES];
+
+    b32 Running;
+    u32 NumThreads;
+    demo_thread Threads[JOB_QUEUE_MAX_THREADS];
+    job_worker Workers[JOB_QUEUE_MAX_THREADS];
+};
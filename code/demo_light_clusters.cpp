@@ -0,0 +1,66 @@
+
+inline light_clusters LightClustersCreate(gpu_allocator* Allocator, u32 MaxLights)
+{
+    light_clusters Result = {};
+    Result.MaxLights = MaxLights;
+    Result.PointLights = GpuBufferCreate(Allocator, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(gpu_point_light)*MaxLights, GpuMemoryCategory_Lights);
+    Result.ClusterLightCounts = GpuBufferCreate(Allocator, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(u32)*LIGHT_CLUSTER_COUNT, GpuMemoryCategory_Lights);
+    Result.ClusterLightIndices = GpuBufferCreate(Allocator, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                 sizeof(u32)*LIGHT_CLUSTER_COUNT*LIGHT_CLUSTER_MAX_LIGHTS, GpuMemoryCategory_Lights);
+
+    return Result;
+}
+
+inline void LightClustersDescriptorWrite(vk_descriptor_manager* Manager, VkDescriptorSet Set, u32 FirstBinding, light_clusters* Clusters)
+{
+    VkDescriptorBufferWrite(Manager, Set, FirstBinding + 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, Clusters->PointLights.Buffer);
+    VkDescriptorBufferWrite(Manager, Set, FirstBinding + 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, Clusters->ClusterLightCounts.Buffer);
+    VkDescriptorBufferWrite(Manager, Set, FirstBinding + 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, Clusters->ClusterLightIndices.Buffer);
+}
+
+inline gpu_point_light* LightClustersPushLights(light_clusters* Clusters, upload_ring* UploadRing, u32 NumLights)
+{
+    Assert(NumLights <= Clusters->MaxLights);
+    Clusters->NumLights = NumLights;
+    gpu_point_light* Result = UploadRingPushArray(UploadRing, Clusters->PointLights.Buffer, gpu_point_light, NumLights,
+                                                  VK_ACCESS_SHADER_READ_BIT,
+                                                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    return Result;
+}
+
+inline void LightClustersRecord(vk_commands* Commands, light_clusters* Clusters, vk_pipeline* Pipeline, VkDescriptorSet Descriptor,
+                                u32 SceneUniformOffset)
+{
+    // NOTE: Last frames forward pass read the lists we are about to clear
+    VkBarrierBufferAdd(Commands, Clusters->ClusterLightCounts.Buffer,
+                       VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkCommandsBarrierFlush(Commands);
+    
+    vkCmdFillBuffer(Commands->Buffer, Clusters->ClusterLightCounts.Buffer, 0, VK_WHOLE_SIZE, 0);
+
+    VkBarrierBufferAdd(Commands, Clusters->ClusterLightCounts.Buffer,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkBarrierBufferAdd(Commands, Clusters->ClusterLightIndices.Buffer,
+                       VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    if (Clusters->NumLights > 0)
+    {
+        vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Handle);
+        vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Layout, 0, 1, &Descriptor, 1, &SceneUniformOffset);
+        vkCmdDispatch(Commands->Buffer, CeilU32(f32(Clusters->NumLights) / 64.0f), 1, 1);
+    }
+
+    VkBarrierBufferAdd(Commands, Clusters->ClusterLightCounts.Buffer,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    VkBarrierBufferAdd(Commands, Clusters->ClusterLightIndices.Buffer,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    VkCommandsBarrierFlush(Commands);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+/*
+
+  NOTE: Clustered forward lighting, see shader_light_clusters.cpp for the GPU side. Lights live in a storage buffer in world space and
+        are binned every frame (one thread per light) into a froxel grid of fixed size light index lists, so the forward pass only pays
+        for the lights near each pixel.
+
+ */
+
+// IMPORTANT: Has to match shader_light_clusters.cpp
+#define LIGHT_CLUSTER_TILES_X 16
+#define LIGHT_CLUSTER_TILES_Y 9
+#define LIGHT_CLUSTER_TILES_Z 24
+#define LIGHT_CLUSTER_MAX_LIGHTS 128
+#define LIGHT_CLUSTER_NEAR 0.1f
+#define LIGHT_CLUSTER_FAR 100.0f
+#define DEMO_NUM_POINT_LIGHTS 1024
+#define LIGHT_CLUSTER_COUNT (LIGHT_CLUSTER_TILES_X*LIGHT_CLUSTER_TILES_Y*LIGHT_CLUSTER_TILES_Z)
+
+// NOTE: Mirrors point_light in shader_light_types.cpp (std430)
+struct gpu_point_light
+{
+    v3 Color;
+    u32 Pad;
+    v3 Pos;
+    f32 MaxDistance;
+};
+
+struct light_clusters
+{
+    u32 MaxLights;
+    u32 NumLights;
+    gpu_buffer PointLights;
+    gpu_buffer ClusterLightCounts;
+    gpu_buffer ClusterLightIndices;
+};
@@ -0,0 +1,422 @@
+
+//
+// NOTE: Pipeline Cache
+//
+
+inline void DemoPipelineCacheCreate(demo_pipelines* Pipelines, VkDevice Device, VkPhysicalDevice PhysicalDevice, char* FileName)
+{
+    VkPhysicalDeviceProperties Properties;
+    vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+
+    u64 FileSize = 0;
+    u8* FileData = DemoFileReadAll(FileName, &FileSize);
+
+    // NOTE: Only hand the blob to the driver if it was written by this exact device and driver
+    u64 InitialDataSize = 0;
+    void* InitialData = 0;
+    if (FileData && FileSize >= sizeof(pipeline_cache_file_header))
+    {
+        pipeline_cache_file_header* Header = (pipeline_cache_file_header*)FileData;
+        b32 Valid = (Header->Magic == PIPELINE_CACHE_MAGIC &&
+                     Header->Version == PIPELINE_CACHE_VERSION &&
+                     Header->VendorId == Properties.vendorID &&
+                     Header->DeviceId == Properties.deviceID &&
+                     Header->DriverVersion == Properties.driverVersion &&
+                     memcmp(Header->PipelineCacheUuid, Properties.pipelineCacheUUID, VK_UUID_SIZE) == 0 &&
+                     sizeof(pipeline_cache_file_header) + Header->DataSize == FileSize);
+
+        // NOTE: The driver blob repeats the device ids in its own header, check those too
+        if (Valid && Header->DataSize >= sizeof(VkPipelineCacheHeaderVersionOne))
+        {
+            VkPipelineCacheHeaderVersionOne* DriverHeader = (VkPipelineCacheHeaderVersionOne*)(Header + 1);
+            Valid = (DriverHeader->headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                     DriverHeader->vendorID == Properties.vendorID &&
+                     DriverHeader->deviceID == Properties.deviceID &&
+                     memcmp(DriverHeader->pipelineCacheUUID, Properties.pipelineCacheUUID, VK_UUID_SIZE) == 0);
+        }
+        else
+        {
+            Valid = false;
+        }
+
+        if (Valid)
+        {
+            InitialDataSize = Header->DataSize;
+            InitialData = Header + 1;
+        }
+    }
+
+    VkPipelineCacheCreateInfo CreateInfo = {};
+    CreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    CreateInfo.initialDataSize = size_t(InitialDataSize);
+    CreateInfo.pInitialData = InitialData;
+    VkCheckResult(vkCreatePipelineCache(Device, &CreateInfo, 0, &Pipelines->Cache));
+    Pipelines->CacheLoaded = InitialDataSize > 0;
+
+    DemoMemoryFree(FileData, FileSize);
+}
+
+inline void DemoPipelineCacheSave(demo_pipelines* Pipelines, VkDevice Device, VkPhysicalDevice PhysicalDevice, char* FileName)
+{
+    size_t DataSize = 0;
+    VkCheckResult(vkGetPipelineCacheData(Device, Pipelines->Cache, &DataSize, 0));
+    if (DataSize == 0)
+    {
+        return;
+    }
+
+    u64 FileSize = sizeof(pipeline_cache_file_header) + DataSize;
+    u8* FileData = (u8*)DemoMemoryAlloc(FileSize);
+    VkCheckResult(vkGetPipelineCacheData(Device, Pipelines->Cache, &DataSize, FileData + sizeof(pipeline_cache_file_header)));
+
+    VkPhysicalDeviceProperties Properties;
+    vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+
+    pipeline_cache_file_header* Header = (pipeline_cache_file_header*)FileData;
+    Header->Magic = PIPELINE_CACHE_MAGIC;
+    Header->Version = PIPELINE_CACHE_VERSION;
+    Header->VendorId = Properties.vendorID;
+    Header->DeviceId = Properties.deviceID;
+    Header->DriverVersion = Properties.driverVersion;
+    Copy(Properties.pipelineCacheUUID, Header->PipelineCacheUuid, VK_UUID_SIZE);
+    Header->DataSize = DataSize;
+
+    DemoFileWriteAll(FileName, FileData, sizeof(pipeline_cache_file_header) + DataSize);
+    DemoMemoryFree(FileData, FileSize);
+}
+
+//
+// NOTE: Pipeline Descs
+//
+
+inline pipeline_desc DemoPipelineDescCompute(char* FileName, char* MainName)
+{
+    pipeline_desc Result = {};
+    Result.Type = PipelineType_Compute;
+    Result.NumShaders = 1;
+    Result.Shaders[0].FileName = FileName;
+    Result.Shaders[0].MainName = MainName;
+    Result.Shaders[0].Stage = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    return Result;
+}
+
+inline pipeline_desc DemoPipelineDescGraphics(VkRenderPass RenderPass, u32 SubPass)
+{
+    pipeline_desc Result = {};
+    Result.Type = PipelineType_Graphics;
+    Result.RenderPass = RenderPass;
+    Result.SubPass = SubPass;
+    Result.Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    Result.CullMode = VK_CULL_MODE_NONE;
+    Result.DepthCompareOp = VK_COMPARE_OP_ALWAYS;
+    Result.NumColorAttachments = 1;
+    Result.ColorWriteMask = (VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+                             VK_COLOR_COMPONENT_A_BIT);
+
+    return Result;
+}
+
+inline void DemoPipelineDescShaderAdd(pipeline_desc* Desc, char* FileName, char* MainName, VkShaderStageFlagBits Stage)
+{
+    Assert(Desc->NumShaders < PIPELINE_MAX_SHADERS);
+    pipeline_shader_desc* Shader = Desc->Shaders + Desc->NumShaders++;
+    Shader->FileName = FileName;
+    Shader->MainName = MainName;
+    Shader->Stage = Stage;
+}
+
+inline void DemoPipelineDescLayoutAdd(pipeline_desc* Desc, VkDescriptorSetLayout Layout)
+{
+    Assert(Desc->NumLayouts < PIPELINE_MAX_LAYOUTS);
+    Desc->Layouts[Desc->NumLayouts++] = Layout;
+}
+
+inline void DemoPipelineDescPushConstantAdd(pipeline_desc* Desc, VkShaderStageFlags Stages, u32 Offset, u32 Size)
+{
+    Assert(Desc->NumPushConstants < PIPELINE_MAX_PUSH_CONSTANTS);
+    VkPushConstantRange* Range = Desc->PushConstants + Desc->NumPushConstants++;
+    Range->stageFlags = Stages;
+    Range->offset = Offset;
+    Range->size = Size;
+}
+
+inline void DemoPipelineDescSpecConstantAdd(pipeline_desc* Desc, u32 ConstantId, u32 Value)
+{
+    Assert(Desc->NumSpecConstants < PIPELINE_MAX_SPEC_CONSTANTS);
+    Desc->SpecConstantIds[Desc->NumSpecConstants] = ConstantId;
+    Desc->SpecConstantValues[Desc->NumSpecConstants] = Value;
+    Desc->NumSpecConstants += 1;
+}
+
+inline void DemoPipelineDescVertexAttributeAdd(pipeline_desc* Desc, VkFormat Format, u32 Size)
+{
+    Assert(Desc->NumVertexAttributes < PIPELINE_MAX_VERTEX_ATTRIBUTES);
+    Desc->VertexFormats[Desc->NumVertexAttributes] = Format;
+    Desc->VertexOffsets[Desc->NumVertexAttributes] = Desc->VertexStride;
+    Desc->NumVertexAttributes += 1;
+    Desc->VertexStride += Size;
+}
+
+inline void DemoPipelineDescDepthSet(pipeline_desc* Desc, VkBool32 TestEnable, VkBool32 WriteEnable, VkCompareOp CompareOp)
+{
+    Desc->DepthTestEnable = TestEnable;
+    Desc->DepthWriteEnable = WriteEnable;
+    Desc->DepthCompareOp = CompareOp;
+}
+
+//
+// NOTE: Pipeline Creation
+//
+
+inline VkShaderModule DemoShaderModuleLoad(VkDevice Device, char* FileName)
+{
+    VkShaderModule Result = VK_NULL_HANDLE;
+
+    u64 CodeSize = 0;
+    u8* Code = DemoFileReadAll(FileName, &CodeSize);
+    if (Code)
+    {
+        VkShaderModuleCreateInfo CreateInfo = {};
+        CreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        CreateInfo.codeSize = size_t(CodeSize);
+        CreateInfo.pCode = (u32*)Code;
+        VkCheckResult(vkCreateShaderModule(Device, &CreateInfo, 0, &Result));
+        DemoMemoryFree(Code, CodeSize);
+    }
+
+    return Result;
+}
+
+// NOTE: Thread safe, only touches the desc and the (internally synchronized) pipeline cache
+inline b32 DemoPipelineCreate(VkDevice Device, VkPipelineCache Cache, pipeline_desc* Desc, VkPipeline* OutHandle, VkPipelineLayout* OutLayout)
+{
+    *OutHandle = VK_NULL_HANDLE;
+    *OutLayout = VK_NULL_HANDLE;
+
+    VkShaderModule Modules[PIPELINE_MAX_SHADERS] = {};
+    b32 ModulesValid = true;
+    for (u32 ShaderId = 0; ShaderId < Desc->NumShaders; ++ShaderId)
+    {
+        Modules[ShaderId] = DemoShaderModuleLoad(Device, Desc->Shaders[ShaderId].FileName);
+        ModulesValid = ModulesValid && Modules[ShaderId] != VK_NULL_HANDLE;
+    }
+
+    if (ModulesValid)
+    {
+        VkPipelineLayoutCreateInfo LayoutCreateInfo = {};
+        LayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        LayoutCreateInfo.setLayoutCount = Desc->NumLayouts;
+        LayoutCreateInfo.pSetLayouts = Desc->Layouts;
+        LayoutCreateInfo.pushConstantRangeCount = Desc->NumPushConstants;
+        LayoutCreateInfo.pPushConstantRanges = Desc->PushConstants;
+        VkCheckResult(vkCreatePipelineLayout(Device, &LayoutCreateInfo, 0, OutLayout));
+
+        VkSpecializationMapEntry SpecEntries[PIPELINE_MAX_SPEC_CONSTANTS] = {};
+        for (u32 ConstantId = 0; ConstantId < Desc->NumSpecConstants; ++ConstantId)
+        {
+            SpecEntries[ConstantId].constantID = Desc->SpecConstantIds[ConstantId];
+            SpecEntries[ConstantId].offset = sizeof(u32)*ConstantId;
+            SpecEntries[ConstantId].size = sizeof(u32);
+        }
+
+        VkSpecializationInfo SpecInfo = {};
+        SpecInfo.mapEntryCount = Desc->NumSpecConstants;
+        SpecInfo.pMapEntries = SpecEntries;
+        SpecInfo.dataSize = sizeof(u32)*Desc->NumSpecConstants;
+        SpecInfo.pData = Desc->SpecConstantValues;
+
+        VkPipelineShaderStageCreateInfo Stages[PIPELINE_MAX_SHADERS] = {};
+        for (u32 ShaderId = 0; ShaderId < Desc->NumShaders; ++ShaderId)
+        {
+            Stages[ShaderId].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            Stages[ShaderId].stage = Desc->Shaders[ShaderId].Stage;
+            Stages[ShaderId].module = Modules[ShaderId];
+            Stages[ShaderId].pName = Desc->Shaders[ShaderId].MainName;
+            Stages[ShaderId].pSpecializationInfo = Desc->NumSpecConstants > 0 ? &SpecInfo : 0;
+        }
+
+        switch (Desc->Type)
+        {
+            case PipelineType_Compute:
+            {
+                VkComputePipelineCreateInfo CreateInfo = {};
+                CreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+                CreateInfo.stage = Stages[0];
+                CreateInfo.layout = *OutLayout;
+                VkCheckResult(vkCreateComputePipelines(Device, Cache, 1, &CreateInfo, 0, OutHandle));
+            } break;
+
+            case PipelineType_Graphics:
+            {
+                VkVertexInputBindingDescription VertexBinding = {};
+                VertexBinding.binding = 0;
+                VertexBinding.stride = Desc->VertexStride;
+                VertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+                VkVertexInputAttributeDescription VertexAttributes[PIPELINE_MAX_VERTEX_ATTRIBUTES] = {};
+                for (u32 AttributeId = 0; AttributeId < Desc->NumVertexAttributes; ++AttributeId)
+                {
+                    VertexAttributes[AttributeId].location = AttributeId;
+                    VertexAttributes[AttributeId].binding = 0;
+                    VertexAttributes[AttributeId].format = Desc->VertexFormats[AttributeId];
+                    VertexAttributes[AttributeId].offset = Desc->VertexOffsets[AttributeId];
+                }
+
+                VkPipelineVertexInputStateCreateInfo VertexInputState = {};
+                VertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+                VertexInputState.vertexBindingDescriptionCount = Desc->NumVertexAttributes > 0 ? 1 : 0;
+                VertexInputState.pVertexBindingDescriptions = &VertexBinding;
+                VertexInputState.vertexAttributeDescriptionCount = Desc->NumVertexAttributes;
+                VertexInputState.pVertexAttributeDescriptions = VertexAttributes;
+
+                VkPipelineInputAssemblyStateCreateInfo InputAssemblyState = {};
+                InputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+                InputAssemblyState.topology = Desc->Topology;
+
+                // NOTE: Viewport and scissor are set by RenderTargetPassBegin
+                VkPipelineViewportStateCreateInfo ViewportState = {};
+                ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+                ViewportState.viewportCount = 1;
+                ViewportState.scissorCount = 1;
+
+                VkDynamicState DynamicStates[] =
+                {
+                    VK_DYNAMIC_STATE_VIEWPORT,
+                    VK_DYNAMIC_STATE_SCISSOR,
+                };
+                VkPipelineDynamicStateCreateInfo DynamicState = {};
+                DynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+                DynamicState.dynamicStateCount = ArrayCount(DynamicStates);
+                DynamicState.pDynamicStates = DynamicStates;
+
+                VkPipelineRasterizationStateCreateInfo RasterizationState = {};
+                RasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+                RasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+                RasterizationState.cullMode = Desc->CullMode;
+                RasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+                RasterizationState.lineWidth = 1.0f;
+
+                VkPipelineMultisampleStateCreateInfo MultisampleState = {};
+                MultisampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+                MultisampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+                VkPipelineDepthStencilStateCreateInfo DepthStencilState = {};
+                DepthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+                DepthStencilState.depthTestEnable = Desc->DepthTestEnable;
+                DepthStencilState.depthWriteEnable = Desc->DepthWriteEnable;
+                DepthStencilState.depthCompareOp = Desc->DepthCompareOp;
+
+                VkPipelineColorBlendAttachmentState BlendAttachments[4] = {};
+                Assert(Desc->NumColorAttachments <= ArrayCount(BlendAttachments));
+                for (u32 AttachmentId = 0; AttachmentId < Desc->NumColorAttachments; ++AttachmentId)
+                {
+                    BlendAttachments[AttachmentId].blendEnable = VK_FALSE;
+                    BlendAttachments[AttachmentId].colorWriteMask = Desc->ColorWriteMask;
+                }
+
+                VkPipelineColorBlendStateCreateInfo ColorBlendState = {};
+                ColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+                ColorBlendState.attachmentCount = Desc->NumColorAttachments;
+                ColorBlendState.pAttachments = BlendAttachments;
+
+                VkGraphicsPipelineCreateInfo CreateInfo = {};
+                CreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+                CreateInfo.stageCount = Desc->NumShaders;
+                CreateInfo.pStages = Stages;
+                CreateInfo.pVertexInputState = &VertexInputState;
+                CreateInfo.pInputAssemblyState = &InputAssemblyState;
+                CreateInfo.pViewportState = &ViewportState;
+                CreateInfo.pRasterizationState = &RasterizationState;
+                CreateInfo.pMultisampleState = &MultisampleState;
+                CreateInfo.pDepthStencilState = &DepthStencilState;
+                CreateInfo.pColorBlendState = &ColorBlendState;
+                CreateInfo.pDynamicState = &DynamicState;
+                CreateInfo.layout = *OutLayout;
+                CreateInfo.renderPass = Desc->RenderPass;
+                CreateInfo.subpass = Desc->SubPass;
+                VkCheckResult(vkCreateGraphicsPipelines(Device, Cache, 1, &CreateInfo, 0, OutHandle));
+            } break;
+
+            default:
+            {
+                InvalidCodePath;
+            } break;
+        }
+    }
+
+    for (u32 ShaderId = 0; ShaderId < Desc->NumShaders; ++ShaderId)
+    {
+        if (Modules[ShaderId] != VK_NULL_HANDLE)
+        {
+            vkDestroyShaderModule(Device, Modules[ShaderId], 0);
+        }
+    }
+
+    b32 Result = *OutHandle != VK_NULL_HANDLE;
+    return Result;
+}
+
+inline vk_pipeline* DemoPipelineAdd(demo_pipelines* Pipelines, linear_arena* Arena, pipeline_desc* Desc)
+{
+    Assert(Pipelines->NumEntries < PIPELINE_MAX_ENTRIES);
+    pipeline_entry* Entry = Pipelines->Entries + Pipelines->NumEntries++;
+    Entry->Desc = *Desc;
+    Entry->Pipeline = PushStruct(Arena, vk_pipeline);
+    *Entry->Pipeline = {};
+
+    return Entry->Pipeline;
+}
+
+inline pipeline_entry* DemoPipelineFindEntry(demo_pipelines* Pipelines, vk_pipeline* Pipeline)
+{
+    pipeline_entry* Result = 0;
+    for (u32 EntryId = 0; EntryId < Pipelines->NumEntries; ++EntryId)
+    {
+        if (Pipelines->Entries[EntryId].Pipeline == Pipeline)
+        {
+            Result = Pipelines->Entries + EntryId;
+            break;
+        }
+    }
+
+    return Result;
+}
+
+inline void DemoPipelineBuildJob(void* Data, u32 ThreadId)
+{
+    pipeline_build_job* Job = (pipeline_build_job*)Data;
+
+    u64 StartTime = DemoTimerGet();
+    DemoPipelineCreate(RenderState->Device, Job->Cache, &Job->Entry->Desc, &Job->Handle, &Job->Layout);
+    Job->Entry->CreateMs = DemoTimerElapsedMs(StartTime);
+}
+
+// NOTE: Fans out creation of every pipeline that doesn't have a handle yet across the job queue and waits for all of them
+inline void DemoPipelinesBuild(demo_pipelines* Pipelines, job_queue* JobQueue, linear_arena* TempArena)
+{
+    pipeline_build_job* Jobs = PushArray(TempArena, pipeline_build_job, Pipelines->NumEntries);
+    u32 NumJobs = 0;
+    for (u32 EntryId = 0; EntryId < Pipelines->NumEntries; ++EntryId)
+    {
+        pipeline_entry* Entry = Pipelines->Entries + EntryId;
+        if (Entry->Pipeline->Handle == VK_NULL_HANDLE)
+        {
+            pipeline_build_job* Job = Jobs + NumJobs++;
+            *Job = {};
+            Job->Entry = Entry;
+            Job->Cache = Pipelines->Cache;
+            JobQueueAdd(JobQueue, DemoPipelineBuildJob, Job);
+        }
+    }
+
+    JobQueueCompleteAll(JobQueue);
+
+    for (u32 JobId = 0; JobId < NumJobs; ++JobId)
+    {
+        pipeline_build_job* Job = Jobs + JobId;
+        Assert(Job->Handle != VK_NULL_HANDLE);
+        Job->Entry->Pipeline->Handle = Job->Handle;
+        Job->Entry->Pipeline->Layout = Job->Layout;
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+/*
+
+  NOTE: Pipeline creation for the demo. Instead of building every PSO serially through the framework, each pipeline is described up
+        front by a pipeline_desc and all of them are compiled in parallel on the job queue against one shared VkPipelineCache. The
+        cache is serialized to disk and only reused if it was written by the same device + driver (pipeline cache UUID).
+
+        The descs are kept around after creation so that pipelines can be rebuilt later (shader reloads, new variants).
+
+ */
+
+#define PIPELINE_CACHE_FILE_NAME "pipeline_cache.bin"
+#define PIPELINE_CACHE_MAGIC 0x48435050 // NOTE: "PPCH"
+#define PIPELINE_CACHE_VERSION 1
+
+#define PIPELINE_MAX_SHADERS 2
+#define PIPELINE_MAX_LAYOUTS 4
+#define PIPELINE_MAX_PUSH_CONSTANTS 2
+#define PIPELINE_MAX_VERTEX_ATTRIBUTES 4
+#define PIPELINE_MAX_SPEC_CONSTANTS 8
+#define PIPELINE_MAX_ENTRIES 320
+
+struct pipeline_cache_file_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 VendorId;
+    u32 DeviceId;
+    u32 DriverVersion;
+    u8 PipelineCacheUuid[VK_UUID_SIZE];
+    u64 DataSize;
+};
+
+enum pipeline_type
+{
+    PipelineType_Compute,
+    PipelineType_Graphics,
+};
+
+struct pipeline_shader_desc
+{
+    char* FileName;
+    char* MainName;
+    VkShaderStageFlagBits Stage;
+};
+
+struct pipeline_desc
+{
+    pipeline_type Type;
+
+    u32 NumShaders;
+    pipeline_shader_desc Shaders[PIPELINE_MAX_SHADERS];
+
+    u32 NumLayouts;
+    VkDescriptorSetLayout Layouts[PIPELINE_MAX_LAYOUTS];
+
+    u32 NumPushConstants;
+    VkPushConstantRange PushConstants[PIPELINE_MAX_PUSH_CONSTANTS];
+
+    // NOTE: Specialization constants are u32 and applied to every stage
+    u32 NumSpecConstants;
+    u32 SpecConstantIds[PIPELINE_MAX_SPEC_CONSTANTS];
+    u32 SpecConstantValues[PIPELINE_MAX_SPEC_CONSTANTS];
+
+    // NOTE: Graphics state
+    VkRenderPass RenderPass;
+    u32 SubPass;
+
+    u32 VertexStride;
+    u32 NumVertexAttributes;
+    VkFormat VertexFormats[PIPELINE_MAX_VERTEX_ATTRIBUTES];
+    u32 VertexOffsets[PIPELINE_MAX_VERTEX_ATTRIBUTES];
+
+    VkPrimitiveTopology Topology;
+    VkCullModeFlags CullMode;
+    VkBool32 DepthTestEnable;
+    VkBool32 DepthWriteEnable;
+    VkCompareOp DepthCompareOp;
+    u32 NumColorAttachments;
+    VkColorComponentFlags ColorWriteMask;
+};
+
+struct pipeline_entry
+{
+    pipeline_desc Desc;
+    vk_pipeline* Pipeline;
+    f64 CreateMs;
+};
+
+struct demo_pipelines
+{
+    VkPipelineCache Cache;
+    b32 CacheLoaded;
+
+    u32 NumEntries;
+    pipeline_entry Entries[PIPELINE_MAX_ENTRIES];
+};
+
+struct pipeline_build_job
+{
+    pipeline_entry* Entry;
+    VkPipelineCache Cache;
+    VkPipeline Handle;
+    VkPipelineLayout Layout;
+};
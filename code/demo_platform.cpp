@@ -0,0 +1,537 @@
+
+//
+// NOTE: Timers
+//
+
+inline u64 DemoTimerGet()
+{
+    u64 Result = 0;
+#if defined(_WIN32)
+    LARGE_INTEGER Counter;
+    QueryPerformanceCounter(&Counter);
+    Result = u64(Counter.QuadPart);
+#else
+    timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    Result = u64(Time.tv_sec)*1000000000ull + u64(Time.tv_nsec);
+#endif
+    return Result;
+}
+
+inline f64 DemoTimerToMs(u64 Ticks)
+{
+    f64 Result = 0.0;
+#if defined(_WIN32)
+    LARGE_INTEGER Frequency;
+    QueryPerformanceFrequency(&Frequency);
+    Result = 1000.0 * f64(Ticks) / f64(Frequency.QuadPart);
+#else
+    Result = f64(Ticks) / 1000000.0;
+#endif
+    return Result;
+}
+
+inline f64 DemoTimerElapsedMs(u64 StartTicks)
+{
+    f64 Result = DemoTimerToMs(DemoTimerGet() - StartTicks);
+    return Result;
+}
+
+//
+// NOTE: Scratch Memory
+//
+
+/*
+
+  NOTE: Offline work like baking chunk archives can need hundreds of MB of scratch memory which we don't want to reserve in the program
+        arena for the whole run, so we go straight to the OS for it.
+
+ */
+
+inline void* DemoMemoryAlloc(u64 Size)
+{
+    void* Result = 0;
+#if defined(_WIN32)
+    Result = VirtualAlloc(0, Size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    Result = mmap(0, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (Result == MAP_FAILED)
+    {
+        Result = 0;
+    }
+#endif
+    return Result;
+}
+
+inline void DemoMemoryFree(void* Memory, u64 Size)
+{
+    if (Memory)
+    {
+#if defined(_WIN32)
+        VirtualFree(Memory, 0, MEM_RELEASE);
+#else
+        munmap(Memory, Size);
+#endif
+    }
+}
+
+//
+// NOTE: File Mapping
+//
+
+inline b32 DemoFileMapOpen(char* FileName, demo_file_map* Result)
+{
+    *Result = {};
+
+#if defined(_WIN32)
+    Result->File = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (Result->File == INVALID_HANDLE_VALUE)
+    {
+        *Result = {};
+        return false;
+    }
+
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(Result->File, &FileSize) || FileSize.QuadPart == 0)
+    {
+        CloseHandle(Result->File);
+        *Result = {};
+        return false;
+    }
+
+    Result->Size = u64(FileSize.QuadPart);
+    Result->Mapping = CreateFileMappingA(Result->File, 0, PAGE_READONLY, 0, 0, 0);
+    if (!Result->Mapping)
+    {
+        CloseHandle(Result->File);
+        *Result = {};
+        return false;
+    }
+
+    Result->Memory = (u8*)MapViewOfFile(Result->Mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!Result->Memory)
+    {
+        CloseHandle(Result->Mapping);
+        CloseHandle(Result->File);
+        *Result = {};
+        return false;
+    }
+#else
+    Result->File = open(FileName, O_RDONLY);
+    if (Result->File < 0)
+    {
+        *Result = {};
+        return false;
+    }
+
+    struct stat FileStat;
+    if (fstat(Result->File, &FileStat) != 0 || FileStat.st_size == 0)
+    {
+        close(Result->File);
+        *Result = {};
+        return false;
+    }
+
+    Result->Size = u64(FileStat.st_size);
+    void* Memory = mmap(0, Result->Size, PROT_READ, MAP_PRIVATE, Result->File, 0);
+    if (Memory == MAP_FAILED)
+    {
+        close(Result->File);
+        *Result = {};
+        return false;
+    }
+
+    // NOTE: Blobs are read front to back exactly once when we upload them
+    madvise(Memory, Result->Size, MADV_SEQUENTIAL);
+    Result->Memory = (u8*)Memory;
+#endif
+
+    return true;
+}
+
+inline void DemoFileMapClose(demo_file_map* Map)
+{
+    if (Map->Memory)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(Map->Memory);
+        CloseHandle(Map->Mapping);
+        CloseHandle(Map->File);
+#else
+        munmap(Map->Memory, Map->Size);
+        close(Map->File);
+#endif
+    }
+
+    *Map = {};
+}
+
+inline b32 DemoFileExists(char* FileName)
+{
+    b32 Result = false;
+    FILE* File = fopen(FileName, "rb");
+    if (File)
+    {
+        Result = true;
+        fclose(File);
+    }
+
+    return Result;
+}
+
+//
+// NOTE: Atomics
+//
+
+// NOTE: All of these return the value that was in Dest before the operation
+inline u32 DemoAtomicCompareExchangeU32(volatile u32* Dest, u32 NewValue, u32 Expected)
+{
+#if defined(_WIN32)
+    u32 Result = u32(_InterlockedCompareExchange((volatile long*)Dest, long(NewValue), long(Expected)));
+#else
+    u32 Result = __sync_val_compare_and_swap(Dest, Expected, NewValue);
+#endif
+    return Result;
+}
+
+inline u64 DemoAtomicCompareExchangeU64(volatile u64* Dest, u64 NewValue, u64 Expected)
+{
+#if defined(_WIN32)
+    u64 Result = u64(_InterlockedCompareExchange64((volatile __int64*)Dest, __int64(NewValue), __int64(Expected)));
+#else
+    u64 Result = __sync_val_compare_and_swap(Dest, Expected, NewValue);
+#endif
+    return Result;
+}
+
+inline u32 DemoAtomicAddU32(volatile u32* Dest, u32 Value)
+{
+#if defined(_WIN32)
+    u32 Result = u32(_InterlockedExchangeAdd((volatile long*)Dest, long(Value)));
+#else
+    u32 Result = __sync_fetch_and_add(Dest, Value);
+#endif
+    return Result;
+}
+
+inline u64 DemoAtomicAddU64(volatile u64* Dest, u64 Value)
+{
+#if defined(_WIN32)
+    u64 Result = u64(_InterlockedExchangeAdd64((volatile __int64*)Dest, __int64(Value)));
+#else
+    u64 Result = __sync_fetch_and_add(Dest, Value);
+#endif
+    return Result;
+}
+
+inline u32 DemoAtomicExchangeU32(volatile u32* Dest, u32 Value)
+{
+#if defined(_WIN32)
+    u32 Result = u32(_InterlockedExchange((volatile long*)Dest, long(Value)));
+#else
+    u32 Result = __sync_lock_test_and_set(Dest, Value);
+    __sync_synchronize();
+#endif
+    return Result;
+}
+
+inline void DemoMemoryFence()
+{
+#if defined(_WIN32)
+    _ReadWriteBarrier();
+    _mm_mfence();
+#else
+    __sync_synchronize();
+#endif
+}
+
+// NOTE: Index of the lowest set bit, Value can't be 0
+inline u32 DemoBitScanForwardU64(u64 Value)
+{
+#if defined(_WIN32)
+    unsigned long Index;
+    _BitScanForward64(&Index, Value);
+    u32 Result = u32(Index);
+#else
+    u32 Result = u32(__builtin_ctzll(Value));
+#endif
+    return Result;
+}
+
+//
+// NOTE: Threads
+//
+
+inline u32 DemoGetNumCores()
+{
+#if defined(_WIN32)
+    SYSTEM_INFO SystemInfo;
+    GetSystemInfo(&SystemInfo);
+    u32 Result = u32(SystemInfo.dwNumberOfProcessors);
+#else
+    long NumCores = sysconf(_SC_NPROCESSORS_ONLN);
+    u32 Result = NumCores > 0 ? u32(NumCores) : 1;
+#endif
+    return Result;
+}
+
+inline void DemoSemaphoreCreate(demo_semaphore* Semaphore, u32 MaxCount)
+{
+#if defined(_WIN32)
+    Semaphore->Handle = CreateSemaphoreExA(0, 0, MaxCount, 0, 0, SEMAPHORE_ALL_ACCESS);
+#else
+    sem_init(&Semaphore->Handle, 0, 0);
+#endif
+}
+
+inline void DemoSemaphoreSignal(demo_semaphore* Semaphore)
+{
+#if defined(_WIN32)
+    ReleaseSemaphore(Semaphore->Handle, 1, 0);
+#else
+    sem_post(&Semaphore->Handle);
+#endif
+}
+
+inline void DemoSemaphoreWait(demo_semaphore* Semaphore)
+{
+#if defined(_WIN32)
+    WaitForSingleObjectEx(Semaphore->Handle, INFINITE, FALSE);
+#else
+    while (sem_wait(&Semaphore->Handle) != 0)
+    {
+    }
+#endif
+}
+
+#if defined(_WIN32)
+DWORD WINAPI DemoThreadEntry(LPVOID Param)
+{
+    demo_thread* Thread = (demo_thread*)Param;
+    Thread->Proc(Thread->Data);
+    return 0;
+}
+#else
+void* DemoThreadEntry(void* Param)
+{
+    demo_thread* Thread = (demo_thread*)Param;
+    Thread->Proc(Thread->Data);
+    return 0;
+}
+#endif
+
+// IMPORTANT: Thread has to stay alive at the same address for the lifetime of the thread
+inline void DemoThreadCreate(demo_thread* Thread, demo_thread_proc* Proc, void* Data)
+{
+    Thread->Proc = Proc;
+    Thread->Data = Data;
+#if defined(_WIN32)
+    Thread->Handle = CreateThread(0, 0, DemoThreadEntry, Thread, 0, 0);
+#else
+    pthread_create(&Thread->Handle, 0, DemoThreadEntry, Thread);
+#endif
+}
+
+inline void DemoSleepMs(u32 Ms)
+{
+#if defined(_WIN32)
+    Sleep(Ms);
+#else
+    usleep(Ms*1000);
+#endif
+}
+
+inline void DemoThreadJoin(demo_thread* Thread)
+{
+#if defined(_WIN32)
+    WaitForSingleObject(Thread->Handle, INFINITE);
+    CloseHandle(Thread->Handle);
+#else
+    pthread_join(Thread->Handle, 0);
+#endif
+}
+
+//
+// NOTE: Files
+//
+
+// NOTE: Reads the whole file into memory from DemoMemoryAlloc, free it with DemoMemoryFree
+inline u8* DemoFileReadAll(char* FileName, u64* OutSize)
+{
+    u8* Result = 0;
+    *OutSize = 0;
+
+    FILE* File = fopen(FileName, "rb");
+    if (File)
+    {
+        fseek(File, 0, SEEK_END);
+        long FileSize = ftell(File);
+        fseek(File, 0, SEEK_SET);
+
+        if (FileSize > 0)
+        {
+            Result = (u8*)DemoMemoryAlloc(u64(FileSize));
+            if (Result && fread(Result, 1, size_t(FileSize), File) == size_t(FileSize))
+            {
+                *OutSize = u64(FileSize);
+            }
+            else
+            {
+                DemoMemoryFree(Result, u64(FileSize));
+                Result = 0;
+            }
+        }
+        
+        fclose(File);
+    }
+
+    return Result;
+}
+
+inline b32 DemoFileWriteAll(char* FileName, void* Data, u64 Size)
+{
+    b32 Result = false;
+    FILE* File = fopen(FileName, "wb");
+    if (File)
+    {
+        Result = fwrite(Data, 1, size_t(Size), File) == size_t(Size);
+        fclose(File);
+    }
+
+    return Result;
+}
+
+//
+// NOTE: Processes
+//
+
+// NOTE: Runs the command line to completion without a console window, returns the exit code (-1 if it failed to launch)
+inline i32 DemoProcessRun(char* CommandLine)
+{
+    i32 Result = -1;
+#if defined(_WIN32)
+    STARTUPINFOA StartupInfo = {};
+    StartupInfo.cb = sizeof(StartupInfo);
+    PROCESS_INFORMATION ProcessInfo = {};
+    if (CreateProcessA(0, CommandLine, 0, 0, FALSE, CREATE_NO_WINDOW, 0, 0, &StartupInfo, &ProcessInfo))
+    {
+        WaitForSingleObject(ProcessInfo.hProcess, INFINITE);
+        DWORD ExitCode = 0;
+        GetExitCodeProcess(ProcessInfo.hProcess, &ExitCode);
+        Result = i32(ExitCode);
+        CloseHandle(ProcessInfo.hThread);
+        CloseHandle(ProcessInfo.hProcess);
+    }
+#else
+    int Status = system(CommandLine);
+    if (Status != -1 && WIFEXITED(Status))
+    {
+        Result = WEXITSTATUS(Status);
+    }
+#endif
+    return Result;
+}
+
+//
+// NOTE: Directory Watching
+//
+
+inline b32 DemoDirWatchCreate(demo_dir_watch* Watch, char* DirName)
+{
+    *Watch = {};
+#if defined(_WIN32)
+    Watch->Dir = CreateFileA(DirName, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0, OPEN_EXISTING,
+                             FILE_FLAG_BACKUP_SEMANTICS, 0);
+    b32 Result = Watch->Dir != INVALID_HANDLE_VALUE;
+#else
+    Watch->Inotify = inotify_init();
+    Watch->Watch = Watch->Inotify >= 0 ? inotify_add_watch(Watch->Inotify, DirName, IN_CLOSE_WRITE | IN_MOVED_TO) : -1;
+    b32 Result = Watch->Watch >= 0;
+#endif
+    return Result;
+}
+
+// NOTE: Blocks the calling thread until a file in the directory changed and writes its name (relative to the dir) to FileName
+inline b32 DemoDirWatchWait(demo_dir_watch* Watch, char* FileName, u32 FileNameSize)
+{
+    while (!Watch->Cancelled)
+    {
+        if (Watch->BufferPos >= Watch->BufferUsed)
+        {
+            Watch->BufferPos = 0;
+            Watch->BufferUsed = 0;
+            
+#if defined(_WIN32)
+            DWORD BytesReturned = 0;
+            if (!ReadDirectoryChangesW(Watch->Dir, Watch->Buffer, sizeof(Watch->Buffer), FALSE,
+                                       FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, &BytesReturned, 0, 0))
+            {
+                return false;
+            }
+#else
+            ssize_t BytesReturned = read(Watch->Inotify, Watch->Buffer, sizeof(Watch->Buffer));
+            if (BytesReturned <= 0)
+            {
+                return false;
+            }
+#endif
+            Watch->BufferUsed = u32(BytesReturned);
+            continue;
+        }
+
+        if (Watch->Cancelled)
+        {
+            break;
+        }
+
+#if defined(_WIN32)
+        FILE_NOTIFY_INFORMATION* Event = (FILE_NOTIFY_INFORMATION*)((u8*)Watch->Buffer + Watch->BufferPos);
+        Watch->BufferPos = Event->NextEntryOffset ? Watch->BufferPos + Event->NextEntryOffset : Watch->BufferUsed;
+        if (Event->Action == FILE_ACTION_MODIFIED || Event->Action == FILE_ACTION_ADDED || Event->Action == FILE_ACTION_RENAMED_NEW_NAME)
+        {
+            int NameLength = WideCharToMultiByte(CP_UTF8, 0, Event->FileName, int(Event->FileNameLength / sizeof(WCHAR)), FileName,
+                                                 int(FileNameSize - 1), 0, 0);
+            FileName[NameLength] = 0;
+            return true;
+        }
+#else
+        inotify_event* Event = (inotify_event*)(Watch->Buffer + Watch->BufferPos);
+        Watch->BufferPos += sizeof(inotify_event) + Event->len;
+        if (Event->len > 0)
+        {
+            snprintf(FileName, FileNameSize, "%s", Event->name);
+            return true;
+        }
+#endif
+    }
+
+    return false;
+}
+
+// NOTE: Makes a DemoDirWatchWait on Thread return false, call before joining the thread
+inline void DemoDirWatchCancel(demo_dir_watch* Watch, demo_thread* Thread)
+{
+    Watch->Cancelled = true;
+    DemoMemoryFence();
+    
+#if defined(_WIN32)
+    // NOTE: Only cancels IO the thread is already blocked in, so keep at it until the thread is gone
+    while (WaitForSingleObject(Thread->Handle, 1) == WAIT_TIMEOUT)
+    {
+        CancelSynchronousIo(Thread->Handle);
+    }
+#else
+    // NOTE: Removing the watch queues an IN_IGNORED event which wakes up the read
+    inotify_rm_watch(Watch->Inotify, Watch->Watch);
+#endif
+}
+
+inline void DemoDirWatchDestroy(demo_dir_watch* Watch)
+{
+#if defined(_WIN32)
+    CloseHandle(Watch->Dir);
+#else
+    close(Watch->Inotify);
+#endif
+    *Watch = {};
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+/*
+
+  NOTE: The framework owns the window, the device and the frame loop. This file holds the extra OS functionality the terrain code needs
+        (timers, large file mappings, scratch memory). Win32 is what build.bat ships, the POSIX path is there for our linux tooling.
+
+ */
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/inotify.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+struct demo_file_map
+{
+    u8* Memory;
+    u64 Size;
+
+#if defined(_WIN32)
+    HANDLE File;
+    HANDLE Mapping;
+#else
+    int File;
+#endif
+};
+
+struct demo_semaphore
+{
+#if defined(_WIN32)
+    HANDLE Handle;
+#else
+    sem_t Handle;
+#endif
+};
+
+typedef void demo_thread_proc(void* Data);
+
+struct demo_thread
+{
+    demo_thread_proc* Proc;
+    void* Data;
+    
+#if defined(_WIN32)
+    HANDLE Handle;
+#else
+    pthread_t Handle;
+#endif
+};
+
+struct demo_dir_watch
+{
+    volatile u32 Cancelled;
+    
+#if defined(_WIN32)
+    HANDLE Dir;
+    u32 BufferUsed;
+    u32 BufferPos;
+    DWORD Buffer[4096];
+#else
+    int Inotify;
+    int Watch;
+    u32 BufferUsed;
+    u32 BufferPos;
+    u8 Buffer[16384];
+#endif
+};
@@ -0,0 +1,206 @@
+
+// NOTE: Must match the glslangValidator calls in build.bat
+global shader_build_entry GlobalShaderBuilds[] =
+{
+    { "forward_shader.cpp", "VERTEX_SHADER", "vert", "shader_forward_vert.spv" },
+    { "forward_shader.cpp", "FRAGMENT_SHADER", "frag", "shader_forward_frag.spv" },
+    { "forward_shader.cpp", "BUILD_LIGHT_CLUSTERS", "comp", "shader_light_clusters.spv" },
+    { "forward_shader.cpp", "SHADOW_VERTEX_SHADER", "vert", "shader_shadow_vert.spv" },
+    { "forward_shader.cpp", "DEPTH_PREPASS_VERTEX_SHADER", "vert", "shader_depth_prepass_vert.spv" },
+    { "forward_shader.cpp", "FAR_FIELD_VERTEX_SHADER", "vert", "shader_far_field_vert.spv" },
+    { "forward_shader.cpp", "FAR_FIELD_FRAGMENT_SHADER", "frag", "shader_far_field_frag.spv" },
+    { "shader_copy_to_swap.cpp", "VERTEX_SHADER", "vert", "shader_copy_to_swap_vert.spv" },
+    { "shader_copy_to_swap.cpp", "FRAGMENT_SHADER", "frag", "shader_copy_to_swap_frag.spv" },
+    { "procedural_3d_terrain_shaders.cpp", "GENERATE_3D_TERRAIN", "comp", "shader_generate_3d_terrain.spv" },
+    { "procedural_3d_terrain_shaders.cpp", "GENERATE_TRIANGLES", "comp", "shader_generate_triangles.spv" },
+    { "procedural_3d_terrain_shaders.cpp", "FUSED_GENERATE", "comp", "shader_fused_generate.spv" },
+    { "procedural_3d_terrain_shaders.cpp", "GENERATE_3D_TERRAIN_FP16", "comp", "shader_generate_3d_terrain_fp16.spv" },
+    { "procedural_3d_terrain_shaders.cpp", "GENERATE_TRIANGLES_FP16", "comp", "shader_generate_triangles_fp16.spv" },
+    { "procedural_3d_terrain_shaders.cpp", "GENERATE_SURFACE_NETS", "comp", "shader_generate_surface_nets.spv" },
+    { "procedural_3d_terrain_shaders.cpp", "FUSED_GENERATE_FP16", "comp", "shader_fused_generate_fp16.spv" },
+    { "procedural_3d_terrain_shaders.cpp", "FP16_ERROR_PROBE", "comp", "shader_fp16_error_probe.spv" },
+    { "procedural_3d_terrain_shaders.cpp", "BUILD_DENSITY_BRICKS", "comp", "shader_density_bricks.spv" },
+    { "procedural_3d_terrain_shaders.cpp", "BUILD_DENSITY_PYRAMID", "comp", "shader_density_pyramid.spv" },
+    { "procedural_3d_terrain_shaders.cpp", "FAR_FIELD_DOWNSAMPLE", "comp", "shader_far_field_downsample.spv" },
+};
+
+inline b32 ShaderReloadCompile(shader_build_entry* Build)
+{
+    char CommandLine[1024];
+    snprintf(CommandLine, sizeof(CommandLine), "glslangValidator -D%s=1 -S %s -e main -g -V -o %s %s/%s",
+             Build->Define, Build->Stage, Build->OutputFile, SHADER_RELOAD_CODE_DIR, Build->SourceFile);
+    b32 Result = DemoProcessRun(CommandLine) == 0;
+    return Result;
+}
+
+inline void ShaderReloadLock(shader_reload_state* State)
+{
+    while (DemoAtomicCompareExchangeU32(&State->Lock, 1, 0) != 0)
+    {
+    }
+}
+
+inline void ShaderReloadUnlock(shader_reload_state* State)
+{
+    DemoMemoryFence();
+    State->Lock = 0;
+}
+
+inline void ShaderReloadRebuildPipelines(shader_reload_state* State, char* SpirvFile)
+{
+    demo_pipelines* Pipelines = State->Pipelines;
+    for (u32 EntryId = 0; EntryId < Pipelines->NumEntries; ++EntryId)
+    {
+        pipeline_entry* Entry = Pipelines->Entries + EntryId;
+
+        b32 UsesShader = false;
+        for (u32 ShaderId = 0; ShaderId < Entry->Desc.NumShaders; ++ShaderId)
+        {
+            UsesShader = UsesShader || strcmp(Entry->Desc.Shaders[ShaderId].FileName, SpirvFile) == 0;
+        }
+
+        if (!UsesShader)
+        {
+            continue;
+        }
+
+        pipeline_swap Swap = {};
+        Swap.Pipeline = Entry->Pipeline;
+        if (DemoPipelineCreate(RenderState->Device, Pipelines->Cache, &Entry->Desc, &Swap.Handle, &Swap.Layout))
+        {
+            ShaderReloadLock(State);
+            
+            // NOTE: If the render thread hasn't picked up an older rebuild of this pipeline yet, replace it
+            b32 Replaced = false;
+            for (u32 PendingId = 0; PendingId < State->NumPending; ++PendingId)
+            {
+                pipeline_swap* Pending = State->Pending + PendingId;
+                if (Pending->Pipeline == Swap.Pipeline)
+                {
+                    vkDestroyPipeline(RenderState->Device, Pending->Handle, 0);
+                    vkDestroyPipelineLayout(RenderState->Device, Pending->Layout, 0);
+                    *Pending = Swap;
+                    Replaced = true;
+                    break;
+                }
+            }
+
+            if (!Replaced)
+            {
+                Assert(State->NumPending < SHADER_RELOAD_MAX_PENDING);
+                State->Pending[State->NumPending] = Swap;
+                DemoMemoryFence();
+                State->NumPending += 1;
+            }
+            
+            ShaderReloadUnlock(State);
+        }
+    }
+}
+
+inline void ShaderReloadThreadProc(void* Data)
+{
+    shader_reload_state* State = (shader_reload_state*)Data;
+
+    char FileName[256];
+    while (DemoDirWatchWait(&State->Watch, FileName, sizeof(FileName)))
+    {
+        // NOTE: Editors tend to write a file in multiple steps, let them finish before we compile
+        DemoSleepMs(50);
+
+        // NOTE: Sources that aren't compiled directly are includes (lighting helpers etc) so we rebuild everything for those
+        b32 IsShaderSource = false;
+        for (u32 BuildId = 0; BuildId < ArrayCount(GlobalShaderBuilds); ++BuildId)
+        {
+            IsShaderSource = IsShaderSource || strcmp(GlobalShaderBuilds[BuildId].SourceFile, FileName) == 0;
+        }
+
+        b32 IsShaderInclude = strncmp(FileName, "shader_", 7) == 0;
+        if (!IsShaderSource && !IsShaderInclude)
+        {
+            continue;
+        }
+
+        for (u32 BuildId = 0; BuildId < ArrayCount(GlobalShaderBuilds); ++BuildId)
+        {
+            shader_build_entry* Build = GlobalShaderBuilds + BuildId;
+            if (IsShaderSource && strcmp(Build->SourceFile, FileName) != 0)
+            {
+                continue;
+            }
+
+            DemoAtomicAddU32(&State->NumCompiles, 1);
+            if (ShaderReloadCompile(Build))
+            {
+                ShaderReloadRebuildPipelines(State, Build->OutputFile);
+            }
+            else
+            {
+                DemoAtomicAddU32(&State->NumFailedCompiles, 1);
+            }
+        }
+    }
+}
+
+// NOTE: Pending and retired swaps survive a stop/resume, only the watcher goes away
+inline void ShaderReloadResume(shader_reload_state* State)
+{
+    if (State->Pipelines && !State->Running && DemoDirWatchCreate(&State->Watch, SHADER_RELOAD_CODE_DIR))
+    {
+        State->Running = true;
+        DemoThreadCreate(&State->Thread, ShaderReloadThreadProc, State);
+    }
+}
+
+inline void ShaderReloadStart(shader_reload_state* State, demo_pipelines* Pipelines)
+{
+    *State = {};
+    State->Pipelines = Pipelines;
+    ShaderReloadResume(State);
+}
+
+// IMPORTANT: The watcher runs code from the demo DLL, it has to be joined before the DLL gets unloaded. Waits for a compile in flight
+inline void ShaderReloadStop(shader_reload_state* State)
+{
+    if (State->Running)
+    {
+        DemoDirWatchCancel(&State->Watch, &State->Thread);
+        DemoThreadJoin(&State->Thread);
+        DemoDirWatchDestroy(&State->Watch);
+        State->Running = false;
+    }
+}
+
+// NOTE: Called by the render thread at a frame boundary, after the previous frames fence has been waited on
+inline void ShaderReloadApplyPending(shader_reload_state* State, VkDevice Device)
+{
+    // NOTE: Anything retired last frame can't be referenced by the GPU anymore
+    for (u32 RetiredId = 0; RetiredId < State->NumRetired; ++RetiredId)
+    {
+        vkDestroyPipeline(Device, State->Retired[RetiredId].Handle, 0);
+        vkDestroyPipelineLayout(Device, State->Retired[RetiredId].Layout, 0);
+    }
+    State->NumRetired = 0;
+
+    // NOTE: Steady state cost is this one load
+    if (State->NumPending == 0)
+    {
+        return;
+    }
+
+    ShaderReloadLock(State);
+    for (u32 PendingId = 0; PendingId < State->NumPending; ++PendingId)
+    {
+        pipeline_swap* Pending = State->Pending + PendingId;
+
+        pipeline_swap* Retired = State->Retired + State->NumRetired++;
+        Retired->Pipeline = Pending->Pipeline;
+        Retired->Handle = Pending->Pipeline->Handle;
+        Retired->Layout = Pending->Pipeline->Layout;
+
+        Pending->Pipeline->Handle = Pending->Handle;
+        Pending->Pipeline->Layout = Pending->Layout;
+    }
+    State->NumPending = 0;
+    ShaderReloadUnlock(State);
+}
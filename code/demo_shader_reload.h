@@ -0,0 +1,48 @@
+#pragma once
+
+/*
+
+  NOTE: Shader hot reload. A watcher thread blocks on directory change notifications for the code dir (ReadDirectoryChangesW on
+        win32, inotify on linux). When a shader source changes it recompiles the affected SPIR-V with the same defines build.bat
+        uses, rebuilds the pipelines that reference it against the pipeline cache, and queues the new handles. The render thread
+        only swaps handles in at the start of a frame, so steady state frames do no file system work at all.
+
+ */
+
+#define SHADER_RELOAD_CODE_DIR "../code"
+#define SHADER_RELOAD_MAX_PENDING PIPELINE_MAX_ENTRIES // NOTE: An include change can rebuild every pipeline
+
+struct shader_build_entry
+{
+    char* SourceFile;
+    char* Define;
+    char* Stage;
+    char* OutputFile;
+};
+
+struct pipeline_swap
+{
+    vk_pipeline* Pipeline;
+    VkPipeline Handle;
+    VkPipelineLayout Layout;
+};
+
+struct shader_reload_state
+{
+    b32 Running;
+    demo_pipelines* Pipelines;
+    demo_dir_watch Watch;
+    demo_thread Thread;
+
+    // NOTE: Written by the watcher thread, consumed by the render thread
+    volatile u32 Lock;
+    volatile u32 NumPending;
+    pipeline_swap Pending[SHADER_RELOAD_MAX_PENDING];
+
+    // NOTE: Old handles are kept until the frame that could still reference them has finished
+    u32 NumRetired;
+    pipeline_swap Retired[SHADER_RELOAD_MAX_PENDING];
+
+    volatile u32 NumCompiles;
+    volatile u32 NumFailedCompiles;
+};
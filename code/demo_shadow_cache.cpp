@@ -0,0 +1,310 @@
+
+//
+// NOTE: Helpers
+//
+
+inline i32 ShadowFloorDiv(f32 Value, f32 Size)
+{
+    i32 Result = i32(floorf(Value / Size));
+    return Result;
+}
+
+inline u32 ShadowWrap(i32 TileCoord)
+{
+    u32 Result = u32(((TileCoord % SHADOW_TILES_PER_AXIS) + SHADOW_TILES_PER_AXIS) % SHADOW_TILES_PER_AXIS);
+    return Result;
+}
+
+inline v3 ShadowLightSpace(shadow_cache* Cache, v3 WorldPos)
+{
+    v3 Result = V3(Dot(WorldPos, Cache->Right), Dot(WorldPos, Cache->Up), Dot(WorldPos, Cache->Dir));
+    return Result;
+}
+
+// NOTE: Light space xy rect of a world space box
+inline void ShadowCacheLightRect(shadow_cache* Cache, v3 WorldMin, v3 WorldMax, v2* OutMin, v2* OutMax)
+{
+    v3 FirstCorner = ShadowLightSpace(Cache, WorldMin);
+    v2 RectMin = V2(FirstCorner.x, FirstCorner.y);
+    v2 RectMax = RectMin;
+    for (u32 CornerId = 1; CornerId < 8; ++CornerId)
+    {
+        v3 Corner = V3((CornerId & 1) ? WorldMax.x : WorldMin.x, (CornerId & 2) ? WorldMax.y : WorldMin.y, (CornerId & 4) ? WorldMax.z : WorldMin.z);
+        v3 LightPos = ShadowLightSpace(Cache, Corner);
+        RectMin.x = LightPos.x < RectMin.x ? LightPos.x : RectMin.x;
+        RectMin.y = LightPos.y < RectMin.y ? LightPos.y : RectMin.y;
+        RectMax.x = LightPos.x > RectMax.x ? LightPos.x : RectMax.x;
+        RectMax.y = LightPos.y > RectMax.y ? LightPos.y : RectMax.y;
+    }
+
+    *OutMin = RectMin;
+    *OutMax = RectMax;
+}
+
+inline b32 ShadowTileOverlaps(shadow_tile_update* Update, v2 RectMin, v2 RectMax)
+{
+    b32 Result = (RectMin.x < Update->TileMax.x && RectMax.x > Update->TileMin.x &&
+                  RectMin.y < Update->TileMax.y && RectMax.y > Update->TileMin.y);
+    return Result;
+}
+
+//
+// NOTE: Shadow Cache
+//
+
+inline void ShadowCacheCreate(shadow_cache* Cache, gpu_allocator* Allocator, linear_arena* TempArena, v3 LightDir, v3 WorldMin, v3 WorldMax,
+                              f32* CascadeSizes)
+{
+    *Cache = {};
+
+    // NOTE: Light space basis, pick a helper axis that isn't parallel to the light
+    Cache->Dir = Normalize(LightDir);
+    v3 Helper = (Cache->Dir.z > 0.9f || Cache->Dir.z < -0.9f) ? V3(0, 1, 0) : V3(0, 0, 1);
+    Cache->Right = Normalize(Cross(Helper, Cache->Dir));
+    Cache->Up = Cross(Cache->Dir, Cache->Right);
+
+    // NOTE: Depth covers the whole terrain so tiles never need a per tile depth range and stay valid while scrolling
+    Cache->MinDepth = Dot(WorldMin, Cache->Dir);
+    Cache->MaxDepth = Cache->MinDepth;
+    for (u32 CornerId = 1; CornerId < 8; ++CornerId)
+    {
+        v3 Corner = V3((CornerId & 1) ? WorldMax.x : WorldMin.x, (CornerId & 2) ? WorldMax.y : WorldMin.y, (CornerId & 4) ? WorldMax.z : WorldMin.z);
+        f32 Depth = Dot(Corner, Cache->Dir);
+        Cache->MinDepth = Depth < Cache->MinDepth ? Depth : Cache->MinDepth;
+        Cache->MaxDepth = Depth > Cache->MaxDepth ? Depth : Cache->MaxDepth;
+    }
+    Cache->MinDepth -= 1.0f;
+    Cache->MaxDepth += 1.0f;
+
+    for (u32 CascadeId = 0; CascadeId < SHADOW_NUM_CASCADES; ++CascadeId)
+    {
+        shadow_cascade* Cascade = Cache->Cascades + CascadeId;
+        Cascade->TileSize = CascadeSizes[CascadeId] / f32(SHADOW_TILES_PER_AXIS);
+    }
+
+    Cache->Atlas = GpuImageCreate(Allocator, SHADOW_NUM_CASCADES*SHADOW_CASCADE_RES, SHADOW_CASCADE_RES, 1, VK_FORMAT_D32_SFLOAT,
+                                  VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_DEPTH_BIT,
+                                  GpuMemoryCategory_Shadows);
+
+    // NOTE: Load, not clear, cached tiles have to survive. Tiles we redraw get cleared with vkCmdClearAttachments
+    {
+        vk_render_pass_builder RpBuilder = VkRenderPassBuilderBegin(TempArena);
+        u32 DepthId = VkRenderPassAttachmentAdd(&RpBuilder, VK_FORMAT_D32_SFLOAT, VK_ATTACHMENT_LOAD_OP_LOAD,
+                                                VK_ATTACHMENT_STORE_OP_STORE, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+
+        VkRenderPassSubPassBegin(&RpBuilder, VK_PIPELINE_BIND_POINT_GRAPHICS);
+        VkRenderPassDepthRefAdd(&RpBuilder, DepthId, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+        VkRenderPassSubPassEnd(&RpBuilder);
+
+        Cache->RenderPass = VkRenderPassBuilderEnd(&RpBuilder, Allocator->Device);
+    }
+
+    {
+        VkFramebufferCreateInfo CreateInfo = {};
+        CreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        CreateInfo.renderPass = Cache->RenderPass;
+        CreateInfo.attachmentCount = 1;
+        CreateInfo.pAttachments = &Cache->Atlas.View;
+        CreateInfo.width = SHADOW_NUM_CASCADES*SHADOW_CASCADE_RES;
+        CreateInfo.height = SHADOW_CASCADE_RES;
+        CreateInfo.layers = 1;
+        VkCheckResult(vkCreateFramebuffer(Allocator->Device, &CreateInfo, 0, &Cache->Framebuffer));
+    }
+}
+
+inline void ShadowCacheInitLayout(shadow_cache* Cache, vk_commands* Commands)
+{
+    VkBarrierImageAdd(Commands, Cache->Atlas.Image, VK_IMAGE_ASPECT_DEPTH_BIT,
+                      0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
+                      VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    VkCommandsBarrierFlush(Commands);
+}
+
+// NOTE: Marks every cached tile that can see the box as stale, call this whenever chunk geometry inside it changes
+inline void ShadowCacheInvalidateBounds(shadow_cache* Cache, v3 WorldMin, v3 WorldMax)
+{
+    v2 RectMin, RectMax;
+    ShadowCacheLightRect(Cache, WorldMin, WorldMax, &RectMin, &RectMax);
+
+    for (u32 CascadeId = 0; CascadeId < SHADOW_NUM_CASCADES; ++CascadeId)
+    {
+        shadow_cascade* Cascade = Cache->Cascades + CascadeId;
+        i32 MinX = ShadowFloorDiv(RectMin.x, Cascade->TileSize);
+        i32 MinY = ShadowFloorDiv(RectMin.y, Cascade->TileSize);
+        i32 MaxX = ShadowFloorDiv(RectMax.x, Cascade->TileSize);
+        i32 MaxY = ShadowFloorDiv(RectMax.y, Cascade->TileSize);
+
+        // NOTE: Only tiles inside the window can be cached
+        MinX = MinX > Cascade->WindowMinX ? MinX : Cascade->WindowMinX;
+        MinY = MinY > Cascade->WindowMinY ? MinY : Cascade->WindowMinY;
+        MaxX = MaxX < Cascade->WindowMinX + SHADOW_TILES_PER_AXIS - 1 ? MaxX : Cascade->WindowMinX + SHADOW_TILES_PER_AXIS - 1;
+        MaxY = MaxY < Cascade->WindowMinY + SHADOW_TILES_PER_AXIS - 1 ? MaxY : Cascade->WindowMinY + SHADOW_TILES_PER_AXIS - 1;
+        
+        for (i32 TileY = MinY; TileY <= MaxY; ++TileY)
+        {
+            for (i32 TileX = MinX; TileX <= MaxX; ++TileX)
+            {
+                shadow_tile* Tile = Cascade->Tiles + ShadowWrap(TileY)*SHADOW_TILES_PER_AXIS + ShadowWrap(TileX);
+                if (Tile->TileX == TileX && Tile->TileY == TileY)
+                {
+                    Tile->Valid = false;
+                }
+            }
+        }
+    }
+}
+
+inline void ShadowCacheInvalidateAll(shadow_cache* Cache)
+{
+    for (u32 CascadeId = 0; CascadeId < SHADOW_NUM_CASCADES; ++CascadeId)
+    {
+        shadow_cascade* Cascade = Cache->Cascades + CascadeId;
+        for (u32 TileId = 0; TileId < SHADOW_TILES_PER_CASCADE; ++TileId)
+        {
+            Cascade->Tiles[TileId].Valid = false;
+        }
+    }
+}
+
+/*
+
+  NOTE: Scrolls every cascade so it is centered on the camera and collects this frames tile redraws. The window is snapped to whole
+        tiles so a tile is either still valid or maps to a new light space tile (the rows/columns that scrolled in).
+
+        Tiles past the budget keep their stale contents for a frame or two. The fragment shader never samples the outermost ring of
+        tiles, which is exactly the row/column a one tile scroll brings in, so a late redraw there is never visible.
+  
+ */
+inline void ShadowCacheUpdate(shadow_cache* Cache, v3 CameraPos)
+{
+    Cache->NumUpdates = 0;
+    Cache->NumTilesRendered = 0;
+    Cache->NumTileChunkDraws = 0;
+
+    v3 CameraLight = ShadowLightSpace(Cache, CameraPos);
+    for (u32 CascadeId = 0; CascadeId < SHADOW_NUM_CASCADES; ++CascadeId)
+    {
+        shadow_cascade* Cascade = Cache->Cascades + CascadeId;
+        Cascade->WindowMinX = ShadowFloorDiv(CameraLight.x, Cascade->TileSize) - SHADOW_TILES_PER_AXIS / 2;
+        Cascade->WindowMinY = ShadowFloorDiv(CameraLight.y, Cascade->TileSize) - SHADOW_TILES_PER_AXIS / 2;
+
+        // NOTE: A cascade with nothing valid (first frame, teleports) gets redrawn in full, otherwise we would sample garbage
+        u32 NumStale = 0;
+        for (i32 TileY = Cascade->WindowMinY; TileY < Cascade->WindowMinY + SHADOW_TILES_PER_AXIS; ++TileY)
+        {
+            for (i32 TileX = Cascade->WindowMinX; TileX < Cascade->WindowMinX + SHADOW_TILES_PER_AXIS; ++TileX)
+            {
+                shadow_tile* Tile = Cascade->Tiles + ShadowWrap(TileY)*SHADOW_TILES_PER_AXIS + ShadowWrap(TileX);
+                NumStale += (Tile->Valid && Tile->TileX == TileX && Tile->TileY == TileY) ? 0 : 1;
+            }
+        }
+        b32 FullRedraw = NumStale == SHADOW_TILES_PER_CASCADE;
+        
+        for (i32 TileY = Cascade->WindowMinY; TileY < Cascade->WindowMinY + SHADOW_TILES_PER_AXIS; ++TileY)
+        {
+            for (i32 TileX = Cascade->WindowMinX; TileX < Cascade->WindowMinX + SHADOW_TILES_PER_AXIS; ++TileX)
+            {
+                u32 AtlasTileX = ShadowWrap(TileX);
+                u32 AtlasTileY = ShadowWrap(TileY);
+                shadow_tile* Tile = Cascade->Tiles + AtlasTileY*SHADOW_TILES_PER_AXIS + AtlasTileX;
+                if (Tile->Valid && Tile->TileX == TileX && Tile->TileY == TileY)
+                {
+                    continue;
+                }
+
+                if (!FullRedraw && Cache->NumUpdates >= SHADOW_MAX_TILE_UPDATES)
+                {
+                    continue;
+                }
+
+                Tile->TileX = TileX;
+                Tile->TileY = TileY;
+                Tile->Valid = true;
+
+                shadow_tile_update* Update = Cache->Updates + Cache->NumUpdates++;
+                Update->CascadeId = CascadeId;
+                Update->AtlasTileX = AtlasTileX;
+                Update->AtlasTileY = AtlasTileY;
+                Update->TileMin = V2(f32(TileX), f32(TileY)) * Cascade->TileSize;
+                Update->TileMax = Update->TileMin + V2(Cascade->TileSize, Cascade->TileSize);
+            }
+        }
+    }
+}
+
+inline void ShadowCacheSceneGlobals(shadow_cache* Cache, v4* OutRight, v4* OutUp, v4* OutDir, v4* OutCascades)
+{
+    *OutRight = V4(Cache->Right.x, Cache->Right.y, Cache->Right.z, 0.0f);
+    *OutUp = V4(Cache->Up.x, Cache->Up.y, Cache->Up.z, 1.0f / (Cache->MaxDepth - Cache->MinDepth));
+    *OutDir = V4(Cache->Dir.x, Cache->Dir.y, Cache->Dir.z, Cache->MinDepth);
+    for (u32 CascadeId = 0; CascadeId < SHADOW_NUM_CASCADES; ++CascadeId)
+    {
+        shadow_cascade* Cascade = Cache->Cascades + CascadeId;
+        v2 WindowMin = V2(f32(Cascade->WindowMinX), f32(Cascade->WindowMinY)) * Cascade->TileSize;
+        OutCascades[CascadeId] = V4(WindowMin.x, WindowMin.y, Cascade->TileSize / f32(SHADOW_TILE_RES), 0.0f);
+    }
+}
+
+inline void ShadowCachePassBegin(shadow_cache* Cache, vk_commands* Commands)
+{
+    VkBarrierImageAdd(Commands, Cache->Atlas.Image, VK_IMAGE_ASPECT_DEPTH_BIT,
+                      VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                      VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                      VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    VkCommandsBarrierFlush(Commands);
+
+    VkRenderPassBeginInfo BeginInfo = {};
+    BeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    BeginInfo.renderPass = Cache->RenderPass;
+    BeginInfo.framebuffer = Cache->Framebuffer;
+    BeginInfo.renderArea.extent.width = SHADOW_NUM_CASCADES*SHADOW_CASCADE_RES;
+    BeginInfo.renderArea.extent.height = SHADOW_CASCADE_RES;
+    vkCmdBeginRenderPass(Commands->Buffer, &BeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+}
+
+inline void ShadowCacheTileBegin(shadow_cache* Cache, vk_commands* Commands, vk_pipeline* Pipeline, shadow_tile_update* Update)
+{
+    VkRect2D Rect = {};
+    Rect.offset.x = i32(Update->CascadeId*SHADOW_CASCADE_RES + Update->AtlasTileX*SHADOW_TILE_RES);
+    Rect.offset.y = i32(Update->AtlasTileY*SHADOW_TILE_RES);
+    Rect.extent.width = SHADOW_TILE_RES;
+    Rect.extent.height = SHADOW_TILE_RES;
+
+    VkViewport Viewport = {};
+    Viewport.x = f32(Rect.offset.x);
+    Viewport.y = f32(Rect.offset.y);
+    Viewport.width = f32(SHADOW_TILE_RES);
+    Viewport.height = f32(SHADOW_TILE_RES);
+    Viewport.minDepth = 0.0f;
+    Viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(Commands->Buffer, 0, 1, &Viewport);
+    vkCmdSetScissor(Commands->Buffer, 0, 1, &Rect);
+
+    VkClearAttachment ClearAttachment = {};
+    ClearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    ClearAttachment.clearValue.depthStencil.depth = 1.0f;
+    VkClearRect ClearRect = {};
+    ClearRect.rect = Rect;
+    ClearRect.layerCount = 1;
+    vkCmdClearAttachments(Commands->Buffer, 1, &ClearAttachment, 1, &ClearRect);
+
+    shadow_tile_constants Constants = {};
+    Constants.TileMin = Update->TileMin;
+    Constants.InvTileSize = V2(1.0f / (Update->TileMax.x - Update->TileMin.x), 1.0f / (Update->TileMax.y - Update->TileMin.y));
+    vkCmdPushConstants(Commands->Buffer, Pipeline->Layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Constants), &Constants);
+
+    Cache->NumTilesRendered += 1;
+}
+
+inline void ShadowCachePassEnd(shadow_cache* Cache, vk_commands* Commands)
+{
+    vkCmdEndRenderPass(Commands->Buffer);
+
+    VkBarrierImageAdd(Commands, Cache->Atlas.Image, VK_IMAGE_ASPECT_DEPTH_BIT,
+                      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                      VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                      VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    VkCommandsBarrierFlush(Commands);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+/*
+
+  NOTE: Cached cascaded shadow maps for the directional light, see shader_shadow_cascades.cpp for the addressing.
+
+    Terrain is static between chunk (re)generations so we never re-render a cascade wholesale. Each cascade tracks which light space
+    tile every atlas tile currently holds and only redraws a tile when:
+
+    - the cascade scrolled and the tile now maps to a different light space tile (toroidal, so only the new rows/columns)
+    - a chunk overlapping it was regenerated or edited (ShadowCacheInvalidateBounds)
+
+    Redraws are capped at SHADOW_MAX_TILE_UPDATES per frame, nearest cascade first, except when nothing in a cascades window is valid
+    (first frame, teleports) where we redraw it fully so we never sample garbage. Each tile only draws the chunks whose bounds overlap it.
+
+ */
+
+// IMPORTANT: Has to match shader_shadow_cascades.cpp
+#define SHADOW_NUM_CASCADES 3
+#define SHADOW_CASCADE_RES 1024
+#define SHADOW_TILES_PER_AXIS 8
+
+#define SHADOW_TILE_RES (SHADOW_CASCADE_RES / SHADOW_TILES_PER_AXIS)
+#define SHADOW_TILES_PER_CASCADE (SHADOW_TILES_PER_AXIS*SHADOW_TILES_PER_AXIS)
+#define SHADOW_MAX_TILE_UPDATES 24
+
+struct shadow_tile
+{
+    i32 TileX; // NOTE: Light space tile coord this atlas tile holds
+    i32 TileY;
+    b32 Valid;
+};
+
+struct shadow_cascade
+{
+    f32 TileSize; // NOTE: Light space units
+    i32 WindowMinX; // NOTE: In tiles
+    i32 WindowMinY;
+    shadow_tile Tiles[SHADOW_TILES_PER_CASCADE];
+};
+
+struct shadow_tile_update
+{
+    u32 CascadeId;
+    u32 AtlasTileX;
+    u32 AtlasTileY;
+    v2 TileMin;
+    v2 TileMax;
+};
+
+struct shadow_tile_constants
+{
+    v2 TileMin;
+    v2 InvTileSize;
+};
+
+struct shadow_cache
+{
+    // NOTE: Light space basis, Dir is the direction light travels
+    v3 Right;
+    v3 Up;
+    v3 Dir;
+    f32 MinDepth;
+    f32 MaxDepth;
+    
+    shadow_cascade Cascades[SHADOW_NUM_CASCADES];
+
+    gpu_image Atlas;
+    VkRenderPass RenderPass;
+    VkFramebuffer Framebuffer;
+
+    u32 NumUpdates;
+    shadow_tile_update Updates[SHADOW_NUM_CASCADES*SHADOW_TILES_PER_CASCADE];
+    
+    // NOTE: Stats
+    u32 NumTilesRendered;
+    u32 NumTileChunkDraws;
+};
@@ -0,0 +1,363 @@
+
+//
+// NOTE: Upload Ring
+//
+
+inline void UploadRingCreate(upload_ring* Ring, gpu_allocator* Allocator, u64 Size)
+{
+    *Ring = {};
+    Ring->Allocator = Allocator;
+    Ring->Size = Size;
+    Ring->Buffer = GpuBufferCreate(Allocator, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, Size,
+                                   GpuMemoryCategory_Staging);
+    Assert(Ring->Buffer.Allocation.Mapped);
+}
+
+inline void UploadRingBeginFrame(upload_ring* Ring)
+{
+    // IMPORTANT: Called after the fence of the frame that last used this slot, so its staging memory can be reused
+    Ring->FrameId += 1;
+    u32 Slot = Ring->FrameId % UPLOAD_RING_FRAMES;
+
+    Ring->Used -= Ring->FrameSize[Slot];
+    Ring->FrameSize[Slot] = 0;
+
+    for (u32 OverflowId = 0; OverflowId < Ring->NumOverflow[Slot]; ++OverflowId)
+    {
+        GpuBufferDestroy(Ring->Allocator, Ring->Overflow[Slot] + OverflowId);
+    }
+    Ring->NumOverflow[Slot] = 0;
+    Ring->OverflowUsed[Slot] = 0;
+}
+
+inline u8* UploadRingAllocate(upload_ring* Ring, u64 Size, VkBuffer* OutBuffer, u64* OutOffset)
+{
+    u32 Slot = Ring->FrameId % UPLOAD_RING_FRAMES;
+    u64 AlignedSize = (Size + UPLOAD_RING_ALIGNMENT - 1) & ~u64(UPLOAD_RING_ALIGNMENT - 1);
+
+    // NOTE: Allocations are FIFO so we only need to waste the tail of the ring when we wrap
+    u64 Padding = Ring->Head + AlignedSize > Ring->Size ? Ring->Size - Ring->Head : 0;
+    if (Ring->Used + Padding + AlignedSize <= Ring->Size)
+    {
+        if (Padding > 0)
+        {
+            Ring->Head = 0;
+        }
+
+        u64 Offset = Ring->Head;
+        Ring->Head = (Ring->Head + AlignedSize) % Ring->Size;
+        Ring->Used += Padding + AlignedSize;
+        Ring->FrameSize[Slot] += Padding + AlignedSize;
+
+        *OutBuffer = Ring->Buffer.Buffer;
+        *OutOffset = Offset;
+        return Ring->Buffer.Allocation.Mapped + Offset;
+    }
+
+    // NOTE: Doesn't fit, bump allocate from this frames overflow staging buffers. Small pushes that spill over (per chunk uploads)
+    // share one buffer instead of each getting their own
+    if (Ring->NumOverflow[Slot] > 0)
+    {
+        u32 OverflowId = Ring->NumOverflow[Slot] - 1;
+        gpu_buffer* Overflow = Ring->Overflow[Slot] + OverflowId;
+        if (Ring->OverflowUsed[Slot] + AlignedSize <= Overflow->Allocation.Size)
+        {
+            u64 Offset = Ring->OverflowUsed[Slot];
+            Ring->OverflowUsed[Slot] += AlignedSize;
+
+            *OutBuffer = Overflow->Buffer;
+            *OutOffset = Offset;
+            return Overflow->Allocation.Mapped + Offset;
+        }
+    }
+
+    Assert(Ring->NumOverflow[Slot] < UPLOAD_RING_MAX_OVERFLOW);
+    gpu_buffer* Overflow = Ring->Overflow[Slot] + Ring->NumOverflow[Slot]++;
+    *Overflow = GpuBufferCreate(Ring->Allocator, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                AlignedSize > Ring->Size ? AlignedSize : Ring->Size, GpuMemoryCategory_Staging);
+    Ring->OverflowUsed[Slot] = AlignedSize;
+
+    *OutBuffer = Overflow->Buffer;
+    *OutOffset = 0;
+    return Overflow->Allocation.Mapped;
+}
+
+inline void* UploadRingPushBuffer(upload_ring* Ring, VkBuffer Dst, u64 DstOffset, u64 Size, VkAccessFlags DstAccess,
+                                  VkPipelineStageFlags DstStage)
+{
+    Assert(Ring->NumBufferCopies < UPLOAD_RING_MAX_BUFFER_COPIES);
+    upload_buffer_copy* Copy = Ring->BufferCopies + Ring->NumBufferCopies++;
+    Copy->Dst = Dst;
+    Copy->Region.dstOffset = DstOffset;
+    Copy->Region.size = Size;
+    Copy->DstAccess = DstAccess;
+    Copy->DstStage = DstStage;
+
+    u8* Result = UploadRingAllocate(Ring, Size, &Copy->Src, &Copy->Region.srcOffset);
+    return Result;
+}
+
+#define UploadRingPushStruct(Ring, Dst, Type, DstAccess, DstStage) (Type*)UploadRingPushBuffer(Ring, Dst, 0, sizeof(Type), DstAccess, DstStage)
+#define UploadRingPushArray(Ring, Dst, Type, Count, DstAccess, DstStage) (Type*)UploadRingPushBuffer(Ring, Dst, 0, sizeof(Type)*(Count), DstAccess, DstStage)
+
+inline void* UploadRingPushImage(upload_ring* Ring, VkImage Dst, i32 OffsetX, i32 OffsetY, i32 OffsetZ, u32 Width, u32 Height, u32 Depth,
+                                 u32 TexelSize, VkImageAspectFlags AspectMask, VkImageLayout OldLayout, VkImageLayout NewLayout,
+                                 VkAccessFlags DstAccess, VkPipelineStageFlags DstStage)
+{
+    Assert(Ring->NumImageCopies < UPLOAD_RING_MAX_IMAGE_COPIES);
+    upload_image_copy* Copy = Ring->ImageCopies + Ring->NumImageCopies++;
+    Copy->Dst = Dst;
+    Copy->OldLayout = OldLayout;
+    Copy->NewLayout = NewLayout;
+    Copy->DstAccess = DstAccess;
+    Copy->DstStage = DstStage;
+    Copy->Region = {};
+    Copy->Region.imageSubresource.aspectMask = AspectMask;
+    Copy->Region.imageSubresource.layerCount = 1;
+    Copy->Region.imageOffset = { OffsetX, OffsetY, OffsetZ };
+    Copy->Region.imageExtent = { Width, Height, Depth };
+
+    Copy->Size = u64(TexelSize)*u64(Width)*u64(Height)*u64(Depth);
+    u8* Result = UploadRingAllocate(Ring, Copy->Size, &Copy->Src, &Copy->Region.bufferOffset);
+    return Result;
+}
+
+inline b32 UploadRegionOverlaps(VkBufferCopy* Regions, u32 NumRegions, VkBufferCopy* Region)
+{
+    b32 Result = false;
+    for (u32 RegionId = 0; RegionId < NumRegions; ++RegionId)
+    {
+        VkBufferCopy* Other = Regions + RegionId;
+        if (Region->dstOffset < Other->dstOffset + Other->size && Other->dstOffset < Region->dstOffset + Region->size)
+        {
+            Result = true;
+            break;
+        }
+    }
+
+    return Result;
+}
+
+inline void UploadRingFlush(upload_ring* Ring, vk_commands* Commands)
+{
+    Ring->FlushBytes = 0;
+    Ring->FlushCopyCalls = 0;
+    if (Ring->NumBufferCopies == 0 && Ring->NumImageCopies == 0)
+    {
+        return;
+    }
+
+    // NOTE: Images have to be in TRANSFER_DST before we copy. One transition per image no matter how many regions it gets, a second
+    // barrier on the same image would name a layout it isn't in anymore. If the image had contents, the previous user is the same
+    // stage we upload for so that is all we wait on
+    for (u32 CopyId = 0; CopyId < Ring->NumImageCopies; ++CopyId)
+    {
+        upload_image_copy* Copy = Ring->ImageCopies + CopyId;
+        b32 FirstCopy = true;
+        for (u32 PrevId = 0; PrevId < CopyId; ++PrevId)
+        {
+            if (Ring->ImageCopies[PrevId].Dst == Copy->Dst)
+            {
+                FirstCopy = false;
+                break;
+            }
+        }
+
+        if (!FirstCopy)
+        {
+            continue;
+        }
+
+        // NOTE: Merge what every region of this image was pushed with, the first push says which layout the image is in
+        VkImageAspectFlags AspectMask = 0;
+        VkAccessFlags DstAccess = 0;
+        VkPipelineStageFlags DstStage = 0;
+        VkImageLayout OldLayout = Copy->OldLayout;
+        for (u32 OtherId = CopyId; OtherId < Ring->NumImageCopies; ++OtherId)
+        {
+            upload_image_copy* Other = Ring->ImageCopies + OtherId;
+            if (Other->Dst == Copy->Dst)
+            {
+                Assert(Other->NewLayout == Copy->NewLayout);
+                AspectMask |= Other->Region.imageSubresource.aspectMask;
+                DstAccess |= Other->DstAccess;
+                DstStage |= Other->DstStage;
+            }
+        }
+
+        b32 Undefined = OldLayout == VK_IMAGE_LAYOUT_UNDEFINED;
+        VkBarrierImageAdd(Commands, Copy->Dst, AspectMask,
+                          Undefined ? VkAccessFlagBits(0) : VkAccessFlagBits(DstAccess),
+                          Undefined ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VkPipelineStageFlagBits(DstStage), OldLayout,
+                          VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    }
+    VkCommandsBarrierFlush(Commands);
+
+    // NOTE: One copy call per destination buffer with all of its regions. Regions of one call can't overlap and later pushes have to
+    // land after earlier ones, so a push that overlaps a region already in the call (or one we left for another source buffer)
+    // ends the call. What is left gets its own call after a transfer -> transfer barrier. Regions we skip over are kept at the back
+    // of TempRegions
+    for (u32 CopyId = 0; CopyId < Ring->NumBufferCopies; ++CopyId)
+    {
+        upload_buffer_copy* Copy = Ring->BufferCopies + CopyId;
+        if (Copy->Dst == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+
+        VkBuffer Src = Copy->Src;
+        VkBuffer Dst = Copy->Dst;
+        VkAccessFlags DstAccess = 0;
+        VkPipelineStageFlags DstStage = 0;
+        u32 NumRegions = 0;
+        u32 NumSkipped = 0;
+        VkBufferCopy* SkippedRegions = Ring->TempRegions + UPLOAD_RING_MAX_BUFFER_COPIES;
+        b32 Overlapped = false;
+        for (u32 OtherId = CopyId; OtherId < Ring->NumBufferCopies; ++OtherId)
+        {
+            upload_buffer_copy* Other = Ring->BufferCopies + OtherId;
+            if (Other->Dst != Dst)
+            {
+                continue;
+            }
+
+            if (UploadRegionOverlaps(Ring->TempRegions, NumRegions, &Other->Region) ||
+                UploadRegionOverlaps(SkippedRegions - NumSkipped, NumSkipped, &Other->Region))
+            {
+                Overlapped = true;
+                break;
+            }
+
+            if (Other->Src == Src)
+            {
+                Ring->TempRegions[NumRegions++] = Other->Region;
+                Ring->FlushBytes += Other->Region.size;
+                DstAccess |= Other->DstAccess;
+                DstStage |= Other->DstStage;
+                Other->Dst = VK_NULL_HANDLE;
+            }
+            else
+            {
+                NumSkipped += 1;
+                *(SkippedRegions - NumSkipped) = Other->Region;
+            }
+        }
+
+        vkCmdCopyBuffer(Commands->Buffer, Src, Dst, NumRegions, Ring->TempRegions);
+        if (Overlapped)
+        {
+            VkBarrierBufferAdd(Commands, Dst, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                               VK_PIPELINE_STAGE_TRANSFER_BIT);
+            VkCommandsBarrierFlush(Commands);
+        }
+        VkBarrierBufferAdd(Commands, Dst, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VkAccessFlagBits(DstAccess),
+                           VkPipelineStageFlagBits(DstStage));
+        Ring->FlushCopyCalls += 1;
+    }
+
+    for (u32 CopyId = 0; CopyId < Ring->NumImageCopies; ++CopyId)
+    {
+        upload_image_copy* Copy = Ring->ImageCopies + CopyId;
+        vkCmdCopyBufferToImage(Commands->Buffer, Copy->Src, Copy->Dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Copy->Region);
+        Ring->FlushBytes += Copy->Size;
+        Ring->FlushCopyCalls += 1;
+    }
+
+    // NOTE: And one transition per image out of TRANSFER_DST once all of its regions are written
+    for (u32 CopyId = 0; CopyId < Ring->NumImageCopies; ++CopyId)
+    {
+        upload_image_copy* Copy = Ring->ImageCopies + CopyId;
+        b32 FirstCopy = true;
+        for (u32 PrevId = 0; PrevId < CopyId; ++PrevId)
+        {
+            if (Ring->ImageCopies[PrevId].Dst == Copy->Dst)
+            {
+                FirstCopy = false;
+                break;
+            }
+        }
+
+        if (!FirstCopy)
+        {
+            continue;
+        }
+
+        VkImageAspectFlags AspectMask = 0;
+        VkAccessFlags DstAccess = 0;
+        VkPipelineStageFlags DstStage = 0;
+        for (u32 OtherId = CopyId; OtherId < Ring->NumImageCopies; ++OtherId)
+        {
+            upload_image_copy* Other = Ring->ImageCopies + OtherId;
+            if (Other->Dst == Copy->Dst)
+            {
+                AspectMask |= Other->Region.imageSubresource.aspectMask;
+                DstAccess |= Other->DstAccess;
+                DstStage |= Other->DstStage;
+            }
+        }
+
+        VkBarrierImageAdd(Commands, Copy->Dst, AspectMask,
+                          VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VkAccessFlagBits(DstAccess), VkPipelineStageFlagBits(DstStage), Copy->NewLayout);
+    }
+    VkCommandsBarrierFlush(Commands);
+
+    Ring->NumBufferCopies = 0;
+    Ring->NumImageCopies = 0;
+}
+
+//
+// NOTE: Uniform Ring
+//
+
+inline uniform_ring UniformRingCreate(gpu_allocator* Allocator, VkPhysicalDevice PhysicalDevice, u32 ElementSize, u32 NumSlots)
+{
+    uniform_ring Result = {};
+
+    VkPhysicalDeviceProperties Properties;
+    vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+    u32 Alignment = u32(Properties.limits.minUniformBufferOffsetAlignment);
+
+    Result.ElementSize = ElementSize;
+    Result.Stride = (ElementSize + Alignment - 1) & ~(Alignment - 1);
+    Result.NumSlots = NumSlots;
+    // NOTE: Prefer device local + host visible (BAR) memory, the allocator falls back to plain host memory
+    Result.Buffer = GpuBufferCreate(Allocator, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                    (VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+                                    u64(Result.Stride)*u64(NumSlots), GpuMemoryCategory_Uniforms);
+    Assert(Result.Buffer.Allocation.Mapped);
+
+    return Result;
+}
+
+inline void* UniformRingPush(uniform_ring* Ring, u32* OutDynamicOffset)
+{
+    // NOTE: Slots are reused every NumSlots frames, so NumSlots has to cover the frames in flight
+    Ring->CurrSlot = (Ring->CurrSlot + 1) % Ring->NumSlots;
+    *OutDynamicOffset = Ring->CurrSlot*Ring->Stride;
+    void* Result = Ring->Buffer.Allocation.Mapped + *OutDynamicOffset;
+    return Result;
+}
+
+#define UniformRingPushStruct(Ring, Type, OutDynamicOffset) (Type*)UniformRingPush(Ring, OutDynamicOffset)
+
+inline void UniformRingDescriptorWrite(VkDevice Device, VkDescriptorSet Set, u32 Binding, uniform_ring* Ring)
+{
+    // NOTE: Dynamic descriptors need an explicit range (not VK_WHOLE_SIZE) so we write these directly
+    VkDescriptorBufferInfo BufferInfo = {};
+    BufferInfo.buffer = Ring->Buffer.Buffer;
+    BufferInfo.offset = 0;
+    BufferInfo.range = Ring->ElementSize;
+
+    VkWriteDescriptorSet Write = {};
+    Write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    Write.dstSet = Set;
+    Write.dstBinding = Binding;
+    Write.descriptorCount = 1;
+    Write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    Write.pBufferInfo = &BufferInfo;
+    vkUpdateDescriptorSets(Device, 1, &Write, 0, 0);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+/*
+
+  NOTE: Upload Ring
+
+    All CPU -> GPU uploads go through one persistently mapped staging ring. Pushing an upload just bump allocates space in the ring and
+    records the copy, UploadRingFlush then emits every copy for the frame at once:
+
+    - one barrier batch moving images into TRANSFER_DST, one transition per image however many regions it gets
+    - one vkCmdCopyBuffer per destination buffer (all regions batched, overlapping pushes split the call) + one vkCmdCopyBufferToImage
+      per image region
+    - one barrier batch from TRANSFER_WRITE to the access/stage the uploads of each buffer/image were pushed with
+
+    The ring is split by frame. A frames region is only reused once UPLOAD_RING_FRAMES frames later, by which point its command buffer
+    has retired. Uploads that don't fit (baked chunk blobs, big volumes) spill into overflow staging buffers of at least the ring size,
+    which are bump allocated and freed the same way.
+
+    Small per frame constants don't go through a copy at all, they are written straight into a uniform_ring and bound with a dynamic
+    offset.
+
+ */
+
+#define UPLOAD_RING_SIZE MegaBytes(16)
+#define UPLOAD_RING_FRAMES 2
+#define UPLOAD_RING_ALIGNMENT 256
+#define UPLOAD_RING_MAX_BUFFER_COPIES 1024
+#define UPLOAD_RING_MAX_IMAGE_COPIES 1024
+#define UPLOAD_RING_MAX_OVERFLOW 32
+
+struct upload_buffer_copy
+{
+    VkBuffer Src;
+    VkBuffer Dst;
+    VkBufferCopy Region;
+    VkAccessFlags DstAccess;
+    VkPipelineStageFlags DstStage;
+};
+
+struct upload_image_copy
+{
+    VkBuffer Src;
+    VkImage Dst;
+    VkBufferImageCopy Region;
+    u64 Size;
+    VkImageLayout OldLayout;
+    VkImageLayout NewLayout;
+    VkAccessFlags DstAccess;
+    VkPipelineStageFlags DstStage;
+};
+
+struct upload_ring
+{
+    gpu_allocator* Allocator;
+    gpu_buffer Buffer;
+    u64 Size;
+    u64 Head;
+    u64 Used;
+
+    u32 FrameId;
+    u64 FrameSize[UPLOAD_RING_FRAMES];
+    u32 NumOverflow[UPLOAD_RING_FRAMES];
+    u64 OverflowUsed[UPLOAD_RING_FRAMES];
+    gpu_buffer Overflow[UPLOAD_RING_FRAMES][UPLOAD_RING_MAX_OVERFLOW];
+
+    u32 NumBufferCopies;
+    upload_buffer_copy BufferCopies[UPLOAD_RING_MAX_BUFFER_COPIES];
+    u32 NumImageCopies;
+    upload_image_copy ImageCopies[UPLOAD_RING_MAX_IMAGE_COPIES];
+    VkBufferCopy TempRegions[UPLOAD_RING_MAX_BUFFER_COPIES];
+
+    // NOTE: Stats for the last flush
+    u64 FlushBytes;
+    u32 FlushCopyCalls;
+};
+
+struct uniform_ring
+{
+    gpu_buffer Buffer;
+    u32 ElementSize;
+    u32 Stride;
+    u32 NumSlots;
+    u32 CurrSlot;
+};
@@ -0,0 +1,278 @@
+
+// NOTE: Shapes the sweep tries, anything over the device limits is dropped
+global u32 GlobalWorkgroupBaseShapes[][3] =
+{
+    { 4, 4, 4 },
+    { 8, 4, 2 },
+    { 4, 8, 2 },
+    { 8, 8, 1 },
+    { 4, 4, 8 },
+    { 8, 4, 4 },
+    { 8, 8, 2 },
+    { 16, 4, 1 },
+    { 16, 4, 2 },
+    { 16, 8, 1 },
+    { 32, 2, 1 },
+    { 32, 4, 1 },
+    { 8, 8, 4 },
+    { 16, 4, 4 },
+};
+
+global char* GlobalWorkgroupKernelTimers[WorkgroupKernel_Count] =
+{
+    "generate_density",
+    "generate_triangles",
+    "generate_density_fp16",
+    "generate_triangles_fp16",
+};
+
+inline u32 WorkgroupCount(u32 NumThreads, u32 GroupSize)
+{
+    u32 Result = (NumThreads + GroupSize - 1) / GroupSize;
+    return Result;
+}
+
+inline void WorkgroupPipelineDescShapeSet(pipeline_desc* Desc, workgroup_shape* Shape)
+{
+    DemoPipelineDescSpecConstantAdd(Desc, WORKGROUP_SPEC_SIZE_X, Shape->SizeX);
+    DemoPipelineDescSpecConstantAdd(Desc, WORKGROUP_SPEC_SIZE_Y, Shape->SizeY);
+    DemoPipelineDescSpecConstantAdd(Desc, WORKGROUP_SPEC_SIZE_Z, Shape->SizeZ);
+}
+
+//
+// NOTE: Tuning File
+//
+
+inline void WorkgroupTunerLoad(workgroup_tuner* Tuner, VkPhysicalDevice PhysicalDevice, char* FileName)
+{
+    VkPhysicalDeviceProperties Properties;
+    vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+
+    u64 FileSize = 0;
+    u8* FileData = DemoFileReadAll(FileName, &FileSize);
+    u64 ExpectedSize = sizeof(workgroup_tuning_file_header) + sizeof(workgroup_tuning_entry)*WorkgroupKernel_Count;
+    if (FileData && FileSize == ExpectedSize)
+    {
+        // NOTE: Timings from another device or driver say nothing about this one
+        workgroup_tuning_file_header* Header = (workgroup_tuning_file_header*)FileData;
+        b32 Valid = (Header->Magic == WORKGROUP_TUNING_MAGIC &&
+                     Header->Version == WORKGROUP_TUNING_VERSION &&
+                     Header->VendorId == Properties.vendorID &&
+                     Header->DeviceId == Properties.deviceID &&
+                     Header->DriverVersion == Properties.driverVersion &&
+                     Header->NumKernels == WorkgroupKernel_Count);
+
+        if (Valid)
+        {
+            workgroup_tuning_entry* Entries = (workgroup_tuning_entry*)(Header + 1);
+            for (u32 KernelId = 0; KernelId < WorkgroupKernel_Count; ++KernelId)
+            {
+                Tuner->Shapes[KernelId] = Entries[KernelId].Shape;
+                Tuner->ShapeMs[KernelId] = Entries[KernelId].Ms;
+            }
+            Tuner->Loaded = true;
+        }
+    }
+
+    DemoMemoryFree(FileData, FileSize);
+}
+
+inline void WorkgroupTunerSave(workgroup_tuner* Tuner, VkPhysicalDevice PhysicalDevice, char* FileName)
+{
+    VkPhysicalDeviceProperties Properties;
+    vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+
+    u8 FileData[sizeof(workgroup_tuning_file_header) + sizeof(workgroup_tuning_entry)*WorkgroupKernel_Count] = {};
+    workgroup_tuning_file_header* Header = (workgroup_tuning_file_header*)FileData;
+    Header->Magic = WORKGROUP_TUNING_MAGIC;
+    Header->Version = WORKGROUP_TUNING_VERSION;
+    Header->VendorId = Properties.vendorID;
+    Header->DeviceId = Properties.deviceID;
+    Header->DriverVersion = Properties.driverVersion;
+    Header->NumKernels = WorkgroupKernel_Count;
+
+    workgroup_tuning_entry* Entries = (workgroup_tuning_entry*)(Header + 1);
+    for (u32 KernelId = 0; KernelId < WorkgroupKernel_Count; ++KernelId)
+    {
+        Entries[KernelId].Shape = Tuner->Shapes[KernelId];
+        Entries[KernelId].Ms = Tuner->ShapeMs[KernelId];
+    }
+
+    DemoFileWriteAll(FileName, FileData, sizeof(FileData));
+}
+
+//
+// NOTE: Tuner
+//
+
+inline void WorkgroupTunerCandidateAdd(workgroup_tuner* Tuner, VkPhysicalDeviceLimits* Limits, u32* Size)
+{
+    u32 NumThreads = Size[0]*Size[1]*Size[2];
+    b32 Valid = (NumThreads <= Limits->maxComputeWorkGroupInvocations &&
+                 Size[0] <= Limits->maxComputeWorkGroupSize[0] &&
+                 Size[1] <= Limits->maxComputeWorkGroupSize[1] &&
+                 Size[2] <= Limits->maxComputeWorkGroupSize[2]);
+
+    if (Valid && Tuner->NumCandidates < WORKGROUP_TUNE_MAX_CANDIDATES)
+    {
+        workgroup_shape* Shape = Tuner->Candidates + Tuner->NumCandidates++;
+        Shape->SizeX = Size[0];
+        Shape->SizeY = Size[1];
+        Shape->SizeZ = Size[2];
+    }
+}
+
+inline void WorkgroupTunerCreate(workgroup_tuner* Tuner, VkPhysicalDevice PhysicalDevice, b32 Autotune)
+{
+    *Tuner = {};
+    for (u32 KernelId = 0; KernelId < WorkgroupKernel_Count; ++KernelId)
+    {
+        Tuner->Shapes[KernelId] = { 4, 4, 4 };
+    }
+
+    WorkgroupTunerLoad(Tuner, PhysicalDevice, WORKGROUP_TUNING_FILE_NAME);
+
+    if (Autotune)
+    {
+        VkPhysicalDeviceProperties Properties;
+        vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+
+        for (u32 BaseId = 0; BaseId < ArrayCount(GlobalWorkgroupBaseShapes); ++BaseId)
+        {
+            WorkgroupTunerCandidateAdd(Tuner, &Properties.limits, GlobalWorkgroupBaseShapes[BaseId]);
+        }
+
+        Tuner->Running = Tuner->NumCandidates > 0;
+    }
+}
+
+/*
+  NOTE: Adds the pipeline(s) for one of the tuned kernels. Outside of autotuning that is a single pipeline with the current shape, while
+        autotuning every candidate gets its own pipeline so the sweep never has to compile mid frame
+ */
+inline vk_pipeline* WorkgroupTunerPipelineAdd(workgroup_tuner* Tuner, demo_pipelines* Pipelines, linear_arena* Arena, workgroup_kernel Kernel,
+                                              pipeline_desc* BaseDesc)
+{
+    if (Tuner->Running)
+    {
+        for (u32 CandidateId = 0; CandidateId < Tuner->NumCandidates; ++CandidateId)
+        {
+            pipeline_desc Desc = *BaseDesc;
+            WorkgroupPipelineDescShapeSet(&Desc, Tuner->Candidates + CandidateId);
+            Tuner->CandidatePipelines[Kernel][CandidateId] = DemoPipelineAdd(Pipelines, Arena, &Desc);
+        }
+        Tuner->Shapes[Kernel] = Tuner->Candidates[0];
+        Tuner->Pipelines[Kernel] = Tuner->CandidatePipelines[Kernel][0];
+    }
+    else
+    {
+        pipeline_desc Desc = *BaseDesc;
+        WorkgroupPipelineDescShapeSet(&Desc, Tuner->Shapes + Kernel);
+        Tuner->Pipelines[Kernel] = DemoPipelineAdd(Pipelines, Arena, &Desc);
+    }
+
+    return Tuner->Pipelines[Kernel];
+}
+
+inline void WorkgroupTunerFinish(workgroup_tuner* Tuner, VkPhysicalDevice PhysicalDevice)
+{
+    for (u32 KernelId = 0; KernelId < WorkgroupKernel_Count; ++KernelId)
+    {
+        u32 BestId = 0;
+        for (u32 CandidateId = 1; CandidateId < Tuner->NumCandidates; ++CandidateId)
+        {
+            f32 CandidateMs = Tuner->CandidateMs[KernelId][CandidateId];
+            f32 BestMs = Tuner->CandidateMs[KernelId][BestId];
+            if (CandidateMs > 0.0f && (BestMs == 0.0f || CandidateMs < BestMs))
+            {
+                BestId = CandidateId;
+            }
+        }
+
+        Tuner->Shapes[KernelId] = Tuner->Candidates[BestId];
+        Tuner->ShapeMs[KernelId] = Tuner->CandidateMs[KernelId][BestId];
+        Tuner->Pipelines[KernelId] = Tuner->CandidatePipelines[KernelId][BestId];
+    }
+
+    Tuner->Running = false;
+    Tuner->Finished = true;
+    WorkgroupTunerSave(Tuner, PhysicalDevice, WORKGROUP_TUNING_FILE_NAME);
+}
+
+/*
+  NOTE: Called once per frame after GpuTimestampsFrameBegin. Collects the previous frames kernel timings and picks the candidate this
+        frame runs. Returns true when the shapes changed, the dispatch args and pipelines have to follow
+ */
+inline b32 WorkgroupTunerUpdate(workgroup_tuner* Tuner, gpu_timestamps* Timestamps, VkPhysicalDevice PhysicalDevice)
+{
+    if (!Tuner->Running)
+    {
+        return false;
+    }
+
+    // NOTE: Keep the fastest sample, slower ones are other work or clock ramping getting in the way
+    if (Tuner->HasTimed && Tuner->TimedFrame >= WORKGROUP_TUNE_WARMUP_FRAMES)
+    {
+        for (u32 KernelId = 0; KernelId < WorkgroupKernel_Count; ++KernelId)
+        {
+            f32 Ms = f32(GpuTimerGetMs(Timestamps, GlobalWorkgroupKernelTimers[KernelId]));
+            f32* CandidateMs = Tuner->CandidateMs[KernelId] + Tuner->TimedCandidate;
+            if (Ms > 0.0f && (*CandidateMs == 0.0f || Ms < *CandidateMs))
+            {
+                *CandidateMs = Ms;
+            }
+        }
+    }
+
+    if (Tuner->CandidateId == Tuner->NumCandidates)
+    {
+        WorkgroupTunerFinish(Tuner, PhysicalDevice);
+        return true;
+    }
+
+    b32 Result = Tuner->CandidateFrame == 0;
+    for (u32 KernelId = 0; KernelId < WorkgroupKernel_Count; ++KernelId)
+    {
+        Tuner->Shapes[KernelId] = Tuner->Candidates[Tuner->CandidateId];
+        Tuner->Pipelines[KernelId] = Tuner->CandidatePipelines[KernelId][Tuner->CandidateId];
+    }
+
+    Tuner->HasTimed = true;
+    Tuner->TimedCandidate = Tuner->CandidateId;
+    Tuner->TimedFrame = Tuner->CandidateFrame;
+    Tuner->CandidateFrame += 1;
+    if (Tuner->CandidateFrame == WORKGROUP_TUNE_WARMUP_FRAMES + WORKGROUP_TUNE_SAMPLE_FRAMES)
+    {
+        Tuner->CandidateFrame = 0;
+        Tuner->CandidateId += 1;
+    }
+
+    return Result;
+}
+
+inline void WorkgroupTunerPanel(ui_panel* Panel, workgroup_tuner* Tuner)
+{
+    char Text[256];
+    if (Tuner->Running)
+    {
+        snprintf(Text, sizeof(Text), "Workgroups: tuning candidate %u / %u", Tuner->CandidateId + 1, Tuner->NumCandidates);
+        UiPanelText(Panel, Text);
+        UiPanelNextRow(Panel);
+        return;
+    }
+
+    char* KernelNames[WorkgroupKernel_Count] = { "Density", "Triangles", "Density FP16", "Triangles FP16" };
+    for (u32 KernelId = 0; KernelId < WorkgroupKernel_Count; ++KernelId)
+    {
+        if (!Tuner->Pipelines[KernelId])
+        {
+            continue;
+        }
+
+        workgroup_shape* Shape = Tuner->Shapes + KernelId;
+        snprintf(Text, sizeof(Text), "Workgroups %s: %ux%ux%u%s", KernelNames[KernelId], Shape->SizeX, Shape->SizeY, Shape->SizeZ,
+                 Tuner->Finished || Tuner->Loaded ? " (tuned)" : "");
+        UiPanelText(Panel, Text);
+        UiPanelNextRow(Panel);
+    }
+}
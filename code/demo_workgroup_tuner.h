@@ -0,0 +1,89 @@
+#pragma once
+
+/*
+
+  NOTE: Workgroup shape autotuner for the chunk generation kernels. GENERATE_3D_TERRAIN and GENERATE_TRIANGLES take their workgroup
+        size through specialization constants and the dispatch math reads the same shapes, so any shape the device allows is valid.
+        Subgroup sizes are left to the driver, requiring one needs subgroupSizeControl enabled at device creation and the framework
+        doesn't take a feature chain.
+
+        With WORKGROUP_AUTOTUNE set, every candidate shape gets its own pipeline up front and MainLoop regenerates the whole terrain
+        with one candidate per frame. Both kernels are timed in their own GPU timer scope, after a few warm up frames we keep the
+        fastest sample of each candidate and at the end the fastest candidate per kernel wins. The result is written next to the
+        pipeline cache and, like the cache, only reused on the device + driver that measured it. Without a tuning file we fall back to
+        the old 4x4x4 groups.
+
+        The fp16 builds of both kernels (see terrain_fp16.h) are separate kernels here, they only get pipelines on devices with fp16
+        arithmetic and the sweep alternates precisions between frames so each kernel gets its own samples.
+
+ */
+
+#define WORKGROUP_TUNING_FILE_NAME "workgroup_tuning.bin"
+#define WORKGROUP_TUNING_MAGIC 0x4E555457 // NOTE: "WTUN"
+#define WORKGROUP_TUNING_VERSION 3
+
+// IMPORTANT: Has to match the local_size_*_id in procedural_3d_terrain_shaders.cpp
+#define WORKGROUP_SPEC_SIZE_X 0
+#define WORKGROUP_SPEC_SIZE_Y 1
+#define WORKGROUP_SPEC_SIZE_Z 2
+
+#define WORKGROUP_TUNE_MAX_CANDIDATES 64
+#define WORKGROUP_TUNE_WARMUP_FRAMES 2
+#define WORKGROUP_TUNE_SAMPLE_FRAMES 8
+
+enum workgroup_kernel
+{
+    WorkgroupKernel_GenerateDensity,
+    WorkgroupKernel_GenerateTriangles,
+    WorkgroupKernel_GenerateDensityFp16, // NOTE: Only get pipelines when the device supports fp16 arithmetic, see terrain_fp16.h
+    WorkgroupKernel_GenerateTrianglesFp16,
+
+    WorkgroupKernel_Count,
+};
+
+struct workgroup_shape
+{
+    u32 SizeX;
+    u32 SizeY;
+    u32 SizeZ;
+};
+
+struct workgroup_tuning_file_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 VendorId;
+    u32 DeviceId;
+    u32 DriverVersion;
+    u32 NumKernels;
+};
+
+struct workgroup_tuning_entry
+{
+    workgroup_shape Shape;
+    f32 Ms;
+};
+
+struct workgroup_tuner
+{
+    // NOTE: Shapes the dispatches currently use
+    workgroup_shape Shapes[WorkgroupKernel_Count];
+    vk_pipeline* Pipelines[WorkgroupKernel_Count];
+    f32 ShapeMs[WorkgroupKernel_Count]; // NOTE: 0 if the shape wasn't measured
+    b32 Loaded;
+
+    // NOTE: Autotune sweep
+    b32 Running;
+    b32 Finished;
+    u32 NumCandidates;
+    workgroup_shape Candidates[WORKGROUP_TUNE_MAX_CANDIDATES];
+    vk_pipeline* CandidatePipelines[WorkgroupKernel_Count][WORKGROUP_TUNE_MAX_CANDIDATES];
+    f32 CandidateMs[WorkgroupKernel_Count][WORKGROUP_TUNE_MAX_CANDIDATES];
+    u32 CandidateId;
+    u32 CandidateFrame;
+
+    // NOTE: What the previous frame ran, its timings come back this frame
+    b32 HasTimed;
+    u32 TimedCandidate;
+    u32 TimedFrame;
+};
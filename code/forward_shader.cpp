@@ -3,11 +3,15 @@
 #extension GL_ARB_separate_shader_objects : enable
 #extension GL_GOOGLE_include_directive : enable
 #extension GL_ARB_gpu_shader_int64 : enable
+#extension GL_ARB_conservative_depth : enable
 
 #define PACK_VERTICES 1
 
 #include "shader_light_types.cpp"
 #include "shader_blinn_phong_lighting.cpp"
+#include "shader_light_clusters.cpp"
+#include "shader_shadow_cascades.cpp"
+#include "shader_density_pyramid.cpp"
 
 layout(set = 0, binding = 0) uniform scene_buffer
 {
@@ -15,44 +19,260 @@ layout(set = 0, binding = 0) uniform scene_buffer
     uint Pad;
     mat4 WVPTransform;
     mat4 WTransform;
+    mat4 VPTransform;
+    uint NumPointLights;
+    uint Flags;
+    vec2 RenderSize;
+
+    // NOTE: Light space basis for the directional light, ShadowDir.w is the min depth and ShadowUp.w is 1 / depth range
+    vec4 ShadowRight;
+    vec4 ShadowUp;
+    vec4 ShadowDir;
+    vec4 ShadowCascades[SHADOW_NUM_CASCADES]; // NOTE: xy = window min in light space, z = texel size
 } SceneBuffer;
 
-#if VERTEX_SHADER
+layout(set = 0, binding = 1) buffer point_light_buffer
+{
+    point_light PointLights[];
+};
 
-layout(location = 0) in vec4 InPackedPosNormal;
+layout(set = 0, binding = 2) buffer cluster_light_count_buffer
+{
+    uint ClusterLightCounts[];
+};
 
-layout(location = 0) out vec3 OutWorldPos;
-layout(location = 1) out vec3 OutWorldNormal;
-layout(location = 2) out vec2 OutUv;
+layout(set = 0, binding = 3) buffer cluster_light_index_buffer
+{
+    uint ClusterLightIndices[];
+};
 
-void main()
+layout(set = 0, binding = 4) uniform sampler2D ShadowAtlas;
+
+// IMPORTANT: Has to match procedural_3d_terrain_demo.h
+#define SCENE_FLAG_OVERDRAW 0x1
+#define OVERDRAW_MAX_PIXELS (3840*2160)
+
+layout(set = 0, binding = 5) buffer overdraw_buffer
+{
+    uint ShadedFragments;
+    uint CoveredPixels;
+    uint MaxFragmentsPerPixel;
+    uint Pad;
+    uint PixelFragments[];
+} Overdraw;
+
+// IMPORTANT: Has to match demo_far_field.h
+#define FAR_FIELD_NUM_LEVELS 4
+#define FAR_FIELD_MAX_STEPS 256
+
+layout(set = 0, binding = 6) uniform sampler3D FarFieldDensity[FAR_FIELD_NUM_LEVELS];
+
+layout(set = 0, binding = 7, std430) readonly buffer density_pyramid_buffer
+{
+    vec2 DensityPyramid[];
+};
+
+vec3 UnpackPosition(vec4 PackedPosNormal)
 {
 #if PACK_VERTICES
-    // NOTE: Unpack the position
-    vec3 Pos;
-    {
-        int64_t PackedPos = packInt2x32(floatBitsToInt(InPackedPosNormal.xy));
-        uint PosX = uint(PackedPos >> 0u) & 0x1FFFFF;
-        uint PosY = uint(PackedPos >> 21u) & 0x1FFFFF;
-        uint PosZ = uint(PackedPos >> 42u) & 0x0FFFFF;
+    int64_t PackedPos = packInt2x32(floatBitsToInt(PackedPosNormal.xy));
+    uint PosX = uint(PackedPos >> 0u) & 0x1FFFFF;
+    uint PosY = uint(PackedPos >> 21u) & 0x1FFFFF;
+    uint PosZ = uint(PackedPos >> 42u) & 0x0FFFFF;
 
-        PosX = PosX << 11u;
-        PosY = PosY << 11u;
-        PosZ = PosZ << 12u;
+    PosX = PosX << 11u;
+    PosY = PosY << 11u;
+    PosZ = PosZ << 12u;
 
-        int PosXI32 = int(PosX);
-        int PosYI32 = int(PosY);
-        int PosZI32 = int(PosZ);
+    int PosXI32 = int(PosX);
+    int PosYI32 = int(PosY);
+    int PosZI32 = int(PosZ);
 
 #define I32_MIN -2147483648
-        Pos = vec3(PosXI32, PosYI32, PosZI32) / (-I32_MIN);
+    vec3 Result = vec3(PosXI32, PosYI32, PosZI32) / (-I32_MIN);
+#else
+    vec3 Result = PackedPosNormal.xyz;
+#endif
+    
+    return Result;
+}
+
+//=========================================================================================================================================
+// NOTE: Lighting
+//=========================================================================================================================================
+
+// NOTE: Pick the smallest cascade whose window holds us (with a tile of margin for the filter) and do a 2x2 PCF
+float DirectionalShadowVisibility(vec3 SurfacePos, vec3 SurfaceNormal)
+{
+    float Result = 1.0f;
+    for (uint CascadeId = 0; CascadeId < SHADOW_NUM_CASCADES; ++CascadeId)
+    {
+        vec4 Cascade = SceneBuffer.ShadowCascades[CascadeId];
+        float TexelSize = Cascade.z;
+        float WindowSize = TexelSize * SHADOW_CASCADE_RES;
+        float Margin = WindowSize / SHADOW_TILES_PER_AXIS;
+
+        // NOTE: Normal offset scaled to the texel size keeps acne down without a large depth bias
+        vec3 SamplePos = SurfacePos + SurfaceNormal * 1.5f * TexelSize;
+        vec3 LightPos = ShadowLightSpace(SamplePos, SceneBuffer.ShadowRight.xyz, SceneBuffer.ShadowUp.xyz, SceneBuffer.ShadowDir.xyz);
+        vec2 WindowPos = LightPos.xy - Cascade.xy;
+        if (all(greaterThanEqual(WindowPos, vec2(Margin))) && all(lessThan(WindowPos, vec2(WindowSize - Margin))))
+        {
+            float Depth = (LightPos.z - SceneBuffer.ShadowDir.w) * SceneBuffer.ShadowUp.w;
+            float Bias = 2.0f * TexelSize * SceneBuffer.ShadowUp.w;
+            vec2 TexelPos = LightPos.xy / TexelSize - vec2(0.5f);
+            ivec2 BaseTexel = ivec2(floor(TexelPos));
+            vec2 Weights = fract(TexelPos);
+
+            vec4 Lit;
+            Lit.x = float(Depth - Bias <= texelFetch(ShadowAtlas, ShadowAtlasTexel(BaseTexel + ivec2(0, 0), CascadeId), 0).r);
+            Lit.y = float(Depth - Bias <= texelFetch(ShadowAtlas, ShadowAtlasTexel(BaseTexel + ivec2(1, 0), CascadeId), 0).r);
+            Lit.z = float(Depth - Bias <= texelFetch(ShadowAtlas, ShadowAtlasTexel(BaseTexel + ivec2(0, 1), CascadeId), 0).r);
+            Lit.w = float(Depth - Bias <= texelFetch(ShadowAtlas, ShadowAtlasTexel(BaseTexel + ivec2(1, 1), CascadeId), 0).r);
+            Result = mix(mix(Lit.x, Lit.y, Weights.x), mix(Lit.z, Lit.w, Weights.x), Weights.y);
+            break;
+        }
+    }
+
+    return Result;
+}
+
+// NOTE: Shared by the mesh and the far field trace so both halves of the terrain light the same
+vec3 SurfaceLighting(vec3 SurfacePos, vec3 SurfaceNormal, vec3 SurfaceColor, vec2 FragCoord)
+{
+    vec3 View = normalize(SceneBuffer.CameraPos - SurfacePos);
+    vec3 Color = vec3(0);
+
+    // NOTE: Calculate lighting for the point lights binned into our cluster
+    {
+        float ViewDepth = (SceneBuffer.VPTransform * vec4(SurfacePos, 1)).w;
+        uvec2 Tile = LightClusterTile(FragCoord / SceneBuffer.RenderSize);
+        uint ClusterId = LightClusterId(Tile, LightClusterSlice(ViewDepth));
+        uint NumLights = min(ClusterLightCounts[ClusterId], LIGHT_CLUSTER_MAX_LIGHTS);
+        for (uint ClusterLightId = 0; ClusterLightId < NumLights; ++ClusterLightId)
+        {
+            point_light CurrLight = PointLights[ClusterLightIndices[ClusterId*LIGHT_CLUSTER_MAX_LIGHTS + ClusterLightId]];
+            vec3 LightDir = normalize(SurfacePos - CurrLight.Pos);
+            Color += BlinnPhongLighting(View, SurfaceColor, SurfaceNormal, 32, LightDir, PointLightAttenuate(SurfacePos, CurrLight));
+        }
+    }
+
+    // NOTE: Calculate lighting for directional lights
+    {
+        directional_light DirLight;
+        DirLight.Color = vec3(1);
+        DirLight.Dir = SceneBuffer.ShadowDir.xyz;
+        DirLight.AmbientLight = vec3(0.4);
+
+        float Visibility = DirectionalShadowVisibility(SurfacePos, SurfaceNormal);
+        Color += Visibility * BlinnPhongLighting(View, SurfaceColor, SurfaceNormal, 32, DirLight.Dir, DirLight.Color);
+        Color += DirLight.AmbientLight * SurfaceColor;
+    }
+
+    return Color;
+}
+
+//=========================================================================================================================================
+// NOTE: Build Light Clusters
+//=========================================================================================================================================
+
+#if BUILD_LIGHT_CLUSTERS
+
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+void main()
+{
+    uint LightId = gl_GlobalInvocationID.x;
+    if (LightId >= SceneBuffer.NumPointLights)
+    {
+        return;
+    }
+
+    point_light Light = PointLights[LightId];
+    float Radius = Light.MaxDistance;
+
+    // NOTE: Depth range is exact since w is the view depth
+    float CenterDepth = (SceneBuffer.VPTransform * vec4(Light.Pos, 1)).w;
+    float MinDepth = CenterDepth - Radius;
+    float MaxDepth = CenterDepth + Radius;
+    if (MaxDepth < LIGHT_CLUSTER_NEAR || MinDepth > LIGHT_CLUSTER_FAR)
+    {
+        return;
     }
 
+    // NOTE: Conservative screen rect from the spheres bounding box. The box corners reach sqrt(3)*Radius in depth, further than the
+    // sphere, so the rect is only used when every corner is in front of the near plane. Anything closer covers the whole screen
+    vec2 MinUv = vec2(0);
+    vec2 MaxUv = vec2(1);
+    if (CenterDepth - 1.7320508f*Radius > LIGHT_CLUSTER_NEAR)
+    {
+        MinUv = vec2(1);
+        MaxUv = vec2(0);
+        bool BehindNear = false;
+        for (uint CornerId = 0; CornerId < 8; ++CornerId)
+        {
+            vec3 Corner = vec3((CornerId & 1) != 0 ? 1 : -1, (CornerId & 2) != 0 ? 1 : -1, (CornerId & 4) != 0 ? 1 : -1);
+            vec4 Clip = SceneBuffer.VPTransform * vec4(Light.Pos + Radius*Corner, 1);
+            BehindNear = BehindNear || Clip.w <= LIGHT_CLUSTER_NEAR;
+            vec2 Uv = 0.5f * (Clip.xy / Clip.w) + vec2(0.5f);
+            MinUv = min(MinUv, Uv);
+            MaxUv = max(MaxUv, Uv);
+        }
+
+        if (BehindNear)
+        {
+            // NOTE: Rounding can still put a corner on the near plane, the projected rect is meaningless then
+            MinUv = vec2(0);
+            MaxUv = vec2(1);
+        }
+        else if (any(greaterThan(MinUv, vec2(1))) || any(lessThan(MaxUv, vec2(0))))
+        {
+            return;
+        }
+    }
+
+    uvec2 MinTile = LightClusterTile(MinUv);
+    uvec2 MaxTile = LightClusterTile(MaxUv);
+    uint MinSlice = LightClusterSlice(MinDepth);
+    uint MaxSlice = LightClusterSlice(MaxDepth);
+    for (uint Slice = MinSlice; Slice <= MaxSlice; ++Slice)
+    {
+        for (uint TileY = MinTile.y; TileY <= MaxTile.y; ++TileY)
+        {
+            for (uint TileX = MinTile.x; TileX <= MaxTile.x; ++TileX)
+            {
+                uint ClusterId = LightClusterId(uvec2(TileX, TileY), Slice);
+                uint Slot = atomicAdd(ClusterLightCounts[ClusterId], 1);
+                if (Slot < LIGHT_CLUSTER_MAX_LIGHTS)
+                {
+                    ClusterLightIndices[ClusterId*LIGHT_CLUSTER_MAX_LIGHTS + Slot] = LightId;
+                }
+            }
+        }
+    }
+}
+
+#endif
+
+#if VERTEX_SHADER
+
+layout(location = 0) in vec4 InPackedPosNormal;
+
+layout(location = 0) out vec3 OutWorldPos;
+layout(location = 1) out vec3 OutWorldNormal;
+layout(location = 2) out vec2 OutUv;
+
+// NOTE: The depth prepass has to produce bit identical depth for the EQUAL test
+invariant gl_Position;
+
+void main()
+{
+    vec3 Pos = UnpackPosition(InPackedPosNormal);
+    
+#if PACK_VERTICES
     // NOTE: Unpack Normal
     vec3 Normal = vec3(InPackedPosNormal.z, InPackedPosNormal.w, 0);
     Normal.z = sqrt(1.0f - clamp(Normal.x*Normal.x - Normal.y*Normal.y, 0, 1));
 #else
-    vec3 Pos = InPackedPosNormal.xyz;
     vec3 Normal = vec3(0);
 #endif
     
@@ -64,6 +284,53 @@ void main()
 
 #endif
 
+//=========================================================================================================================================
+// NOTE: Depth Prepass
+//=========================================================================================================================================
+
+#if DEPTH_PREPASS_VERTEX_SHADER
+
+// NOTE: Only the packed position half of the vertex is fetched
+layout(location = 0) in vec2 InPackedPos;
+
+invariant gl_Position;
+
+void main()
+{
+    // IMPORTANT: Has to stay the exact same math as VERTEX_SHADER
+    vec3 Pos = UnpackPosition(vec4(InPackedPos, 0, 0));
+    gl_Position = SceneBuffer.WVPTransform * vec4(Pos, 1);
+}
+
+#endif
+
+//=========================================================================================================================================
+// NOTE: Shadow Tiles
+//=========================================================================================================================================
+
+#if SHADOW_VERTEX_SHADER
+
+layout(location = 0) in vec4 InPackedPosNormal;
+
+layout(push_constant) uniform shadow_tile_constants
+{
+    vec2 TileMin; // NOTE: Light space
+    vec2 InvTileSize;
+} ShadowTile;
+
+void main()
+{
+    vec3 WorldPos = (SceneBuffer.WTransform * vec4(UnpackPosition(InPackedPosNormal), 1)).xyz;
+    vec3 LightPos = ShadowLightSpace(WorldPos, SceneBuffer.ShadowRight.xyz, SceneBuffer.ShadowUp.xyz, SceneBuffer.ShadowDir.xyz);
+
+    // NOTE: Viewport is the tiles rect in the atlas so we only map the tile to NDC
+    vec2 Ndc = 2.0f*(LightPos.xy - ShadowTile.TileMin)*ShadowTile.InvTileSize - vec2(1);
+    float Depth = (LightPos.z - SceneBuffer.ShadowDir.w) * SceneBuffer.ShadowUp.w;
+    gl_Position = vec4(Ndc, Depth, 1);
+}
+
+#endif
+
 #if FRAGMENT_SHADER
 
 layout(location = 0) in vec3 InWorldPos;
@@ -72,9 +339,28 @@ layout(location = 2) in vec2 InUv;
 
 layout(location = 0) out vec4 OutColor;
 
+// NOTE: We never write depth, this keeps the depth test before shading even with the overdraw counter writes
+layout(early_fragment_tests) in;
+
 void main()
 {
-    vec3 CameraPos = vec3(0, 0, 0);
+    if ((SceneBuffer.Flags & SCENE_FLAG_OVERDRAW) != 0)
+    {
+        uvec2 Pixel = uvec2(gl_FragCoord.xy);
+        uint PixelId = Pixel.y * uint(SceneBuffer.RenderSize.x) + Pixel.x;
+
+        // NOTE: The per pixel counts stop at OVERDRAW_MAX_PIXELS, fragments past that aren't counted at all
+        if (PixelId < OVERDRAW_MAX_PIXELS)
+        {
+            uint PrevFragments = atomicAdd(Overdraw.PixelFragments[PixelId], 1);
+            atomicAdd(Overdraw.ShadedFragments, 1);
+            atomicMax(Overdraw.MaxFragmentsPerPixel, PrevFragments + 1);
+            if (PrevFragments == 0)
+            {
+                atomicAdd(Overdraw.CoveredPixels, 1);
+            }
+        }
+    }
 
     // TODO: Proper texture mapping
 #if PACK_VERTICES
@@ -86,28 +372,222 @@ void main()
     vec3 SurfacePos = InWorldPos;
     vec3 SurfaceNormal = normalize(InWorldNormal);
     vec3 SurfaceColor = TexelColor.rgb;
-    vec3 View = normalize(CameraPos - SurfacePos);
-    vec3 Color = vec3(0);
+    vec3 Color = SurfaceLighting(SurfacePos, SurfaceNormal, SurfaceColor, gl_FragCoord.xy);
+
+    OutColor = vec4(Color, 1);
+}
+
+#endif
+
+//=========================================================================================================================================
+// NOTE: Far Field Trace
+//=========================================================================================================================================
+
+#if FAR_FIELD_VERTEX_SHADER || FAR_FIELD_FRAGMENT_SHADER
 
-    // NOTE: Calculate lighting for point lights
-    //for (int i = 0; i < SceneBuffer.NumPointLights; ++i)
+layout(push_constant) uniform far_field_constants
+{
+    vec3 TerrainMin;
+    float CutoverDistance;
+    vec3 TerrainSize;
+    float WorldPerDensity;
+    vec3 TexelOffset;
+    float Level0TexelSize;
+    float LodBias;
+    float Pad;
+    uvec3 NumChunks; // NOTE: Chunk i of the grid is pyramid slot i
+    uint EmptySpaceSkip;
+} FarField;
+
+vec3 FarFieldUnproject(mat4 InvVP, vec2 Ndc)
+{
+    // NOTE: Any fixed depth works, points on it are affine in screen space. 0.5 stays finite with an infinite reverse z far plane
+    vec4 Result = InvVP * vec4(Ndc, 0.5f, 1);
+    return Result.xyz / Result.w;
+}
+
+#endif
+
+#if FAR_FIELD_VERTEX_SHADER
+
+layout(location = 0) noperspective out vec3 OutRayDir;
+
+void main()
+{
+    vec2 Ndc = 2.0f * vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2) - vec2(1.0f);
+    mat4 InvVP = inverse(SceneBuffer.VPTransform);
+    vec3 CameraPos = SceneBuffer.CameraPos;
+    OutRayDir = FarFieldUnproject(InvVP, Ndc) - CameraPos;
+
+    // NOTE: Every hit is at least CutoverDistance along its ray so its view depth is at least CutoverDistance * cos(corner angle). We
+    // put the triangle on that plane and declare depth_less, which lets the depth test reject pixels the mesh already covers before
+    // we trace them
+    vec3 Forward = normalize(FarFieldUnproject(InvVP, vec2(0)) - CameraPos);
+    vec3 Corner = normalize(FarFieldUnproject(InvVP, vec2(1)) - CameraPos);
+    vec4 PlaneClip = SceneBuffer.VPTransform * vec4(CameraPos + Forward * FarField.CutoverDistance * dot(Forward, Corner), 1);
+    gl_Position = vec4(Ndc, clamp(PlaneClip.z / PlaneClip.w, 0.0f, 1.0f), 1);
+}
+
+#endif
+
+#if FAR_FIELD_FRAGMENT_SHADER
+
+layout(location = 0) noperspective in vec3 InRayDir;
+
+layout(location = 0) out vec4 OutColor;
+layout(depth_less) out float gl_FragDepth;
+
+// NOTE: Constant indices only, the level differs per pixel
+float FarFieldSample(vec3 Uvw, int Level)
+{
+    vec3 Uv = Uvw + FarField.TexelOffset;
+    float Result = 0.0f;
+    if (Level == 0) Result = textureLod(FarFieldDensity[0], Uv, 0).x;
+    else if (Level == 1) Result = textureLod(FarFieldDensity[1], Uv, 0).x;
+    else if (Level == 2) Result = textureLod(FarFieldDensity[2], Uv, 0).x;
+    else Result = textureLod(FarFieldDensity[3], Uv, 0).x;
+    return Result;
+}
+
+int FarFieldLevel(float T, float PixelAngle)
+{
+    int Result = int(clamp(log2(max(T * PixelAngle / FarField.Level0TexelSize, 1.0f)) + FarField.LodBias, 0.0f, float(FAR_FIELD_NUM_LEVELS - 1)));
+    return Result;
+}
+
+/*
+  NOTE: How far along the ray we can jump without sampling. We walk down the pyramid nodes under the sample and stop at the first one
+        that is all air (max < 0). A far field texel of a level averages 2^(Level + 1) samples and filtering reaches half a texel further,
+        so the field is only guaranteed to be negative Margin samples inside of the node and we jump to where the ray leaves that
+        shrunk box. Solid nodes aren't skipped, sampling them is what finds the hit.
+ */
+float FarFieldEmptySkip(vec3 Uvw, vec3 UvwDir, float Margin)
+{
+    vec3 TerrainRes = vec3(FarField.NumChunks * DENSITY_PYRAMID_CHUNK_RES);
+    vec3 SamplePos = Uvw * TerrainRes;
+    vec3 SampleDir = UvwDir * TerrainRes;
+    
+    uvec3 Chunk = uvec3(clamp(floor(SamplePos / float(DENSITY_PYRAMID_CHUNK_RES)), vec3(0), vec3(FarField.NumChunks - uvec3(1))));
+    uint Slot = (Chunk.z*FarField.NumChunks.y + Chunk.y)*FarField.NumChunks.x + Chunk.x;
+    vec3 ChunkPos = SamplePos - vec3(Chunk * DENSITY_PYRAMID_CHUNK_RES);
+
+    float Result = 0.0f;
+    for (uint Level = 0; Level < DENSITY_PYRAMID_LEVELS; ++Level)
+    {
+        float NodeSize = float(DENSITY_PYRAMID_CHUNK_RES >> Level);
+        uvec3 Node = uvec3(clamp(floor(ChunkPos / NodeSize), vec3(0), vec3((1 << Level) - 1)));
+        if (DensityPyramid[DensityPyramidNode(Slot, Level, Node)].y >= 0.0f)
+        {
+            continue;
+        }
+
+        vec3 BoxMin = vec3(Node)*NodeSize + vec3(Margin);
+        vec3 BoxMax = vec3(Node + uvec3(1))*NodeSize - vec3(Margin);
+        if (all(greaterThan(ChunkPos, BoxMin)) && all(lessThan(ChunkPos, BoxMax)))
+        {
+            vec3 InvDir = 1.0f / SampleDir;
+            vec3 TExit = max((BoxMin - ChunkPos) * InvDir, (BoxMax - ChunkPos) * InvDir);
+            Result = min(min(TExit.x, TExit.y), TExit.z);
+        }
+        break;
+    }
+    
+    return Result;
+}
+
+void main()
+{
+    vec3 RayDir = normalize(InRayDir);
+    float PixelAngle = length(fwidth(RayDir));
+    vec3 RayPos = SceneBuffer.CameraPos;
+
+    // NOTE: Clip the ray against the terrain box, uvw is [0, 1] over it
+    vec3 UvwPos = (RayPos - FarField.TerrainMin) / FarField.TerrainSize;
+    vec3 UvwDir = RayDir / FarField.TerrainSize;
+    vec3 InvDir = 1.0f / UvwDir;
+    vec3 T0 = -UvwPos * InvDir;
+    vec3 T1 = (vec3(1) - UvwPos) * InvDir;
+    vec3 TMin = min(T0, T1);
+    vec3 TMax = max(T0, T1);
+    float TEnter = max(max(TMin.x, TMin.y), TMin.z);
+    float TExit = min(min(TMax.x, TMax.y), TMax.z);
+
+    float T = max(TEnter, FarField.CutoverDistance);
+    if (T >= TExit)
     {
-        //point_light CurrLight = PointLights[i];
-        //vec3 LightDir = normalize(SurfacePos - CurrLight.Pos);
-        //Color += BlinnPhongLighting(View, SurfaceColor, SurfaceNormal, 32, LightDir, PointLightAttenuate(SurfacePos, CurrLight));
+        discard;
     }
 
-    // NOTE: Calculate lighting for directional lights
+    // NOTE: Sphere trace with the density bound, coarser levels once a level 0 texel is smaller than a pixel
+    bool Hit = false;
+    int Level = 0;
+    float PrevT = T;
+    float PrevDensity = -1.0f;
+    for (uint StepId = 0; StepId < FAR_FIELD_MAX_STEPS; ++StepId)
     {
-        directional_light DirLight;
-        DirLight.Color = vec3(1);
-        DirLight.Dir = normalize(vec3(1, 1, 0));
-        DirLight.AmbientLight = vec3(0.4);
-        Color += BlinnPhongLighting(View, SurfaceColor, SurfaceNormal, 32, DirLight.Dir, DirLight.Color);
-        Color += DirLight.AmbientLight * SurfaceColor;
+        Level = FarFieldLevel(T, PixelAngle);
+        if (FarField.EmptySpaceSkip != 0)
+        {
+            // NOTE: The level can go up over the jump, redo it with the margin of the level we land on. Landing in the shrunk box
+            // means the next sample is still air so the secant below never spans a jump
+            float Skip = FarFieldEmptySkip(UvwPos + T*UvwDir, UvwDir, float(3 << Level));
+            int SkipLevel = FarFieldLevel(T + Skip, PixelAngle);
+            if (Skip > 0.0f && SkipLevel > Level)
+            {
+                Level = SkipLevel;
+                Skip = FarFieldEmptySkip(UvwPos + T*UvwDir, UvwDir, float(3 << Level));
+            }
+
+            T += Skip;
+            if (T >= TExit)
+            {
+                break;
+            }
+        }
+        
+        float Density = FarFieldSample(UvwPos + T*UvwDir, Level);
+        if (Density >= 0.0f)
+        {
+            // NOTE: Secant between the last two samples, the first sample being inside just means the surface crosses the cutover
+            if (StepId > 0)
+            {
+                T = PrevT + (T - PrevT) * (-PrevDensity) / (Density - PrevDensity);
+            }
+            Hit = true;
+            break;
+        }
+
+        float MinStep = 0.5f * FarField.Level0TexelSize * float(1 << Level);
+        PrevT = T;
+        PrevDensity = Density;
+        T += max(-Density * FarField.WorldPerDensity, MinStep);
+        if (T >= TExit)
+        {
+            break;
+        }
+    }
+
+    if (!Hit)
+    {
+        discard;
     }
 
+    vec3 SurfacePos = RayPos + T*RayDir;
+    vec3 SurfaceUvw = UvwPos + T*UvwDir;
+
+    // NOTE: Same convention as GenerateNormals, density grows into the ground
+    vec3 Step = FarField.TexelOffset * 2.0f * float(2 << Level);
+    vec3 Gradient;
+    Gradient.x = FarFieldSample(SurfaceUvw + vec3(Step.x, 0, 0), Level) - FarFieldSample(SurfaceUvw - vec3(Step.x, 0, 0), Level);
+    Gradient.y = FarFieldSample(SurfaceUvw + vec3(0, Step.y, 0), Level) - FarFieldSample(SurfaceUvw - vec3(0, Step.y, 0), Level);
+    Gradient.z = FarFieldSample(SurfaceUvw + vec3(0, 0, Step.z), Level) - FarFieldSample(SurfaceUvw - vec3(0, 0, Step.z), Level);
+    vec3 SurfaceNormal = -normalize(Gradient / (Step * FarField.TerrainSize));
+
+    vec3 Color = SurfaceLighting(SurfacePos, SurfaceNormal, vec3(1), gl_FragCoord.xy);
     OutColor = vec4(Color, 1);
+
+    vec4 Clip = SceneBuffer.VPTransform * vec4(SurfacePos, 1);
+    gl_FragDepth = Clip.z / Clip.w;
 }
 
 #endif
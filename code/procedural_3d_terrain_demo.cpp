@@ -1,6 +1,27 @@
 
 #include "procedural_3d_terrain_demo.h"
 #include "transvoxel.cpp"
+#include "demo_platform.cpp"
+#include "demo_gpu_allocator.cpp"
+#include "demo_upload_ring.cpp"
+#include "demo_job_queue.cpp"
+#include "demo_pipelines.cpp"
+#include "demo_shader_reload.cpp"
+#include "terrain_benchmark.cpp"
+#include "demo_workgroup_tuner.cpp"
+#include "terrain_chunk_cache.cpp"
+#include "demo_light_clusters.cpp"
+#include "demo_shadow_cache.cpp"
+#include "demo_dynamic_resolution.cpp"
+#include "demo_far_field.cpp"
+#include "demo_density_pyramid.cpp"
+#include "terrain_queries.cpp"
+#include "terrain_fp16.cpp"
+#include "terrain_chunk_scheduler.cpp"
+#include "terrain_chunk_residency.cpp"
+#include "terrain_chunk_class.cpp"
+#include "terrain_preview.cpp"
+#include "terrain_cpu_mesher.cpp"
 
 inline void DemoWindowResize(u32 Width, u32 Height)
 {
@@ -25,15 +46,1326 @@ inline void DemoWindowResize(u32 Width, u32 Height)
         RenderTargetUpdateEntries(&DemoState->TempArena, &DemoState->RenderTarget);
     }
 
+    // NOTE: Targets are window sized, the dynamic resolution rect lives inside them
+    DynamicResolutionResize(&DemoState->DynamicRes, Width, Height);
+    
+    // NOTE: Linear so copy to swap can upscale the dynamic resolution rect
     VkDescriptorImageWrite(&RenderState->DescriptorManager, DemoState->CopyToSwapDesc, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                           DemoState->ColorEntry.View, DemoState->PointSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+                           DemoState->ColorEntry.View, DemoState->LinearSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     VkDescriptorManagerFlush(RenderState->Device, &RenderState->DescriptorManager);
 }
 
+//
+// NOTE: GPU Memory
+//
+
+inline f64 TerrainBytesToMb(u64 Size)
+{
+    f64 Result = f64(Size) / (1024.0*1024.0);
+    return Result;
+}
+
+inline void TerrainGpuMemoryPanel(ui_panel* Panel)
+{
+    gpu_memory_stats* Stats = &DemoState->GpuAllocator.Stats;
+    char Text[256];
+
+    snprintf(Text, sizeof(Text), "GPU Memory: %.1f MB allocated, %.1f MB reserved", TerrainBytesToMb(Stats->AllocatedSize),
+             TerrainBytesToMb(Stats->ReservedSize));
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+
+    snprintf(Text, sizeof(Text), "Fragmented: %.1f MB, Free Frag: %.2f, Allocs: %u (%u dedicated)", TerrainBytesToMb(Stats->FragmentedSize),
+             Stats->FragmentationRatio, Stats->NumAllocations, Stats->NumDedicated);
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+
+    for (u32 CategoryId = 0; CategoryId < GpuMemoryCategory_Count; ++CategoryId)
+    {
+        if (Stats->CategorySize[CategoryId] > 0)
+        {
+            snprintf(Text, sizeof(Text), "  %s: %.2f MB", GlobalGpuMemoryCategoryNames[CategoryId], TerrainBytesToMb(Stats->CategorySize[CategoryId]));
+            UiPanelText(Panel, Text);
+            UiPanelNextRow(Panel);
+        }
+    }
+
+    for (u32 HeapId = 0; HeapId < Stats->NumHeaps; ++HeapId)
+    {
+        snprintf(Text, sizeof(Text), "Heap %u: %.1f / %.1f MB", HeapId, TerrainBytesToMb(Stats->HeapUsage[HeapId]),
+                 TerrainBytesToMb(Stats->HeapBudget[HeapId]));
+        UiPanelText(Panel, Text);
+        UiPanelNextRow(Panel);
+    }
+}
+
+inline void TerrainGpuMemoryRecord(benchmark_state* Bench)
+{
+    gpu_memory_stats* Stats = &DemoState->GpuAllocator.Stats;
+    BenchmarkRecord(Bench, "gpu_mem_reserved_mb", TerrainBytesToMb(Stats->ReservedSize), "MB");
+    BenchmarkRecord(Bench, "gpu_mem_allocated_mb", TerrainBytesToMb(Stats->AllocatedSize), "MB");
+    BenchmarkRecord(Bench, "gpu_mem_fragmented_mb", TerrainBytesToMb(Stats->FragmentedSize), "MB");
+    BenchmarkRecord(Bench, "gpu_mem_free_fragmentation", Stats->FragmentationRatio, "ratio");
+    BenchmarkRecord(Bench, "gpu_mem_allocations", Stats->NumAllocations, "allocations");
+
+    char Name[64];
+    for (u32 CategoryId = 0; CategoryId < GpuMemoryCategory_Count; ++CategoryId)
+    {
+        snprintf(Name, sizeof(Name), "gpu_mem_%s_mb", GlobalGpuMemoryCategoryNames[CategoryId]);
+        BenchmarkRecord(Bench, Name, TerrainBytesToMb(Stats->CategorySize[CategoryId]), "MB");
+    }
+
+    for (u32 HeapId = 0; HeapId < Stats->NumHeaps; ++HeapId)
+    {
+        snprintf(Name, sizeof(Name), "gpu_heap%u_usage_mb", HeapId);
+        BenchmarkRecord(Bench, Name, TerrainBytesToMb(Stats->HeapUsage[HeapId]), "MB");
+        snprintf(Name, sizeof(Name), "gpu_heap%u_budget_mb", HeapId);
+        BenchmarkRecord(Bench, Name, TerrainBytesToMb(Stats->HeapBudget[HeapId]), "MB");
+    }
+}
+
+//
+// NOTE: Chunk Generation
+//
+
+inline chunk_key TerrainChunkSlotKey(u32 Slot)
+{
+    chunk_key Result = ChunkKey(Slot % DemoState->ChunksX, (Slot / DemoState->ChunksX) % DemoState->ChunksY,
+                                Slot / (DemoState->ChunksX*DemoState->ChunksY), 0);
+    return Result;
+}
+
+// NOTE: Chunk bounds in terrain space ([-1, 1] over the whole terrain), same mapping GENERATE_TRIANGLES uses for vertices
+inline void TerrainChunkBounds(chunk_key Key, v3* OutMin, v3* OutMax)
+{
+    v3 Resolution = V3(f32(DemoState->TerrainResX), f32(DemoState->TerrainResY), f32(DemoState->TerrainResZ));
+    f32 ChunkSize = f32(TERRAIN_CHUNK_RES << Key.Lod);
+    v3 Origin = V3(f32(Key.X), f32(Key.Y), f32(Key.Z))*ChunkSize;
+    *OutMin = 2.0f*(Origin / Resolution) - V3(1.0f);
+    *OutMax = 2.0f*((Origin + V3(ChunkSize)) / Resolution) - V3(1.0f);
+}
+
+inline v3 TerrainToWorld(v3 TerrainPos)
+{
+    v3 Result = DemoState->TerrainPos + 2.0f*DemoState->TerrainRadius*TerrainPos;
+    return Result;
+}
+
+inline chunk_shadow_bounds TerrainChunkShadowBounds(v3 BoundsMin, v3 BoundsMax)
+{
+    chunk_shadow_bounds Result = {};
+    Result.Valid = true;
+    Result.WorldMin = TerrainToWorld(BoundsMin);
+    Result.WorldMax = TerrainToWorld(BoundsMax);
+    ShadowCacheLightRect(&DemoState->ShadowCache, Result.WorldMin, Result.WorldMax, &Result.LightMin, &Result.LightMax);
+    return Result;
+}
+
+inline void TerrainChunkSlotAtlasOffset(u32 Slot, u32* OutX, u32* OutY, u32* OutZ)
+{
+    *OutX = (Slot % DemoState->AtlasSlotsX) * TERRAIN_CHUNK_SLOT_DIM;
+    *OutY = ((Slot / DemoState->AtlasSlotsX) % DemoState->AtlasSlotsY) * TERRAIN_CHUNK_SLOT_DIM;
+    *OutZ = (Slot / (DemoState->AtlasSlotsX*DemoState->AtlasSlotsY)) * TERRAIN_CHUNK_SLOT_DIM;
+}
+
+//
+// NOTE: Chunk Classes
+//
+
+// NOTE: Bound over every sample of the chunks slot, slot sample 0 is one step below the chunk and the last is RES + 1 above
+inline chunk_class TerrainChunkClassFromBound(chunk_key Key, f32* OutFill)
+{
+    f32 Step = f32(1 << Key.Lod);
+    f32 OriginY = f32(Key.Y * (TERRAIN_CHUNK_RES << Key.Lod));
+    f32 ResolutionY = f32(DemoState->TerrainResY);
+    f32 MinUvY = 2.0f*((OriginY - Step) / ResolutionY) - 1.0f;
+    f32 MaxUvY = 2.0f*((OriginY + f32(TERRAIN_CHUNK_SLOT_DIM - 2)*Step) / ResolutionY) - 1.0f;
+
+    // NOTE: Same mapping as TerrainDensityEvaluate
+    f32 MinY = DemoState->TerrainPos.y + MinUvY*DemoState->TerrainRadius.y;
+    f32 MaxY = DemoState->TerrainPos.y + MaxUvY*DemoState->TerrainRadius.y;
+    chunk_class Result = ChunkClassFromBound(MinY, MaxY, OutFill);
+    return Result;
+}
+
+// NOTE: Call after DensityPyramidReadbackRead, slots generated in fp32 last frame get classified from their chunk node
+inline void TerrainChunkClassMeasure()
+{
+    chunk_class_cache* Classes = &DemoState->ChunkClasses;
+    v2* ChunkNodes = (v2*)DemoState->DensityPyramid.Readback.Allocation.Mapped;
+    for (u32 Slot = 0; Slot < Classes->NumSlots; ++Slot)
+    {
+        if (Classes->SlotMeasure[Slot])
+        {
+            ChunkClassMeasure(Classes, Slot, TerrainChunkSlotKey(Slot), ChunkNodes[Slot]);
+        }
+    }
+}
+
+/*
+  NOTE: Skipped slots still get read by the far field, the bake and the pyramid walk. Every skipped slot gets a copy of the constant
+        air or solid slot in its atlas region and its pyramid nodes filled with the same value, all regions of a class go out in one
+        copy call
+ */
+inline void TerrainChunkClassFillRecord(vk_commands* Commands)
+{
+    chunk_class_cache* Classes = &DemoState->ChunkClasses;
+    density_pyramid* Pyramid = &DemoState->DensityPyramid;
+    VkBarrierImageAdd(Commands, DemoState->TerrainDensity.Image, VK_IMAGE_ASPECT_COLOR_BIT,
+                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                      VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_IMAGE_LAYOUT_GENERAL);
+    VkBarrierBufferAdd(Commands, Pyramid->Nodes.Buffer,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    chunk_class FillClasses[] = { ChunkClass_Air, ChunkClass_Solid };
+    gpu_buffer* FillBuffers[] = { &DemoState->ChunkClassAirFill, &DemoState->ChunkClassSolidFill };
+    f32 FillDensities[] = { Classes->AirFill, Classes->SolidFill };
+    for (u32 ClassId = 0; ClassId < ArrayCount(FillClasses); ++ClassId)
+    {
+        u32 NumRegions = 0;
+        for (u32 FillId = 0; FillId < Classes->NumFillSlots; ++FillId)
+        {
+            u32 Slot = Classes->FillSlots[FillId];
+            if (Classes->SlotClass[Slot] != FillClasses[ClassId])
+            {
+                continue;
+            }
+
+            u32 AtlasX, AtlasY, AtlasZ;
+            TerrainChunkSlotAtlasOffset(Slot, &AtlasX, &AtlasY, &AtlasZ);
+            VkBufferImageCopy* Region = DemoState->ChunkClassFillRegions + NumRegions++;
+            *Region = {};
+            Region->imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            Region->imageSubresource.layerCount = 1;
+            Region->imageOffset = { i32(AtlasX), i32(AtlasY), i32(AtlasZ) };
+            Region->imageExtent = { TERRAIN_CHUNK_SLOT_DIM, TERRAIN_CHUNK_SLOT_DIM, TERRAIN_CHUNK_SLOT_DIM };
+
+            DensityPyramidSlotFill(Pyramid, Commands, Slot, FillDensities[ClassId]);
+        }
+
+        if (NumRegions > 0)
+        {
+            vkCmdCopyBufferToImage(Commands->Buffer, FillBuffers[ClassId]->Buffer, DemoState->TerrainDensity.Image, VK_IMAGE_LAYOUT_GENERAL,
+                                   NumRegions, DemoState->ChunkClassFillRegions);
+        }
+    }
+
+    VkBarrierImageAdd(Commands, DemoState->TerrainDensity.Image, VK_IMAGE_ASPECT_COLOR_BIT,
+                      VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL);
+    VkBarrierBufferAdd(Commands, Pyramid->Nodes.Buffer,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    Classes->NumFillSlots = 0;
+    DemoState->FarField.Dirty = true;
+}
+
+inline chunk_batch ChunkBatchCreate(gpu_allocator* Allocator, linear_arena* Arena, u32 MaxJobs)
+{
+    chunk_batch Result = {};
+    Result.MaxJobs = MaxJobs;
+    Result.Jobs = PushArray(Arena, chunk_job, MaxJobs);
+    Result.JobBuffer = GpuBufferCreate(Allocator, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(chunk_job)*MaxJobs, GpuMemoryCategory_Terrain);
+    Result.DispatchArgs = GpuBufferCreate(Allocator, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 6*sizeof(VkDispatchIndirectCommand), GpuMemoryCategory_Terrain);
+    return Result;
+}
+
+inline void ChunkBatchClear(chunk_batch* Batch)
+{
+    Batch->NumJobs = 0;
+    Batch->Dirty = true;
+}
+
+inline void ChunkBatchAdd(chunk_batch* Batch, chunk_key Key, u32 Slot)
+{
+    Assert(Batch->NumJobs < Batch->MaxJobs);
+    chunk_job* Job = Batch->Jobs + Batch->NumJobs++;
+    *Job = {};
+    Job->OriginX = Key.X * (TERRAIN_CHUNK_RES << Key.Lod);
+    Job->OriginY = Key.Y * (TERRAIN_CHUNK_RES << Key.Lod);
+    Job->OriginZ = Key.Z * (TERRAIN_CHUNK_RES << Key.Lod);
+    Job->Lod = Key.Lod;
+    Job->Slot = Slot;
+    TerrainChunkSlotAtlasOffset(Slot, &Job->AtlasOffsetX, &Job->AtlasOffsetY, &Job->AtlasOffsetZ);
+    Batch->Dirty = true;
+    DensityPyramidSlotReset(&DemoState->DensityPyramid, Slot);
+
+    // NOTE: The slot gets new geometry so shadow tiles that saw its old or new contents are stale
+    v3 BoundsMin, BoundsMax;
+    TerrainChunkBounds(Key, &BoundsMin, &BoundsMax);
+    chunk_shadow_bounds* ShadowBounds = DemoState->SlotShadowBounds + Slot;
+    if (ShadowBounds->Valid)
+    {
+        ShadowCacheInvalidateBounds(&DemoState->ShadowCache, ShadowBounds->WorldMin, ShadowBounds->WorldMax);
+    }
+    *ShadowBounds = TerrainChunkShadowBounds(BoundsMin, BoundsMax);
+    ShadowCacheInvalidateBounds(&DemoState->ShadowCache, ShadowBounds->WorldMin, ShadowBounds->WorldMax);
+}
+
+inline void ChunkBatchUpload(chunk_batch* Batch, upload_ring* UploadRing)
+{
+    if (!Batch->Dirty || Batch->NumJobs == 0)
+    {
+        return;
+    }
+
+    chunk_job* Jobs = UploadRingPushArray(UploadRing, Batch->JobBuffer.Buffer, chunk_job, Batch->NumJobs,
+                                          VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    Copy(Batch->Jobs, Jobs, sizeof(chunk_job)*Batch->NumJobs);
+
+    // NOTE: Every chunk gets GroupsPerChunk work groups stacked along z
+    workgroup_shape* DensityShape = DemoState->WorkgroupTuner.Shapes + WorkgroupKernel_GenerateDensity;
+    workgroup_shape* TriangleShape = DemoState->WorkgroupTuner.Shapes + WorkgroupKernel_GenerateTriangles;
+    workgroup_shape* DensityFp16Shape = DemoState->WorkgroupTuner.Shapes + WorkgroupKernel_GenerateDensityFp16;
+    workgroup_shape* TriangleFp16Shape = DemoState->WorkgroupTuner.Shapes + WorkgroupKernel_GenerateTrianglesFp16;
+    u32 BrickGroups = TERRAIN_CHUNK_RES / DENSITY_BRICK_RES;
+    u32 FusedGroups = TERRAIN_CHUNK_RES / TERRAIN_FUSED_TILE_RES;
+    VkDispatchIndirectCommand* Args = UploadRingPushArray(UploadRing, Batch->DispatchArgs.Buffer, VkDispatchIndirectCommand, 6,
+                                                          VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+    Args[0] = { WorkgroupCount(TERRAIN_CHUNK_SLOT_DIM, DensityShape->SizeX), WorkgroupCount(TERRAIN_CHUNK_SLOT_DIM, DensityShape->SizeY),
+                WorkgroupCount(TERRAIN_CHUNK_SLOT_DIM, DensityShape->SizeZ)*Batch->NumJobs };
+    Args[1] = { WorkgroupCount(TERRAIN_CHUNK_RES, TriangleShape->SizeX), WorkgroupCount(TERRAIN_CHUNK_RES, TriangleShape->SizeY),
+                WorkgroupCount(TERRAIN_CHUNK_RES, TriangleShape->SizeZ)*Batch->NumJobs };
+    Args[2] = { BrickGroups, BrickGroups, BrickGroups*Batch->NumJobs };
+    Args[3] = { FusedGroups, FusedGroups, FusedGroups*Batch->NumJobs };
+    Args[4] = { WorkgroupCount(TERRAIN_CHUNK_SLOT_DIM, DensityFp16Shape->SizeX), WorkgroupCount(TERRAIN_CHUNK_SLOT_DIM, DensityFp16Shape->SizeY),
+                WorkgroupCount(TERRAIN_CHUNK_SLOT_DIM, DensityFp16Shape->SizeZ)*Batch->NumJobs };
+    Args[5] = { WorkgroupCount(TERRAIN_CHUNK_RES, TriangleFp16Shape->SizeX), WorkgroupCount(TERRAIN_CHUNK_RES, TriangleFp16Shape->SizeY),
+                WorkgroupCount(TERRAIN_CHUNK_RES, TriangleFp16Shape->SizeZ)*Batch->NumJobs };
+
+    Batch->Dirty = false;
+}
+
+/*
+  NOTE: FUSED_GENERATE has no barrier between the groups of a chunk to reset its draw args behind, so they get uploaded before the
+        dispatch instead. Jobs for consecutive slots share one copy region
+ */
+inline void ChunkBatchDrawArgsReset(chunk_batch* Batch, upload_ring* UploadRing)
+{
+    u32 JobId = 0;
+    while (JobId < Batch->NumJobs)
+    {
+        u32 FirstSlot = Batch->Jobs[JobId].Slot;
+        u32 NumSlots = 1;
+        while (JobId + NumSlots < Batch->NumJobs && Batch->Jobs[JobId + NumSlots].Slot == FirstSlot + NumSlots)
+        {
+            NumSlots += 1;
+        }
+
+        indirect_args* Args = (indirect_args*)UploadRingPushBuffer(UploadRing, DemoState->ChunkDrawArgs.Buffer, sizeof(indirect_args)*FirstSlot,
+                                                                   sizeof(indirect_args)*NumSlots,
+                                                                   VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                                                   VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        for (u32 SlotId = 0; SlotId < NumSlots; ++SlotId)
+        {
+            Args[SlotId] = {};
+            Args[SlotId].NumInstances = 1;
+            Args[SlotId].StartVertexIndex = (FirstSlot + SlotId)*TERRAIN_CHUNK_MAX_VERTICES;
+        }
+
+        JobId += NumSlots;
+    }
+}
+
+inline void ChunkBatchBindPipeline(vk_commands* Commands, vk_pipeline* Pipeline, chunk_push_constants* PushConstants)
+{
+    vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Handle);
+    vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Layout, 0, 1, &DemoState->TerrainDescriptor, 0, 0);
+    vkCmdPushConstants(Commands->Buffer, Pipeline->Layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(*PushConstants), PushConstants);
+}
+
+inline void ChunkBatchDensityBarrier(vk_commands* Commands)
+{
+    VkBarrierBufferAdd(Commands, DemoState->ChunkDrawArgs.Buffer,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkBarrierImageAdd(Commands, DemoState->TerrainDensity.Image, VK_IMAGE_ASPECT_COLOR_BIT,
+                      VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                      VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL);
+    VkCommandsBarrierFlush(Commands);
+}
+
+/*
+  NOTE: Fused generation only writes the atlas when something reads it afterwards, there is no editing so that is the far field and
+        the chunk cache bake. The workgroup tuner times the two unfused kernels so its sweep stays on the batched path, surface nets
+        only exist unfused too
+ */
+inline chunk_generate_path ChunkGeneratePathSelect(b32 Fused)
+{
+    chunk_generate_path Result = ChunkGeneratePath_Batched;
+    if (Fused && !DemoState->WorkgroupTuner.Running && DemoState->Mesher == TerrainMesher_Transvoxel)
+    {
+        b32 KeepDensity = DemoState->FarField.Enabled || DemoState->ChunkBake.Stage != ChunkBakeStage_None;
+        Result = KeepDensity ? ChunkGeneratePath_FusedKeepDensity : ChunkGeneratePath_Fused;
+    }
+
+    return Result;
+}
+
+/*
+  NOTE: Residency follows the scheduler once per frame. Generation writes straight into the slot so the GPU path goes queued ->
+        generating -> uploaded, generating lasts until the next frame when the fence of the frame that issued it has passed. Meshed
+        is for chunks the job queue put in staging memory (archive loads, see ChunkCacheLoadJobCallback), the init upload flushes
+        them before the first frame
+ */
+inline void TerrainResidencySync()
+{
+    chunk_residency* Residency = &DemoState->ChunkResidency;
+    chunk_scheduler* Scheduler = &DemoState->ChunkScheduler;
+    ChunkResidencyEpochEnter(Residency, 0);
+    for (u32 Slot = 0; Slot < DemoState->NumChunkSlots; ++Slot)
+    {
+        u32 EntryId = DemoState->SlotResidency[Slot];
+        u32 ResidentSlot;
+        chunk_residency_state State = ChunkResidencyGetState(Residency, EntryId, &ResidentSlot);
+        if (Scheduler->SlotPending[Slot])
+        {
+            if (State != ChunkResidencyState_Queued && State != ChunkResidencyState_Free)
+            {
+                ChunkResidencyTransition(Residency, 0, EntryId, State, ChunkResidencyState_Queued);
+            }
+        }
+        else if (State == ChunkResidencyState_Queued)
+        {
+            ChunkResidencyTransition(Residency, 0, EntryId, State, ChunkResidencyState_Generating);
+        }
+        else if (State == ChunkResidencyState_Generating || State == ChunkResidencyState_Meshed)
+        {
+            ChunkResidencyTransition(Residency, 0, EntryId, State, ChunkResidencyState_Uploaded);
+        }
+    }
+    ChunkResidencyEpochExit(Residency, 0);
+    ChunkResidencyReclaim(Residency, 0);
+}
+
+// NOTE: Grid chunks of a region that still shows its preview chunk stay hidden and the other way around
+inline b32 TerrainSlotDrawn(u32 Slot)
+{
+    terrain_preview* Preview = &DemoState->Preview;
+    b32 Result = (Slot < DemoState->NumChunkSlots ? TerrainPreviewSlotDrawn(Preview, Slot) :
+                  !Preview->RegionRefined[Slot - Preview->FirstSlot]);
+    Result = Result && DemoState->DensityPyramid.SlotSurface[Slot];
+    return Result;
+}
+
+inline void TerrainPreviewUpdate()
+{
+    terrain_preview* Preview = &DemoState->Preview;
+    u32 NumRefined = Preview->NumRefined;
+    TerrainPreviewRefine(Preview, DemoState->ChunkScheduler.SlotPending);
+    if (Preview->NumRefined == NumRefined)
+    {
+        return;
+    }
+
+    // NOTE: Shadow tiles over a region that just switched still hold its preview chunk, invalid bounds also keep it out of the
+    // shadow draws from now on
+    for (u32 Region = 0; Region < Preview->NumRegions; ++Region)
+    {
+        chunk_shadow_bounds* Bounds = DemoState->SlotShadowBounds + Preview->FirstSlot + Region;
+        if (Preview->RegionRefined[Region] && Bounds->Valid)
+        {
+            ShadowCacheInvalidateBounds(&DemoState->ShadowCache, Bounds->WorldMin, Bounds->WorldMax);
+            Bounds->Valid = false;
+        }
+    }
+}
+
+// NOTE: Known empty chunks never get a job, their slot only needs the constant fill
+inline b32 TerrainChunkClassSkip(u32 Slot)
+{
+    chunk_class_cache* Classes = &DemoState->ChunkClasses;
+    b32 Result = ChunkClassEmpty(Classes->SlotClass[Slot]);
+    if (Result)
+    {
+        Classes->FillSlots[Classes->NumFillSlots++] = Slot;
+        Classes->NumSkipped += 1;
+    }
+
+    return Result;
+}
+
+/*
+  NOTE: Fills the batch with this frames jobs and returns false if there is nothing to generate. A full regeneration keeps the batch
+        when it already covers the same slots, rebuilding it would invalidate every shadow tile each frame. Classes only ever go from
+        unknown to empty so with SkipEmpty the job count changes whenever the slots do. With progressive startup the first frame only
+        generates the preview chunks
+ */
+inline b32 TerrainChunkSchedule(b32 FullRegenerate, b32 SkipEmpty, terrain_mesher Mesher, b32 Fp16)
+{
+    chunk_scheduler* Scheduler = &DemoState->ChunkScheduler;
+    chunk_batch* Batch = &DemoState->ChunkBatch;
+    terrain_preview* Preview = &DemoState->Preview;
+    b32 Result = false;
+    if (FullRegenerate)
+    {
+        if (!Preview->Generated)
+        {
+            TerrainPreviewSkip(Preview);
+        }
+
+        u32 NumJobs = 0;
+        for (u32 Slot = 0; Slot < DemoState->NumChunkSlots; ++Slot)
+        {
+            NumJobs += SkipEmpty && TerrainChunkClassSkip(Slot) ? 0 : 1;
+        }
+        
+        if (Batch->NumJobs != NumJobs)
+        {
+            ChunkBatchClear(Batch);
+            for (u32 Slot = 0; Slot < DemoState->NumChunkSlots; ++Slot)
+            {
+                if (!SkipEmpty || !ChunkClassEmpty(DemoState->ChunkClasses.SlotClass[Slot]))
+                {
+                    ChunkBatchAdd(Batch, TerrainChunkSlotKey(Slot), Slot);
+                }
+            }
+        }
+        ChunkSchedulerReadyAll(Scheduler);
+        Scheduler->NumIssued = Batch->NumJobs;
+        Result = Batch->NumJobs > 0;
+    }
+    else if (Preview->Enabled && !Preview->Generated)
+    {
+        ChunkBatchClear(Batch);
+        for (u32 Region = 0; Region < Preview->NumRegions; ++Region)
+        {
+            ChunkBatchAdd(Batch, TerrainPreviewRegionKey(Preview, Region), Preview->FirstSlot + Region);
+        }
+        Preview->Generated = true;
+        Scheduler->NumIssued = 0;
+        Result = true;
+    }
+    else
+    {
+        // NOTE: Ready slots hold meshes of another mesher or precision
+        if (Mesher != DemoState->ScheduledMesher || Fp16 != DemoState->ScheduledFp16)
+        {
+            ChunkSchedulerInvalidateAll(Scheduler);
+        }
+
+        for (u32 Slot = 0; Slot < DemoState->NumChunkSlots; ++Slot)
+        {
+            if (Scheduler->SlotPending[Slot] && TerrainChunkClassSkip(Slot))
+            {
+                ChunkSchedulerSlotReady(Scheduler, Slot);
+            }
+        }
+
+        m4 VPTransform = CameraGetVP(&DemoState->Camera);
+        ChunkSchedulerQueueBuild(Scheduler, VPTransform, DemoState->Camera.Pos, f32(DemoState->DynamicRes.Height));
+        u32 NumIssued = ChunkSchedulerIssue(Scheduler);
+        if (NumIssued > 0)
+        {
+            ChunkBatchClear(Batch);
+            for (u32 JobId = 0; JobId < NumIssued; ++JobId)
+            {
+                u32 Slot = Scheduler->IssuedSlots[JobId];
+                ChunkBatchAdd(Batch, TerrainChunkSlotKey(Slot), Slot);
+            }
+        }
+        Result = NumIssued > 0;
+    }
+
+    // NOTE: FP16 rounding could flip a sign right at 0, only fp32 results get classified. Preview chunks aren't grid chunks
+    if (Result && !Fp16)
+    {
+        for (u32 JobId = 0; JobId < Batch->NumJobs; ++JobId)
+        {
+            u32 Slot = Batch->Jobs[JobId].Slot;
+            if (Slot < DemoState->NumChunkSlots)
+            {
+                DemoState->ChunkClasses.SlotMeasure[Slot] = true;
+            }
+        }
+    }
+
+    DemoState->ScheduledMesher = Mesher;
+    DemoState->ScheduledFp16 = Fp16;
+    TerrainResidencySync();
+    TerrainPreviewUpdate();
+
+    return Result;
+}
+
+// NOTE: [0] = fp32, [1] = fp16
+global char* GlobalChunkGenerateTimers[2][4] =
+{
+    {
+        "generate_chunks_batched",
+        "generate_chunks_per_chunk",
+        "generate_chunks_fused",
+        "generate_chunks_fused_keep_density",
+    },
+    {
+        "generate_chunks_batched_fp16",
+        "generate_chunks_per_chunk_fp16",
+        "generate_chunks_fused_fp16",
+        "generate_chunks_fused_keep_density_fp16",
+    },
+};
+
+// NOTE: Only asks for fp16 when the device has the pipelines for it
+inline void ChunkBatchRecord(vk_commands* Commands, chunk_batch* Batch, chunk_generate_path Path, b32 Fp16, terrain_mesher Mesher)
+{
+    if (Batch->NumJobs == 0)
+    {
+        return;
+    }
+
+    chunk_push_constants PushConstants = {};
+    PushConstants.NumJobs = Batch->NumJobs;
+    
+    vk_pipeline* DensityPso = Fp16 ? DemoState->GenerateTerrainFp16Pso : DemoState->GenerateTerrainPso;
+    vk_pipeline* TrianglesPso = Fp16 ? DemoState->GenerateTrianglesFp16Pso : DemoState->GenerateTrianglesPso;
+    workgroup_kernel DensityKernel = Fp16 ? WorkgroupKernel_GenerateDensityFp16 : WorkgroupKernel_GenerateDensity;
+    workgroup_kernel TrianglesKernel = Fp16 ? WorkgroupKernel_GenerateTrianglesFp16 : WorkgroupKernel_GenerateTriangles;
+    u32 DensityArgs = Fp16 ? 4 : 0;
+    u32 TrianglesArgs = Fp16 ? 5 : 1;
+
+    u32 GenerateTimer = GpuTimerBegin(&DemoState->GpuTimestamps, Commands, GlobalChunkGenerateTimers[Fp16 ? 1 : 0][Path]);
+    if (Path == ChunkGeneratePath_Fused || Path == ChunkGeneratePath_FusedKeepDensity)
+    {
+        // NOTE: One dispatch, the draw args were reset by ChunkBatchDrawArgsReset and the groups write their own density bricks
+        b32 KeepDensity = Path == ChunkGeneratePath_FusedKeepDensity;
+        PushConstants.JobOffset = 0;
+        DensityPyramidWriteBarrier(&DemoState->DensityPyramid, Commands);
+        vk_pipeline* FusedPso = (Fp16 ? (KeepDensity ? DemoState->FusedGenerateKeepDensityFp16Pso : DemoState->FusedGenerateFp16Pso) :
+                                 (KeepDensity ? DemoState->FusedGenerateKeepDensityPso : DemoState->FusedGeneratePso));
+        ChunkBatchBindPipeline(Commands, FusedPso, &PushConstants);
+        vkCmdDispatchIndirect(Commands->Buffer, Batch->DispatchArgs.Buffer, 3*sizeof(VkDispatchIndirectCommand));
+
+        DensityPyramidReduceRecord(&DemoState->DensityPyramid, Commands, DemoState->DensityPyramidPso, DemoState->TerrainDescriptor,
+                                   &PushConstants, Batch->NumJobs);
+        if (KeepDensity)
+        {
+            VkBarrierImageAdd(Commands, DemoState->TerrainDensity.Image, VK_IMAGE_ASPECT_COLOR_BIT,
+                              VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                              VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_IMAGE_LAYOUT_GENERAL);
+        }
+    }
+    else if (Path == ChunkGeneratePath_PerChunk)
+    {
+        // NOTE: Reference path, one density + triangles dispatch per chunk with barriers in between
+        workgroup_shape* DensityShape = DemoState->WorkgroupTuner.Shapes + DensityKernel;
+        workgroup_shape* TriangleShape = DemoState->WorkgroupTuner.Shapes + TrianglesKernel;
+        for (u32 JobId = 0; JobId < Batch->NumJobs; ++JobId)
+        {
+            PushConstants.JobOffset = JobId;
+            ChunkBatchBindPipeline(Commands, DensityPso, &PushConstants);
+            vkCmdDispatch(Commands->Buffer, WorkgroupCount(TERRAIN_CHUNK_SLOT_DIM, DensityShape->SizeX),
+                          WorkgroupCount(TERRAIN_CHUNK_SLOT_DIM, DensityShape->SizeY), WorkgroupCount(TERRAIN_CHUNK_SLOT_DIM, DensityShape->SizeZ));
+            ChunkBatchDensityBarrier(Commands);
+            DensityPyramidBuildRecord(&DemoState->DensityPyramid, Commands, DemoState->DensityBricksPso, DemoState->DensityPyramidPso,
+                                      DemoState->TerrainDescriptor, &PushConstants, 1, VK_NULL_HANDLE, 0);
+            
+            if (Mesher == TerrainMesher_SurfaceNets)
+            {
+                u32 BrickGroups = TERRAIN_CHUNK_RES / DENSITY_BRICK_RES;
+                ChunkBatchBindPipeline(Commands, DemoState->SurfaceNetsPso, &PushConstants);
+                vkCmdDispatch(Commands->Buffer, BrickGroups, BrickGroups, BrickGroups);
+            }
+            else
+            {
+                ChunkBatchBindPipeline(Commands, TrianglesPso, &PushConstants);
+                vkCmdDispatch(Commands->Buffer, WorkgroupCount(TERRAIN_CHUNK_RES, TriangleShape->SizeX),
+                              WorkgroupCount(TERRAIN_CHUNK_RES, TriangleShape->SizeY), WorkgroupCount(TERRAIN_CHUNK_RES, TriangleShape->SizeZ));
+            }
+            VkBarrierImageAdd(Commands, DemoState->TerrainDensity.Image, VK_IMAGE_ASPECT_COLOR_BIT,
+                              VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                              VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL);
+            VkCommandsBarrierFlush(Commands);
+        }
+    }
+    else
+    {
+        // NOTE: All chunks in one indirect dispatch per kernel, each kernel gets its own timer for the workgroup tuner
+        PushConstants.JobOffset = 0;
+        u32 DensityTimer = GpuTimerBegin(&DemoState->GpuTimestamps, Commands, GlobalWorkgroupKernelTimers[DensityKernel]);
+        ChunkBatchBindPipeline(Commands, DensityPso, &PushConstants);
+        vkCmdDispatchIndirect(Commands->Buffer, Batch->DispatchArgs.Buffer, DensityArgs*sizeof(VkDispatchIndirectCommand));
+        GpuTimerEnd(&DemoState->GpuTimestamps, Commands, DensityTimer);
+        ChunkBatchDensityBarrier(Commands);
+
+        DensityPyramidBuildRecord(&DemoState->DensityPyramid, Commands, DemoState->DensityBricksPso, DemoState->DensityPyramidPso,
+                                  DemoState->TerrainDescriptor, &PushConstants, Batch->NumJobs, Batch->DispatchArgs.Buffer,
+                                  2*sizeof(VkDispatchIndirectCommand));
+
+        if (Mesher == TerrainMesher_SurfaceNets)
+        {
+            // NOTE: One group per density brick, same as the bricks dispatch
+            u32 SurfaceNetsTimer = GpuTimerBegin(&DemoState->GpuTimestamps, Commands, "generate_surface_nets");
+            ChunkBatchBindPipeline(Commands, DemoState->SurfaceNetsPso, &PushConstants);
+            vkCmdDispatchIndirect(Commands->Buffer, Batch->DispatchArgs.Buffer, 2*sizeof(VkDispatchIndirectCommand));
+            GpuTimerEnd(&DemoState->GpuTimestamps, Commands, SurfaceNetsTimer);
+        }
+        else
+        {
+            u32 TrianglesTimer = GpuTimerBegin(&DemoState->GpuTimestamps, Commands, GlobalWorkgroupKernelTimers[TrianglesKernel]);
+            ChunkBatchBindPipeline(Commands, TrianglesPso, &PushConstants);
+            vkCmdDispatchIndirect(Commands->Buffer, Batch->DispatchArgs.Buffer, TrianglesArgs*sizeof(VkDispatchIndirectCommand));
+            GpuTimerEnd(&DemoState->GpuTimestamps, Commands, TrianglesTimer);
+        }
+    }
+
+    VkBarrierBufferAdd(Commands, DemoState->ChunkDrawArgs.Buffer,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+    VkBarrierBufferAdd(Commands, DemoState->TerrainTriangles.Buffer,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+    VkCommandsBarrierFlush(Commands);
+    DensityPyramidReadbackRecord(&DemoState->DensityPyramid, Commands);
+    GpuTimerEnd(&DemoState->GpuTimestamps, Commands, GenerateTimer);
+}
+
+//
+// NOTE: Mesh Stats
+//
+
+global char* GlobalTerrainMesherNames[] =
+{
+    "transvoxel",
+    "surface_nets",
+};
+
+// NOTE: Copies the draw args ChunkBatchRecord just wrote, the vertex counts tell us how many triangles the mesher emitted
+inline void TerrainMeshStatsRecord(vk_commands* Commands, terrain_mesher Mesher)
+{
+    VkBarrierBufferAdd(Commands, DemoState->ChunkDrawArgs.Buffer,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    VkBufferCopy Region = {};
+    Region.size = sizeof(indirect_args)*DemoState->NumChunkSlots;
+    vkCmdCopyBuffer(Commands->Buffer, DemoState->ChunkDrawArgs.Buffer, DemoState->MeshStatsReadback.Buffer, 1, &Region);
+
+    // NOTE: Next frames generation overwrites the args so make it wait on our read
+    VkBarrierBufferAdd(Commands, DemoState->ChunkDrawArgs.Buffer,
+                       VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkBarrierBufferAdd(Commands, DemoState->MeshStatsReadback.Buffer,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    DemoState->MeshStatsPending = true;
+    DemoState->MeshStatsMesher = Mesher;
+}
+
+// NOTE: Called after VkCommandsBegin waited on last frames fence
+inline void TerrainMeshStatsRead()
+{
+    if (!DemoState->MeshStatsPending)
+    {
+        return;
+    }
+    DemoState->MeshStatsPending = false;
+
+    indirect_args* Args = (indirect_args*)DemoState->MeshStatsReadback.Allocation.Mapped;
+    u64 NumVertices = 0;
+    for (u32 Slot = 0; Slot < DemoState->NumChunkSlots; ++Slot)
+    {
+        u32 SlotVertices = Args[Slot].NumVerticesPerInstance;
+        SlotVertices = SlotVertices < TERRAIN_CHUNK_MAX_VERTICES ? SlotVertices : TERRAIN_CHUNK_MAX_VERTICES;
+        DemoState->SlotNumVertices[Slot] = SlotVertices;
+        NumVertices += SlotVertices;
+    }
+    DemoState->NumMeshTriangles = NumVertices / 3;
+}
+
+inline void TerrainMeshStatsPanel(ui_panel* Panel)
+{
+    char Text[256];
+    snprintf(Text, sizeof(Text), "Mesher: %s, %.2fM triangles", GlobalTerrainMesherNames[DemoState->MeshStatsMesher],
+             f64(DemoState->NumMeshTriangles) / 1000000.0);
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+}
+
+//
+// NOTE: Chunk Cache
+//
+
+inline gpu_buffer TerrainReadbackBufferCreate(u64 Size)
+{
+    // NOTE: We read the whole buffer on the CPU so prefer cached memory when the device exposes it
+    gpu_buffer Result = GpuBufferCreate(&DemoState->GpuAllocator, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                        (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+                                         VK_MEMORY_PROPERTY_HOST_CACHED_BIT),
+                                        Size, GpuMemoryCategory_Readback);
+    return Result;
+}
+
+inline void ChunkCacheLoadJobAdd(chunk_cache_load_job* Job, void* Src, void* Dst, u64 Size)
+{
+    Assert(Job->NumCopies < ArrayCount(Job->Src));
+    Job->Src[Job->NumCopies] = Src;
+    Job->Dst[Job->NumCopies] = Dst;
+    Job->Size[Job->NumCopies] = Size;
+    Job->NumCopies += 1;
+}
+
+// NOTE: Runs on the job queue, the chunk is meshed on the CPU as far as residency goes and TerrainResidencySync uploads it
+inline void ChunkCacheLoadJobCallback(void* Data, u32 ThreadId)
+{
+    chunk_cache_load_job* Job = (chunk_cache_load_job*)Data;
+    for (u32 CopyId = 0; CopyId < Job->NumCopies; ++CopyId)
+    {
+        Copy(Job->Src[CopyId], Job->Dst[CopyId], Job->Size[CopyId]);
+    }
+
+    chunk_residency* Residency = Job->Residency;
+    ChunkResidencyEpochEnter(Residency, ThreadId);
+    ChunkResidencyTransition(Residency, ThreadId, Job->EntryId, ChunkResidencyState_Queued, ChunkResidencyState_Meshed);
+    ChunkResidencyEpochExit(Residency, ThreadId);
+}
+
+inline b32 TerrainChunkCacheLoad(upload_ring* UploadRing)
+{
+    chunk_archive* Archive = &DemoState->ChunkArchive;
+    if (!ChunkArchiveOpen(CHUNK_ARCHIVE_FILE_NAME, Archive))
+    {
+        return false;
+    }
+
+    // NOTE: Only use the archive if it was baked from the terrain we would otherwise generate
+    chunk_archive_header* Header = Archive->Header;
+    b32 Matches = (Header->NumChunks == DemoState->NumChunkSlots &&
+                   Header->TerrainPos.x == DemoState->TerrainPos.x &&
+                   Header->TerrainPos.y == DemoState->TerrainPos.y &&
+                   Header->TerrainPos.z == DemoState->TerrainPos.z &&
+                   Header->TerrainRadius.x == DemoState->TerrainRadius.x &&
+                   Header->TerrainRadius.y == DemoState->TerrainRadius.y &&
+                   Header->TerrainRadius.z == DemoState->TerrainRadius.z);
+
+    u64 TotalVertices = 0;
+    u64 TotalIndices = 0;
+    for (u32 Slot = 0; Matches && Slot < DemoState->NumChunkSlots; ++Slot)
+    {
+        chunk_archive_entry* Entry = ChunkArchiveFind(Archive, TerrainChunkSlotKey(Slot));
+        Matches = (Entry &&
+                   Entry->DensityResX == TERRAIN_CHUNK_SLOT_DIM &&
+                   Entry->DensityResY == TERRAIN_CHUNK_SLOT_DIM &&
+                   Entry->DensityResZ == TERRAIN_CHUNK_SLOT_DIM);
+        if (Matches)
+        {
+            TotalVertices += Entry->NumVertices;
+            TotalIndices += Entry->NumIndices + Entry->NumLodIndices;
+        }
+    }
+    
+    if (!Matches)
+    {
+        ChunkArchiveClose(Archive);
+        return false;
+    }
+
+    // NOTE: A terrain without any surface is still a valid bake, the buffers just need a non zero size to bind
+    TotalVertices = TotalVertices > 0 ? TotalVertices : 1;
+    TotalIndices = TotalIndices > 0 ? TotalIndices : 1;
+    DemoState->CachedVertices = GpuBufferCreate(&DemoState->GpuAllocator, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(v4)*TotalVertices,
+                                                GpuMemoryCategory_ChunkCache);
+    DemoState->CachedIndices = GpuBufferCreate(&DemoState->GpuAllocator, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(u32)*TotalIndices,
+                                               GpuMemoryCategory_ChunkCache);
+
+    /*
+      NOTE: Every blob goes straight from the mapped file into the staging memory, no intermediate copies. The staging space is
+            reserved here in order, the copies run on the job queue one chunk per job
+     */
+    chunk_cache_load_job* Jobs = PushArray(&DemoState->TempArena, chunk_cache_load_job, DemoState->NumChunkSlots);
+    u32 VertexOffset = 0;
+    u32 IndexOffset = 0;
+    DemoState->NumCachedChunks = 0;
+    for (u32 Slot = 0; Slot < DemoState->NumChunkSlots; ++Slot)
+    {
+        chunk_archive_entry* Entry = ChunkArchiveFind(Archive, TerrainChunkSlotKey(Slot));
+        chunk_cache_load_job* Job = Jobs + Slot;
+        *Job = {};
+        Job->Residency = &DemoState->ChunkResidency;
+        Job->EntryId = DemoState->SlotResidency[Slot];
+
+        {
+            u32 AtlasX, AtlasY, AtlasZ;
+            TerrainChunkSlotAtlasOffset(Slot, &AtlasX, &AtlasY, &AtlasZ);
+            u16* GpuPtr = (u16*)UploadRingPushImage(UploadRing, DemoState->TerrainDensity.Image, AtlasX, AtlasY, AtlasZ, Entry->DensityResX,
+                                                    Entry->DensityResY, Entry->DensityResZ, sizeof(u16), VK_IMAGE_ASPECT_COLOR_BIT,
+                                                    Slot == 0 ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                                                    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            ChunkCacheLoadJobAdd(Job, ChunkArchiveGetBlob(Archive, Entry->DensityOffset), GpuPtr, Entry->DensitySize);
+        }
+        
+        if (Entry->NumIndices == 0)
+        {
+            continue;
+        }
+        
+        {
+            v4* GpuPtr = (v4*)UploadRingPushBuffer(UploadRing, DemoState->CachedVertices.Buffer, sizeof(v4)*VertexOffset,
+                                                   sizeof(v4)*Entry->NumVertices, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+                                                   VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+            ChunkCacheLoadJobAdd(Job, ChunkArchiveGetBlob(Archive, Entry->VertexOffset), GpuPtr, sizeof(v4)*Entry->NumVertices);
+        }
+
+        {
+            u32* GpuPtr = (u32*)UploadRingPushBuffer(UploadRing, DemoState->CachedIndices.Buffer, sizeof(u32)*IndexOffset,
+                                                     sizeof(u32)*Entry->NumIndices, VK_ACCESS_INDEX_READ_BIT,
+                                                     VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+            ChunkCacheLoadJobAdd(Job, ChunkArchiveGetBlob(Archive, Entry->IndexOffset), GpuPtr, sizeof(u32)*Entry->NumIndices);
+        }
+
+        cached_chunk_draw* Draw = DemoState->CachedChunks + DemoState->NumCachedChunks++;
+        Draw->FirstIndex = IndexOffset;
+        Draw->NumIndices = Entry->NumIndices;
+        Draw->NumVertices = Entry->NumVertices;
+        Draw->VertexOffset = i32(VertexOffset);
+        IndexOffset += Entry->NumIndices;
+
+        // NOTE: The LOD indexes into the same vertices, chunks without one just draw the full mesh at any distance
+        Draw->FirstLodIndex = Draw->FirstIndex;
+        Draw->NumLodIndices = Draw->NumIndices;
+        if (Entry->NumLodIndices > 0)
+        {
+            u32* GpuPtr = (u32*)UploadRingPushBuffer(UploadRing, DemoState->CachedIndices.Buffer, sizeof(u32)*IndexOffset,
+                                                     sizeof(u32)*Entry->NumLodIndices, VK_ACCESS_INDEX_READ_BIT,
+                                                     VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+            ChunkCacheLoadJobAdd(Job, ChunkArchiveGetBlob(Archive, Entry->LodIndexOffset), GpuPtr, sizeof(u32)*Entry->NumLodIndices);
+
+            Draw->FirstLodIndex = IndexOffset;
+            Draw->NumLodIndices = Entry->NumLodIndices;
+            IndexOffset += Entry->NumLodIndices;
+        }
+
+        v3 BoundsMin, BoundsMax;
+        TerrainChunkBounds(Entry->Key, &BoundsMin, &BoundsMax);
+        Draw->Center = 0.5f*(BoundsMin + BoundsMax);
+        Draw->ShadowBounds = TerrainChunkShadowBounds(BoundsMin, BoundsMax);
+        VertexOffset += Entry->NumVertices;
+    }
+
+    for (u32 Slot = 0; Slot < DemoState->NumChunkSlots; ++Slot)
+    {
+        JobQueueAdd(&DemoState->JobQueue, ChunkCacheLoadJobCallback, Jobs + Slot);
+    }
+    JobQueueCompleteAll(&DemoState->JobQueue);
+
+    return true;
+}
+
+/*
+  NOTE: The cached path ends once the init upload is on the GPU, so this is called after the first frame waited on the fence of the
+        init submission. Covers the archive reads, the staging copies and the GPU copies, comparable to a full cold generation
+        (the rest of the init uploads share that batch and are included too)
+ */
+inline void TerrainChunkCacheLoadFinish()
+{
+    if (DemoState->ChunkCacheLoadStart != 0)
+    {
+        BenchmarkRecord(&DemoState->Benchmark, "chunk_cache_load_end_to_end_ms", DemoTimerElapsedMs(DemoState->ChunkCacheLoadStart), "ms");
+        DemoState->ChunkCacheLoadStart = 0;
+    }
+}
+
+inline void TerrainChunkBakeRecord(vk_commands* Commands)
+{
+    // NOTE: The archive needs every slot, the scheduler can take a few frames to generate them all
+    chunk_bake_state* Bake = &DemoState->ChunkBake;
+    if (Bake->Stage == ChunkBakeStage_None || Bake->CopyRecorded || !ChunkSchedulerAllReady(&DemoState->ChunkScheduler))
+    {
+        return;
+    }
+
+    if (Bake->Stage == ChunkBakeStage_ReadbackCount)
+    {
+        Bake->Readback = TerrainReadbackBufferCreate(sizeof(indirect_args)*Bake->NumChunks);
+    }
+
+    VkBarrierBufferAdd(Commands, DemoState->ChunkDrawArgs.Buffer,
+                       VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                       VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkBarrierBufferAdd(Commands, DemoState->TerrainTriangles.Buffer,
+                       VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                       VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkBarrierImageAdd(Commands, DemoState->TerrainDensity.Image, VK_IMAGE_ASPECT_COLOR_BIT,
+                      VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                      VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_IMAGE_LAYOUT_GENERAL);
+    VkCommandsBarrierFlush(Commands);
+
+    if (Bake->Stage == ChunkBakeStage_ReadbackCount)
+    {
+        VkBufferCopy Region = {};
+        Region.size = sizeof(indirect_args)*Bake->NumChunks;
+        vkCmdCopyBuffer(Commands->Buffer, DemoState->ChunkDrawArgs.Buffer, Bake->Readback.Buffer, 1, &Region);
+    }
+    else if (Bake->Stage == ChunkBakeStage_ReadbackMesh)
+    {
+        // NOTE: One copy call for all the chunk meshes and one for all the density slots
+        if (Bake->NumMeshRegions > 0)
+        {
+            vkCmdCopyBuffer(Commands->Buffer, DemoState->TerrainTriangles.Buffer, Bake->Readback.Buffer, Bake->NumMeshRegions, Bake->MeshRegions);
+        }
+        vkCmdCopyImageToBuffer(Commands->Buffer, DemoState->TerrainDensity.Image, VK_IMAGE_LAYOUT_GENERAL, Bake->Readback.Buffer,
+                               Bake->NumChunks, Bake->DensityRegions);
+    }
+
+    // NOTE: Next frames generation overwrites these so make it wait on our reads
+    VkBarrierBufferAdd(Commands, DemoState->ChunkDrawArgs.Buffer,
+                       VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkBarrierBufferAdd(Commands, DemoState->TerrainTriangles.Buffer,
+                       VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkBarrierImageAdd(Commands, DemoState->TerrainDensity.Image, VK_IMAGE_ASPECT_COLOR_BIT,
+                      VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL);
+    VkCommandsBarrierFlush(Commands);
+
+    Bake->CopyRecorded = true;
+}
+
+inline void TerrainChunkBakeUpdate()
+{
+    // IMPORTANT: Called at the start of the frame, after the previous frames fence so the readback contents are valid
+    chunk_bake_state* Bake = &DemoState->ChunkBake;
+    if (!Bake->CopyRecorded)
+    {
+        return;
+    }
+    Bake->CopyRecorded = false;
+
+    switch (Bake->Stage)
+    {
+        case ChunkBakeStage_ReadbackCount:
+        {
+            // NOTE: Now that we know how many vertices every chunk generated, read back only those plus the density slots
+            indirect_args* Args = (indirect_args*)Bake->Readback.Allocation.Mapped;
+            u64 DensitySize = sizeof(u16)*TERRAIN_CHUNK_SLOT_DIM*TERRAIN_CHUNK_SLOT_DIM*TERRAIN_CHUNK_SLOT_DIM;
+            u64 CurrOffset = 0;
+            Bake->NumMeshRegions = 0;
+            for (u32 Slot = 0; Slot < Bake->NumChunks; ++Slot)
+            {
+                u32 NumVertices = Args[Slot].NumVerticesPerInstance;
+                Bake->NumVertices[Slot] = NumVertices < TERRAIN_CHUNK_MAX_VERTICES ? NumVertices : TERRAIN_CHUNK_MAX_VERTICES;
+
+                Bake->MeshOffsets[Slot] = CurrOffset;
+                if (Bake->NumVertices[Slot] > 0)
+                {
+                    VkBufferCopy* Region = Bake->MeshRegions + Bake->NumMeshRegions++;
+                    Region->srcOffset = sizeof(v4)*u64(Args[Slot].StartVertexIndex);
+                    Region->dstOffset = CurrOffset;
+                    Region->size = sizeof(v4)*u64(Bake->NumVertices[Slot]);
+                    CurrOffset += Region->size;
+                }
+
+                Bake->DensityOffsets[Slot] = CurrOffset;
+                VkBufferImageCopy* Region = Bake->DensityRegions + Slot;
+                *Region = {};
+                Region->bufferOffset = CurrOffset;
+                Region->imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                Region->imageSubresource.layerCount = 1;
+                u32 AtlasX, AtlasY, AtlasZ;
+                TerrainChunkSlotAtlasOffset(Slot, &AtlasX, &AtlasY, &AtlasZ);
+                Region->imageOffset = { i32(AtlasX), i32(AtlasY), i32(AtlasZ) };
+                Region->imageExtent = { TERRAIN_CHUNK_SLOT_DIM, TERRAIN_CHUNK_SLOT_DIM, TERRAIN_CHUNK_SLOT_DIM };
+                CurrOffset += DensitySize;
+            }
+            
+            GpuBufferDestroy(&DemoState->GpuAllocator, &Bake->Readback);
+            Bake->Readback = TerrainReadbackBufferCreate(CurrOffset);
+            Bake->Stage = ChunkBakeStage_ReadbackMesh;
+        } break;
+
+        case ChunkBakeStage_ReadbackMesh:
+        {
+            u64 StartTime = DemoTimerGet();
+            u8* Mapped = Bake->Readback.Allocation.Mapped;
+
+            // NOTE: Weld + cache optimize every chunk on the worker threads, the archive is written serially afterwards
+            chunk_mesh_job* Jobs = PushArray(&DemoState->TempArena, chunk_mesh_job, Bake->NumChunks);
+            for (u32 Slot = 0; Slot < Bake->NumChunks; ++Slot)
+            {
+                chunk_mesh_job* Job = Jobs + Slot;
+                *Job = {};
+                Job->SoupVertices = (v4*)(Mapped + Bake->MeshOffsets[Slot]);
+                Job->NumSoupVertices = Bake->NumVertices[Slot];
+                Job->Optimize = CHUNK_MESH_OPTIMIZE;
+                Job->Simplify = CHUNK_MESH_SIMPLIFY;
+                Job->CellSize = 2.0f / f32(DemoState->TerrainResX);
+                TerrainChunkBounds(TerrainChunkSlotKey(Slot), &Job->BoundsMin, &Job->BoundsMax);
+                JobQueueAdd(&DemoState->JobQueue, ChunkMeshJobCallback, Job);
+            }
+            JobQueueCompleteAll(&DemoState->JobQueue);
+            BenchmarkRecord(&DemoState->Benchmark, "chunk_bake_mesh_ms", DemoTimerElapsedMs(StartTime), "ms");
+
+            chunk_archive_writer Writer;
+            if (ChunkArchiveWriterBegin(&DemoState->TempArena, CHUNK_ARCHIVE_FILE_NAME, Bake->NumChunks, DemoState->TerrainPos,
+                                        DemoState->TerrainRadius, &Writer))
+            {
+                u64 TotalSoupVertices = 0;
+                u64 TotalWeldedVertices = 0;
+                chunk_mesh_cache_stats Before = {};
+                chunk_mesh_cache_stats After = {};
+                u64 TotalTriangles = 0;
+                u64 TotalLodTriangles = 0;
+                u32 NumSimplified = 0;
+                f64 TotalSimplifyMs = 0.0;
+                f32 MaxLodError = 0.0f;
+                for (u32 Slot = 0; Slot < Bake->NumChunks; ++Slot)
+                {
+                    chunk_mesh_job* Job = Jobs + Slot;
+                    u16* Density = (u16*)(Mapped + Bake->DensityOffsets[Slot]);
+                    ChunkArchiveWriteChunk(&Writer, TerrainChunkSlotKey(Slot), Job->Vertices, Job->NumVertices, Job->Indices, Job->NumIndices,
+                                           Job->LodIndices, Job->NumLodIndices, Job->LodError, Density, TERRAIN_CHUNK_SLOT_DIM,
+                                           TERRAIN_CHUNK_SLOT_DIM, TERRAIN_CHUNK_SLOT_DIM);
+
+                    if (Job->LodIndices)
+                    {
+                        TotalTriangles += Job->NumIndices / 3;
+                        TotalLodTriangles += Job->NumLodIndices / 3;
+                        NumSimplified += 1;
+                        TotalSimplifyMs += Job->SimplifyMs;
+                        MaxLodError = Job->LodError > MaxLodError ? Job->LodError : MaxLodError;
+                    }
+
+                    TotalSoupVertices += Job->NumSoupVertices;
+                    TotalWeldedVertices += Job->NumVertices;
+                    ChunkMeshCacheStatsAccumulate(&Before, Job->Before);
+                    ChunkMeshCacheStatsAccumulate(&After, Job->After);
+                }
+                ChunkArchiveWriterEnd(&Writer);
+
+                BenchmarkRecord(&DemoState->Benchmark, "chunk_bake_soup_vertices", f64(TotalSoupVertices), "vertices");
+                BenchmarkRecord(&DemoState->Benchmark, "chunk_bake_welded_vertices", f64(TotalWeldedVertices), "vertices");
+                BenchmarkRecord(&DemoState->Benchmark, "chunk_bake_acmr_before", Before.Acmr, "vertices/triangle");
+                BenchmarkRecord(&DemoState->Benchmark, "chunk_bake_acmr_after", After.Acmr, "vertices/triangle");
+                BenchmarkRecord(&DemoState->Benchmark, "chunk_bake_atvr_before", Before.Atvr, "ratio");
+                BenchmarkRecord(&DemoState->Benchmark, "chunk_bake_atvr_after", After.Atvr, "ratio");
+                if (NumSimplified > 0)
+                {
+                    f32 CellSize = 2.0f / f32(DemoState->TerrainResX);
+                    BenchmarkRecord(&DemoState->Benchmark, "chunk_simplify_triangle_reduction",
+                                    1.0 - f64(TotalLodTriangles) / f64(TotalTriangles), "ratio");
+                    BenchmarkRecord(&DemoState->Benchmark, "chunk_simplify_ms_per_chunk", TotalSimplifyMs / f64(NumSimplified), "ms");
+                    BenchmarkRecord(&DemoState->Benchmark, "chunk_simplify_hausdorff_cells", MaxLodError / CellSize, "cells");
+                }
+            }
+
+            for (u32 Slot = 0; Slot < Bake->NumChunks; ++Slot)
+            {
+                ChunkMeshJobFree(Jobs + Slot);
+            }
+
+            BenchmarkRecord(&DemoState->Benchmark, "chunk_bake_write_ms", DemoTimerElapsedMs(StartTime), "ms");
+            GpuBufferDestroy(&DemoState->GpuAllocator, &Bake->Readback);
+            Bake->Stage = ChunkBakeStage_None;
+        } break;
+
+        default:
+        {
+            InvalidCodePath;
+        } break;
+    }
+}
+
+//
+// NOTE: Forward Pass
+//
+
+// NOTE: Runs once per frame, the prepass and color pass both skip the chunks the far field trace covers
+inline void TerrainFarFieldCull()
+{
+    far_field* FarField = &DemoState->FarField;
+    FarFieldFrameBegin(FarField);
+    if (DemoState->TerrainFromCache)
+    {
+        for (u32 ChunkId = 0; ChunkId < DemoState->NumCachedChunks; ++ChunkId)
+        {
+            cached_chunk_draw* Draw = DemoState->CachedChunks + ChunkId;
+            u32 NumIndices = Draw->NumIndices + (Draw->FirstLodIndex != Draw->FirstIndex ? Draw->NumLodIndices : 0);
+            u64 MeshSize = sizeof(v4)*Draw->NumVertices + sizeof(u32)*NumIndices;
+            DemoState->ChunkFarCulled[ChunkId] = FarFieldChunkCulled(FarField, DemoState->Camera.Pos, Draw->ShadowBounds.WorldMin,
+                                                                     Draw->ShadowBounds.WorldMax, MeshSize);
+        }
+    }
+    else
+    {
+        // NOTE: Generated chunks use the vertex counts of the last mesh stats readback
+        for (u32 Slot = 0; Slot < DemoState->NumChunkSlots; ++Slot)
+        {
+            chunk_shadow_bounds* Bounds = DemoState->SlotShadowBounds + Slot;
+            DemoState->ChunkFarCulled[Slot] = (Bounds->Valid &&
+                                               FarFieldChunkCulled(FarField, DemoState->Camera.Pos, Bounds->WorldMin, Bounds->WorldMax,
+                                                                   sizeof(v4)*u64(DemoState->SlotNumVertices[Slot])));
+        }
+    }
+}
+
+inline void TerrainDrawChunks(vk_commands* Commands)
+{
+    VkDeviceSize Offset = 0;
+    if (DemoState->TerrainFromCache)
+    {
+        vkCmdBindVertexBuffers(Commands->Buffer, 0, 1, &DemoState->CachedVertices.Buffer, &Offset);
+        vkCmdBindIndexBuffer(Commands->Buffer, DemoState->CachedIndices.Buffer, 0, VK_INDEX_TYPE_UINT32);
+        for (u32 ChunkId = 0; ChunkId < DemoState->NumCachedChunks; ++ChunkId)
+        {
+            if (DemoState->ChunkFarCulled[ChunkId])
+            {
+                continue;
+            }
+            
+            cached_chunk_draw* Draw = DemoState->CachedChunks + ChunkId;
+            v3 WorldCenter = DemoState->TerrainPos + 2.0f*DemoState->TerrainRadius*Draw->Center;
+            if (Length(WorldCenter - DemoState->Camera.Pos) > TERRAIN_CHUNK_LOD_DISTANCE)
+            {
+                vkCmdDrawIndexed(Commands->Buffer, Draw->NumLodIndices, 1, Draw->FirstLodIndex, Draw->VertexOffset, 0);
+            }
+            else
+            {
+                vkCmdDrawIndexed(Commands->Buffer, Draw->NumIndices, 1, Draw->FirstIndex, Draw->VertexOffset, 0);
+            }
+        }
+    }
+    else
+    {
+        // NOTE: Every slot has its own draw args pointing into its vertex pool range. This is one vkCmdDrawIndirect per slot
+        // since drawCount > 1 needs the multiDrawIndirect feature which the framework doesn't enable
+        vkCmdBindVertexBuffers(Commands->Buffer, 0, 1, &DemoState->TerrainTriangles.Buffer, &Offset);
+        for (u32 Slot = 0; Slot < DemoState->NumAllocatedSlots; ++Slot)
+        {
+            b32 FarCulled = Slot < DemoState->NumChunkSlots && DemoState->ChunkFarCulled[Slot];
+            if (!FarCulled && TerrainSlotDrawn(Slot))
+            {
+                vkCmdDrawIndirect(Commands->Buffer, DemoState->ChunkDrawArgs.Buffer, sizeof(indirect_args)*Slot, 1, sizeof(indirect_args));
+            }
+        }
+    }
+}
+
+inline void FarFieldDrawRecord(vk_commands* Commands, u32 SceneUniformOffset)
+{
+    if (!DemoState->FarField.Enabled)
+    {
+        return;
+    }
+    
+    u32 FarFieldTimer = GpuTimerBegin(&DemoState->GpuTimestamps, Commands, "far_field");
+    vk_pipeline* Pipeline = DemoState->FarFieldPso;
+    vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline->Handle);
+    vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline->Layout, 0, 1, &DemoState->ForwardDescriptor, 1,
+                            &SceneUniformOffset);
+
+    far_field_constants Constants = FarFieldConstants(&DemoState->FarField, TerrainToWorld(V3(-1.0f)), TerrainToWorld(V3(1.0f)),
+                                                      DemoState->TerrainRadius, DemoState->NoiseDim);
+    Constants.NumChunksX = DemoState->ChunksX;
+    Constants.NumChunksY = DemoState->ChunksY;
+    Constants.NumChunksZ = DemoState->ChunksZ;
+    Constants.EmptySpaceSkip = true;
+    vkCmdPushConstants(Commands->Buffer, Pipeline->Layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(Constants),
+                       &Constants);
+    vkCmdDraw(Commands->Buffer, 3, 1, 0, 0);
+    GpuTimerEnd(&DemoState->GpuTimestamps, Commands, FarFieldTimer);
+}
+
+inline void OverdrawCountersClearRecord(vk_commands* Commands)
+{
+    // NOTE: The buffer only has counts for OVERDRAW_MAX_PIXELS, the shader skips anything past that
+    u32 NumPixels = DemoState->RenderWidth*DemoState->RenderHeight;
+    NumPixels = NumPixels < OVERDRAW_MAX_PIXELS ? NumPixels : OVERDRAW_MAX_PIXELS;
+    u64 Size = sizeof(u32)*(OVERDRAW_NUM_COUNTERS + u64(NumPixels));
+    VkBarrierBufferAdd(Commands, DemoState->OverdrawCounters.Buffer,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    vkCmdFillBuffer(Commands->Buffer, DemoState->OverdrawCounters.Buffer, 0, Size, 0);
+
+    VkBarrierBufferAdd(Commands, DemoState->OverdrawCounters.Buffer,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    VkCommandsBarrierFlush(Commands);
+}
+
+inline void OverdrawCountersReadbackRecord(vk_commands* Commands, b32 DepthPrepass)
+{
+    VkBarrierBufferAdd(Commands, DemoState->OverdrawCounters.Buffer,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                       VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    VkBufferCopy Region = {};
+    Region.size = sizeof(u32)*OVERDRAW_NUM_COUNTERS;
+    vkCmdCopyBuffer(Commands->Buffer, DemoState->OverdrawCounters.Buffer, DemoState->OverdrawReadback.Buffer, 1, &Region);
+
+    VkBarrierBufferAdd(Commands, DemoState->OverdrawReadback.Buffer,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    DemoState->OverdrawPending = true;
+    DemoState->OverdrawPendingPrepass = DepthPrepass;
+}
+
+// NOTE: Called after VkCommandsBegin waited on last frames fence, so last frames counters are in the readback buffer
+inline void OverdrawCountersRead()
+{
+    if (!DemoState->OverdrawPending)
+    {
+        return;
+    }
+    DemoState->OverdrawPending = false;
+
+    u32* Counters = (u32*)DemoState->OverdrawReadback.Allocation.Mapped;
+    overdraw_stats* Stats = DemoState->OverdrawPendingPrepass ? &DemoState->OverdrawPrepass : &DemoState->OverdrawSinglePass;
+    Stats->ShadedFragments = Counters[0];
+    Stats->CoveredPixels = Counters[1];
+    Stats->MaxFragmentsPerPixel = Counters[2];
+    Stats->FragmentsPerPixel = Stats->CoveredPixels > 0 ? f32(Stats->ShadedFragments) / f32(Stats->CoveredPixels) : 0.0f;
+}
+
+inline void OverdrawPanel(ui_panel* Panel)
+{
+    if (!DemoState->OverdrawDebug)
+    {
+        return;
+    }
+    
+    char Text[256];
+    overdraw_stats* Stats = DemoState->OverdrawPendingPrepass ? &DemoState->OverdrawPrepass : &DemoState->OverdrawSinglePass;
+    snprintf(Text, sizeof(Text), "Overdraw (%s): %.2f shaded fragments per covered pixel, max %u",
+             DemoState->OverdrawPendingPrepass ? "depth prepass" : "single pass", Stats->FragmentsPerPixel, Stats->MaxFragmentsPerPixel);
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+}
+
 //
 // NOTE: Demo Code
 //
 
+// NOTE: xorshift32, the noise only depends on TerrainSeed and not on how much else drew from rand() before it
+inline f32 TerrainNoiseRandom(u32* State)
+{
+    u32 X = *State;
+    X ^= X << 13;
+    X ^= X >> 17;
+    X ^= X << 5;
+    *State = X;
+    f32 Result = f32(X >> 8) / f32(1 << 24);
+    return Result;
+}
+
 inline void DemoAllocGlobals(linear_arena* Arena)
 {
     // IMPORTANT: These are always the top of the program memory
@@ -41,8 +1373,56 @@ inline void DemoAllocGlobals(linear_arena* Arena)
     RenderState = PushStruct(Arena, render_state);
 }
 
+/*
+  NOTE: Our worker threads run code from this DLL, so they have to be gone before the platform layer unloads it. The platform only
+        tells us about a reload after the fact (CodeReload), so a watcher thread blocks on change notifications for the directory the
+        DLL is loaded from and flags a new build, MainLoop stops the threads on the flag without touching the file system. CodeReload
+        starts them again with the new code. If the platform picks up the DLL before the flag was seen the reload still races the
+        threads, the window is the notification latency plus the rest of the frame
+ */
+inline void DemoCodeWatchThreadProc(void* Data)
+{
+    demo_state* State = (demo_state*)Data;
+
+    char FileName[256];
+    while (DemoDirWatchWait(&State->CodeWatch, FileName, sizeof(FileName)))
+    {
+        if (strcmp(FileName, DEMO_CODE_FILE_NAME) == 0)
+        {
+            State->CodeChanged = true;
+            DemoMemoryFence();
+            break;
+        }
+    }
+}
+
+// NOTE: The platform loads DEMO_CODE_FILE_NAME from the working directory
+inline void DemoCodeWatchStart(demo_state* State)
+{
+    State->CodeChanged = false;
+    if (!State->CodeWatchRunning && DemoDirWatchCreate(&State->CodeWatch, "."))
+    {
+        State->CodeWatchRunning = true;
+        DemoThreadCreate(&State->CodeWatchThread, DemoCodeWatchThreadProc, State);
+    }
+}
+
+inline void DemoCodeWatchStop(demo_state* State)
+{
+    if (State->CodeWatchRunning)
+    {
+        DemoDirWatchCancel(&State->CodeWatch, &State->CodeWatchThread);
+        DemoThreadJoin(&State->CodeWatchThread);
+        DemoDirWatchDestroy(&State->CodeWatch);
+        State->CodeWatchRunning = false;
+    }
+}
+
 DEMO_INIT(Init)
 {
+    // NOTE: Time to first frame counts from here
+    u64 InitStartTime = DemoTimerGet();
+
     // NOTE: Init Memory
     {
         linear_arena Arena = LinearArenaCreate(ProgramMemory, ProgramMemorySize);
@@ -51,6 +1431,12 @@ DEMO_INIT(Init)
         *RenderState = {};
         DemoState->Arena = Arena;
         DemoState->TempArena = LinearSubArena(&DemoState->Arena, MegaBytes(10));
+        BenchmarkBegin(&DemoState->Benchmark);
+
+        // NOTE: Keep one core for the main thread
+        u32 NumCores = DemoGetNumCores();
+        JobQueueCreate(&DemoState->JobQueue, NumCores > 1 ? NumCores - 1 : 1);
+        DemoCodeWatchStart(DemoState);
     }
 
     // NOTE: Init Vulkan
@@ -68,11 +1454,22 @@ DEMO_INIT(Init)
             //InitParams.PresentMode = VK_PRESENT_MODE_FIFO_KHR;
             InitParams.WindowWidth = WindowWidth;
             InitParams.WindowHeight = WindowHeight;
-            InitParams.GpuLocalSize = MegaBytes(3000);
+            // NOTE: Only the framework (UI etc) still uses the linear arena, our resources come from the GPU allocator
+            InitParams.GpuLocalSize = MegaBytes(64);
             InitParams.DeviceExtensionCount = ArrayCount(DeviceExtensions);
             InitParams.DeviceExtensions = DeviceExtensions;
             VkInit(VulkanLib, hInstance, WindowHandle, &DemoState->Arena, &DemoState->TempArena, InitParams);
         }
+
+        GpuAllocatorCreate(&DemoState->GpuAllocator, &DemoState->Arena, RenderState->Instance, RenderState->Device,
+                           RenderState->PhysicalDevice);
+        UploadRingCreate(&DemoState->UploadRing, &DemoState->GpuAllocator, UPLOAD_RING_SIZE);
+        DemoState->GpuTimestamps = GpuTimestampsCreate(RenderState->Device, RenderState->PhysicalDevice);
+        DemoPipelineCacheCreate(&DemoState->Pipelines, RenderState->Device, RenderState->PhysicalDevice, PIPELINE_CACHE_FILE_NAME);
+        WorkgroupTunerCreate(&DemoState->WorkgroupTuner, RenderState->PhysicalDevice, WORKGROUP_AUTOTUNE);
+        // IMPORTANT: render_init_params has no feature chain so shaderFloat16 is never enabled on our device, fp16 stays off until
+        // the framework can enable it
+        TerrainFp16Create(&DemoState->TerrainFp16, &DemoState->GpuAllocator, false, FP16_GENERATION);
     }
     
     // NOTE: Create samplers
@@ -103,7 +1500,13 @@ DEMO_INIT(Init)
 
         DemoState->CopyToSwapTarget = RenderTargetBuilderEnd(&Builder, VkRenderPassBuilderEnd(&RpBuilder, RenderState->Device));
         DemoState->CopyToSwapDesc = VkDescriptorSetAllocate(RenderState->Device, RenderState->DescriptorPool, RenderState->CopyImageDescLayout);
-        DemoState->CopyToSwapPipeline = FullScreenCopyImageCreate(DemoState->CopyToSwapTarget.RenderPass, 0);
+
+        pipeline_desc Desc = DemoPipelineDescGraphics(DemoState->CopyToSwapTarget.RenderPass, 0);
+        DemoPipelineDescShaderAdd(&Desc, "shader_copy_to_swap_vert.spv", "main", VK_SHADER_STAGE_VERTEX_BIT);
+        DemoPipelineDescShaderAdd(&Desc, "shader_copy_to_swap_frag.spv", "main", VK_SHADER_STAGE_FRAGMENT_BIT);
+        DemoPipelineDescLayoutAdd(&Desc, RenderState->CopyImageDescLayout);
+        DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(copy_to_swap_constants));
+        DemoState->CopyToSwapPipeline = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
     }
 
     // NOTE: Init camera
@@ -126,67 +1529,197 @@ DEMO_INIT(Init)
             VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
             VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
             VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, VK_SHADER_STAGE_COMPUTE_BIT);
+            VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+            VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, FAR_FIELD_NUM_LEVELS, VK_SHADER_STAGE_COMPUTE_BIT);
+            VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+            VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
             VkDescriptorLayoutEnd(RenderState->Device, &Builder);
         }
-
-        // NOTE: Create PSOs
-        VkDescriptorSetLayout Layouts[] =
+
+        // NOTE: Create PSOs
+        {
+            pipeline_desc Desc = DemoPipelineDescCompute("shader_generate_3d_terrain.spv", "main");
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->TerrainDescLayout);
+            DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(chunk_push_constants));
+            DemoState->GenerateTerrainPso = WorkgroupTunerPipelineAdd(&DemoState->WorkgroupTuner, &DemoState->Pipelines, &DemoState->Arena,
+                                                                      WorkgroupKernel_GenerateDensity, &Desc);
+        }
+        {
+            pipeline_desc Desc = DemoPipelineDescCompute("shader_generate_triangles.spv", "main");
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->TerrainDescLayout);
+            DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(chunk_push_constants));
+            DemoState->GenerateTrianglesPso = WorkgroupTunerPipelineAdd(&DemoState->WorkgroupTuner, &DemoState->Pipelines, &DemoState->Arena,
+                                                                        WorkgroupKernel_GenerateTriangles, &Desc);
+        }
+        {
+            pipeline_desc Desc = DemoPipelineDescCompute("shader_fused_generate.spv", "main");
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->TerrainDescLayout);
+            DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(chunk_push_constants));
+            DemoState->FusedGeneratePso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+
+            DemoPipelineDescSpecConstantAdd(&Desc, TERRAIN_FUSED_SPEC_WRITE_DENSITY, 1);
+            DemoState->FusedGenerateKeepDensityPso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+            DemoState->FusedGeneration = FUSED_GENERATION;
+        }
+        {
+            pipeline_desc Desc = DemoPipelineDescCompute("shader_generate_surface_nets.spv", "main");
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->TerrainDescLayout);
+            DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(chunk_push_constants));
+            DemoState->SurfaceNetsPso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+            DemoState->Mesher = SURFACE_NETS ? TerrainMesher_SurfaceNets : TerrainMesher_Transvoxel;
+        }
+
+        // NOTE: The fp16 modules don't even load without fp16 arithmetic, those devices keep null PSOs and run fp32
+        if (DemoState->TerrainFp16.Supported)
+        {
+            {
+                pipeline_desc Desc = DemoPipelineDescCompute("shader_generate_3d_terrain_fp16.spv", "main");
+                DemoPipelineDescLayoutAdd(&Desc, DemoState->TerrainDescLayout);
+                DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(chunk_push_constants));
+                DemoState->GenerateTerrainFp16Pso = WorkgroupTunerPipelineAdd(&DemoState->WorkgroupTuner, &DemoState->Pipelines, &DemoState->Arena,
+                                                                              WorkgroupKernel_GenerateDensityFp16, &Desc);
+            }
+            {
+                pipeline_desc Desc = DemoPipelineDescCompute("shader_generate_triangles_fp16.spv", "main");
+                DemoPipelineDescLayoutAdd(&Desc, DemoState->TerrainDescLayout);
+                DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(chunk_push_constants));
+                DemoState->GenerateTrianglesFp16Pso = WorkgroupTunerPipelineAdd(&DemoState->WorkgroupTuner, &DemoState->Pipelines, &DemoState->Arena,
+                                                                                WorkgroupKernel_GenerateTrianglesFp16, &Desc);
+            }
+            {
+                pipeline_desc Desc = DemoPipelineDescCompute("shader_fused_generate_fp16.spv", "main");
+                DemoPipelineDescLayoutAdd(&Desc, DemoState->TerrainDescLayout);
+                DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(chunk_push_constants));
+                DemoState->FusedGenerateFp16Pso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+
+                DemoPipelineDescSpecConstantAdd(&Desc, TERRAIN_FUSED_SPEC_WRITE_DENSITY, 1);
+                DemoState->FusedGenerateKeepDensityFp16Pso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+            }
+            {
+                pipeline_desc Desc = DemoPipelineDescCompute("shader_fp16_error_probe.spv", "main");
+                DemoPipelineDescLayoutAdd(&Desc, DemoState->TerrainDescLayout);
+                DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(chunk_push_constants));
+                DemoState->Fp16ErrorProbePso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+            }
+        }
+        {
+            pipeline_desc Desc = DemoPipelineDescCompute("shader_far_field_downsample.spv", "main");
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->TerrainDescLayout);
+            DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(far_field_build_constants));
+            DemoState->FarFieldDownsamplePso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+        }
+        {
+            pipeline_desc Desc = DemoPipelineDescCompute("shader_density_bricks.spv", "main");
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->TerrainDescLayout);
+            DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(chunk_push_constants));
+            DemoState->DensityBricksPso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+        }
         {
-            DemoState->TerrainDescLayout,
-        };
-        DemoState->GenerateTerrainPso = VkPipelineComputeCreate(RenderState->Device, &RenderState->PipelineManager, &DemoState->TempArena,
-                                                                "shader_generate_3d_terrain.spv", "main", Layouts, ArrayCount(Layouts));
-        DemoState->GenerateTrianglesPso = VkPipelineComputeCreate(RenderState->Device, &RenderState->PipelineManager, &DemoState->TempArena,
-                                                                  "shader_generate_triangles.spv", "main", Layouts, ArrayCount(Layouts));
+            pipeline_desc Desc = DemoPipelineDescCompute("shader_density_pyramid.spv", "main");
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->TerrainDescLayout);
+            DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(chunk_push_constants));
+            DemoState->DensityPyramidPso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+        }
 
         // NOTE: Create Resources
-        DemoState->TerrainResX = 256;
-        DemoState->TerrainResY = 256;
-        DemoState->TerrainResZ = 256;
+        DemoState->ChunksX = 8;
+        DemoState->ChunksY = 8;
+        DemoState->ChunksZ = 8;
+        DemoState->NumChunkSlots = DemoState->ChunksX*DemoState->ChunksY*DemoState->ChunksZ;
+        TerrainPreviewCreate(&DemoState->Preview, &DemoState->Arena, PROGRESSIVE_STARTUP, TERRAIN_PREVIEW_LOD, DemoState->ChunksX,
+                             DemoState->ChunksY, DemoState->ChunksZ, InitStartTime);
+        DemoState->NumAllocatedSlots = DemoState->NumChunkSlots + DemoState->Preview.NumRegions;
+        
+        // NOTE: The grid keeps slot i at chunk i of the atlas, the preview slots go into extra z layers after it
+        DemoState->AtlasSlotsX = DemoState->ChunksX;
+        DemoState->AtlasSlotsY = DemoState->ChunksY;
+        u32 AtlasSlotsPerLayer = DemoState->ChunksX*DemoState->ChunksY;
+        DemoState->AtlasSlotsZ = (DemoState->NumAllocatedSlots + AtlasSlotsPerLayer - 1) / AtlasSlotsPerLayer;
+        DemoState->TerrainResX = DemoState->ChunksX*TERRAIN_CHUNK_RES;
+        DemoState->TerrainResY = DemoState->ChunksY*TERRAIN_CHUNK_RES;
+        DemoState->TerrainResZ = DemoState->ChunksZ*TERRAIN_CHUNK_RES;
         DemoState->TerrainPos = V3(0);
         DemoState->TerrainRadius = V3(5.0f);
+        DemoState->SlotShadowBounds = PushArray(&DemoState->Arena, chunk_shadow_bounds, DemoState->NumAllocatedSlots);
+        for (u32 Slot = 0; Slot < DemoState->NumAllocatedSlots; ++Slot)
+        {
+            DemoState->SlotShadowBounds[Slot] = {};
+        }
         
-        DemoState->TerrainGlobals = VkBufferCreate(RenderState->Device, &RenderState->GpuArena,
-                                                   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                   sizeof(terrain_globals));
-        DemoState->TerrainDensity = VkImageCreate(RenderState->Device, &RenderState->GpuArena, DemoState->TerrainResX,
-                                                  DemoState->TerrainResY, DemoState->TerrainResZ, VK_FORMAT_R16_SFLOAT,
-                                                  VK_IMAGE_USAGE_STORAGE_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
-        DemoState->CellClasses = VkBufferCreate(RenderState->Device, &RenderState->GpuArena,
-                                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                sizeof(u32)*256);
-        DemoState->RegularCells = VkBufferCreate(RenderState->Device, &RenderState->GpuArena,
-                                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                 sizeof(regular_cell_data)*16);
-        DemoState->RegularCellVertices = VkBufferCreate(RenderState->Device, &RenderState->GpuArena,
-                                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                        sizeof(regular_cell_vertices)*256);
-        DemoState->IndirectArgBuffer = VkBufferCreate(RenderState->Device, &RenderState->GpuArena,
-                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                      sizeof(indirect_args));
-        DemoState->TerrainTriangles = VkBufferCreate(RenderState->Device, &RenderState->GpuArena,
-                                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                                                     //sizeof(v4)*15*DemoState->TerrainResX*DemoState->TerrainResY*DemoState->TerrainResZ);
-                                                     sizeof(v4)*5*DemoState->TerrainResX*DemoState->TerrainResY*DemoState->TerrainResZ);
+        gpu_allocator* GpuAllocator = &DemoState->GpuAllocator;
+        DemoState->TerrainGlobals = GpuBufferCreate(GpuAllocator, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(terrain_globals), GpuMemoryCategory_Uniforms);
+        // NOTE: Density atlas, every chunk slot stores its cells plus a 1 sample border on each side so chunks mesh independently
+        DemoState->TerrainDensity = GpuImageCreate(GpuAllocator, DemoState->AtlasSlotsX*TERRAIN_CHUNK_SLOT_DIM,
+                                                   DemoState->AtlasSlotsY*TERRAIN_CHUNK_SLOT_DIM, DemoState->AtlasSlotsZ*TERRAIN_CHUNK_SLOT_DIM,
+                                                   VK_FORMAT_R16_SFLOAT,
+                                                   VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                                   VK_IMAGE_ASPECT_COLOR_BIT, GpuMemoryCategory_Density);
+        DemoState->CellClasses = GpuBufferCreate(GpuAllocator, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(u32)*256, GpuMemoryCategory_Tables);
+        DemoState->RegularCells = GpuBufferCreate(GpuAllocator, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(regular_cell_data)*16, GpuMemoryCategory_Tables);
+        DemoState->RegularCellVertices = GpuBufferCreate(GpuAllocator, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(regular_cell_vertices)*256,
+                                                         GpuMemoryCategory_Tables);
+        DemoState->ChunkDrawArgs = GpuBufferCreate(GpuAllocator,
+                                                   (VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT),
+                                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(indirect_args)*DemoState->NumAllocatedSlots,
+                                                   GpuMemoryCategory_Terrain);
+        DemoState->MeshStatsReadback = TerrainReadbackBufferCreate(sizeof(indirect_args)*DemoState->NumChunkSlots);
+        DemoState->SlotNumVertices = PushArray(&DemoState->Arena, u32, DemoState->NumChunkSlots);
+        // NOTE: Vertex pool, every chunk slot owns a fixed TERRAIN_CHUNK_MAX_VERTICES range
+        DemoState->TerrainTriangles = GpuBufferCreate(GpuAllocator,
+                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                      sizeof(v4)*u64(TERRAIN_CHUNK_MAX_VERTICES)*DemoState->NumAllocatedSlots,
+                                                      GpuMemoryCategory_Terrain);
+        DemoState->ChunkBatch = ChunkBatchCreate(GpuAllocator, &DemoState->Arena, DemoState->NumAllocatedSlots);
+        ChunkSchedulerCreate(&DemoState->ChunkScheduler, &DemoState->Arena, DemoState->NumChunkSlots, CHUNK_SCHEDULER_BUDGET_MS);
+        ChunkResidencyCreate(&DemoState->ChunkResidency, &DemoState->Arena, DemoState->NumChunkSlots, DemoState->NumChunkSlots,
+                             DemoState->JobQueue.NumThreads + 1);
+        DemoState->SlotResidency = PushArray(&DemoState->Arena, u32, DemoState->NumChunkSlots);
+        DemoState->CachedChunks = PushArray(&DemoState->Arena, cached_chunk_draw, DemoState->NumChunkSlots);
+        DemoState->ChunkFarCulled = PushArray(&DemoState->Arena, b32, DemoState->NumChunkSlots);
+        FarFieldCreate(&DemoState->FarField, GpuAllocator, DemoState->TerrainResX, DemoState->TerrainResY, DemoState->TerrainResZ);
+        Assert(DENSITY_PYRAMID_CHUNK_RES == TERRAIN_CHUNK_RES);
+        DensityPyramidCreate(&DemoState->DensityPyramid, GpuAllocator, &DemoState->Arena, DemoState->NumAllocatedSlots);
+
+        {
+            chunk_bake_state* Bake = &DemoState->ChunkBake;
+            Bake->NumChunks = DemoState->NumChunkSlots;
+            Bake->NumVertices = PushArray(&DemoState->Arena, u32, Bake->NumChunks);
+            Bake->MeshOffsets = PushArray(&DemoState->Arena, u64, Bake->NumChunks);
+            Bake->DensityOffsets = PushArray(&DemoState->Arena, u64, Bake->NumChunks);
+            Bake->MeshRegions = PushArray(&DemoState->Arena, VkBufferCopy, Bake->NumChunks);
+            Bake->DensityRegions = PushArray(&DemoState->Arena, VkBufferImageCopy, Bake->NumChunks);
+        }
         
         DemoState->TerrainDescriptor = VkDescriptorSetAllocate(RenderState->Device, RenderState->DescriptorPool, DemoState->TerrainDescLayout);
-        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, DemoState->TerrainGlobals);
+        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, DemoState->TerrainGlobals.Buffer);
         VkDescriptorImageWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
                                DemoState->TerrainDensity.View, DemoState->PointSampler, VK_IMAGE_LAYOUT_GENERAL);
-        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->CellClasses);
-        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->RegularCells);
-        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->RegularCellVertices);
-        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->IndirectArgBuffer);
-        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->TerrainTriangles);
+        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->CellClasses.Buffer);
+        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->RegularCells.Buffer);
+        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->RegularCellVertices.Buffer);
+        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->ChunkDrawArgs.Buffer);
+        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->TerrainTriangles.Buffer);
+        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->ChunkBatch.JobBuffer.Buffer);
+        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 10, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->DensityPyramid.Nodes.Buffer);
+        VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 11, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DemoState->TerrainFp16.Errors.Buffer);
         
+        // NOTE: Seeded before anything draws from rand() (the lights), the noise has its own generator. The chunk class cache is
+        // keyed by this seed
+        DemoState->TerrainSeed = TERRAIN_SEED;
+        srand(DemoState->TerrainSeed);
         DemoState->NoiseDim = 16;
         DemoState->NoiseSampler = VkSamplerCreate(RenderState->Device, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK, 0.0f);
         for (u32 NoiseTextureId = 0; NoiseTextureId < ArrayCount(DemoState->NoiseTextures); ++NoiseTextureId)
         {
-            DemoState->NoiseTextures[NoiseTextureId] = VkImageCreate(RenderState->Device, &RenderState->GpuArena, DemoState->NoiseDim,
-                                                                     DemoState->NoiseDim, DemoState->NoiseDim, VK_FORMAT_R32_SFLOAT,
-                                                                     VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-                                                                     VK_IMAGE_ASPECT_COLOR_BIT);
+            DemoState->NoiseTextures[NoiseTextureId] = GpuImageCreate(GpuAllocator, DemoState->NoiseDim, DemoState->NoiseDim, DemoState->NoiseDim,
+                                                                      VK_FORMAT_R32_SFLOAT, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                                                      VK_IMAGE_ASPECT_COLOR_BIT, GpuMemoryCategory_Noise);
             VkDescriptorImageWrite(&RenderState->DescriptorManager, DemoState->TerrainDescriptor, 7, NoiseTextureId,
                                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, DemoState->NoiseTextures[NoiseTextureId].View,
                                    DemoState->NoiseSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
@@ -198,6 +1731,7 @@ DEMO_INIT(Init)
     {
         DemoState->RenderWidth = WindowWidth;
         DemoState->RenderHeight = WindowHeight;
+        DemoState->DynamicRes = DynamicResolutionCreate(WindowWidth, WindowHeight);
         DemoWindowResize(WindowWidth, WindowHeight);
 
         // NOTE: Create Forward Render Target
@@ -222,57 +1756,150 @@ DEMO_INIT(Init)
             DemoState->RenderTarget = RenderTargetBuilderEnd(&Builder, VkRenderPassBuilderEnd(&RpBuilder, RenderState->Device));
         }
 
+        // NOTE: Shadow Cache
+        {
+            // NOTE: Same direction the forward pass always lit with, cascades are in world units
+            f32 CascadeSizes[SHADOW_NUM_CASCADES] = { 6.0f, 16.0f, 48.0f };
+            v3 TerrainMin = TerrainToWorld(V3(-1.0f));
+            v3 TerrainMax = TerrainToWorld(V3(1.0f));
+            ShadowCacheCreate(&DemoState->ShadowCache, &DemoState->GpuAllocator, &DemoState->TempArena, V3(1, 1, 0), TerrainMin, TerrainMax,
+                              CascadeSizes);
+        }
+        
         // NOTE: Forward Descriptor Data
         {
             {
                 vk_descriptor_layout_builder Builder = VkDescriptorLayoutBegin(&DemoState->ForwardDescLayout);
-                VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+                VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1,
+                                      VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT);
+                VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT);
+                VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT);
+                VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT);
+                VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+                VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+                VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, FAR_FIELD_NUM_LEVELS, VK_SHADER_STAGE_FRAGMENT_BIT);
+                VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
                 VkDescriptorLayoutEnd(RenderState->Device, &Builder);
             }
             
-            DemoState->SceneUniforms = VkBufferCreate(RenderState->Device, &RenderState->GpuArena,
-                                                      VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                      sizeof(scene_globals));
+            // NOTE: Scene globals change every frame so they are written straight into mapped memory and bound with a dynamic offset
+            DemoState->SceneUniforms = UniformRingCreate(&DemoState->GpuAllocator, RenderState->PhysicalDevice, sizeof(scene_globals),
+                                                         UPLOAD_RING_FRAMES);
             
             DemoState->ForwardDescriptor = VkDescriptorSetAllocate(RenderState->Device, RenderState->DescriptorPool, DemoState->ForwardDescLayout);
-            VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->ForwardDescriptor, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, DemoState->SceneUniforms);
+            UniformRingDescriptorWrite(RenderState->Device, DemoState->ForwardDescriptor, 0, &DemoState->SceneUniforms);
+
+            DemoState->LightClusters = LightClustersCreate(&DemoState->GpuAllocator, DEMO_NUM_POINT_LIGHTS);
+            LightClustersDescriptorWrite(&RenderState->DescriptorManager, DemoState->ForwardDescriptor, 1, &DemoState->LightClusters);
+            VkDescriptorImageWrite(&RenderState->DescriptorManager, DemoState->ForwardDescriptor, 4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                   DemoState->ShadowCache.Atlas.View, DemoState->PointSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+            // NOTE: Sized for the largest resolution we support so window resizes don't have to touch it
+            DemoState->OverdrawCounters = GpuBufferCreate(&DemoState->GpuAllocator, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(u32)*(OVERDRAW_NUM_COUNTERS + OVERDRAW_MAX_PIXELS),
+                                                          GpuMemoryCategory_Debug);
+            DemoState->OverdrawReadback = TerrainReadbackBufferCreate(sizeof(u32)*OVERDRAW_NUM_COUNTERS);
+            VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->ForwardDescriptor, 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                    DemoState->OverdrawCounters.Buffer);
+            DemoState->DepthPrepass = DEPTH_PREPASS;
+            DemoState->OverdrawDebug = OVERDRAW_DEBUG;
+
+            FarFieldDescriptorWrite(&RenderState->DescriptorManager, &DemoState->FarField, DemoState->TerrainDescriptor, 9,
+                                    DemoState->ForwardDescriptor, 6, DemoState->LinearSampler);
+            VkDescriptorBufferWrite(&RenderState->DescriptorManager, DemoState->ForwardDescriptor, 7, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                    DemoState->DensityPyramid.Nodes.Buffer);
+        }
+        
+        // NOTE: Create Light Cluster PSO
+        {
+            pipeline_desc Desc = DemoPipelineDescCompute("shader_light_clusters.spv", "main");
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->ForwardDescLayout);
+            DemoState->LightClusterPso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+        }
+
+        // NOTE: Create Shadow Tile PSO, depth only
+        {
+            pipeline_desc Desc = DemoPipelineDescGraphics(DemoState->ShadowCache.RenderPass, 0);
+            DemoPipelineDescShaderAdd(&Desc, "shader_shadow_vert.spv", "main", VK_SHADER_STAGE_VERTEX_BIT);
+            DemoPipelineDescVertexAttributeAdd(&Desc, VK_FORMAT_R32G32B32A32_SFLOAT, sizeof(v4));
+            DemoPipelineDescDepthSet(&Desc, VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS);
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->ForwardDescLayout);
+            DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(shadow_tile_constants));
+            Desc.NumColorAttachments = 0;
+            DemoState->ShadowPso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
         }
         
         // NOTE: Create PSO
         {
-            vk_pipeline_builder Builder = VkPipelineBuilderBegin(&DemoState->TempArena);
+            pipeline_desc Desc = DemoPipelineDescGraphics(DemoState->RenderTarget.RenderPass, 0);
 
             // NOTE: Shaders
-            VkPipelineShaderAdd(&Builder, "shader_forward_vert.spv", "main", VK_SHADER_STAGE_VERTEX_BIT);
-            VkPipelineShaderAdd(&Builder, "shader_forward_frag.spv", "main", VK_SHADER_STAGE_FRAGMENT_BIT);
+            DemoPipelineDescShaderAdd(&Desc, "shader_forward_vert.spv", "main", VK_SHADER_STAGE_VERTEX_BIT);
+            DemoPipelineDescShaderAdd(&Desc, "shader_forward_frag.spv", "main", VK_SHADER_STAGE_FRAGMENT_BIT);
                 
             // NOTE: Specify input vertex data format
-            VkPipelineVertexBindingBegin(&Builder);
-            VkPipelineVertexAttributeAdd(&Builder, VK_FORMAT_R32G32B32A32_SFLOAT, sizeof(v4));
-            VkPipelineVertexBindingEnd(&Builder);
+            DemoPipelineDescVertexAttributeAdd(&Desc, VK_FORMAT_R32G32B32A32_SFLOAT, sizeof(v4));
 
-            VkPipelineInputAssemblyAdd(&Builder, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_FALSE);
-            VkPipelineDepthStateAdd(&Builder, VK_TRUE, VK_TRUE, VK_COMPARE_OP_GREATER);
-            VkPipelineMsaaStateSet(&Builder, VK_SAMPLE_COUNT_1_BIT, VK_FALSE);
+            Desc.Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            DemoPipelineDescDepthSet(&Desc, VK_TRUE, VK_TRUE, VK_COMPARE_OP_GREATER);
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->ForwardDescLayout);
             
-            // NOTE: Set the blending state
-            VkPipelineColorAttachmentAdd(&Builder, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO,
-                                         VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO);
+            DemoState->ForwardPipeline = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
 
-            VkDescriptorSetLayout DescriptorLayouts[] =
-                {
-                    DemoState->ForwardDescLayout,
-                };
-            
-            DemoState->ForwardPipeline = VkPipelineBuilderEnd(&Builder, RenderState->Device, &RenderState->PipelineManager,
-                                                              DemoState->RenderTarget.RenderPass, 0, DescriptorLayouts, ArrayCount(DescriptorLayouts));
+            // NOTE: Same shaders, the prepass already wrote the closest depth so we only shade fragments that match it
+            DemoPipelineDescDepthSet(&Desc, VK_TRUE, VK_FALSE, VK_COMPARE_OP_EQUAL);
+            DemoState->ForwardEqualPipeline = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+        }
+
+        // NOTE: Create Far Field PSO, full screen triangle that writes the depth of its hit
+        {
+            pipeline_desc Desc = DemoPipelineDescGraphics(DemoState->RenderTarget.RenderPass, 0);
+            DemoPipelineDescShaderAdd(&Desc, "shader_far_field_vert.spv", "main", VK_SHADER_STAGE_VERTEX_BIT);
+            DemoPipelineDescShaderAdd(&Desc, "shader_far_field_frag.spv", "main", VK_SHADER_STAGE_FRAGMENT_BIT);
+            DemoPipelineDescDepthSet(&Desc, VK_TRUE, VK_TRUE, VK_COMPARE_OP_GREATER);
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->ForwardDescLayout);
+            DemoPipelineDescPushConstantAdd(&Desc, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(far_field_constants));
+            DemoState->FarFieldPso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
+        }
+
+        // NOTE: Create Depth Prepass PSO, position only vertex fetch and no color writes
+        {
+            pipeline_desc Desc = DemoPipelineDescGraphics(DemoState->RenderTarget.RenderPass, 0);
+            DemoPipelineDescShaderAdd(&Desc, "shader_depth_prepass_vert.spv", "main", VK_SHADER_STAGE_VERTEX_BIT);
+
+            // NOTE: Only the packed position (xy) of each vertex is fetched, stride stays the full vertex
+            DemoPipelineDescVertexAttributeAdd(&Desc, VK_FORMAT_R32G32_SFLOAT, sizeof(v2));
+            Desc.VertexStride = sizeof(v4);
+
+            Desc.Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            Desc.ColorWriteMask = 0;
+            DemoPipelineDescDepthSet(&Desc, VK_TRUE, VK_TRUE, VK_COMPARE_OP_GREATER);
+            DemoPipelineDescLayoutAdd(&Desc, DemoState->ForwardDescLayout);
+            DemoState->DepthPrepassPso = DemoPipelineAdd(&DemoState->Pipelines, &DemoState->Arena, &Desc);
         }
     }
+
+    // NOTE: Compile all PSOs in parallel against the pipeline cache
+    {
+        u64 StartTime = DemoTimerGet();
+        DemoPipelinesBuild(&DemoState->Pipelines, &DemoState->JobQueue, &DemoState->TempArena);
+        DemoPipelineCacheSave(&DemoState->Pipelines, RenderState->Device, RenderState->PhysicalDevice, PIPELINE_CACHE_FILE_NAME);
+
+        BenchmarkRecord(&DemoState->Benchmark, "pipeline_creation_ms", DemoTimerElapsedMs(StartTime), "ms");
+        BenchmarkRecord(&DemoState->Benchmark, "pipeline_count", DemoState->Pipelines.NumEntries, "pipelines");
+        BenchmarkRecord(&DemoState->Benchmark, "pipeline_cache_warm", DemoState->Pipelines.CacheLoaded ? 1.0 : 0.0, "bool");
+        BenchmarkRecord(&DemoState->Benchmark, "pipeline_worker_threads", DemoState->JobQueue.NumThreads, "threads");
+
+#if SHADER_HOT_RELOAD
+        ShaderReloadStart(&DemoState->ShaderReload, &DemoState->Pipelines);
+#endif
+    }
     
     VkDescriptorManagerFlush(RenderState->Device, &RenderState->DescriptorManager);
 
     // NOTE: Upload assets
     vk_commands* Commands = &RenderState->Commands;
+    upload_ring* UploadRing = &DemoState->UploadRing;
     VkCommandsBegin(Commands, RenderState->Device);
     {
         // NOTE: Create UI
@@ -282,21 +1909,115 @@ DEMO_INIT(Init)
 
         // NOTE: Upload Terrain Globals
         {
-            terrain_globals* GpuPtr = VkCommandsPushWriteStruct(&RenderState->Commands, DemoState->TerrainGlobals, terrain_globals,
-                                                                BarrierMask(VkAccessFlagBits(0), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT),
-                                                                BarrierMask(VK_ACCESS_UNIFORM_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT));
+            terrain_globals* GpuPtr = UploadRingPushStruct(UploadRing, DemoState->TerrainGlobals.Buffer, terrain_globals,
+                                                           VK_ACCESS_UNIFORM_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
             
             *GpuPtr = {};
             GpuPtr->Center = DemoState->TerrainPos;
             GpuPtr->Radius = DemoState->TerrainRadius;
             GpuPtr->Resolution = V3(DemoState->TerrainResX, DemoState->TerrainResY, DemoState->TerrainResZ);
+            GpuPtr->ChunkRes = TERRAIN_CHUNK_RES;
+            GpuPtr->SlotDim = TERRAIN_CHUNK_SLOT_DIM;
+            GpuPtr->MaxVerticesPerChunk = TERRAIN_CHUNK_MAX_VERTICES;
+        }
+
+        // NOTE: Every chunk of the grid goes into one batch, slot i is chunk i. The scheduler replaces it with the slots it picks
+        // once we generate, until then no slot has geometry so their draw args start out empty
+        {
+            chunk_batch* Batch = &DemoState->ChunkBatch;
+            chunk_residency* Residency = &DemoState->ChunkResidency;
+            ChunkBatchClear(Batch);
+            ChunkResidencyEpochEnter(Residency, 0);
+            for (u32 Slot = 0; Slot < DemoState->NumChunkSlots; ++Slot)
+            {
+                chunk_key Key = TerrainChunkSlotKey(Slot);
+                ChunkBatchAdd(Batch, Key, Slot);
+
+                // NOTE: The free list hands out slots in order on one thread, so the grid keeps slot i = chunk i
+                u32 ResidentSlot;
+                ChunkResidencyRequest(Residency, 0, Key, DemoState->SlotResidency + Slot, &ResidentSlot);
+                Assert(ResidentSlot == Slot);
+
+                v3 BoundsMin, BoundsMax;
+                TerrainChunkBounds(Key, &BoundsMin, &BoundsMax);
+                ChunkSchedulerSlotBoundsSet(&DemoState->ChunkScheduler, Slot, TerrainToWorld(BoundsMin), TerrainToWorld(BoundsMax));
+                DemoState->Preview.SlotRegion[Slot] = TerrainPreviewRegion(&DemoState->Preview, Key);
+            }
+            ChunkResidencyEpochExit(Residency, 0);
+            ChunkBatchUpload(Batch, UploadRing);
+            ChunkBatchDrawArgsReset(Batch, UploadRing);
+            BenchmarkRecord(&DemoState->Benchmark, "chunk_jobs", Batch->NumJobs, "chunks");
+        }
+
+        // NOTE: Chunk classes, earlier runs measured some and the density bound proves the high and deep ones
+        {
+            chunk_class_cache* Classes = &DemoState->ChunkClasses;
+            u32 GeneratorHash = ChunkClassGeneratorHash(DemoState->TerrainResX, DemoState->TerrainResY, DemoState->TerrainResZ,
+                                                        DemoState->TerrainPos, DemoState->TerrainRadius, DemoState->NoiseDim);
+            ChunkClassCacheCreate(Classes, &DemoState->Arena, DemoState->NumChunkSlots, DemoState->TerrainSeed, GeneratorHash);
+            ChunkClassCacheLoad(Classes, CHUNK_CLASS_FILE_NAME);
+
+            // NOTE: The fills are the bound closest to 0 of each class, any value with the right sign would do
+            u32 NumAir = 0;
+            u32 NumSolid = 0;
+            for (u32 Slot = 0; Slot < DemoState->NumChunkSlots; ++Slot)
+            {
+                chunk_key Key = TerrainChunkSlotKey(Slot);
+                f32 Fill = 0.0f;
+                chunk_class Class = ChunkClassGet(Classes, Key, &Fill);
+                if (Class == ChunkClass_Unknown)
+                {
+                    Class = TerrainChunkClassFromBound(Key, &Fill);
+                    if (ChunkClassEmpty(Class))
+                    {
+                        ChunkClassAdd(Classes, Key, Class, Fill);
+                        Classes->NumProven += 1;
+                    }
+                }
+                Classes->SlotClass[Slot] = Class;
+
+                if (Class == ChunkClass_Air)
+                {
+                    Classes->AirFill = (NumAir == 0 || Fill > Classes->AirFill) ? Fill : Classes->AirFill;
+                    NumAir += 1;
+                }
+                else if (Class == ChunkClass_Solid)
+                {
+                    Classes->SolidFill = (NumSolid == 0 || Fill < Classes->SolidFill) ? Fill : Classes->SolidFill;
+                    NumSolid += 1;
+                }
+            }
+            Classes->AirFill = Classes->AirFill > -CHUNK_CLASS_MIN_FILL ? -CHUNK_CLASS_MIN_FILL : Classes->AirFill;
+            Classes->SolidFill = Classes->SolidFill < CHUNK_CLASS_MIN_FILL ? CHUNK_CLASS_MIN_FILL : Classes->SolidFill;
+
+            u32 NumFillTexels = TERRAIN_CHUNK_SLOT_DIM*TERRAIN_CHUNK_SLOT_DIM*TERRAIN_CHUNK_SLOT_DIM;
+            gpu_buffer* FillBuffers[] = { &DemoState->ChunkClassAirFill, &DemoState->ChunkClassSolidFill };
+            f32 FillDensities[] = { Classes->AirFill, Classes->SolidFill };
+            for (u32 ClassId = 0; ClassId < ArrayCount(FillBuffers); ++ClassId)
+            {
+                *FillBuffers[ClassId] = GpuBufferCreate(&DemoState->GpuAllocator,
+                                                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(u16)*NumFillTexels,
+                                                        GpuMemoryCategory_Density);
+                u16* GpuPtr = (u16*)UploadRingPushBuffer(UploadRing, FillBuffers[ClassId]->Buffer, 0, sizeof(u16)*NumFillTexels,
+                                                         VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+                u16 FillHalf = ChunkClassF16FromF32(FillDensities[ClassId]);
+                for (u32 TexelId = 0; TexelId < NumFillTexels; ++TexelId)
+                {
+                    GpuPtr[TexelId] = FillHalf;
+                }
+            }
+            DemoState->ChunkClassFillRegions = PushArray(&DemoState->Arena, VkBufferImageCopy, DemoState->NumChunkSlots);
+
+            BenchmarkRecord(&DemoState->Benchmark, "chunk_class_empty_chunks", NumAir + NumSolid, "chunks");
+            BenchmarkRecord(&DemoState->Benchmark, "chunk_class_proven_chunks", Classes->NumProven, "chunks");
+            BenchmarkRecord(&DemoState->Benchmark, "chunk_class_loaded_chunks", Classes->NumLoaded, "chunks");
         }
 
         // NOTE: Upload Cell Classes
         {
-            u32* GpuPtr = VkCommandsPushWriteArray(&RenderState->Commands, DemoState->CellClasses, u32, 256,
-                                                   BarrierMask(VkAccessFlagBits(0), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT),
-                                                   BarrierMask(VK_ACCESS_UNIFORM_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT));
+            u32* GpuPtr = UploadRingPushArray(UploadRing, DemoState->CellClasses.Buffer, u32, 256,
+                                              VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 
             for (u32 CellClassId = 0; CellClassId < 256; ++CellClassId)
             {
@@ -306,9 +2027,8 @@ DEMO_INIT(Init)
 
         // NOTE: Upload Regular Cells
         {
-            regular_cell_data* GpuPtr = VkCommandsPushWriteArray(&RenderState->Commands, DemoState->RegularCells, regular_cell_data, 16,
-                                                                 BarrierMask(VkAccessFlagBits(0), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT),
-                                                                 BarrierMask(VK_ACCESS_UNIFORM_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT));
+            regular_cell_data* GpuPtr = UploadRingPushArray(UploadRing, DemoState->RegularCells.Buffer, regular_cell_data, 16,
+                                                            VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 
             for (u32 RegularCellId = 0; RegularCellId < 16; ++RegularCellId)
             {
@@ -318,9 +2038,8 @@ DEMO_INIT(Init)
 
         // NOTE: Upload Regular Cell Vertices
         {
-            u32* GpuPtr = VkCommandsPushWriteArray(&RenderState->Commands, DemoState->RegularCellVertices, u32, 256*12,
-                                                   BarrierMask(VkAccessFlagBits(0), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT),
-                                                   BarrierMask(VK_ACCESS_UNIFORM_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT));
+            u32* GpuPtr = UploadRingPushArray(UploadRing, DemoState->RegularCellVertices.Buffer, u32, 256*12,
+                                              VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 
             u32* CurrElement = GpuPtr;
             for (u32 CellClassId = 0; CellClassId < 256; ++CellClassId)
@@ -340,36 +2059,120 @@ DEMO_INIT(Init)
             }
         }
 
-        // NOTE: Upload Noise Textures
+        // NOTE: Upload Point Lights, warm torches scattered through the terrain box
+        {
+            light_clusters* Clusters = &DemoState->LightClusters;
+            gpu_point_light* GpuPtr = LightClustersPushLights(Clusters, UploadRing, DEMO_NUM_POINT_LIGHTS);
+            
+            v3 BoxMin = DemoState->TerrainPos - 2.0f*DemoState->TerrainRadius;
+            v3 BoxSize = 4.0f*DemoState->TerrainRadius;
+            for (u32 LightId = 0; LightId < Clusters->NumLights; ++LightId)
+            {
+                gpu_point_light* Light = GpuPtr + LightId;
+                *Light = {};
+                Light->Pos = BoxMin + V3(f32(rand()) / f32(RAND_MAX), f32(rand()) / f32(RAND_MAX), f32(rand()) / f32(RAND_MAX)) * BoxSize;
+                Light->Color = V3(1.0f, 0.5f + 0.3f*f32(rand()) / f32(RAND_MAX), 0.2f + 0.2f*f32(rand()) / f32(RAND_MAX));
+                Light->MaxDistance = 1.0f + f32(rand()) / f32(RAND_MAX);
+            }
+
+            BenchmarkRecord(&DemoState->Benchmark, "light_count", Clusters->NumLights, "lights");
+        }
+
+        // NOTE: Upload Noise Textures, xorshift can't start from 0
+        u32 NoiseRandomState = DemoState->TerrainSeed*0x9E3779B9 | 1;
         for (u32 NoiseTextureId = 0; NoiseTextureId < ArrayCount(DemoState->NoiseTextures); ++NoiseTextureId)
         {
-            f32* GpuPtr = (f32*)VkCommandsPushWriteImage(&RenderState->Commands, DemoState->NoiseTextures[NoiseTextureId].Image,
-                                                         DemoState->NoiseDim, DemoState->NoiseDim, DemoState->NoiseDim, sizeof(f32),
-                                                         VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
-                                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                                         BarrierMask(VkAccessFlagBits(0), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT),
-                                                         BarrierMask(VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT));
+            f32* GpuPtr = (f32*)UploadRingPushImage(UploadRing, DemoState->NoiseTextures[NoiseTextureId].Image, 0, 0, 0,
+                                                    DemoState->NoiseDim, DemoState->NoiseDim, DemoState->NoiseDim, sizeof(f32),
+                                                    VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                    VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            u32 NumPixels = DemoState->NoiseDim * DemoState->NoiseDim * DemoState->NoiseDim;
+            f32* NoiseData = PushArray(&DemoState->Arena, f32, NumPixels);
+            for (u32 PixelId = 0; PixelId < NumPixels; ++PixelId)
+            {
+                NoiseData[PixelId] = TerrainNoiseRandom(&NoiseRandomState);
+            }
+            Copy(NoiseData, GpuPtr, sizeof(f32)*NumPixels);
+            DemoState->NoiseData[NoiseTextureId] = NoiseData;
+        }
+
+        // NOTE: CPU Terrain Queries
+        {
+            u64 StartTime = DemoTimerGet();
+            TerrainQueriesCreate(&DemoState->Queries, &DemoState->Arena, &DemoState->JobQueue, DemoState->NoiseData, DemoState->NoiseDim,
+                                 DemoState->TerrainPos, DemoState->TerrainRadius, TerrainToWorld(V3(-1.0f)), TerrainToWorld(V3(1.0f)),
+                                 DemoState->TerrainResX, DemoState->TerrainResY, DemoState->TerrainResZ, TERRAIN_QUERY_PANEL);
+            BenchmarkRecord(&DemoState->Benchmark, "cpu_query_build_ms", DemoTimerElapsedMs(StartTime), "ms");
 
-            for (u32 PixelId = 0; PixelId < DemoState->NoiseDim * DemoState->NoiseDim * DemoState->NoiseDim; ++PixelId)
+#if BENCHMARK
+            TerrainQueryBenchmark(&DemoState->Queries, &DemoState->Benchmark);
+            TerrainCpuMesherBenchmark(&DemoState->Queries, &DemoState->Benchmark);
+            ChunkResidencyBenchmark(&DemoState->Benchmark, &DemoState->TempArena);
+#endif
+        }
+        
+        // NOTE: Load baked terrain if we have an archive for it, otherwise bake one from the first generated frames
+        {
+            u64 StartTime = DemoTimerGet();
+            DemoState->TerrainFromCache = TerrainChunkCacheLoad(UploadRing);
+            if (DemoState->TerrainFromCache)
+            {
+                BenchmarkRecord(&DemoState->Benchmark, "chunk_cache_load_cpu_ms", DemoTimerElapsedMs(StartTime), "ms");
+                DemoState->ChunkCacheLoadStart = StartTime;
+                ChunkSchedulerReadyAll(&DemoState->ChunkScheduler);
+                TerrainPreviewSkip(&DemoState->Preview);
+            }
+            else
             {
-                // TODO: Write a diff random generator?
-                GpuPtr[PixelId] = f32(rand()) / f32(RAND_MAX);
+                DemoState->ChunkBake.Stage = ChunkBakeStage_ReadbackCount;
             }
         }
         
+        ShadowCacheInitLayout(&DemoState->ShadowCache, Commands);
+        FarFieldInitLayout(&DemoState->FarField, Commands);
+        
+        // NOTE: All of our uploads go out as one batch, the framework transfer path is only left with the UI
+        UploadRingFlush(UploadRing, Commands);
         VkCommandsTransferFlush(Commands, RenderState->Device);
+        BenchmarkRecord(&DemoState->Benchmark, "init_upload_mb", TerrainBytesToMb(UploadRing->FlushBytes), "MB");
+        BenchmarkRecord(&DemoState->Benchmark, "init_upload_copy_calls", UploadRing->FlushCopyCalls, "calls");
 
-        VkBarrierImageAdd(&RenderState->Commands, DemoState->TerrainDensity.Image, VK_IMAGE_ASPECT_COLOR_BIT,
-                          VK_ACCESS_MEMORY_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
-                          VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL);
-        VkCommandsBarrierFlush(&RenderState->Commands);
+        if (!DemoState->TerrainFromCache)
+        {
+            VkBarrierImageAdd(&RenderState->Commands, DemoState->TerrainDensity.Image, VK_IMAGE_ASPECT_COLOR_BIT,
+                              VK_ACCESS_MEMORY_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
+                              VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL);
+            VkCommandsBarrierFlush(&RenderState->Commands);
+        }
     }
     
     VkCommandsSubmit(Commands, RenderState->Device, RenderState->GraphicsQueue);
 }
 
+// NOTE: See DemoCodeWatchThreadProc
+inline void DemoWorkerThreadsStop()
+{
+    DemoCodeWatchStop(DemoState);
+    ShaderReloadStop(&DemoState->ShaderReload);
+    JobQueueStop(&DemoState->JobQueue);
+}
+
+inline void DemoWorkerThreadsStart()
+{
+    JobQueueStart(&DemoState->JobQueue);
+    ShaderReloadResume(&DemoState->ShaderReload);
+    DemoCodeWatchStart(DemoState);
+}
+
 DEMO_DESTROY(Destroy)
 {
+    DemoWorkerThreadsStop();
+    ChunkArchiveClose(&DemoState->ChunkArchive);
+    if (DemoState->ChunkClasses.Dirty)
+    {
+        ChunkClassCacheSave(&DemoState->ChunkClasses, CHUNK_CLASS_FILE_NAME);
+    }
 }
 
 DEMO_SWAPCHAIN_CHANGE(SwapChainChange)
@@ -397,6 +2200,8 @@ DEMO_CODE_RELOAD(CodeReload)
     VkGetGlobalFunctionPointers(VulkanLib);
     VkGetInstanceFunctionPointers();
     VkGetDeviceFunctionPointers();
+
+    DemoWorkerThreadsStart();
 }
 
 DEMO_MAIN_LOOP(MainLoop)
@@ -408,9 +2213,92 @@ DEMO_MAIN_LOOP(MainLoop)
 
     vk_commands* Commands = &RenderState->Commands;
     VkCommandsBegin(Commands, RenderState->Device);
+    UploadRingBeginFrame(&DemoState->UploadRing);
+    GpuTimestampsFrameBegin(&DemoState->GpuTimestamps, RenderState->Device, Commands);
+    u32 FrameTimer = GpuTimerBegin(&DemoState->GpuTimestamps, Commands, "gpu_frame");
+    DynamicResolutionUpdate(&DemoState->DynamicRes, GpuTimerGetMs(&DemoState->GpuTimestamps, "gpu_frame"));
+    TerrainChunkBakeUpdate();
+    OverdrawCountersRead();
+    DensityPyramidReadbackRead(&DemoState->DensityPyramid);
+    TerrainChunkClassMeasure();
+    TerrainPreviewFrameBegin(&DemoState->Preview, &DemoState->Benchmark);
+    TerrainChunkCacheLoadFinish();
+    TerrainFp16ReadbackRead(&DemoState->TerrainFp16);
+    TerrainMeshStatsRead();
+    ChunkSchedulerTimingsUpdate(&DemoState->ChunkScheduler, &DemoState->GpuTimestamps);
+
+    b32 DepthPrepass = DemoState->DepthPrepass;
+    b32 OverdrawDebug = DemoState->OverdrawDebug;
+#if BENCHMARK
+    // NOTE: Cycle through prepass on/off with and without overdraw counting, the atomics would skew the timings so they get own frames.
+    // Bit 1 is the per chunk / batched generation toggle below, so the prepass gets its own bit
+    DepthPrepass = (DemoState->Benchmark.FrameId & 64) != 0;
+    OverdrawDebug = (DemoState->Benchmark.FrameId & 2) != 0;
+    
+    // NOTE: And the far field trace against meshing every chunk
+    DemoState->FarField.Enabled = (DemoState->Benchmark.FrameId & 4) != 0;
 
-    // NOTE: Update pipelines
-    VkPipelineUpdateShaders(RenderState->Device, &RenderState->CpuArena, &RenderState->PipelineManager);
+    // NOTE: And surface nets against transvoxel on the same volume
+    DemoState->Mesher = (DemoState->Benchmark.FrameId & 32) != 0 ? TerrainMesher_SurfaceNets : TerrainMesher_Transvoxel;
+#endif
+
+    // NOTE: Cached terrain is static so we only run the generation kernels when we don't have it
+    b32 GenerateTerrain = !DemoState->TerrainFromCache;
+
+    // NOTE: The autotune sweep regenerates the whole terrain with a different workgroup shape every few frames
+    {
+        workgroup_tuner* Tuner = &DemoState->WorkgroupTuner;
+        GenerateTerrain = GenerateTerrain || Tuner->Running;
+        if (WorkgroupTunerUpdate(Tuner, &DemoState->GpuTimestamps, RenderState->PhysicalDevice))
+        {
+            DemoState->GenerateTerrainPso = Tuner->Pipelines[WorkgroupKernel_GenerateDensity];
+            DemoState->GenerateTrianglesPso = Tuner->Pipelines[WorkgroupKernel_GenerateTriangles];
+            DemoState->GenerateTerrainFp16Pso = Tuner->Pipelines[WorkgroupKernel_GenerateDensityFp16];
+            DemoState->GenerateTrianglesFp16Pso = Tuner->Pipelines[WorkgroupKernel_GenerateTrianglesFp16];
+            DemoState->ChunkBatch.Dirty = true;
+        }
+    }
+
+    chunk_generate_path GeneratePath = ChunkGeneratePathSelect(DemoState->FusedGeneration);
+#if BENCHMARK
+    // NOTE: Alternate with one dispatch per chunk and with the fused kernel so the benchmark can compare them against the batched path
+    if ((DemoState->Benchmark.FrameId & 8) != 0)
+    {
+        GeneratePath = ChunkGeneratePathSelect(true);
+    }
+    else
+    {
+        GeneratePath = (DemoState->Benchmark.FrameId & 1) != 0 ? ChunkGeneratePath_PerChunk : ChunkGeneratePath_Batched;
+    }
+#endif
+    b32 FusedPath = GeneratePath == ChunkGeneratePath_Fused || GeneratePath == ChunkGeneratePath_FusedKeepDensity;
+
+    // NOTE: The tuner times the transvoxel kernel, the fused path only has transvoxel
+    terrain_mesher Mesher = DemoState->Mesher;
+    if (DemoState->WorkgroupTuner.Running || FusedPath)
+    {
+        Mesher = TerrainMesher_Transvoxel;
+    }
+
+    // NOTE: Enabled is never set without device support, the sweep and the benchmark alternate precisions only when both exist
+    b32 Fp16 = DemoState->TerrainFp16.Enabled;
+    if (DemoState->WorkgroupTuner.Running)
+    {
+        Fp16 = DemoState->TerrainFp16.Supported && (DemoState->WorkgroupTuner.TimedFrame & 1) != 0;
+    }
+#if BENCHMARK
+    Fp16 = DemoState->TerrainFp16.Supported && (DemoState->Benchmark.FrameId & 16) != 0;
+
+    // NOTE: Warm starts still generate for a few frames so the benchmark can compare cold generation against the cached load, the
+    // precision and the mesher only toggle after those so they regenerate on every toggle too
+    GenerateTerrain = (GenerateTerrain || DemoState->Benchmark.FrameId < 16 || Fp16 != DemoState->ScheduledFp16 ||
+                       Mesher != DemoState->ScheduledMesher);
+#endif
+    
+    // NOTE: Swap in pipelines the shader reload thread rebuilt since last frame
+#if SHADER_HOT_RELOAD
+    ShaderReloadApplyPending(&DemoState->ShaderReload, RenderState->Device);
+#endif
 
     RenderTargetUpdateEntries(&DemoState->TempArena, &DemoState->CopyToSwapTarget);
     
@@ -425,121 +2313,272 @@ DEMO_MAIN_LOOP(MainLoop)
         Copy(CurrInput->KeysDown, UiCurrInput.KeysDown, sizeof(UiCurrInput.KeysDown));
         UiStateBegin(UiState, FrameTime, RenderState->WindowWidth, RenderState->WindowHeight, UiCurrInput);
         local_global v2 PanelPos = V2(100, 800);
+        ui_panel Panel = UiPanelBegin(UiState, &PanelPos, "Terrain Panel");
+        {
+            GpuAllocatorUpdateStats(&DemoState->GpuAllocator);
+            TerrainGpuMemoryPanel(&Panel);
+            OverdrawPanel(&Panel);
+            FarFieldPanel(&Panel, &DemoState->FarField);
+            DensityPyramidPanel(&Panel, &DemoState->DensityPyramid);
+            TerrainFp16Panel(&Panel, &DemoState->TerrainFp16);
+            TerrainMeshStatsPanel(&Panel);
+            ChunkSchedulerPanel(&Panel, &DemoState->ChunkScheduler);
+            ChunkResidencyPanel(&Panel, &DemoState->ChunkResidency);
+            ChunkClassPanel(&Panel, &DemoState->ChunkClasses);
+            TerrainPreviewPanel(&Panel, &DemoState->Preview);
+            TerrainQueriesPanel(&Panel, &DemoState->Queries, DemoState->Camera.Pos);
+            DynamicResolutionPanel(&Panel, &DemoState->DynamicRes);
+            WorkgroupTunerPanel(&Panel, &DemoState->WorkgroupTuner);
+        }
+        UiPanelEnd(&Panel);
         
         UiStateEnd(UiState, &RenderState->DescriptorManager);
     }
 
     // NOTE: Upload scene data
+    u32 SceneUniformOffset = 0;
     {
         if (!(DemoState->UiState.MouseTouchingUi || DemoState->UiState.ProcessedInteraction))
         {
             CameraUpdate(&DemoState->Camera, CurrInput, PrevInput);
         }
         
-        // NOTE: Push Scene Globals
+        // NOTE: Push Scene Globals, no copy needed since the uniform ring is mapped
         {
-            scene_globals* GpuPtr = VkCommandsPushWriteStruct(&RenderState->Commands, DemoState->SceneUniforms, scene_globals,
-                                                              BarrierMask(VkAccessFlagBits(0), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT),
-                                                              BarrierMask(VK_ACCESS_UNIFORM_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT));
+            scene_globals* GpuPtr = UniformRingPushStruct(&DemoState->SceneUniforms, scene_globals, &SceneUniformOffset);
             
             *GpuPtr = {};
             GpuPtr->CameraPos = DemoState->Camera.Pos;
             GpuPtr->WTransform = M4Pos(DemoState->TerrainPos) * M4Scale(2.0f*DemoState->TerrainRadius);
-            GpuPtr->WVPTransform = CameraGetVP(&DemoState->Camera) * GpuPtr->WTransform;
+            GpuPtr->VPTransform = CameraGetVP(&DemoState->Camera);
+            GpuPtr->WVPTransform = GpuPtr->VPTransform * GpuPtr->WTransform;
+            GpuPtr->NumPointLights = DemoState->LightClusters.NumLights;
+            GpuPtr->Flags = OverdrawDebug ? SCENE_FLAG_OVERDRAW : 0;
+            GpuPtr->RenderSize = V2(f32(DemoState->DynamicRes.Width), f32(DemoState->DynamicRes.Height));
+
+            ShadowCacheUpdate(&DemoState->ShadowCache, DemoState->Camera.Pos);
+            ShadowCacheSceneGlobals(&DemoState->ShadowCache, &GpuPtr->ShadowRight, &GpuPtr->ShadowUp, &GpuPtr->ShadowDir, GpuPtr->ShadowCascades);
         }
         
-        // NOTE: Upload Indirect Arg Buffer
+        /*
+          NOTE: Generate only what the scheduler picks for this camera, the tuner and the benchmark time whole regenerations. The tuner
+                times the kernels on every chunk, the benchmark skips the known empty ones like the scheduler does. A run without
+                CHUNK_CLASS_FILE_NAME starts cold (only the proven chunks are skipped until the first readback is measured), the next
+                run loads the classes and is hot from the first frame
+         */
+        if (GenerateTerrain)
         {
-            indirect_args* GpuPtr = VkCommandsPushWriteStruct(&RenderState->Commands, DemoState->IndirectArgBuffer, indirect_args,
-                                                              BarrierMask(VkAccessFlagBits(0), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT),
-                                                              BarrierMask(VK_ACCESS_UNIFORM_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT));
-            
-            *GpuPtr = {};
-            GpuPtr->NumInstances = 1;
+            b32 FullRegenerate = DemoState->WorkgroupTuner.Running;
+            b32 SkipEmpty = false;
+#if BENCHMARK
+            FullRegenerate = true;
+            SkipEmpty = !DemoState->WorkgroupTuner.Running;
+#endif
+            GenerateTerrain = TerrainChunkSchedule(FullRegenerate, SkipEmpty, Mesher, Fp16);
         }
-
+        
+        // NOTE: Only does work when the batch or the workgroup shapes changed
+        ChunkBatchUpload(&DemoState->ChunkBatch, &DemoState->UploadRing);
+        
+        // NOTE: ChunkDrawArgs are reset by the generation kernel so the per frame uploads are only streaming data now, except for
+        // the fused kernel which can't reset them itself
+        if (GenerateTerrain && FusedPath)
+        {
+            ChunkBatchDrawArgsReset(&DemoState->ChunkBatch, &DemoState->UploadRing);
+        }
+        UploadRingFlush(&DemoState->UploadRing, Commands);
+        // NOTE: Only the UI can still have framework transfers queued
         VkCommandsTransferFlush(&RenderState->Commands, RenderState->Device);
     }
     
+    // NOTE: Slots the scheduler skipped as known empty
+    if (DemoState->ChunkClasses.NumFillSlots > 0)
     {
-        // NOTE: Generate proedural terrain 
-        {            
-            vk_pipeline* Pipeline = DemoState->GenerateTerrainPso;
-            vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Handle);
-            VkDescriptorSet DescriptorSets[] =
-                {
-                    DemoState->TerrainDescriptor,
-                };
-            vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Layout, 0,
-                                    ArrayCount(DescriptorSets), DescriptorSets, 0, 0);
+        TerrainChunkClassFillRecord(Commands);
+    }
 
-            u32 DispatchX = CeilU32(f32(DemoState->TerrainResX) / 4.0f);
-            u32 DispatchY = CeilU32(f32(DemoState->TerrainResY) / 4.0f);
-            u32 DispatchZ = CeilU32(f32(DemoState->TerrainResZ) / 4.0f);
-            vkCmdDispatch(Commands->Buffer, DispatchX, DispatchY, DispatchZ);
-        }
-        
-        VkBarrierBufferAdd(&RenderState->Commands, DemoState->IndirectArgBuffer,
-                           VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
-                           VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
-        VkBarrierBufferAdd(&RenderState->Commands, DemoState->TerrainTriangles,
+    if (GenerateTerrain)
+    {
+        // NOTE: Last frames draw reads the vertex pool, the density atlas was last read by the previous generation
+        VkBarrierBufferAdd(&RenderState->Commands, DemoState->TerrainTriangles.Buffer,
                            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
                            VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        VkBarrierBufferAdd(&RenderState->Commands, DemoState->ChunkDrawArgs.Buffer,
+                           VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                           VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
         VkBarrierImageAdd(&RenderState->Commands, DemoState->TerrainDensity.Image, VK_IMAGE_ASPECT_COLOR_BIT,
                           VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL,
                           VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL);
         VkCommandsBarrierFlush(&RenderState->Commands);
+
+        ChunkBatchRecord(Commands, &DemoState->ChunkBatch, GeneratePath, Fp16, Mesher);
+        ChunkSchedulerJobsTimed(&DemoState->ChunkScheduler, GlobalChunkGenerateTimers[Fp16 ? 1 : 0][GeneratePath],
+                                DemoState->ChunkBatch.NumJobs);
+        TerrainMeshStatsRecord(Commands, Mesher);
+        if (Fp16 && TerrainFp16ProbeNeeded(&DemoState->TerrainFp16))
+        {
+            TerrainFp16ProbeRecord(&DemoState->TerrainFp16, Commands, DemoState->Fp16ErrorProbePso, DemoState->TerrainDescriptor,
+                                   DemoState->ChunkBatch.NumJobs, DemoState->ChunkBatch.DispatchArgs.Buffer,
+                                   2*sizeof(VkDispatchIndirectCommand));
+        }
+
+        // NOTE: Without the atlas there is nothing to downsample, the far field is off and gets rebuilt by the first generation after
+        // it is turned back on
+        if (GeneratePath != ChunkGeneratePath_Fused)
+        {
+            DemoState->FarField.Dirty = true;
+        }
+    }
+    TerrainChunkBakeRecord(Commands);
+
+    // NOTE: Cached terrain skips generation, build the pyramid from the uploaded atlas with the batch that covers every slot
+    if (DemoState->DensityPyramid.Dirty)
+    {
+        chunk_push_constants PushConstants = {};
+        PushConstants.NumJobs = DemoState->ChunkBatch.NumJobs;
+        DensityPyramidBuildRecord(&DemoState->DensityPyramid, Commands, DemoState->DensityBricksPso, DemoState->DensityPyramidPso,
+                                  DemoState->TerrainDescriptor, &PushConstants, DemoState->ChunkBatch.NumJobs,
+                                  DemoState->ChunkBatch.DispatchArgs.Buffer, 2*sizeof(VkDispatchIndirectCommand));
+        DensityPyramidReadbackRecord(&DemoState->DensityPyramid, Commands);
+    }
+
+    // NOTE: Keep the far field in sync with the density atlas
+    if (DemoState->FarField.Dirty)
+    {
+        u32 BuildTimer = GpuTimerBegin(&DemoState->GpuTimestamps, Commands, "far_field_build");
+        FarFieldBuildRecord(&DemoState->FarField, Commands, DemoState->FarFieldDownsamplePso, DemoState->TerrainDescriptor,
+                            DemoState->TerrainDensity.Image);
+        GpuTimerEnd(&DemoState->GpuTimestamps, Commands, BuildTimer);
+    }
+
+    // NOTE: Redraw the shadow tiles that scrolled in or saw chunk changes, each tile only draws the chunks overlapping it
+    shadow_cache* ShadowCache = &DemoState->ShadowCache;
+    if (ShadowCache->NumUpdates > 0)
+    {
+        u32 ShadowTimer = GpuTimerBegin(&DemoState->GpuTimestamps, Commands, "shadow_tiles");
+        ShadowCachePassBegin(ShadowCache, Commands);
+
+        vk_pipeline* Pipeline = DemoState->ShadowPso;
+        vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline->Handle);
+        vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline->Layout, 0, 1, &DemoState->ForwardDescriptor,
+                                1, &SceneUniformOffset);
+
+        VkDeviceSize Offset = 0;
+        if (DemoState->TerrainFromCache)
+        {
+            vkCmdBindVertexBuffers(Commands->Buffer, 0, 1, &DemoState->CachedVertices.Buffer, &Offset);
+            vkCmdBindIndexBuffer(Commands->Buffer, DemoState->CachedIndices.Buffer, 0, VK_INDEX_TYPE_UINT32);
+        }
+        else
+        {
+            vkCmdBindVertexBuffers(Commands->Buffer, 0, 1, &DemoState->TerrainTriangles.Buffer, &Offset);
+        }
         
-        // NOTE: Generate triangles for terrain
+        for (u32 UpdateId = 0; UpdateId < ShadowCache->NumUpdates; ++UpdateId)
         {
-            vk_pipeline* Pipeline = DemoState->GenerateTrianglesPso;
-            vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Handle);
-            VkDescriptorSet DescriptorSets[] =
+            shadow_tile_update* Update = ShadowCache->Updates + UpdateId;
+            ShadowCacheTileBegin(ShadowCache, Commands, Pipeline, Update);
+
+            if (DemoState->TerrainFromCache)
+            {
+                for (u32 ChunkId = 0; ChunkId < DemoState->NumCachedChunks; ++ChunkId)
                 {
-                    DemoState->TerrainDescriptor,
-                };
-            vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Layout, 0,
-                                    ArrayCount(DescriptorSets), DescriptorSets, 0, 0);
-
-            u32 DispatchX = CeilU32(f32(DemoState->TerrainResX - 1) / 4.0f);
-            u32 DispatchY = CeilU32(f32(DemoState->TerrainResY - 1) / 4.0f);
-            u32 DispatchZ = CeilU32(f32(DemoState->TerrainResZ - 1) / 4.0f);
-            vkCmdDispatch(Commands->Buffer, DispatchX, DispatchY, DispatchZ);
-        }
-
-        VkBarrierBufferAdd(&RenderState->Commands, DemoState->IndirectArgBuffer,
-                           VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                           VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
-        VkBarrierBufferAdd(&RenderState->Commands, DemoState->TerrainTriangles,
-                           VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                           VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
-        VkCommandsBarrierFlush(&RenderState->Commands);
-    }
+                    cached_chunk_draw* Draw = DemoState->CachedChunks + ChunkId;
+                    if (ShadowTileOverlaps(Update, Draw->ShadowBounds.LightMin, Draw->ShadowBounds.LightMax))
+                    {
+                        // NOTE: Outer cascades have texels far larger than the simplification error so they use the LOD
+                        if (Update->CascadeId > 0)
+                        {
+                            vkCmdDrawIndexed(Commands->Buffer, Draw->NumLodIndices, 1, Draw->FirstLodIndex, Draw->VertexOffset, 0);
+                        }
+                        else
+                        {
+                            vkCmdDrawIndexed(Commands->Buffer, Draw->NumIndices, 1, Draw->FirstIndex, Draw->VertexOffset, 0);
+                        }
+                        ShadowCache->NumTileChunkDraws += 1;
+                    }
+                }
+            }
+            else
+            {
+                for (u32 Slot = 0; Slot < DemoState->NumAllocatedSlots; ++Slot)
+                {
+                    chunk_shadow_bounds* Bounds = DemoState->SlotShadowBounds + Slot;
+                    if (Bounds->Valid && TerrainSlotDrawn(Slot) &&
+                        ShadowTileOverlaps(Update, Bounds->LightMin, Bounds->LightMax))
+                    {
+                        vkCmdDrawIndirect(Commands->Buffer, DemoState->ChunkDrawArgs.Buffer, sizeof(indirect_args)*Slot, 1, sizeof(indirect_args));
+                        ShadowCache->NumTileChunkDraws += 1;
+                    }
+                }
+            }
+        }
 
+        ShadowCachePassEnd(ShadowCache, Commands);
+        GpuTimerEnd(&DemoState->GpuTimestamps, Commands, ShadowTimer);
+    }
+    
+    // NOTE: Bin lights into clusters for this frames camera
+    {
+        u32 LightTimer = GpuTimerBegin(&DemoState->GpuTimestamps, Commands, "light_clusters");
+        LightClustersRecord(Commands, &DemoState->LightClusters, DemoState->LightClusterPso, DemoState->ForwardDescriptor, SceneUniformOffset);
+        GpuTimerEnd(&DemoState->GpuTimestamps, Commands, LightTimer);
+    }
+    
+    if (OverdrawDebug)
+    {
+        OverdrawCountersClearRecord(Commands);
+    }
+    
     // NOTE: Draw Terrain
-    RenderTargetPassBegin(&DemoState->RenderTarget, Commands, RenderTargetRenderPass_SetViewPort | RenderTargetRenderPass_SetScissor);
     {
-        vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, DemoState->ForwardPipeline->Handle);
+        u32 ForwardTimer = GpuTimerBegin(&DemoState->GpuTimestamps, Commands, DepthPrepass ? "forward_prepass" : "forward_single_pass");
+        TerrainFarFieldCull();
+        RenderTargetPassBegin(&DemoState->RenderTarget, Commands, 0);
+        DynamicResolutionViewportSet(&DemoState->DynamicRes, Commands);
+
+        // NOTE: Depth only pass first so the color pass only shades the visible fragment of every pixel (EQUAL test)
+        vk_pipeline* ColorPipeline = DemoState->ForwardPipeline;
+        if (DepthPrepass)
         {
-            VkDescriptorSet DescriptorSets[] =
-                {
-                    DemoState->ForwardDescriptor,
-                };
-            vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, DemoState->ForwardPipeline->Layout, 0,
-                                    ArrayCount(DescriptorSets), DescriptorSets, 0, 0);
+            vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, DemoState->DepthPrepassPso->Handle);
+            vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, DemoState->DepthPrepassPso->Layout, 0, 1,
+                                    &DemoState->ForwardDescriptor, 1, &SceneUniformOffset);
+            TerrainDrawChunks(Commands);
+            ColorPipeline = DemoState->ForwardEqualPipeline;
         }
+        
+        vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, ColorPipeline->Handle);
+        vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, ColorPipeline->Layout, 0, 1, &DemoState->ForwardDescriptor,
+                                1, &SceneUniformOffset);
+        TerrainDrawChunks(Commands);
 
-        VkDeviceSize Offset = 0;
-        vkCmdBindVertexBuffers(Commands->Buffer, 0, 1, &DemoState->TerrainTriangles, &Offset);
-        vkCmdDrawIndirect(Commands->Buffer, DemoState->IndirectArgBuffer, 0, 1, 0);
+        // NOTE: Fills in everything past the cutover, depth tested against the mesh
+        FarFieldDrawRecord(Commands, SceneUniformOffset);
+        
+        RenderTargetPassEnd(Commands);
+        GpuTimerEnd(&DemoState->GpuTimestamps, Commands, ForwardTimer);
+    }
+
+    if (OverdrawDebug)
+    {
+        OverdrawCountersReadbackRecord(Commands, DepthPrepass);
     }
-    RenderTargetPassEnd(Commands);        
     
     RenderTargetPassBegin(&DemoState->CopyToSwapTarget, Commands, RenderTargetRenderPass_SetViewPort | RenderTargetRenderPass_SetScissor);
-    FullScreenPassRender(Commands, DemoState->CopyToSwapPipeline, 1, &DemoState->CopyToSwapDesc);
+    {
+        vk_pipeline* Pipeline = DemoState->CopyToSwapPipeline;
+        vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline->Handle);
+        vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline->Layout, 0, 1, &DemoState->CopyToSwapDesc, 0, 0);
+        copy_to_swap_constants Constants = DynamicResolutionCopyConstants(&DemoState->DynamicRes);
+        vkCmdPushConstants(Commands->Buffer, Pipeline->Layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                           sizeof(Constants), &Constants);
+        vkCmdDraw(Commands->Buffer, 3, 1, 0, 0);
+    }
     RenderTargetPassEnd(Commands);
     UiStateRender(&DemoState->UiState, RenderState->Device, Commands, DemoState->SwapChainEntry.View);
 
+    GpuTimerEnd(&DemoState->GpuTimestamps, Commands, FrameTimer);
     VkCommandsEnd(Commands, RenderState->Device);
                     
     // NOTE: Render to our window surface
@@ -585,4 +2624,209 @@ DEMO_MAIN_LOOP(MainLoop)
     }
 
     DemoState->WindowResized = false;
+
+    if (!DemoState->FirstFramePresented)
+    {
+        DemoState->FirstFramePresented = true;
+        BenchmarkRecord(&DemoState->Benchmark, "startup_to_first_frame_ms", DemoTimerElapsedMs(DemoState->Benchmark.StartTicks), "ms");
+    }
+    
+#if BENCHMARK
+    {
+        benchmark_state* Bench = &DemoState->Benchmark;
+        f64 NumJobs = f64(DemoState->ChunkBatch.NumJobs);
+        f64 BatchedMs = GpuTimerGetMs(&DemoState->GpuTimestamps, "generate_chunks_batched");
+        if (BatchedMs > 0.0)
+        {
+            BenchmarkRecord(Bench, "cold_generation_gpu_ms", BatchedMs, "ms");
+            BenchmarkRecord(Bench, "chunks_per_sec_batched", NumJobs / (BatchedMs / 1000.0), "chunks/s");
+            BenchmarkRecord(Bench, "generate_density_gpu_ms", GpuTimerGetMs(&DemoState->GpuTimestamps, "generate_density"), "ms");
+            BenchmarkRecord(Bench, "generate_triangles_gpu_ms", GpuTimerGetMs(&DemoState->GpuTimestamps, "generate_triangles"), "ms");
+            BenchmarkRecord(Bench, "workgroup_shapes_tuned", DemoState->WorkgroupTuner.Loaded || DemoState->WorkgroupTuner.Finished ? 1.0 : 0.0, "bool");
+        }
+
+        // NOTE: The fused kernel skips writing (and reading back) the r16f atlas, 2 bytes per slot sample
+        f64 FusedMs = GpuTimerGetMs(&DemoState->GpuTimestamps, "generate_chunks_fused");
+        if (FusedMs > 0.0)
+        {
+            u64 AtlasBytes = u64(DemoState->ChunkBatch.NumJobs)*TERRAIN_CHUNK_SLOT_DIM*TERRAIN_CHUNK_SLOT_DIM*TERRAIN_CHUNK_SLOT_DIM*2;
+            BenchmarkRecord(Bench, "generate_fused_gpu_ms", FusedMs, "ms");
+            BenchmarkRecord(Bench, "chunks_per_sec_fused", NumJobs / (FusedMs / 1000.0), "chunks/s");
+            BenchmarkRecord(Bench, "generate_fused_atlas_writes_skipped_mb", TerrainBytesToMb(AtlasBytes), "MB");
+        }
+        f64 FusedKeepMs = GpuTimerGetMs(&DemoState->GpuTimestamps, "generate_chunks_fused_keep_density");
+        if (FusedKeepMs > 0.0)
+        {
+            BenchmarkRecord(Bench, "generate_fused_keep_density_gpu_ms", FusedKeepMs, "ms");
+        }
+
+        // NOTE: FP16 frames alternate with fp32 ones, the speedups are against the latest fp32 timing of the same path
+        f64 BatchedFp16Ms = GpuTimerGetMs(&DemoState->GpuTimestamps, "generate_chunks_batched_fp16");
+        if (BatchedFp16Ms > 0.0)
+        {
+            BenchmarkRecord(Bench, "generate_batched_fp16_gpu_ms", BatchedFp16Ms, "ms");
+            BenchmarkRecord(Bench, "chunks_per_sec_batched_fp16", NumJobs / (BatchedFp16Ms / 1000.0), "chunks/s");
+            BenchmarkRecord(Bench, "generate_density_fp16_gpu_ms", GpuTimerGetMs(&DemoState->GpuTimestamps, "generate_density_fp16"), "ms");
+            BenchmarkRecord(Bench, "generate_triangles_fp16_gpu_ms", GpuTimerGetMs(&DemoState->GpuTimestamps, "generate_triangles_fp16"), "ms");
+            f64 BatchedFp32Ms = BenchmarkGet(Bench, "cold_generation_gpu_ms");
+            if (BatchedFp32Ms > 0.0)
+            {
+                BenchmarkRecord(Bench, "generate_batched_fp16_speedup", BatchedFp32Ms / BatchedFp16Ms, "x");
+            }
+        }
+        f64 FusedFp16Ms = GpuTimerGetMs(&DemoState->GpuTimestamps, "generate_chunks_fused_fp16");
+        if (FusedFp16Ms > 0.0)
+        {
+            BenchmarkRecord(Bench, "generate_fused_fp16_gpu_ms", FusedFp16Ms, "ms");
+            BenchmarkRecord(Bench, "chunks_per_sec_fused_fp16", NumJobs / (FusedFp16Ms / 1000.0), "chunks/s");
+            f64 FusedFp32Ms = BenchmarkGet(Bench, "generate_fused_gpu_ms");
+            if (FusedFp32Ms > 0.0)
+            {
+                BenchmarkRecord(Bench, "generate_fused_fp16_speedup", FusedFp32Ms / FusedFp16Ms, "x");
+            }
+        }
+        if (DemoState->TerrainFp16.HasErrors)
+        {
+            terrain_fp16* Fp16State = &DemoState->TerrainFp16;
+            BenchmarkRecord(Bench, "fp16_max_vertex_error_cells", Fp16State->MaxVertexError, "cells");
+            BenchmarkRecord(Bench, "fp16_max_normal_error_deg", Fp16State->MaxNormalError, "deg");
+            BenchmarkRecord(Bench, "fp16_case_mismatch_ratio", TerrainFp16MismatchRatio(Fp16State), "ratio");
+        }
+        BenchmarkRecord(Bench, "fp16_supported", DemoState->TerrainFp16.Supported ? 1.0 : 0.0, "bool");
+
+        // NOTE: Surface nets against transvoxel, extraction only covers the triangles step since the density is shared
+        f64 SurfaceNetsMs = GpuTimerGetMs(&DemoState->GpuTimestamps, "generate_surface_nets");
+        if (SurfaceNetsMs > 0.0)
+        {
+            BenchmarkRecord(Bench, "generate_surface_nets_gpu_ms", SurfaceNetsMs, "ms");
+        }
+        if (DemoState->NumMeshTriangles > 0)
+        {
+            b32 SurfaceNets = DemoState->MeshStatsMesher == TerrainMesher_SurfaceNets;
+            BenchmarkRecord(Bench, SurfaceNets ? "mesh_triangles_surface_nets" : "mesh_triangles_transvoxel", f64(DemoState->NumMeshTriangles),
+                            "triangles");
+
+            f64 TransvoxelTriangles = BenchmarkGet(Bench, "mesh_triangles_transvoxel");
+            if (TransvoxelTriangles > 0.0)
+            {
+                BenchmarkRecord(Bench, "surface_nets_triangle_ratio", BenchmarkGet(Bench, "mesh_triangles_surface_nets") / TransvoxelTriangles, "ratio");
+            }
+        }
+
+        // NOTE: Draw time of the previous frames geometry, without the far field culling away chunks
+        if (!OverdrawDebug && !DemoState->FarField.PrevFrameEnabled)
+        {
+            f64 DrawMs = (GpuTimerGetMs(&DemoState->GpuTimestamps, "forward_prepass") +
+                          GpuTimerGetMs(&DemoState->GpuTimestamps, "forward_single_pass"));
+            if (DrawMs > 0.0)
+            {
+                b32 SurfaceNets = DemoState->PrevFrameMesher == TerrainMesher_SurfaceNets;
+                BenchmarkRecord(Bench, SurfaceNets ? "forward_gpu_ms_surface_nets" : "forward_gpu_ms_transvoxel", DrawMs, "ms");
+            }
+        }
+        // NOTE: Only frames without the overdraw atomics are timed
+        if (!OverdrawDebug)
+        {
+            f64 ForwardMs = GpuTimerGetMs(&DemoState->GpuTimestamps, DepthPrepass ? "forward_prepass" : "forward_single_pass");
+            if (ForwardMs > 0.0)
+            {
+                BenchmarkRecord(Bench, DepthPrepass ? "forward_gpu_ms_prepass" : "forward_gpu_ms_single_pass", ForwardMs, "ms");
+            }
+        }
+        if (DemoState->OverdrawSinglePass.CoveredPixels > 0)
+        {
+            BenchmarkRecord(Bench, "overdraw_fragments_per_pixel_single_pass", DemoState->OverdrawSinglePass.FragmentsPerPixel, "fragments/px");
+            BenchmarkRecord(Bench, "overdraw_max_fragments_single_pass", DemoState->OverdrawSinglePass.MaxFragmentsPerPixel, "fragments");
+        }
+        if (DemoState->OverdrawPrepass.CoveredPixels > 0)
+        {
+            BenchmarkRecord(Bench, "overdraw_fragments_per_pixel_prepass", DemoState->OverdrawPrepass.FragmentsPerPixel, "fragments/px");
+            BenchmarkRecord(Bench, "overdraw_max_fragments_prepass", DemoState->OverdrawPrepass.MaxFragmentsPerPixel, "fragments");
+        }
+        
+        f64 ShadowMs = GpuTimerGetMs(&DemoState->GpuTimestamps, "shadow_tiles");
+        if (ShadowMs > 0.0)
+        {
+            BenchmarkRecord(Bench, "shadow_tile_gpu_ms", ShadowMs, "ms");
+        }
+        BenchmarkRecord(Bench, "shadow_tiles_rendered", DemoState->ShadowCache.NumTilesRendered, "tiles");
+        BenchmarkRecord(Bench, "shadow_tile_chunk_draws", DemoState->ShadowCache.NumTileChunkDraws, "draws");
+        f64 GpuFrameMs = GpuTimerGetMs(&DemoState->GpuTimestamps, "gpu_frame");
+        if (GpuFrameMs > 0.0)
+        {
+            BenchmarkRecord(Bench, "gpu_frame_ms", GpuFrameMs, "ms");
+            BenchmarkRecord(Bench, "dynamic_res_scale", DemoState->DynamicRes.Scale, "scale");
+            BenchmarkRecord(Bench, "dynamic_res_pixels", f64(DemoState->DynamicRes.Width)*f64(DemoState->DynamicRes.Height), "pixels");
+
+            // NOTE: Timestamps are a frame behind so the frame time belongs to the previous frames far field mode
+            BenchmarkRecord(Bench, DemoState->FarField.PrevFrameEnabled ? "gpu_frame_ms_far_field" : "gpu_frame_ms_mesh_all", GpuFrameMs, "ms");
+        }
+        f64 FarFieldMs = GpuTimerGetMs(&DemoState->GpuTimestamps, "far_field");
+        if (FarFieldMs > 0.0)
+        {
+            BenchmarkRecord(Bench, "far_field_trace_gpu_ms", FarFieldMs, "ms");
+        }
+        f64 FarFieldBuildMs = GpuTimerGetMs(&DemoState->GpuTimestamps, "far_field_build");
+        if (FarFieldBuildMs > 0.0)
+        {
+            BenchmarkRecord(Bench, "far_field_build_gpu_ms", FarFieldBuildMs, "ms");
+        }
+        if (DemoState->FarField.Enabled)
+        {
+            BenchmarkRecord(Bench, "far_field_volume_mb", TerrainBytesToMb(FarFieldMemorySize(&DemoState->FarField)), "MB");
+            BenchmarkRecord(Bench, "far_field_chunks_traced", DemoState->FarField.NumChunksCulled, "chunks");
+            BenchmarkRecord(Bench, "far_field_mesh_mb_replaced", TerrainBytesToMb(DemoState->FarField.CulledMeshSize), "MB");
+        }
+
+        BenchmarkRecord(Bench, "density_pyramid_mb", TerrainBytesToMb(DensityPyramidMemorySize(&DemoState->DensityPyramid)), "MB");
+        BenchmarkRecord(Bench, "density_pyramid_surface_chunks", DemoState->DensityPyramid.NumSurfaceSlots, "chunks");
+        f64 LightClusterMs = GpuTimerGetMs(&DemoState->GpuTimestamps, "light_clusters");
+        if (LightClusterMs > 0.0)
+        {
+            BenchmarkRecord(Bench, "light_cluster_gpu_ms", LightClusterMs, "ms");
+        }
+        f64 PerChunkMs = GpuTimerGetMs(&DemoState->GpuTimestamps, "generate_chunks_per_chunk");
+        if (PerChunkMs > 0.0)
+        {
+            BenchmarkRecord(Bench, "generation_per_chunk_gpu_ms", PerChunkMs, "ms");
+            BenchmarkRecord(Bench, "chunks_per_sec_per_chunk", NumJobs / (PerChunkMs / 1000.0), "chunks/s");
+        }
+
+        // NOTE: The benchmark regenerates everything so the queue stays empty, the per job estimate is what a budget would buy
+        chunk_scheduler* Scheduler = &DemoState->ChunkScheduler;
+        BenchmarkRecord(Bench, "chunk_scheduler_job_gpu_ms", Scheduler->JobMs, "ms");
+        BenchmarkRecord(Bench, "chunk_scheduler_jobs_per_budget", f64(u32(Scheduler->BudgetMs / Scheduler->JobMs)), "chunks");
+
+        // NOTE: Hot if the classes came from an earlier run, compare the generation timings of a cold and a hot run
+        chunk_class_cache* Classes = &DemoState->ChunkClasses;
+        BenchmarkRecord(Bench, "chunk_class_cache_hot", Classes->NumLoaded > 0 ? 1.0 : 0.0, "bool");
+        BenchmarkRecord(Bench, "chunk_class_generated_chunks", NumJobs, "chunks");
+        BenchmarkRecord(Bench, "chunk_class_skipped_chunks", f64(DemoState->NumChunkSlots) - NumJobs, "chunks");
+
+        Bench->FrameId += 1;
+        if (Bench->FrameId == BENCHMARK_NUM_FRAMES && !Bench->Written)
+        {
+            f64 CachedLoadMs = BenchmarkGet(Bench, "chunk_cache_load_end_to_end_ms");
+            f64 ColdMs = BenchmarkGet(Bench, "cold_generation_gpu_ms");
+            if (CachedLoadMs > 0.0 && ColdMs > 0.0)
+            {
+                BenchmarkRecord(Bench, "chunk_cache_speedup", ColdMs / CachedLoadMs, "x");
+            }
+            TerrainGpuMemoryRecord(Bench);
+            BenchmarkWriteJson(Bench, BENCHMARK_FILE_NAME);
+        }
+    }
+#endif
+    TerrainPreviewFrameEnd(&DemoState->Preview, ChunkSchedulerAllReady(&DemoState->ChunkScheduler));
+    DemoState->FarField.PrevFrameEnabled = DemoState->FarField.Enabled;
+    if (GenerateTerrain)
+    {
+        DemoState->PrevFrameMesher = Mesher;
+    }
+
+    // NOTE: A new build is about to be loaded
+    if (DemoState->CodeChanged)
+    {
+        DemoWorkerThreadsStop();
+    }
 }
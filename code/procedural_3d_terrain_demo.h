@@ -1,9 +1,45 @@
 #pragma once
 
 #define VALIDATION 1
+#define BENCHMARK 0
+#define SHADER_HOT_RELOAD 1
+#define DEPTH_PREPASS 1 // NOTE: Default for DemoState->DepthPrepass
+#define OVERDRAW_DEBUG 0 // NOTE: Default for DemoState->OverdrawDebug
+#define WORKGROUP_AUTOTUNE 0 // NOTE: Sweeps the chunk kernel workgroup shapes and saves the fastest next to the pipeline cache
+#define FUSED_GENERATION 1 // NOTE: Default for DemoState->FusedGeneration
+#define FP16_GENERATION 0 // NOTE: Default for DemoState->TerrainFp16.Enabled, ignored without shaderFloat16
+#define SURFACE_NETS 0 // NOTE: Default for DemoState->Mesher, 1 meshes with surface nets instead of transvoxel
+#if defined(_WIN32)
+#define DEMO_CODE_FILE_NAME "procedural_3d_terrain_demo.dll" // NOTE: What build.bat writes and the platform layer hot reloads
+#else
+#define DEMO_CODE_FILE_NAME "procedural_3d_terrain_demo.so"
+#endif
+#define TERRAIN_SEED 1 // NOTE: Seeds the noise textures and srand for the light placement
 
 #include "framework_vulkan\framework_vulkan.h"
 
+#include "demo_platform.h"
+#include "demo_gpu_allocator.h"
+#include "demo_upload_ring.h"
+#include "demo_job_queue.h"
+#include "demo_pipelines.h"
+#include "demo_shader_reload.h"
+#include "terrain_benchmark.h"
+#include "demo_workgroup_tuner.h"
+#include "terrain_chunk_cache.h"
+#include "demo_light_clusters.h"
+#include "demo_shadow_cache.h"
+#include "demo_dynamic_resolution.h"
+#include "demo_far_field.h"
+#include "demo_density_pyramid.h"
+#include "terrain_queries.h"
+#include "terrain_fp16.h"
+#include "terrain_chunk_scheduler.h"
+#include "terrain_chunk_residency.h"
+#include "terrain_chunk_class.h"
+#include "terrain_preview.h"
+#include "terrain_cpu_mesher.h"
+
 struct regular_cell_vertices
 {
     u32 Edges[12];
@@ -26,11 +62,137 @@ struct indirect_args
 struct terrain_globals
 {
     v3 Center;
-    u32 Pad0;
+    u32 ChunkRes;
     v3 Radius;
-    u32 Pad1;
+    u32 SlotDim;
     v3 Resolution;
-    u32 Pad2;
+    u32 MaxVerticesPerChunk;
+};
+
+//
+// NOTE: Chunk Generation
+//
+
+// NOTE: Cells per chunk axis, the density slot adds a 1 sample border below and 2 above so normals work across chunk borders
+#define TERRAIN_CHUNK_RES 32
+#define TERRAIN_CHUNK_SLOT_DIM (TERRAIN_CHUNK_RES + 3)
+#define TERRAIN_CHUNK_MAX_VERTICES (5*TERRAIN_CHUNK_RES*TERRAIN_CHUNK_RES*TERRAIN_CHUNK_RES)
+
+// IMPORTANT: Has to match FUSED_GENERATE in procedural_3d_terrain_shaders.cpp
+#define TERRAIN_FUSED_TILE_RES 8
+#define TERRAIN_FUSED_SPEC_WRITE_DENSITY 0
+
+struct chunk_job
+{
+    i32 OriginX;
+    i32 OriginY;
+    i32 OriginZ;
+    u32 Lod;
+    u32 AtlasOffsetX;
+    u32 AtlasOffsetY;
+    u32 AtlasOffsetZ;
+    u32 Slot;
+};
+
+struct chunk_push_constants
+{
+    u32 JobOffset;
+    u32 NumJobs;
+};
+
+struct chunk_batch
+{
+    u32 MaxJobs;
+    u32 NumJobs;
+    chunk_job* Jobs;
+    b32 Dirty;
+
+    gpu_buffer JobBuffer;
+    gpu_buffer DispatchArgs; // NOTE: [0] = density dispatch, [1] = triangles dispatch, [2] = density bricks dispatch, [3] = fused dispatch,
+                             //       [4] = fp16 density dispatch, [5] = fp16 triangles dispatch
+};
+
+/*
+  NOTE: How the chunk kernels get recorded
+
+    - Batched: density for every job, a barrier, then triangles for every job
+    - PerChunk: the same two kernels with one dispatch per chunk, reference for the benchmark
+    - Fused: FUSED_GENERATE meshes straight from shared memory, the density atlas is never written
+    - FusedKeepDensity: fused but the atlas is written too, for the far field and the chunk cache bake
+
+    Every path has an fp16 build, see terrain_fp16.h.
+ */
+enum chunk_generate_path
+{
+    ChunkGeneratePath_Batched,
+    ChunkGeneratePath_PerChunk,
+    ChunkGeneratePath_Fused,
+    ChunkGeneratePath_FusedKeepDensity,
+};
+
+/*
+  NOTE: How the triangles step turns the density into a mesh, both write triangle lists into the same vertex pool
+
+    - Transvoxel: regular cells of the modified marching cubes tables, up to 5 triangles per cell
+    - SurfaceNets: one vertex per cell the surface passes through and one quad per sign changing edge, about half the triangles on
+      smooth terrain. Only the batched and per chunk paths have it, FUSED_GENERATE meshes transvoxel
+ */
+enum terrain_mesher
+{
+    TerrainMesher_Transvoxel,
+    TerrainMesher_SurfaceNets,
+};
+
+// NOTE: Cached chunks further than this from the camera draw their simplified LOD indices
+#define TERRAIN_CHUNK_LOD_DISTANCE 10.0f
+
+struct chunk_shadow_bounds
+{
+    b32 Valid;
+    v3 WorldMin;
+    v3 WorldMax;
+    v2 LightMin; // NOTE: Light space rect, used to pick the chunks a shadow tile draws
+    v2 LightMax;
+};
+
+// NOTE: The staging copies of one cached chunk (density, vertices, indices, lod indices)
+struct chunk_cache_load_job
+{
+    chunk_residency* Residency;
+    u32 EntryId;
+
+    u32 NumCopies;
+    void* Src[4];
+    void* Dst[4];
+    u64 Size[4];
+};
+
+struct cached_chunk_draw
+{
+    u32 FirstIndex;
+    u32 NumIndices;
+    u32 FirstLodIndex;
+    u32 NumLodIndices;
+    u32 NumVertices;
+    i32 VertexOffset;
+    v3 Center; // NOTE: Terrain space
+    chunk_shadow_bounds ShadowBounds;
+};
+
+// IMPORTANT: Has to match forward_shader.cpp
+#define SCENE_FLAG_OVERDRAW 0x1
+
+// NOTE: Overdraw counters are ShadedFragments, CoveredPixels, MaxFragmentsPerPixel followed by one count per pixel. Pixels past
+// OVERDRAW_MAX_PIXELS (render targets over 4K) aren't counted
+#define OVERDRAW_NUM_COUNTERS 4
+#define OVERDRAW_MAX_PIXELS (3840*2160) // IMPORTANT: Has to match forward_shader.cpp
+
+struct overdraw_stats
+{
+    u32 ShadedFragments;
+    u32 CoveredPixels;
+    u32 MaxFragmentsPerPixel;
+    f32 FragmentsPerPixel;
 };
 
 struct scene_globals
@@ -39,6 +201,16 @@ struct scene_globals
     u32 Pad;
     m4 WVPTransform;
     m4 WTransform;
+    m4 VPTransform;
+    u32 NumPointLights;
+    u32 Flags;
+    v2 RenderSize;
+
+    // NOTE: See ShadowCacheSceneGlobals
+    v4 ShadowRight;
+    v4 ShadowUp;
+    v4 ShadowDir;
+    v4 ShadowCascades[SHADOW_NUM_CASCADES];
 };
 
 struct demo_state
@@ -46,6 +218,17 @@ struct demo_state
     linear_arena Arena;
     linear_arena TempArena;
 
+    job_queue JobQueue;
+    // NOTE: Watches for a new build of our DLL, see DemoCodeWatchStart
+    demo_dir_watch CodeWatch;
+    demo_thread CodeWatchThread;
+    b32 CodeWatchRunning;
+    volatile u32 CodeChanged;
+    gpu_allocator GpuAllocator;
+    upload_ring UploadRing;
+    demo_pipelines Pipelines;
+    shader_reload_state ShaderReload;
+
     // NOTE: Samplers
     VkSampler PointSampler;
     VkSampler LinearSampler;
@@ -74,17 +257,81 @@ struct demo_state
     VkDescriptorSet TerrainDescriptor;
     vk_pipeline* GenerateTerrainPso;
     vk_pipeline* GenerateTrianglesPso;
-    VkBuffer TerrainGlobals;
-    vk_image TerrainDensity;
-    VkBuffer CellClasses;
-    VkBuffer RegularCells;
-    VkBuffer RegularCellVertices;
-    VkBuffer IndirectArgBuffer;
-    VkBuffer TerrainTriangles;
+    workgroup_tuner WorkgroupTuner;
+    b32 FusedGeneration;
+    vk_pipeline* FusedGeneratePso;
+    vk_pipeline* FusedGenerateKeepDensityPso;
+
+    terrain_mesher Mesher;
+    terrain_mesher PrevFrameMesher; // NOTE: Mesher of the geometry the previous frame drew, its timestamps come back this frame
+    vk_pipeline* SurfaceNetsPso;
+
+    // NOTE: Draw args readback after generation, only for stats
+    gpu_buffer MeshStatsReadback;
+    b32 MeshStatsPending;
+    terrain_mesher MeshStatsMesher;
+    u64 NumMeshTriangles;
+    u32* SlotNumVertices; // NOTE: Clamped to TERRAIN_CHUNK_MAX_VERTICES, as of the last readback
 
+    // NOTE: FP16 builds of the generation kernels, 0 when the device has no fp16 arithmetic
+    terrain_fp16 TerrainFp16;
+    vk_pipeline* GenerateTerrainFp16Pso;
+    vk_pipeline* GenerateTrianglesFp16Pso;
+    vk_pipeline* FusedGenerateFp16Pso;
+    vk_pipeline* FusedGenerateKeepDensityFp16Pso;
+    vk_pipeline* Fp16ErrorProbePso;
+    gpu_buffer TerrainGlobals;
+    gpu_image TerrainDensity;
+    gpu_buffer CellClasses;
+    gpu_buffer RegularCells;
+    gpu_buffer RegularCellVertices;
+    gpu_buffer ChunkDrawArgs;
+    gpu_buffer TerrainTriangles;
+
+    // NOTE: Chunks, slot i owns atlas region i and vertex pool region i
+    u32 ChunksX;
+    u32 ChunksY;
+    u32 ChunksZ;
+    u32 NumChunkSlots;
+    u32 NumAllocatedSlots; // NOTE: The grid slots followed by the preview slots
+    u32 AtlasSlotsX;
+    u32 AtlasSlotsY;
+    u32 AtlasSlotsZ;
+    chunk_batch ChunkBatch;
+
+    // NOTE: Picks which slots the batch generates each frame, Scheduled* is what the ready slots were generated with
+    chunk_scheduler ChunkScheduler;
+    terrain_mesher ScheduledMesher;
+    b32 ScheduledFp16;
+
+    // NOTE: Shared with the job queue workers, the main thread is thread 0 and SlotResidency is the entry of the chunk in slot i
+    chunk_residency ChunkResidency;
+    u32* SlotResidency;
+
+    // NOTE: Chunks known to be all air or all rock, skipped slots get the constant fills copied into their atlas region
+    chunk_class_cache ChunkClasses;
+    gpu_buffer ChunkClassAirFill;
+    gpu_buffer ChunkClassSolidFill;
+    VkBufferImageCopy* ChunkClassFillRegions;
+
+    // NOTE: Coarse chunks of the whole terrain drawn until the grid chunks around them are ready
+    terrain_preview Preview;
+
+    u32 TerrainSeed;
     u32 NoiseDim;
     VkSampler NoiseSampler;
-    vk_image NoiseTextures[4];
+    gpu_image NoiseTextures[4];
+    f32* NoiseData[4]; // NOTE: CPU copy of the noise textures for terrain queries
+
+    // NOTE: Chunk Cache
+    chunk_archive ChunkArchive;
+    b32 TerrainFromCache;
+    u64 ChunkCacheLoadStart; // NOTE: 0 once the load finished
+    u32 NumCachedChunks;
+    cached_chunk_draw* CachedChunks;
+    gpu_buffer CachedVertices;
+    gpu_buffer CachedIndices;
+    chunk_bake_state ChunkBake;
 
     // NOTE: Render Data
     vk_linear_arena RenderTargetArena;
@@ -93,14 +340,53 @@ struct demo_state
     VkImage DepthImage;
     render_target_entry DepthEntry;
     render_target RenderTarget;
+    dynamic_resolution DynamicRes;
 
     // NOTE: Forward Data
     VkDescriptorSetLayout ForwardDescLayout;
     VkDescriptorSet ForwardDescriptor;
     vk_pipeline* ForwardPipeline;
-    VkBuffer SceneUniforms;
+    uniform_ring SceneUniforms;
+    
+    b32 DepthPrepass;
+    vk_pipeline* DepthPrepassPso;
+    vk_pipeline* ForwardEqualPipeline; // NOTE: Color pass after the depth prepass
+
+    b32 OverdrawDebug;
+    gpu_buffer OverdrawCounters;
+    gpu_buffer OverdrawReadback;
+    b32 OverdrawPending;
+    b32 OverdrawPendingPrepass;
+    overdraw_stats OverdrawSinglePass;
+    overdraw_stats OverdrawPrepass;
+    vk_pipeline* LightClusterPso;
+    light_clusters LightClusters;
+
+    // NOTE: Shadows, slot i of SlotShadowBounds is what chunk slot i currently holds
+    shadow_cache ShadowCache;
+    vk_pipeline* ShadowPso;
+    chunk_shadow_bounds* SlotShadowBounds;
+
+    // NOTE: Far field, ChunkFarCulled is indexed like TerrainDrawChunks walks the chunks (cached chunk id or slot)
+    far_field FarField;
+    vk_pipeline* FarFieldDownsamplePso;
+    vk_pipeline* FarFieldPso;
+    b32* ChunkFarCulled;
+
+    // NOTE: Density min/max pyramid, built right after generation
+    density_pyramid DensityPyramid;
+    vk_pipeline* DensityBricksPso;
+    vk_pipeline* DensityPyramidPso;
+
+    // NOTE: CPU Terrain Queries
+    terrain_queries Queries;
     
     ui_state UiState;
+
+    // NOTE: Profiling
+    b32 FirstFramePresented;
+    gpu_timestamps GpuTimestamps;
+    benchmark_state Benchmark;
 };
 
 global demo_state* DemoState;
@@ -4,8 +4,34 @@
 #extension GL_GOOGLE_include_directive : enable
 #extension GL_ARB_gpu_shader_int64 : enable
 
+// NOTE: The _FP16 kernels are the same kernels with fp16 arithmetic, see terrain_fp16.h
+#if GENERATE_3D_TERRAIN_FP16 || GENERATE_TRIANGLES_FP16 || FUSED_GENERATE_FP16 || FP16_ERROR_PROBE
+#extension GL_EXT_shader_explicit_arithmetic_types_float16 : require
+#define TERRAIN_FP16 1
+#endif
+
+#if GENERATE_3D_TERRAIN_FP16
+#define GENERATE_3D_TERRAIN 1
+#endif
+#if GENERATE_TRIANGLES_FP16
+#define GENERATE_TRIANGLES 1
+#endif
+#if FUSED_GENERATE_FP16
+#define FUSED_GENERATE 1
+#endif
+
+#if TERRAIN_FP16
+#define terrain_float float16_t
+#define terrain_vec3 f16vec3
+#else
+#define terrain_float float
+#define terrain_vec3 vec3
+#endif
+
 #define PACK_VERTICES 1
 
+#include "shader_density_pyramid.cpp"
+
 // NOTE: The RegularCellData structure holds information about the triangulation
 // used for a single equivalence class in the modified Marching Cubes algorithm,
 // described in Section 3.2.
@@ -39,13 +65,25 @@ struct indirect_args
     uint StartInstanceIndex;
 };
 
+struct chunk_job
+{
+    ivec3 Origin; // NOTE: In terrain samples
+    uint Lod;
+    uvec3 AtlasOffset;
+    uint Slot;
+};
+
 layout(set = 0, binding = 0) uniform terrain_globals
 {
     vec3 Center;
+    uint ChunkRes;
     vec3 Radius;
+    uint SlotDim;
     vec3 Resolution;
+    uint MaxVerticesPerChunk;
 } TerrainGlobals;
 
+// NOTE: Density atlas, each chunk owns a SlotDim^3 region with a one sample border on the low side and two on the high side
 layout(set = 0, binding = 1, r16f) uniform image3D TerrainDensity;
 
 // TODO: This can be compressed since each element is 16bits
@@ -64,11 +102,12 @@ layout(set = 0, binding = 4, std430) buffer regular_cell_vertices_buffer
     regular_cell_vertices RegularCellVertices[256];
 };
 
-layout(set = 0, binding = 5) buffer indirect_arg_buffer
+layout(set = 0, binding = 5) buffer chunk_draw_arg_buffer
 {
-    indirect_args IndirectArgs;
+    indirect_args ChunkDrawArgs[];
 };
 
+// NOTE: Shared vertex pool, each chunk slot owns MaxVerticesPerChunk vertices
 layout(set = 0, binding = 6) buffer triangle_list
 {
     vec4 TerrainTriangleList[];
@@ -76,47 +115,332 @@ layout(set = 0, binding = 6) buffer triangle_list
 
 layout(set = 0, binding = 7) uniform sampler3D NoiseTextures[4];
 
+layout(set = 0, binding = 8) buffer chunk_job_buffer
+{
+    chunk_job ChunkJobs[];
+};
+
+// IMPORTANT: Has to match demo_far_field.h
+#define FAR_FIELD_NUM_LEVELS 4
+
+// NOTE: Downsampled copies of the whole terrain for the far field trace, level 0 is half the terrain resolution
+layout(set = 0, binding = 9, r16f) uniform image3D FarFieldLevels[FAR_FIELD_NUM_LEVELS];
+
+// NOTE: Min/max pyramid over every chunk slot, see shader_density_pyramid.cpp
+layout(set = 0, binding = 10, std430) buffer density_pyramid_buffer
+{
+    vec2 DensityPyramid[];
+};
+
+// NOTE: Written by FP16_ERROR_PROBE, the errors are positive floats so their bits order like uints
+layout(set = 0, binding = 11, std430) buffer fp16_error_buffer
+{
+    uint Fp16MaxVertexError;
+    uint Fp16MaxNormalError;
+    uint Fp16SurfaceCells;
+    uint Fp16MismatchCells;
+};
+
+#if FAR_FIELD_DOWNSAMPLE
+layout(push_constant) uniform far_field_build_constants
+{
+    uint Level;
+} FarFieldBuild;
+#else
+layout(push_constant) uniform chunk_push_constants
+{
+    uint JobOffset;
+    uint NumJobs;
+} ChunkPush;
+#endif
+
+#if !FAR_FIELD_DOWNSAMPLE
+
+// NOTE: All chunks are batched into one dispatch, gl_WorkGroupID.z / GroupsPerChunk picks the job and the rest is the local position
+bool ChunkGetJob(uint GroupsPerChunk, out chunk_job Job, out uvec3 LocalId)
+{
+    uint JobId = ChunkPush.JobOffset + gl_WorkGroupID.z / GroupsPerChunk;
+    if (JobId >= ChunkPush.NumJobs)
+    {
+        return false;
+    }
+
+    Job = ChunkJobs[JobId];
+    LocalId = uvec3(gl_GlobalInvocationID.xy, (gl_WorkGroupID.z % GroupsPerChunk)*gl_WorkGroupSize.z + gl_LocalInvocationID.z);
+    return true;
+}
+
+#endif
+
 //=========================================================================================================================================
-// NOTE: Generate 3d Terrain
+// NOTE: Density Function
 //=========================================================================================================================================
 
-#if GENERATE_3D_TERRAIN
+#if GENERATE_3D_TERRAIN || FUSED_GENERATE || FP16_ERROR_PROBE
 
-layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
-void main()
+vec3 TerrainSampleUv(chunk_job Job, vec3 SlotSample)
 {
-    if (gl_GlobalInvocationID.x < TerrainGlobals.Resolution.x &&
-        gl_GlobalInvocationID.y < TerrainGlobals.Resolution.y &&
-        gl_GlobalInvocationID.z < TerrainGlobals.Resolution.z)
-    {
-        // NOTE: Remap our thread id to world space position
-        vec3 Uv = 2.0f * (gl_GlobalInvocationID / TerrainGlobals.Resolution) - vec3(1.0f);
-        vec3 WorldSpacePos = TerrainGlobals.Center + Uv * TerrainGlobals.Radius;
+    vec3 SamplePos = vec3(Job.Origin) + (SlotSample - vec3(1)) * float(1 << Job.Lod);
+    vec3 Result = 2.0f * (SamplePos / TerrainGlobals.Resolution) - vec3(1.0f);
+    return Result;
+}
 
-        // NOTE: Generate a density value
-        float Density = -WorldSpacePos.y;
+// NOTE: Density at a sample of the jobs slot, slot sample 0 is one step outside of the chunk
+float TerrainDensityEvaluate(chunk_job Job, vec3 SlotSample)
+{
+    // NOTE: Remap our thread id to world space position
+    vec3 Uv = TerrainSampleUv(Job, SlotSample);
+    vec3 WorldSpacePos = TerrainGlobals.Center + Uv * TerrainGlobals.Radius;
+
+    // NOTE: Generate a density value
+    float Density = -WorldSpacePos.y;
 
-        // NOTE: Add noise
+    // NOTE: Add noise
 #if 1
-        //Density += texture(NoiseTextures[0], WorldSpacePos).x;
-        Density += texture(NoiseTextures[0], Uv*9.53).x*0.07;
-        Density += texture(NoiseTextures[1], Uv*6.03).x*0.13; 
-        Density += texture(NoiseTextures[0], Uv*4.03).x*0.25;
-        Density += texture(NoiseTextures[1], Uv*1.96).x*0.50;
-        Density += texture(NoiseTextures[2], Uv*1.01).x*1.00; 
-        Density += texture(NoiseTextures[3], Uv*0.87).x*1.00;
-        Density += texture(NoiseTextures[0], Uv*0.54).x*1.00;
-        Density += texture(NoiseTextures[1], Uv*0.32).x*1.55; 
+    //Density += texture(NoiseTextures[0], WorldSpacePos).x;
+    Density += texture(NoiseTextures[0], Uv*9.53).x*0.07;
+    Density += texture(NoiseTextures[1], Uv*6.03).x*0.13; 
+    Density += texture(NoiseTextures[0], Uv*4.03).x*0.25;
+    Density += texture(NoiseTextures[1], Uv*1.96).x*0.50;
+    Density += texture(NoiseTextures[2], Uv*1.01).x*1.00; 
+    Density += texture(NoiseTextures[3], Uv*0.87).x*1.00;
+    Density += texture(NoiseTextures[0], Uv*0.54).x*1.00;
+    Density += texture(NoiseTextures[1], Uv*0.32).x*1.55; 
 #endif
 
-        Density -= 3.5f;
+    Density -= 3.5f;
         
-        // NOTE: Create floors
-        //float HardFloor = 0.7;
-        //Density += clamp((HardFloor - Uv.y)*3, 0, 1)*40; 
+    // NOTE: Create floors
+    //float HardFloor = 0.7;
+    //Density += clamp((HardFloor - Uv.y)*3, 0, 1)*40; 
+
+    return Density;
+}
+
+#if TERRAIN_FP16
+
+/*
+  NOTE: Same octaves as TerrainDensityEvaluate, paired up into f16vec2 so the multiply adds run packed. The uvs stay fp32, 11 bits of
+        mantissa can't address the noise texels at the high frequencies
+ */
+float16_t TerrainDensityEvaluateFp16(chunk_job Job, vec3 SlotSample)
+{
+    vec3 Uv = TerrainSampleUv(Job, SlotSample);
+    float WorldSpacePosY = TerrainGlobals.Center.y + Uv.y * TerrainGlobals.Radius.y;
+
+    f16vec2 Octaves = f16vec2(0);
+    Octaves += f16vec2(texture(NoiseTextures[0], Uv*9.53).x, texture(NoiseTextures[1], Uv*6.03).x) * f16vec2(0.07, 0.13);
+    Octaves += f16vec2(texture(NoiseTextures[0], Uv*4.03).x, texture(NoiseTextures[1], Uv*1.96).x) * f16vec2(0.25, 0.50);
+    Octaves += f16vec2(texture(NoiseTextures[2], Uv*1.01).x, texture(NoiseTextures[3], Uv*0.87).x) * f16vec2(1.00, 1.00);
+    Octaves += f16vec2(texture(NoiseTextures[0], Uv*0.54).x, texture(NoiseTextures[1], Uv*0.32).x) * f16vec2(1.00, 1.55);
+
+    float16_t Result = float16_t(-WorldSpacePosY - 3.5f) + Octaves.x + Octaves.y;
+    return Result;
+}
+
+#endif
+
+// NOTE: Density in the precision the kernel was built for
+terrain_float TerrainDensitySample(chunk_job Job, vec3 SlotSample)
+{
+#if TERRAIN_FP16
+    terrain_float Result = TerrainDensityEvaluateFp16(Job, SlotSample);
+#else
+    terrain_float Result = TerrainDensityEvaluate(Job, SlotSample);
+#endif
+    return Result;
+}
+
+#endif
+
+//=========================================================================================================================================
+// NOTE: Cell Triangulation
+//=========================================================================================================================================
+
+#if GENERATE_TRIANGLES || FUSED_GENERATE || FP16_ERROR_PROBE || GENERATE_SURFACE_NETS
+
+uint TerrainCellCaseByte(float Densities[8])
+{
+    uint CaseBit0 = Densities[0] >= 0 ? 0x1 : 0x0;
+    uint CaseBit1 = Densities[1] >= 0 ? 0x1 : 0x0;
+    uint CaseBit2 = Densities[2] >= 0 ? 0x1 : 0x0;
+    uint CaseBit3 = Densities[3] >= 0 ? 0x1 : 0x0;
+    uint CaseBit4 = Densities[4] >= 0 ? 0x1 : 0x0;
+    uint CaseBit5 = Densities[5] >= 0 ? 0x1 : 0x0;
+    uint CaseBit6 = Densities[6] >= 0 ? 0x1 : 0x0;
+    uint CaseBit7 = Densities[7] >= 0 ? 0x1 : 0x0;
+    uint Result = ((CaseBit0 << 0) | (CaseBit1 << 1) | (CaseBit2 << 2) | (CaseBit3 << 3) |
+                   (CaseBit4 << 4) | (CaseBit5 << 5) | (CaseBit6 << 6) | (CaseBit7 << 7));
+    return Result;
+}
+
+#if TERRAIN_FP16
+uint TerrainCellCaseByte(float16_t Densities[8])
+{
+    uint Result = 0;
+    for (uint CornerId = 0; CornerId < 8; ++CornerId)
+    {
+        Result |= (Densities[CornerId] >= float16_t(0) ? 0x1 : 0x0) << CornerId;
+    }
+    return Result;
+}
+#endif
+
+// NOTE: Cases 0 and 255 are empty
+bool TerrainCellHasSurface(uint CaseByte)
+{
+    bool Result = CaseByte != 0 && CaseByte != 0xFF;
+    return Result;
+}
+
+// NOTE: Converts a position in terrain samples to the vertex pools format
+vec4 TerrainVertexPack(vec3 Vertex, vec3 Normal)
+{
+    Vertex = (2.0f * Vertex / TerrainGlobals.Resolution) - vec3(1);
+
+#if PACK_VERTICES
+    // NOTE: Pack to fixed point
+    vec2 PackedPos;
+    {
+        // NOTE: Convert to 32bit fixed point
+#define I32_MIN -2147483648
+        Vertex *= -I32_MIN;
+        int PosX = int(Vertex.x + 0.5f);
+        int PosY = int(Vertex.y + 0.5f);
+        int PosZ = int(Vertex.z + 0.5f);
+
+        // NOTE: Only keep top 21:21:20 bits
+        int64_t PosX64 = PosX;
+        int64_t PosY64 = PosY;
+        int64_t PosZ64 = PosZ;
+        PosX64 = (PosX64 >> 11u) & 0x1FFFFF;
+        PosY64 = (PosY64 >> 11u) & 0x1FFFFF;
+        PosZ64 = (PosZ64 >> 12u) & 0x0FFFFF;
+            
+        // NOTE: Pack as a U64
+        int64_t PackedVertex = (PosX64 << 0u) | (PosY64 << 21u) | (PosZ64 << 42u);
+        PackedPos = vec2(intBitsToFloat(unpackInt2x32(PackedVertex)));
+    }
+
+    // NOTE: Pack Normals
+    vec4 Result = vec4(PackedPos, Normal.xy);
+#else
+    vec4 Result = vec4(Vertex, 1);
+#endif
+
+    return Result;
+}
+
+/*
+  NOTE: Reserves NumVertices in the slots region of the vertex pool, returns false when the region is full. The count doubles as the
+        indirect draws vertex count, so a reservation that doesn't fit is never added to it
+ */
+bool TerrainVerticesAllocate(uint Slot, uint NumVertices, out uint StartVertexId)
+{
+    StartVertexId = 0;
+    uint LocalVertexId = ChunkDrawArgs[Slot].NumVerticesPerInstance;
+    while (LocalVertexId + NumVertices <= TerrainGlobals.MaxVerticesPerChunk)
+    {
+        uint PrevVertexId = atomicCompSwap(ChunkDrawArgs[Slot].NumVerticesPerInstance, LocalVertexId, LocalVertexId + NumVertices);
+        if (PrevVertexId == LocalVertexId)
+        {
+            StartVertexId = Slot*TerrainGlobals.MaxVerticesPerChunk + LocalVertexId;
+            return true;
+        }
+
+        LocalVertexId = PrevVertexId;
+    }
+
+    return false;
+}
+
+#endif
+
+#if GENERATE_TRIANGLES || FUSED_GENERATE || FP16_ERROR_PROBE
+
+/*
+  NOTE: Triangulates one cell into its slots region of the vertex pool. Corners are in sample units, a vertex ends up at
+        Corner*SampleScale + SampleOffset in terrain samples
+ */
+void TerrainCellEmit(uint Slot, uint CaseByte, vec3 Corners[8], terrain_float Densities[8], terrain_vec3 CornerNormals[8], float SampleScale,
+                     vec3 SampleOffset)
+{
+    uint RegularCellId = CellClasses[CaseByte];
+    regular_cell_data RegularCell = RegularCells[RegularCellId];
+    regular_cell_vertices PackedVertices = RegularCellVertices[CaseByte];
+
+    // NOTE: Generate triangle list from loaded cell data
+    // TODO: Right now I don't do any vertex reuse just to make sure I generate valid data
+    vec4 Vertices[12];
+    for (uint VertexId = 0; VertexId < GetVertexCount(RegularCell); ++VertexId)
+    {
+        uint Edge = PackedVertices.Edges[VertexId];
+        uint FirstVertexId = Edge & 0xF;
+        uint SecondVertexId = (Edge >> 4) & 0xF;
+
+        vec3 FirstCorner = Corners[FirstVertexId];
+        vec3 SecondCorner = Corners[SecondVertexId];
+
+        // NOTE: Interpolate according to density value, only T is in the kernels precision, the position math stays fp32
+        terrain_float FirstDensity = Densities[FirstVertexId];
+        terrain_float SecondDensity = Densities[SecondVertexId];
+        terrain_float T = SecondDensity / (SecondDensity - FirstDensity);
+                
+        vec3 Vertex = mix(FirstCorner, SecondCorner, float(T))*SampleScale + SampleOffset;
+        vec3 Normal = vec3(normalize(mix(CornerNormals[FirstVertexId], CornerNormals[SecondVertexId], T)));
+        Vertices[VertexId] = TerrainVertexPack(Vertex, Normal);
+    }
+            
+    // NOTE: Write out our triangle list into this chunks region of the vertex pool
+    uint NumTriangles = GetTriangleCount(RegularCell);
+    uint StartVertexId;
+    if (!TerrainVerticesAllocate(Slot, NumTriangles*3, StartVertexId))
+    {
+        return;
+    }
+            
+    for (uint TriangleId = 0; TriangleId < NumTriangles; ++TriangleId)
+    {
+        TerrainTriangleList[StartVertexId + 3*TriangleId + 0] = Vertices[RegularCell.VertexIndex[3*TriangleId + 0]];
+        TerrainTriangleList[StartVertexId + 3*TriangleId + 1] = Vertices[RegularCell.VertexIndex[3*TriangleId + 1]];
+        TerrainTriangleList[StartVertexId + 3*TriangleId + 2] = Vertices[RegularCell.VertexIndex[3*TriangleId + 2]];
+    }
+}
+
+#endif
+
+//=========================================================================================================================================
+// NOTE: Generate 3d Terrain
+//=========================================================================================================================================
+
+#if GENERATE_3D_TERRAIN
+
+// NOTE: Workgroup shape is picked per device, see demo_workgroup_tuner.h
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4, local_size_x_id = 0, local_size_y_id = 1, local_size_z_id = 2) in;
+void main()
+{
+    chunk_job Job;
+    uvec3 LocalId;
+    if (!ChunkGetJob((TerrainGlobals.SlotDim + gl_WorkGroupSize.z - 1) / gl_WorkGroupSize.z, Job, LocalId))
+    {
+        return;
+    }
+    
+    // NOTE: Reset the draw args here instead of uploading them every frame, GENERATE_TRIANGLES runs after a barrier
+    if (LocalId == uvec3(0))
+    {
+        ChunkDrawArgs[Job.Slot].NumVerticesPerInstance = 0;
+        ChunkDrawArgs[Job.Slot].NumInstances = 1;
+        ChunkDrawArgs[Job.Slot].StartVertexIndex = Job.Slot*TerrainGlobals.MaxVerticesPerChunk;
+        ChunkDrawArgs[Job.Slot].StartInstanceIndex = 0;
+    }
+    
+    if (all(lessThan(LocalId, uvec3(TerrainGlobals.SlotDim))))
+    {
+        float Density = float(TerrainDensitySample(Job, vec3(LocalId)));
         
         // NOTE: Write out the density
-        imageStore(TerrainDensity, ivec3(gl_GlobalInvocationID), vec4(Density, 0, 0, 0));
+        imageStore(TerrainDensity, ivec3(Job.AtlasOffset + LocalId), vec4(Density, 0, 0, 0));
     }
 }
 
@@ -128,157 +452,698 @@ void main()
 
 #if GENERATE_TRIANGLES
 
-vec3 GenerateNormals(ivec3 Origin)
+terrain_vec3 GenerateNormals(ivec3 Origin)
 {
-    vec3 Gradient;
-    Gradient.x = imageLoad(TerrainDensity, Origin + ivec3(1, 0, 0)).x - imageLoad(TerrainDensity, Origin - ivec3(1, 0, 0)).x;
-    Gradient.y = imageLoad(TerrainDensity, Origin + ivec3(0, 1, 0)).x - imageLoad(TerrainDensity, Origin - ivec3(0, 1, 0)).x;
-    Gradient.z = imageLoad(TerrainDensity, Origin + ivec3(0, 0, 1)).x - imageLoad(TerrainDensity, Origin - ivec3(0, 0, 1)).x;
+    terrain_vec3 High = terrain_vec3(imageLoad(TerrainDensity, Origin + ivec3(1, 0, 0)).x, imageLoad(TerrainDensity, Origin + ivec3(0, 1, 0)).x,
+                                     imageLoad(TerrainDensity, Origin + ivec3(0, 0, 1)).x);
+    terrain_vec3 Low = terrain_vec3(imageLoad(TerrainDensity, Origin - ivec3(1, 0, 0)).x, imageLoad(TerrainDensity, Origin - ivec3(0, 1, 0)).x,
+                                    imageLoad(TerrainDensity, Origin - ivec3(0, 0, 1)).x);
 
-    vec3 Result = -normalize(Gradient);
+    terrain_vec3 Result = -normalize(High - Low);
     return Result;
 }
 
-layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+// NOTE: Workgroup shape is picked per device, see demo_workgroup_tuner.h
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4, local_size_x_id = 0, local_size_y_id = 1, local_size_z_id = 2) in;
 void main()
 {
-    if (gl_GlobalInvocationID.x < TerrainGlobals.Resolution.x - 1 &&
-        gl_GlobalInvocationID.y < TerrainGlobals.Resolution.y - 1 &&
-        gl_GlobalInvocationID.z < TerrainGlobals.Resolution.z - 1)
+    chunk_job Job;
+    uvec3 LocalId;
+    if (!ChunkGetJob((TerrainGlobals.ChunkRes + gl_WorkGroupSize.z - 1) / gl_WorkGroupSize.z, Job, LocalId))
+    {
+        return;
+    }
+
+    // NOTE: Cells leave when their chunk or brick can't hold any surface, with 4x4x4 groups that is the whole group at once
+    if (!DensityHasSurface(DensityPyramid[DensityPyramidNode(Job.Slot, 0, uvec3(0))]) ||
+        !DensityHasSurface(DensityPyramid[DensityPyramidNode(Job.Slot, DENSITY_PYRAMID_LEVELS - 1, LocalId / DENSITY_BRICK_RES)]))
     {
-        // NOTE: Find the 8 corner uvs
+        return;
+    }
+    
+    if (all(lessThan(LocalId, uvec3(TerrainGlobals.ChunkRes))))
+    {
+        // NOTE: Find the 8 corner uvs in the atlas (skipping the border sample)
+        ivec3 CellOrigin = ivec3(Job.AtlasOffset + LocalId) + ivec3(1);
         ivec3 Corners[8];
-        Corners[0] = ivec3(gl_GlobalInvocationID) + ivec3(0, 0, 0);
-        Corners[1] = ivec3(gl_GlobalInvocationID) + ivec3(1, 0, 0);
-        Corners[2] = ivec3(gl_GlobalInvocationID) + ivec3(0, 1, 0);
-        Corners[3] = ivec3(gl_GlobalInvocationID) + ivec3(1, 1, 0);
-        Corners[4] = ivec3(gl_GlobalInvocationID) + ivec3(0, 0, 1);
-        Corners[5] = ivec3(gl_GlobalInvocationID) + ivec3(1, 0, 1);
-        Corners[6] = ivec3(gl_GlobalInvocationID) + ivec3(0, 1, 1);
-        Corners[7] = ivec3(gl_GlobalInvocationID) + ivec3(1, 1, 1);
+        Corners[0] = CellOrigin + ivec3(0, 0, 0);
+        Corners[1] = CellOrigin + ivec3(1, 0, 0);
+        Corners[2] = CellOrigin + ivec3(0, 1, 0);
+        Corners[3] = CellOrigin + ivec3(1, 1, 0);
+        Corners[4] = CellOrigin + ivec3(0, 0, 1);
+        Corners[5] = CellOrigin + ivec3(1, 0, 1);
+        Corners[6] = CellOrigin + ivec3(0, 1, 1);
+        Corners[7] = CellOrigin + ivec3(1, 1, 1);
+
+        // NOTE: Atlas coords -> terrain sample coords for the vertex positions
+        vec3 SampleOffset = vec3(Job.Origin) - vec3(Job.AtlasOffset + uvec3(1)) * float(1 << Job.Lod);
+        float SampleScale = float(1 << Job.Lod);
 
         // NOTE: Sample the density at each corner
-        float Densities[8];
-        Densities[0] = imageLoad(TerrainDensity, Corners[0]).x;
-        Densities[1] = imageLoad(TerrainDensity, Corners[1]).x;
-        Densities[2] = imageLoad(TerrainDensity, Corners[2]).x;
-        Densities[3] = imageLoad(TerrainDensity, Corners[3]).x;
-        Densities[4] = imageLoad(TerrainDensity, Corners[4]).x;
-        Densities[5] = imageLoad(TerrainDensity, Corners[5]).x;
-        Densities[6] = imageLoad(TerrainDensity, Corners[6]).x;
-        Densities[7] = imageLoad(TerrainDensity, Corners[7]).x;
-
-        vec3 CornerNormals[8];
-        CornerNormals[0] = GenerateNormals(Corners[0]);
-        CornerNormals[1] = GenerateNormals(Corners[1]);
-        CornerNormals[2] = GenerateNormals(Corners[2]);
-        CornerNormals[3] = GenerateNormals(Corners[3]);
-        CornerNormals[4] = GenerateNormals(Corners[4]);
-        CornerNormals[5] = GenerateNormals(Corners[5]);
-        CornerNormals[6] = GenerateNormals(Corners[6]);
-        CornerNormals[7] = GenerateNormals(Corners[7]);
-        
-        // NOTE: Generate case byte
-        uint CaseBit0 = Densities[0] >= 0 ? 0x1 : 0x0;
-        uint CaseBit1 = Densities[1] >= 0 ? 0x1 : 0x0;
-        uint CaseBit2 = Densities[2] >= 0 ? 0x1 : 0x0;
-        uint CaseBit3 = Densities[3] >= 0 ? 0x1 : 0x0;
-        uint CaseBit4 = Densities[4] >= 0 ? 0x1 : 0x0;
-        uint CaseBit5 = Densities[5] >= 0 ? 0x1 : 0x0;
-        uint CaseBit6 = Densities[6] >= 0 ? 0x1 : 0x0;
-        uint CaseBit7 = Densities[7] >= 0 ? 0x1 : 0x0;
-        uint CaseByte = ((CaseBit0 << 0) | (CaseBit1 << 1) | (CaseBit2 << 2) | (CaseBit3 << 3) |
-                         (CaseBit4 << 4) | (CaseBit5 << 5) | (CaseBit6 << 6) | (CaseBit7 << 7));
-
-        // NOTE: Skip cases 0 and 255 since they are empty
-        if ((CaseByte ^ ((CaseBit7 >> 7) & 0xFF)) != 0)
+        terrain_float Densities[8];
+        Densities[0] = terrain_float(imageLoad(TerrainDensity, Corners[0]).x);
+        Densities[1] = terrain_float(imageLoad(TerrainDensity, Corners[1]).x);
+        Densities[2] = terrain_float(imageLoad(TerrainDensity, Corners[2]).x);
+        Densities[3] = terrain_float(imageLoad(TerrainDensity, Corners[3]).x);
+        Densities[4] = terrain_float(imageLoad(TerrainDensity, Corners[4]).x);
+        Densities[5] = terrain_float(imageLoad(TerrainDensity, Corners[5]).x);
+        Densities[6] = terrain_float(imageLoad(TerrainDensity, Corners[6]).x);
+        Densities[7] = terrain_float(imageLoad(TerrainDensity, Corners[7]).x);
+
+        // NOTE: Only cells the surface passes through need their normals
+        uint CaseByte = TerrainCellCaseByte(Densities);
+        if (TerrainCellHasSurface(CaseByte))
         {
-            uint RegularCellId = CellClasses[CaseByte];
-            regular_cell_data RegularCell = RegularCells[RegularCellId];
-            regular_cell_vertices PackedVertices = RegularCellVertices[CaseByte];
+            vec3 CornerPositions[8];
+            terrain_vec3 CornerNormals[8];
+            for (uint CornerId = 0; CornerId < 8; ++CornerId)
+            {
+                CornerPositions[CornerId] = vec3(Corners[CornerId]);
+                CornerNormals[CornerId] = GenerateNormals(Corners[CornerId]);
+            }
+            
+            TerrainCellEmit(Job.Slot, CaseByte, CornerPositions, Densities, CornerNormals, SampleScale, SampleOffset);
+        }
+    }
+}
 
-            // NOTE: Generate triangle list from loaded cell data
-            // TODO: Right now I don't do any vertex reuse just to make sure I generate valid data
-#if PACK_VERTICES
-            vec2 Vertices[12];
-            vec2 Normals[12];
-#else
-            vec3 Vertices[12];
 #endif
-            for (uint VertexId = 0; VertexId < GetVertexCount(RegularCell); ++VertexId)
-            {
-                uint Edge = PackedVertices.Edges[VertexId];
-                uint FirstVertexId = Edge & 0xF;
-                uint SecondVertexId = (Edge >> 4) & 0xF;
 
-                ivec3 FirstCorner = Corners[FirstVertexId];
-                ivec3 SecondCorner = Corners[SecondVertexId];
+//=========================================================================================================================================
+// NOTE: Generate Surface Nets
+//=========================================================================================================================================
 
-                // NOTE: Interpolate according to density value
-                float FirstDensity = Densities[FirstVertexId];
-                float SecondDensity = Densities[SecondVertexId];
-                float T = SecondDensity / (SecondDensity - FirstDensity);
-                
-                vec3 Vertex = mix(vec3(FirstCorner), vec3(SecondCorner), T);
-                Vertex = (2.0f * Vertex / TerrainGlobals.Resolution) - vec3(1);
+#if GENERATE_SURFACE_NETS
+
+/*
+  NOTE: Dual mesher, every cell the surface passes through gets one vertex at the mean of its edge crossings and every sign changing
+        edge gets a quad between the 4 cells around it. Reads the same atlas and writes the same vertex pool as GENERATE_TRIANGLES.
+
+        A cell owns the 3 edges leaving its low corner, so the quads of a chunk need the vertices of the cells one step below it. The
+        atlas has the low border sample for exactly that. Groups are one density brick, they first place the vertices of their 5^3
+        cell neighbourhood in shared memory and then emit their quads from there.
+ */
+
+#define SURFACE_NETS_REGION_DIM (DENSITY_BRICK_RES + 1)
+#define SURFACE_NETS_REGION_CELLS (SURFACE_NETS_REGION_DIM*SURFACE_NETS_REGION_DIM*SURFACE_NETS_REGION_DIM)
+
+shared vec4 NetVertices[SURFACE_NETS_REGION_CELLS]; // NOTE: xyz in atlas samples, w = 1 when the cell has a vertex
+shared vec3 NetNormals[SURFACE_NETS_REGION_CELLS];
+
+uint SurfaceNetsRegionId(uvec3 RegionPos)
+{
+    uint Result = (RegionPos.z*SURFACE_NETS_REGION_DIM + RegionPos.y)*SURFACE_NETS_REGION_DIM + RegionPos.x;
+    return Result;
+}
+
+// NOTE: Vertex of the cell whose low corner is CellOrigin, w is 0 when the surface doesn't pass through it
+vec4 SurfaceNetsCellVertex(ivec3 CellOrigin, out vec3 Normal)
+{
+    float Densities[8];
+    for (uint CornerId = 0; CornerId < 8; ++CornerId)
+    {
+        ivec3 Offset = ivec3(CornerId & 1, (CornerId >> 1) & 1, (CornerId >> 2) & 1);
+        Densities[CornerId] = imageLoad(TerrainDensity, CellOrigin + Offset).x;
+    }
+
+    Normal = vec3(0, 1, 0);
+    if (!TerrainCellHasSurface(TerrainCellCaseByte(Densities)))
+    {
+        return vec4(0);
+    }
+
+    // NOTE: Edges as corner pairs, 4 along each axis
+    const uvec2 Edges[12] = uvec2[12](uvec2(0, 1), uvec2(2, 3), uvec2(4, 5), uvec2(6, 7),
+                                      uvec2(0, 2), uvec2(1, 3), uvec2(4, 6), uvec2(5, 7),
+                                      uvec2(0, 4), uvec2(1, 5), uvec2(2, 6), uvec2(3, 7));
+    vec3 CrossingSum = vec3(0);
+    float NumCrossings = 0.0f;
+    for (uint EdgeId = 0; EdgeId < 12; ++EdgeId)
+    {
+        float FirstDensity = Densities[Edges[EdgeId].x];
+        float SecondDensity = Densities[Edges[EdgeId].y];
+        if ((FirstDensity >= 0) != (SecondDensity >= 0))
+        {
+            uint FirstId = Edges[EdgeId].x;
+            uint SecondId = Edges[EdgeId].y;
+            vec3 FirstCorner = vec3(FirstId & 1, (FirstId >> 1) & 1, (FirstId >> 2) & 1);
+            vec3 SecondCorner = vec3(SecondId & 1, (SecondId >> 1) & 1, (SecondId >> 2) & 1);
+            CrossingSum += mix(FirstCorner, SecondCorner, FirstDensity / (FirstDensity - SecondDensity));
+            NumCrossings += 1.0f;
+        }
+    }
+
+    // NOTE: Gradient of the trilinear density at the cell center, only needs the 8 corners we already have
+    vec3 Gradient = vec3((Densities[1] + Densities[3] + Densities[5] + Densities[7]) - (Densities[0] + Densities[2] + Densities[4] + Densities[6]),
+                         (Densities[2] + Densities[3] + Densities[6] + Densities[7]) - (Densities[0] + Densities[1] + Densities[4] + Densities[5]),
+                         (Densities[4] + Densities[5] + Densities[6] + Densities[7]) - (Densities[0] + Densities[1] + Densities[2] + Densities[3]));
+    if (dot(Gradient, Gradient) > 0.0f)
+    {
+        Normal = -normalize(Gradient);
+    }
+
+    vec4 Result = vec4(vec3(CellOrigin) + CrossingSum / NumCrossings, 1.0f);
+    return Result;
+}
+
+// NOTE: Same dispatch as BUILD_DENSITY_BRICKS, one group per brick
+layout(local_size_x = DENSITY_BRICK_RES, local_size_y = DENSITY_BRICK_RES, local_size_z = DENSITY_BRICK_RES) in;
+void main()
+{
+    chunk_job Job;
+    uvec3 LocalId;
+    if (!ChunkGetJob(TerrainGlobals.ChunkRes / DENSITY_BRICK_RES, Job, LocalId))
+    {
+        return;
+    }
+
+    // NOTE: The edges a cell owns lie inside of it so the brick test holds, and it is uniform over the group so the barrier is safe
+    if (!DensityHasSurface(DensityPyramid[DensityPyramidNode(Job.Slot, 0, uvec3(0))]) ||
+        !DensityHasSurface(DensityPyramid[DensityPyramidNode(Job.Slot, DENSITY_PYRAMID_LEVELS - 1, LocalId / DENSITY_BRICK_RES)]))
+    {
+        return;
+    }
+
+    // NOTE: Place the vertices of the bricks cells and of the cells one step below them, region cell 0 is brick cell -1
+    ivec3 RegionOrigin = ivec3(Job.AtlasOffset + LocalId - gl_LocalInvocationID);
+    for (uint RegionId = gl_LocalInvocationIndex; RegionId < SURFACE_NETS_REGION_CELLS; RegionId += gl_WorkGroupSize.x*gl_WorkGroupSize.y*gl_WorkGroupSize.z)
+    {
+        uvec3 RegionPos = uvec3(RegionId % SURFACE_NETS_REGION_DIM, (RegionId / SURFACE_NETS_REGION_DIM) % SURFACE_NETS_REGION_DIM,
+                                RegionId / (SURFACE_NETS_REGION_DIM*SURFACE_NETS_REGION_DIM));
+        vec3 Normal;
+        NetVertices[RegionId] = SurfaceNetsCellVertex(RegionOrigin + ivec3(RegionPos), Normal);
+        NetNormals[RegionId] = Normal;
+    }
+
+    barrier();
+
+    // NOTE: Atlas coords -> terrain sample coords for the vertex positions
+    vec3 SampleOffset = vec3(Job.Origin) - vec3(Job.AtlasOffset + uvec3(1)) * float(1 << Job.Lod);
+    float SampleScale = float(1 << Job.Lod);
+
+    // NOTE: Our low corner and the far end of the 3 edges it owns
+    ivec3 CellOrigin = ivec3(Job.AtlasOffset + LocalId) + ivec3(1);
+    float Density = imageLoad(TerrainDensity, CellOrigin).x;
+    vec3 EdgeDensities = vec3(imageLoad(TerrainDensity, CellOrigin + ivec3(1, 0, 0)).x, imageLoad(TerrainDensity, CellOrigin + ivec3(0, 1, 0)).x,
+                              imageLoad(TerrainDensity, CellOrigin + ivec3(0, 0, 1)).x);
+
+    uint NumQuads = 0;
+    bool QuadAxes[3];
+    for (uint Axis = 0; Axis < 3; ++Axis)
+    {
+        QuadAxes[Axis] = (Density >= 0) != (EdgeDensities[Axis] >= 0);
+        NumQuads += QuadAxes[Axis] ? 1 : 0;
+    }
+
+    uint StartVertexId;
+    if (NumQuads == 0 || !TerrainVerticesAllocate(Job.Slot, NumQuads*6, StartVertexId))
+    {
+        return;
+    }
+
+    uvec3 RegionPos = gl_LocalInvocationID + uvec3(1);
+    for (uint Axis = 0; Axis < 3; ++Axis)
+    {
+        if (!QuadAxes[Axis])
+        {
+            continue;
+        }
+
+        // NOTE: The 4 cells around the edge, counter clockwise looking down the axis. Flip when the solid side is the far end so the
+        //       quad always faces the air
+        uvec3 AxisU = uvec3(0);
+        uvec3 AxisV = uvec3(0);
+        AxisU[(Axis + 1) % 3] = 1;
+        AxisV[(Axis + 2) % 3] = 1;
+        uint QuadCells[4];
+        QuadCells[0] = SurfaceNetsRegionId(RegionPos);
+        QuadCells[1] = SurfaceNetsRegionId(RegionPos - AxisU);
+        QuadCells[2] = SurfaceNetsRegionId(RegionPos - AxisU - AxisV);
+        QuadCells[3] = SurfaceNetsRegionId(RegionPos - AxisV);
+        if (Density < 0)
+        {
+            uint Temp = QuadCells[1];
+            QuadCells[1] = QuadCells[3];
+            QuadCells[3] = Temp;
+        }
+
+        vec4 QuadVertices[4];
+        for (uint CornerId = 0; CornerId < 4; ++CornerId)
+        {
+            uint RegionId = QuadCells[CornerId];
+            QuadVertices[CornerId] = TerrainVertexPack(NetVertices[RegionId].xyz*SampleScale + SampleOffset, NetNormals[RegionId]);
+        }
+
+        TerrainTriangleList[StartVertexId + 0] = QuadVertices[0];
+        TerrainTriangleList[StartVertexId + 1] = QuadVertices[1];
+        TerrainTriangleList[StartVertexId + 2] = QuadVertices[2];
+        TerrainTriangleList[StartVertexId + 3] = QuadVertices[0];
+        TerrainTriangleList[StartVertexId + 4] = QuadVertices[2];
+        TerrainTriangleList[StartVertexId + 5] = QuadVertices[3];
+        StartVertexId += 6;
+    }
+}
 
-#if PACK_VERTICES
-                // NOTE: Pack to fixed point
-                {
-                    // NOTE: Convert to 32bit fixed point
-#define I32_MIN -2147483648
-                    Vertex *= -I32_MIN;
-                    int PosX = int(Vertex.x + 0.5f);
-                    int PosY = int(Vertex.y + 0.5f);
-                    int PosZ = int(Vertex.z + 0.5f);
-
-                    // NOTE: Only keep top 21:21:20 bits
-                    int64_t PosX64 = PosX;
-                    int64_t PosY64 = PosY;
-                    int64_t PosZ64 = PosZ;
-                    PosX64 = (PosX64 >> 11u) & 0x1FFFFF;
-                    PosY64 = (PosY64 >> 11u) & 0x1FFFFF;
-                    PosZ64 = (PosZ64 >> 12u) & 0x0FFFFF;
-            
-                    // NOTE: Pack as a U64
-                    int64_t PackedVertex = (PosX64 << 0u) | (PosY64 << 21u) | (PosZ64 << 42u);
-                    Vertices[VertexId] = vec2(intBitsToFloat(unpackInt2x32(PackedVertex)));
-                }
-
-                // NOTE: Pack Normals
-                {
-                    vec3 Normal = normalize(mix(CornerNormals[FirstVertexId], CornerNormals[SecondVertexId], T));
-                    Normals[VertexId] = Normal.xy;
-                }
-                
-#else
-                Vertices[VertexId] = Vertex;
 #endif
+
+//=========================================================================================================================================
+// NOTE: Fused Generate
+//=========================================================================================================================================
+
+#if FUSED_GENERATE
+
+/*
+  NOTE: Density and triangles in one dispatch. Every group owns a FUSED_TILE_RES^3 tile of cells, evaluates the density of the tile
+        plus its halo into shared memory, then meshes the tile from there. Cells read their corners and one more sample on each side for
+        the normals, so a tile needs samples -1 to +2 around its cells.
+
+        - The density atlas is only written when FusedWriteDensity is set (the far field or the chunk cache want it), otherwise the
+          volume never leaves the group
+        - The tile min/max comes for free so the group writes its density bricks, only the pyramid reduce runs afterwards
+        - The draw args are reset by an upload before the dispatch since there is no barrier between groups of the same chunk
+ */
+
+// IMPORTANT: Has to match procedural_3d_terrain_demo.h
+#define FUSED_TILE_RES 8
+#define FUSED_TILE_SAMPLES (FUSED_TILE_RES + 3)
+#define FUSED_TILE_NUM_SAMPLES (FUSED_TILE_SAMPLES*FUSED_TILE_SAMPLES*FUSED_TILE_SAMPLES)
+#define FUSED_TILE_BRICKS (FUSED_TILE_RES / DENSITY_BRICK_RES)
+#define FUSED_GROUP_SIZE 128
+
+layout(constant_id = 0) const uint FusedWriteDensity = 0;
+
+shared float TileDensity[FUSED_TILE_NUM_SAMPLES];
+shared vec2 TileMinMax[FUSED_GROUP_SIZE];
+
+terrain_float FusedDensityLoad(uvec3 Sample)
+{
+    terrain_float Result = terrain_float(TileDensity[(Sample.z*FUSED_TILE_SAMPLES + Sample.y)*FUSED_TILE_SAMPLES + Sample.x]);
+    return Result;
+}
+
+terrain_vec3 FusedGenerateNormals(uvec3 Sample)
+{
+    terrain_vec3 High = terrain_vec3(FusedDensityLoad(Sample + uvec3(1, 0, 0)), FusedDensityLoad(Sample + uvec3(0, 1, 0)),
+                                     FusedDensityLoad(Sample + uvec3(0, 0, 1)));
+    terrain_vec3 Low = terrain_vec3(FusedDensityLoad(Sample - uvec3(1, 0, 0)), FusedDensityLoad(Sample - uvec3(0, 1, 0)),
+                                    FusedDensityLoad(Sample - uvec3(0, 0, 1)));
+
+    terrain_vec3 Result = -normalize(High - Low);
+    return Result;
+}
+
+// NOTE: Every thread meshes a column of 4 cells along z, the column never crosses a density brick
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 2) in;
+void main()
+{
+    uint TilesPerChunk = TerrainGlobals.ChunkRes / FUSED_TILE_RES;
+    chunk_job Job;
+    uvec3 LocalId;
+    if (!ChunkGetJob(TilesPerChunk, Job, LocalId))
+    {
+        return;
+    }
+
+    // NOTE: Tile sample 0 is slot sample TileBase, the tiles first cell starts at tile sample 1
+    uvec3 Tile = uvec3(gl_WorkGroupID.xy, gl_WorkGroupID.z % TilesPerChunk);
+    uvec3 TileBase = Tile*FUSED_TILE_RES;
+    uint ThreadId = gl_LocalInvocationIndex;
+
+    // NOTE: Tiles write the samples up to their neighbours first sample, the last tile on an axis writes the rest of the slot
+    uvec3 WriteEnd = mix(uvec3(FUSED_TILE_RES), uvec3(TerrainGlobals.SlotDim) - TileBase, equal(Tile, uvec3(TilesPerChunk - 1)));
+    for (uint SampleId = ThreadId; SampleId < FUSED_TILE_NUM_SAMPLES; SampleId += FUSED_GROUP_SIZE)
+    {
+        uvec3 Sample = uvec3(SampleId % FUSED_TILE_SAMPLES, (SampleId / FUSED_TILE_SAMPLES) % FUSED_TILE_SAMPLES,
+                             SampleId / (FUSED_TILE_SAMPLES*FUSED_TILE_SAMPLES));
+        float Density = float(TerrainDensitySample(Job, vec3(TileBase + Sample)));
+
+        // NOTE: Round like the r16f atlas so both paths mesh the same densities
+        Density = unpackHalf2x16(packHalf2x16(vec2(Density, 0.0f))).x;
+        TileDensity[SampleId] = Density;
+
+        if (FusedWriteDensity != 0 && all(lessThan(Sample, WriteEnd)))
+        {
+            imageStore(TerrainDensity, ivec3(Job.AtlasOffset + TileBase + Sample), vec4(Density, 0, 0, 0));
+        }
+    }
+    barrier();
+
+    // NOTE: Tile samples -> terrain sample coords for the vertex positions
+    float SampleScale = float(1 << Job.Lod);
+    vec3 SampleOffset = vec3(Job.Origin) + (vec3(TileBase) - vec3(1)) * SampleScale;
+
+    uvec3 ColumnOrigin = uvec3(gl_LocalInvocationID.xy, gl_LocalInvocationID.z*4) + uvec3(1);
+    vec2 MinMax = vec2(float(FusedDensityLoad(ColumnOrigin)));
+    for (uint CellId = 0; CellId < 4; ++CellId)
+    {
+        uvec3 CellOrigin = ColumnOrigin + uvec3(0, 0, CellId);
+        uvec3 Corners[8];
+        terrain_float Densities[8];
+        for (uint CornerId = 0; CornerId < 8; ++CornerId)
+        {
+            Corners[CornerId] = CellOrigin + uvec3(CornerId & 1, (CornerId >> 1) & 1, (CornerId >> 2) & 1);
+            Densities[CornerId] = FusedDensityLoad(Corners[CornerId]);
+            MinMax = DensityMinMaxCombine(MinMax, vec2(float(Densities[CornerId])));
+        }
+
+        uint CaseByte = TerrainCellCaseByte(Densities);
+        if (TerrainCellHasSurface(CaseByte))
+        {
+            vec3 CornerPositions[8];
+            terrain_vec3 CornerNormals[8];
+            for (uint CornerId = 0; CornerId < 8; ++CornerId)
+            {
+                CornerPositions[CornerId] = vec3(Corners[CornerId]);
+                CornerNormals[CornerId] = FusedGenerateNormals(Corners[CornerId]);
             }
             
-            // NOTE: Write out our triangle list
-            uint StartVertexId = atomicAdd(IndirectArgs.NumVerticesPerInstance, GetTriangleCount(RegularCell)*3);
-            for (uint TriangleId = 0; TriangleId < GetTriangleCount(RegularCell); ++TriangleId)
+            TerrainCellEmit(Job.Slot, CaseByte, CornerPositions, Densities, CornerNormals, SampleScale, SampleOffset);
+        }
+    }
+
+    // NOTE: Bricks of the tile, thread z picks the brick along z and 4x4 threads along x and y share a brick
+    TileMinMax[ThreadId] = MinMax;
+    barrier();
+
+    if (ThreadId < FUSED_TILE_BRICKS*FUSED_TILE_BRICKS*FUSED_TILE_BRICKS)
+    {
+        uvec3 Brick = uvec3(ThreadId & 1, (ThreadId >> 1) & 1, (ThreadId >> 2) & 1);
+        vec2 BrickMinMax = TileMinMax[(Brick.z*8 + Brick.y*DENSITY_BRICK_RES)*8 + Brick.x*DENSITY_BRICK_RES];
+        for (uint Y = 0; Y < DENSITY_BRICK_RES; ++Y)
+        {
+            for (uint X = 0; X < DENSITY_BRICK_RES; ++X)
             {
-#if PACK_VERTICES
-                uint VertexId0 = RegularCell.VertexIndex[3*TriangleId + 0];
-                uint VertexId1 = RegularCell.VertexIndex[3*TriangleId + 1];
-                uint VertexId2 = RegularCell.VertexIndex[3*TriangleId + 2];
-                TerrainTriangleList[StartVertexId + 3*TriangleId + 0] = vec4(Vertices[VertexId0], Normals[VertexId0]);
-                TerrainTriangleList[StartVertexId + 3*TriangleId + 1] = vec4(Vertices[VertexId1], Normals[VertexId1]);
-                TerrainTriangleList[StartVertexId + 3*TriangleId + 2] = vec4(Vertices[VertexId2], Normals[VertexId2]);
-#else
-                TerrainTriangleList[StartVertexId + 3*TriangleId + 0] = vec4(Vertices[RegularCell.VertexIndex[3*TriangleId + 0]], 1);
-                TerrainTriangleList[StartVertexId + 3*TriangleId + 1] = vec4(Vertices[RegularCell.VertexIndex[3*TriangleId + 1]], 1);
-                TerrainTriangleList[StartVertexId + 3*TriangleId + 2] = vec4(Vertices[RegularCell.VertexIndex[3*TriangleId + 2]], 1);
-#endif
+                uvec3 Thread = uvec3(Brick.x*DENSITY_BRICK_RES + X, Brick.y*DENSITY_BRICK_RES + Y, Brick.z);
+                BrickMinMax = DensityMinMaxCombine(BrickMinMax, TileMinMax[(Thread.z*8 + Thread.y)*8 + Thread.x]);
             }
         }
+
+        DensityPyramid[DensityPyramidNode(Job.Slot, DENSITY_PYRAMID_LEVELS - 1, Tile*FUSED_TILE_BRICKS + Brick)] = BrickMinMax;
+    }
+}
+
+#endif
+
+//=========================================================================================================================================
+// NOTE: FP16 Error Probe
+//=========================================================================================================================================
+
+#if FP16_ERROR_PROBE
+
+/*
+  NOTE: Meshes every cell with both precisions and keeps the worst difference. The fp32 side rounds its densities to fp16 like the
+        r16f atlas does, so what is left is the fp16 octave sum, gradients and edge interpolation. Vertex errors are in cells, normal
+        errors in degrees, cells where the two precisions pick different cases are only counted
+ */
+
+float ProbeDensity32(chunk_job Job, vec3 SlotSample)
+{
+    float Result = unpackHalf2x16(packHalf2x16(vec2(TerrainDensityEvaluate(Job, SlotSample), 0.0f))).x;
+    return Result;
+}
+
+vec3 ProbeNormal32(chunk_job Job, vec3 SlotSample)
+{
+    vec3 High = vec3(ProbeDensity32(Job, SlotSample + vec3(1, 0, 0)), ProbeDensity32(Job, SlotSample + vec3(0, 1, 0)),
+                     ProbeDensity32(Job, SlotSample + vec3(0, 0, 1)));
+    vec3 Low = vec3(ProbeDensity32(Job, SlotSample - vec3(1, 0, 0)), ProbeDensity32(Job, SlotSample - vec3(0, 1, 0)),
+                    ProbeDensity32(Job, SlotSample - vec3(0, 0, 1)));
+    vec3 Result = -normalize(High - Low);
+    return Result;
+}
+
+f16vec3 ProbeNormal16(chunk_job Job, vec3 SlotSample)
+{
+    f16vec3 High = f16vec3(TerrainDensityEvaluateFp16(Job, SlotSample + vec3(1, 0, 0)), TerrainDensityEvaluateFp16(Job, SlotSample + vec3(0, 1, 0)),
+                           TerrainDensityEvaluateFp16(Job, SlotSample + vec3(0, 0, 1)));
+    f16vec3 Low = f16vec3(TerrainDensityEvaluateFp16(Job, SlotSample - vec3(1, 0, 0)), TerrainDensityEvaluateFp16(Job, SlotSample - vec3(0, 1, 0)),
+                          TerrainDensityEvaluateFp16(Job, SlotSample - vec3(0, 0, 1)));
+    f16vec3 Result = -normalize(High - Low);
+    return Result;
+}
+
+// NOTE: Same dispatch as BUILD_DENSITY_BRICKS
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+void main()
+{
+    chunk_job Job;
+    uvec3 LocalId;
+    if (!ChunkGetJob(TerrainGlobals.ChunkRes / 4, Job, LocalId))
+    {
+        return;
+    }
+
+    vec3 Corners[8];
+    float Densities32[8];
+    float16_t Densities16[8];
+    for (uint CornerId = 0; CornerId < 8; ++CornerId)
+    {
+        Corners[CornerId] = vec3(LocalId + uvec3(1) + uvec3(CornerId & 1, (CornerId >> 1) & 1, (CornerId >> 2) & 1));
+        Densities32[CornerId] = ProbeDensity32(Job, Corners[CornerId]);
+        Densities16[CornerId] = TerrainDensityEvaluateFp16(Job, Corners[CornerId]);
+    }
+
+    uint CaseByte32 = TerrainCellCaseByte(Densities32);
+    uint CaseByte16 = TerrainCellCaseByte(Densities16);
+    if (!TerrainCellHasSurface(CaseByte32) && !TerrainCellHasSurface(CaseByte16))
+    {
+        return;
+    }
+
+    atomicAdd(Fp16SurfaceCells, 1);
+    if (CaseByte32 != CaseByte16)
+    {
+        atomicAdd(Fp16MismatchCells, 1);
+        return;
+    }
+
+    vec3 Normals32[8];
+    f16vec3 Normals16[8];
+    for (uint CornerId = 0; CornerId < 8; ++CornerId)
+    {
+        Normals32[CornerId] = ProbeNormal32(Job, Corners[CornerId]);
+        Normals16[CornerId] = ProbeNormal16(Job, Corners[CornerId]);
+    }
+
+    regular_cell_data RegularCell = RegularCells[CellClasses[CaseByte32]];
+    regular_cell_vertices PackedVertices = RegularCellVertices[CaseByte32];
+    float MaxVertexError = 0.0f;
+    float MaxNormalError = 0.0f;
+    for (uint VertexId = 0; VertexId < GetVertexCount(RegularCell); ++VertexId)
+    {
+        uint Edge = PackedVertices.Edges[VertexId];
+        uint FirstVertexId = Edge & 0xF;
+        uint SecondVertexId = (Edge >> 4) & 0xF;
+
+        // NOTE: Cell edges are one sample long so the T difference is the vertex error in cells
+        float T32 = Densities32[SecondVertexId] / (Densities32[SecondVertexId] - Densities32[FirstVertexId]);
+        float16_t T16 = Densities16[SecondVertexId] / (Densities16[SecondVertexId] - Densities16[FirstVertexId]);
+        MaxVertexError = max(MaxVertexError, abs(T32 - float(T16)));
+
+        vec3 Normal32 = normalize(mix(Normals32[FirstVertexId], Normals32[SecondVertexId], T32));
+        vec3 Normal16 = vec3(normalize(mix(Normals16[FirstVertexId], Normals16[SecondVertexId], T16)));
+        MaxNormalError = max(MaxNormalError, degrees(acos(clamp(dot(Normal32, Normal16), -1.0f, 1.0f))));
+    }
+
+    atomicMax(Fp16MaxVertexError, floatBitsToUint(MaxVertexError));
+    atomicMax(Fp16MaxNormalError, floatBitsToUint(MaxNormalError));
+}
+
+#endif
+
+//=========================================================================================================================================
+// NOTE: Density Pyramid
+//=========================================================================================================================================
+
+#if BUILD_DENSITY_BRICKS
+
+shared vec2 BrickMinMax[64];
+
+// NOTE: Same dispatch shape as GENERATE_TRIANGLES, every thread reduces the 8 corners of its cell and the group reduces the brick
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+void main()
+{
+    chunk_job Job;
+    uvec3 LocalId;
+    if (!ChunkGetJob(TerrainGlobals.ChunkRes / 4, Job, LocalId))
+    {
+        return;
+    }
+
+    ivec3 CellOrigin = ivec3(Job.AtlasOffset + LocalId) + ivec3(1);
+    vec2 MinMax = vec2(imageLoad(TerrainDensity, CellOrigin).x);
+    for (uint CornerId = 1; CornerId < 8; ++CornerId)
+    {
+        ivec3 Corner = CellOrigin + ivec3(CornerId & 1, (CornerId >> 1) & 1, (CornerId >> 2) & 1);
+        MinMax = DensityMinMaxCombine(MinMax, vec2(imageLoad(TerrainDensity, Corner).x));
+    }
+
+    uint ThreadId = gl_LocalInvocationIndex;
+    BrickMinMax[ThreadId] = MinMax;
+    barrier();
+    
+    for (uint Stride = 32; Stride > 0; Stride >>= 1)
+    {
+        if (ThreadId < Stride)
+        {
+            BrickMinMax[ThreadId] = DensityMinMaxCombine(BrickMinMax[ThreadId], BrickMinMax[ThreadId + Stride]);
+        }
+        barrier();
+    }
+
+    if (ThreadId == 0)
+    {
+        DensityPyramid[DensityPyramidNode(Job.Slot, DENSITY_PYRAMID_LEVELS - 1, LocalId / DENSITY_BRICK_RES)] = BrickMinMax[0];
     }
 }
 
 #endif
 
+#if BUILD_DENSITY_PYRAMID
+
+shared vec2 LevelMinMax[64];
+
+// NOTE: One group per chunk, thread i builds node i of level 2 from the bricks and the upper levels reduce in shared memory
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+void main()
+{
+    chunk_job Job;
+    uvec3 LocalId;
+    if (!ChunkGetJob(1, Job, LocalId))
+    {
+        return;
+    }
+
+    uint ThreadId = gl_LocalInvocationIndex;
+    {
+        uvec3 Child = 2*LocalId;
+        vec2 MinMax = DensityPyramid[DensityPyramidNode(Job.Slot, 3, Child)];
+        for (uint ChildId = 1; ChildId < 8; ++ChildId)
+        {
+            uvec3 ChildCoord = Child + uvec3(ChildId & 1, (ChildId >> 1) & 1, (ChildId >> 2) & 1);
+            MinMax = DensityMinMaxCombine(MinMax, DensityPyramid[DensityPyramidNode(Job.Slot, 3, ChildCoord)]);
+        }
+
+        DensityPyramid[DensityPyramidNode(Job.Slot, 2, LocalId)] = MinMax;
+        LevelMinMax[ThreadId] = MinMax;
+    }
+    barrier();
+
+    vec2 Level1MinMax = vec2(0);
+    if (all(lessThan(LocalId, uvec3(2))))
+    {
+        uvec3 Child = 2*LocalId;
+        Level1MinMax = LevelMinMax[(Child.z*4 + Child.y)*4 + Child.x];
+        for (uint ChildId = 1; ChildId < 8; ++ChildId)
+        {
+            uvec3 ChildCoord = Child + uvec3(ChildId & 1, (ChildId >> 1) & 1, (ChildId >> 2) & 1);
+            Level1MinMax = DensityMinMaxCombine(Level1MinMax, LevelMinMax[(ChildCoord.z*4 + ChildCoord.y)*4 + ChildCoord.x]);
+        }
+
+        DensityPyramid[DensityPyramidNode(Job.Slot, 1, LocalId)] = Level1MinMax;
+    }
+    barrier();
+
+    // NOTE: Level 2 is done with shared memory, reuse the first 8 entries for level 1
+    if (all(lessThan(LocalId, uvec3(2))))
+    {
+        LevelMinMax[(LocalId.z*2 + LocalId.y)*2 + LocalId.x] = Level1MinMax;
+    }
+    barrier();
+
+    if (ThreadId == 0)
+    {
+        vec2 MinMax = LevelMinMax[0];
+        for (uint ChildId = 1; ChildId < 8; ++ChildId)
+        {
+            MinMax = DensityMinMaxCombine(MinMax, LevelMinMax[ChildId]);
+        }
+        DensityPyramid[DensityPyramidNode(Job.Slot, 0, uvec3(0))] = MinMax;
+    }
+}
+
+#endif
+
+//=========================================================================================================================================
+// NOTE: Far Field Downsample
+//=========================================================================================================================================
+
+#if FAR_FIELD_DOWNSAMPLE
+
+// NOTE: Levels are only indexed with constants, dynamically indexing storage image arrays is an optional feature
+float FarFieldLevelLoad(uint Level, ivec3 Coord)
+{
+    float Result = 0.0f;
+    if (Level == 0) Result = imageLoad(FarFieldLevels[0], Coord).x;
+    else if (Level == 1) Result = imageLoad(FarFieldLevels[1], Coord).x;
+    else if (Level == 2) Result = imageLoad(FarFieldLevels[2], Coord).x;
+    else Result = imageLoad(FarFieldLevels[3], Coord).x;
+    return Result;
+}
+
+void FarFieldLevelStore(uint Level, ivec3 Coord, float Density)
+{
+    if (Level == 0) imageStore(FarFieldLevels[0], Coord, vec4(Density, 0, 0, 0));
+    else if (Level == 1) imageStore(FarFieldLevels[1], Coord, vec4(Density, 0, 0, 0));
+    else if (Level == 2) imageStore(FarFieldLevels[2], Coord, vec4(Density, 0, 0, 0));
+    else imageStore(FarFieldLevels[3], Coord, vec4(Density, 0, 0, 0));
+}
+
+ivec3 FarFieldLevelSize(uint Level)
+{
+    ivec3 Result = ivec3(0);
+    if (Level == 0) Result = imageSize(FarFieldLevels[0]);
+    else if (Level == 1) Result = imageSize(FarFieldLevels[1]);
+    else if (Level == 2) Result = imageSize(FarFieldLevels[2]);
+    else Result = imageSize(FarFieldLevels[3]);
+    return Result;
+}
+
+float FarFieldLoadSource(ivec3 Coord)
+{
+    float Result = 0.0f;
+    if (FarFieldBuild.Level == 0)
+    {
+        // NOTE: Terrain sample -> atlas texel. Slot i holds chunk i and the atlas is laid out in the same grid as the chunks, skip the
+        // low border sample
+        ivec3 Chunk = Coord / int(TerrainGlobals.ChunkRes);
+        ivec3 AtlasCoord = Chunk*int(TerrainGlobals.SlotDim) + (Coord - Chunk*int(TerrainGlobals.ChunkRes)) + ivec3(1);
+        Result = imageLoad(TerrainDensity, AtlasCoord).x;
+    }
+    else
+    {
+        Result = FarFieldLevelLoad(FarFieldBuild.Level - 1, Coord);
+    }
+
+    return Result;
+}
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+void main()
+{
+    ivec3 DstCoord = ivec3(gl_GlobalInvocationID);
+    if (any(greaterThanEqual(DstCoord, FarFieldLevelSize(FarFieldBuild.Level))))
+    {
+        return;
+    }
+
+    // NOTE: Box filter, the sign of the average is what the trace sees as the surface
+    ivec3 SrcCoord = 2*DstCoord;
+    float Density = 0.0f;
+    Density += FarFieldLoadSource(SrcCoord + ivec3(0, 0, 0));
+    Density += FarFieldLoadSource(SrcCoord + ivec3(1, 0, 0));
+    Density += FarFieldLoadSource(SrcCoord + ivec3(0, 1, 0));
+    Density += FarFieldLoadSource(SrcCoord + ivec3(1, 1, 0));
+    Density += FarFieldLoadSource(SrcCoord + ivec3(0, 0, 1));
+    Density += FarFieldLoadSource(SrcCoord + ivec3(1, 0, 1));
+    Density += FarFieldLoadSource(SrcCoord + ivec3(0, 1, 1));
+    Density += FarFieldLoadSource(SrcCoord + ivec3(1, 1, 1));
+    
+    FarFieldLevelStore(FarFieldBuild.Level, DstCoord, 0.125f*Density);
+}
+
+#endif
+
 // NOTE: Junk for debugging
 // TODO: REMOVE
 /*
@@ -0,0 +1,64 @@
+#version 450
+
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(set = 0, binding = 0) uniform sampler2D InputImage;
+
+// NOTE: The input is only rendered in its top left UvScale rect (dynamic resolution), see demo_dynamic_resolution.h
+layout(push_constant) uniform copy_to_swap_constants
+{
+    vec2 UvScale;
+    vec2 InvInputSize;
+    float Sharpness;
+} Constants;
+
+#if VERTEX_SHADER
+
+layout(location = 0) out vec2 OutUv;
+
+void main()
+{
+    // NOTE: Single triangle that covers the whole screen, no vertex buffer needed
+    vec2 ScreenUv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    OutUv = ScreenUv * Constants.UvScale;
+    gl_Position = vec4(2.0f * ScreenUv - vec2(1.0f), 0, 1);
+}
+
+#endif
+
+#if FRAGMENT_SHADER
+
+layout(location = 0) in vec2 InUv;
+
+layout(location = 0) out vec4 OutColor;
+
+vec3 SampleInput(vec2 Uv)
+{
+    // NOTE: Never filter in texels outside the rendered rect, they hold older frames at other resolutions
+    vec2 MaxUv = Constants.UvScale - 0.5f*Constants.InvInputSize;
+    return texture(InputImage, clamp(Uv, 0.5f*Constants.InvInputSize, MaxUv)).rgb;
+}
+
+void main()
+{
+    vec3 Center = SampleInput(InUv);
+    vec3 Color = Center;
+    
+    if (Constants.Sharpness > 0.0f)
+    {
+        // NOTE: Unsharp mask on the bilinear result, clamped to the neighbourhood so edges don't ring
+        vec3 Left = SampleInput(InUv - vec2(Constants.InvInputSize.x, 0));
+        vec3 Right = SampleInput(InUv + vec2(Constants.InvInputSize.x, 0));
+        vec3 Up = SampleInput(InUv - vec2(0, Constants.InvInputSize.y));
+        vec3 Down = SampleInput(InUv + vec2(0, Constants.InvInputSize.y));
+
+        vec3 MinColor = min(Center, min(min(Left, Right), min(Up, Down)));
+        vec3 MaxColor = max(Center, max(max(Left, Right), max(Up, Down)));
+        Color = Center + Constants.Sharpness*(4.0f*Center - Left - Right - Up - Down);
+        Color = clamp(Color, MinColor, MaxColor);
+    }
+    
+    OutColor = vec4(Color, 1);
+}
+
+#endif
@@ -0,0 +1,48 @@
+/*
+
+  NOTE: Density min/max pyramid
+
+    Every chunk slot gets DENSITY_PYRAMID_NODES_PER_SLOT (min, max) nodes over its cells, coarse to fine:
+
+    - node 0: the whole chunk
+    - nodes 1-8: 2^3 octants
+    - nodes 9-72: 4^3
+    - nodes 73-584: 8^3 bricks of DENSITY_BRICK_RES^3 cells, the bricks include their high side corners so each one covers every sample
+      its cells read
+
+    A node can only hold part of the surface when min < 0 <= max, matching the >= 0 solid test the mesher uses.
+
+    IMPORTANT: These have to match demo_density_pyramid.h
+
+ */
+
+#define DENSITY_BRICK_RES 4
+#define DENSITY_PYRAMID_LEVELS 4
+#define DENSITY_PYRAMID_NODES_PER_SLOT 585
+#define DENSITY_PYRAMID_CHUNK_RES (DENSITY_BRICK_RES << (DENSITY_PYRAMID_LEVELS - 1))
+
+uint DensityPyramidLevelOffset(uint Level)
+{
+    // NOTE: 0, 1, 9, 73
+    uint Result = ((1 << (3*Level)) - 1) / 7;
+    return Result;
+}
+
+uint DensityPyramidNode(uint Slot, uint Level, uvec3 NodeCoord)
+{
+    uint Dim = 1 << Level;
+    uint Result = Slot*DENSITY_PYRAMID_NODES_PER_SLOT + DensityPyramidLevelOffset(Level) + (NodeCoord.z*Dim + NodeCoord.y)*Dim + NodeCoord.x;
+    return Result;
+}
+
+vec2 DensityMinMaxCombine(vec2 A, vec2 B)
+{
+    vec2 Result = vec2(min(A.x, B.x), max(A.y, B.y));
+    return Result;
+}
+
+bool DensityHasSurface(vec2 MinMax)
+{
+    bool Result = MinMax.x < 0.0f && MinMax.y >= 0.0f;
+    return Result;
+}
@@ -0,0 +1,38 @@
+/*
+
+  NOTE: Clustered forward shading
+
+    The view frustum is split into LIGHT_CLUSTER_TILES_X * LIGHT_CLUSTER_TILES_Y screen tiles and LIGHT_CLUSTER_TILES_Z depth slices.
+    Slices are exponential in view depth so near clusters stay small. BUILD_LIGHT_CLUSTERS runs one thread per light, finds the range of
+    clusters its sphere can touch and appends itself to each of them. The fragment shader then only loops over its own cluster.
+
+    View depth is the clip space w, which for a perspective projection is the distance along the view axis, so we never need the view
+    matrix on its own.
+
+    IMPORTANT: These have to match the LIGHT_CLUSTER_* defines in demo_light_clusters.h
+
+ */
+
+#define LIGHT_CLUSTER_TILES_X 16
+#define LIGHT_CLUSTER_TILES_Y 9
+#define LIGHT_CLUSTER_TILES_Z 24
+#define LIGHT_CLUSTER_MAX_LIGHTS 128
+#define LIGHT_CLUSTER_NEAR 0.1f
+#define LIGHT_CLUSTER_FAR 100.0f
+
+uint LightClusterSlice(float ViewDepth)
+{
+    float Slice = log(max(ViewDepth, LIGHT_CLUSTER_NEAR) / LIGHT_CLUSTER_NEAR) / log(LIGHT_CLUSTER_FAR / LIGHT_CLUSTER_NEAR);
+    return min(uint(Slice * LIGHT_CLUSTER_TILES_Z), LIGHT_CLUSTER_TILES_Z - 1);
+}
+
+uvec2 LightClusterTile(vec2 ScreenUv)
+{
+    uvec2 Result = uvec2(clamp(ScreenUv, vec2(0), vec2(1)) * vec2(LIGHT_CLUSTER_TILES_X, LIGHT_CLUSTER_TILES_Y));
+    return min(Result, uvec2(LIGHT_CLUSTER_TILES_X - 1, LIGHT_CLUSTER_TILES_Y - 1));
+}
+
+uint LightClusterId(uvec2 Tile, uint Slice)
+{
+    return (Slice * LIGHT_CLUSTER_TILES_Y + Tile.y) * LIGHT_CLUSTER_TILES_X + Tile.x;
+}
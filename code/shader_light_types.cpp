@@ -9,7 +9,7 @@ struct directional_light
 struct point_light
 {
     vec3 Color;
-    vec3 Pos; // NOTE: Camera Space Position
+    vec3 Pos; // NOTE: World Space Position
     float MaxDistance; // TODO: Rename to radius
 };
 
@@ -0,0 +1,32 @@
+/*
+
+  NOTE: Cached cascaded shadow maps
+
+    Every cascade is a SHADOW_CASCADE_RES square region of one depth atlas (cascades side by side in x), split into
+    SHADOW_TILES_PER_AXIS^2 tiles. Cascades are positioned in light space and snapped to whole tiles. A tile with light space tile coord
+    (X, Y) always lives at atlas tile (X mod N, Y mod N), so when the cascade scrolls only the row/column of tiles that came into view
+    needs to be redrawn and everything else stays valid (toroidal addressing). Sampling applies the same wrap per texel.
+
+    Depth is the distance along the light direction, remapped to [0, 1] over the terrain bounds. Smaller is closer to the light.
+
+    IMPORTANT: These have to match the SHADOW_* defines in demo_shadow_cache.h
+
+ */
+
+#define SHADOW_NUM_CASCADES 3
+#define SHADOW_CASCADE_RES 1024
+#define SHADOW_TILES_PER_AXIS 8
+
+vec3 ShadowLightSpace(vec3 WorldPos, vec3 Right, vec3 Up, vec3 Dir)
+{
+    vec3 Result = vec3(dot(WorldPos, Right), dot(WorldPos, Up), dot(WorldPos, Dir));
+    return Result;
+}
+
+ivec2 ShadowAtlasTexel(ivec2 LightSpaceTexel, uint CascadeId)
+{
+    // NOTE: Toroidal wrap, % is undefined for negative ints in GLSL but the resolution is a power of 2 so a mask works for both signs
+    ivec2 Result = LightSpaceTexel & ivec2(SHADOW_CASCADE_RES - 1);
+    Result.x += int(CascadeId) * SHADOW_CASCADE_RES;
+    return Result;
+}
@@ -0,0 +1,151 @@
+
+//
+// NOTE: Benchmark Metrics
+//
+
+inline void BenchmarkBegin(benchmark_state* Bench)
+{
+    *Bench = {};
+    Bench->StartTicks = DemoTimerGet();
+}
+
+inline void BenchmarkRecord(benchmark_state* Bench, char* Name, f64 Value, char* Unit)
+{
+    // NOTE: Re-recording a metric overwrites it so systems can keep publishing their latest value every frame
+    benchmark_metric* Metric = 0;
+    for (u32 MetricId = 0; MetricId < Bench->NumMetrics; ++MetricId)
+    {
+        if (strcmp(Bench->Metrics[MetricId].Name, Name) == 0)
+        {
+            Metric = Bench->Metrics + MetricId;
+            break;
+        }
+    }
+
+    if (!Metric)
+    {
+        Assert(Bench->NumMetrics < BENCHMARK_MAX_METRICS);
+        Metric = Bench->Metrics + Bench->NumMetrics++;
+        snprintf(Metric->Name, sizeof(Metric->Name), "%s", Name);
+    }
+
+    snprintf(Metric->Unit, sizeof(Metric->Unit), "%s", Unit);
+    Metric->Value = Value;
+}
+
+inline f64 BenchmarkGet(benchmark_state* Bench, char* Name)
+{
+    f64 Result = 0.0;
+    for (u32 MetricId = 0; MetricId < Bench->NumMetrics; ++MetricId)
+    {
+        if (strcmp(Bench->Metrics[MetricId].Name, Name) == 0)
+        {
+            Result = Bench->Metrics[MetricId].Value;
+            break;
+        }
+    }
+
+    return Result;
+}
+
+inline void BenchmarkWriteJson(benchmark_state* Bench, char* FileName)
+{
+    FILE* File = fopen(FileName, "wb");
+    if (!File)
+    {
+        return;
+    }
+
+    fprintf(File, "{\n");
+    for (u32 MetricId = 0; MetricId < Bench->NumMetrics; ++MetricId)
+    {
+        benchmark_metric* Metric = Bench->Metrics + MetricId;
+        fprintf(File, "    \"%s\": { \"value\": %.6f, \"unit\": \"%s\" }%s\n", Metric->Name, Metric->Value, Metric->Unit,
+                MetricId + 1 < Bench->NumMetrics ? "," : "");
+    }
+    fprintf(File, "}\n");
+    fclose(File);
+
+    Bench->Written = true;
+}
+
+//
+// NOTE: GPU Timestamps
+//
+
+inline gpu_timestamps GpuTimestampsCreate(VkDevice Device, VkPhysicalDevice PhysicalDevice)
+{
+    gpu_timestamps Result = {};
+    Result.NumQueries = 2*GPU_TIMESTAMPS_MAX_SCOPES;
+
+    VkPhysicalDeviceProperties Properties;
+    vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+    Result.MsPerTick = f64(Properties.limits.timestampPeriod) / 1000000.0;
+
+    VkQueryPoolCreateInfo CreateInfo = {};
+    CreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    CreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    CreateInfo.queryCount = Result.NumQueries;
+    VkCheckResult(vkCreateQueryPool(Device, &CreateInfo, 0, &Result.QueryPool));
+
+    return Result;
+}
+
+inline void GpuTimestampsFrameBegin(gpu_timestamps* Timestamps, VkDevice Device, vk_commands* Commands)
+{
+    // NOTE: Resolve the scopes of the previous frame, its fence has already been waited on
+    Timestamps->NumResults = 0;
+    if (Timestamps->NumScopes > 0)
+    {
+        u64 Ticks[2*GPU_TIMESTAMPS_MAX_SCOPES];
+        VkResult Result = vkGetQueryPoolResults(Device, Timestamps->QueryPool, 0, 2*Timestamps->NumScopes, sizeof(Ticks), Ticks,
+                                                sizeof(u64), VK_QUERY_RESULT_64_BIT);
+        if (Result == VK_SUCCESS)
+        {
+            for (u32 ScopeId = 0; ScopeId < Timestamps->NumScopes; ++ScopeId)
+            {
+                gpu_timer_scope* Scope = Timestamps->Scopes + ScopeId;
+                Timestamps->ResultNames[ScopeId] = Scope->Name;
+                Timestamps->ResultMs[ScopeId] = f64(Ticks[Scope->EndQuery] - Ticks[Scope->StartQuery]) * Timestamps->MsPerTick;
+            }
+            Timestamps->NumResults = Timestamps->NumScopes;
+        }
+    }
+
+    Timestamps->NumScopes = 0;
+    vkCmdResetQueryPool(Commands->Buffer, Timestamps->QueryPool, 0, Timestamps->NumQueries);
+}
+
+inline u32 GpuTimerBegin(gpu_timestamps* Timestamps, vk_commands* Commands, char* Name)
+{
+    Assert(Timestamps->NumScopes < GPU_TIMESTAMPS_MAX_SCOPES);
+    u32 ScopeId = Timestamps->NumScopes++;
+    gpu_timer_scope* Scope = Timestamps->Scopes + ScopeId;
+    Scope->Name = Name;
+    Scope->StartQuery = 2*ScopeId + 0;
+    Scope->EndQuery = 2*ScopeId + 1;
+
+    vkCmdWriteTimestamp(Commands->Buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, Timestamps->QueryPool, Scope->StartQuery);
+    return ScopeId;
+}
+
+inline void GpuTimerEnd(gpu_timestamps* Timestamps, vk_commands* Commands, u32 ScopeId)
+{
+    gpu_timer_scope* Scope = Timestamps->Scopes + ScopeId;
+    vkCmdWriteTimestamp(Commands->Buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, Timestamps->QueryPool, Scope->EndQuery);
+}
+
+inline f64 GpuTimerGetMs(gpu_timestamps* Timestamps, char* Name)
+{
+    // NOTE: Returns the previous frames timing, summed if the scope was recorded multiple times
+    f64 Result = 0.0;
+    for (u32 ResultId = 0; ResultId < Timestamps->NumResults; ++ResultId)
+    {
+        if (strcmp(Timestamps->ResultNames[ResultId], Name) == 0)
+        {
+            Result += Timestamps->ResultMs[ResultId];
+        }
+    }
+
+    return Result;
+}
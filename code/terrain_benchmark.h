@@ -0,0 +1,55 @@
+#pragma once
+
+/*
+
+  NOTE: The benchmark harness collects named metrics from the different terrain systems and dumps them as a flat JSON object once the
+        benchmark frames are done. GPU timings come from a timestamp query pool that is read back one frame later (MainLoop waits on
+        the previous frames fence before recording so the results are always available by then).
+
+ */
+
+#define BENCHMARK_FILE_NAME "procedural_3d_terrain_bench.json"
+#define BENCHMARK_NUM_FRAMES 240
+#define BENCHMARK_MAX_METRICS 256
+
+struct benchmark_metric
+{
+    char Name[64];
+    char Unit[16];
+    f64 Value;
+};
+
+struct benchmark_state
+{
+    u64 StartTicks;
+    u32 FrameId;
+    b32 Written;
+
+    u32 NumMetrics;
+    benchmark_metric Metrics[BENCHMARK_MAX_METRICS];
+};
+
+#define GPU_TIMESTAMPS_MAX_SCOPES 64
+
+struct gpu_timer_scope
+{
+    char* Name;
+    u32 StartQuery;
+    u32 EndQuery;
+};
+
+struct gpu_timestamps
+{
+    VkQueryPool QueryPool;
+    f64 MsPerTick;
+    u32 NumQueries;
+
+    // NOTE: Scopes recorded in the current frame
+    u32 NumScopes;
+    gpu_timer_scope Scopes[GPU_TIMESTAMPS_MAX_SCOPES];
+
+    // NOTE: Results of the previous frame
+    u32 NumResults;
+    char* ResultNames[GPU_TIMESTAMPS_MAX_SCOPES];
+    f64 ResultMs[GPU_TIMESTAMPS_MAX_SCOPES];
+};
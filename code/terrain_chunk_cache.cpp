@@ -0,0 +1,1246 @@
+
+//
+// NOTE: Chunk Keys
+//
+
+inline i32 ChunkKeyCompare(chunk_key A, chunk_key B)
+{
+    if (A.Lod != B.Lod) return A.Lod < B.Lod ? -1 : 1;
+    if (A.Z != B.Z) return A.Z < B.Z ? -1 : 1;
+    if (A.Y != B.Y) return A.Y < B.Y ? -1 : 1;
+    if (A.X != B.X) return A.X < B.X ? -1 : 1;
+    return 0;
+}
+
+inline chunk_key ChunkKey(i32 X, i32 Y, i32 Z, u32 Lod)
+{
+    chunk_key Result = {};
+    Result.X = X;
+    Result.Y = Y;
+    Result.Z = Z;
+    Result.Lod = Lod;
+    return Result;
+}
+
+//
+// NOTE: Archive Writer
+//
+
+inline void ChunkArchiveWritePadding(chunk_archive_writer* Writer)
+{
+    local_global u8 Zeros[CHUNK_ARCHIVE_ALIGNMENT] = {};
+    u64 AlignedOffset = (Writer->CurrOffset + CHUNK_ARCHIVE_ALIGNMENT - 1) & ~u64(CHUNK_ARCHIVE_ALIGNMENT - 1);
+    u64 PaddingSize = AlignedOffset - Writer->CurrOffset;
+    if (PaddingSize > 0)
+    {
+        fwrite(Zeros, 1, PaddingSize, Writer->File);
+        Writer->CurrOffset = AlignedOffset;
+    }
+}
+
+inline u64 ChunkArchiveWriteBlob(chunk_archive_writer* Writer, void* Data, u64 Size)
+{
+    u64 Result = 0;
+    if (Size > 0)
+    {
+        ChunkArchiveWritePadding(Writer);
+        Result = Writer->CurrOffset;
+        fwrite(Data, 1, Size, Writer->File);
+        Writer->CurrOffset += Size;
+    }
+
+    return Result;
+}
+
+inline b32 ChunkArchiveWriterBegin(linear_arena* Arena, char* FileName, u32 MaxChunks, v3 TerrainPos, v3 TerrainRadius,
+                                   chunk_archive_writer* Writer)
+{
+    *Writer = {};
+    Writer->File = fopen(FileName, "wb");
+    if (!Writer->File)
+    {
+        return false;
+    }
+
+    Writer->MaxChunks = MaxChunks;
+    Writer->Entries = PushArray(Arena, chunk_archive_entry, MaxChunks);
+
+    chunk_archive_header* Header = &Writer->Header;
+    Header->Magic = CHUNK_ARCHIVE_MAGIC;
+    Header->Version = CHUNK_ARCHIVE_VERSION;
+    Header->Alignment = CHUNK_ARCHIVE_ALIGNMENT;
+    Header->VertexStride = sizeof(v4);
+    Header->IndexStride = sizeof(u32);
+    Header->DensityTexelSize = sizeof(u16);
+    Header->TerrainPos = TerrainPos;
+    Header->TerrainRadius = TerrainRadius;
+
+    // NOTE: Reserve the header, it gets patched once we know where the index lives
+    fwrite(Header, sizeof(*Header), 1, Writer->File);
+    Writer->CurrOffset = sizeof(*Header);
+
+    return true;
+}
+
+inline void ChunkArchiveWriteChunk(chunk_archive_writer* Writer, chunk_key Key, v4* Vertices, u32 NumVertices, u32* Indices, u32 NumIndices,
+                                   u32* LodIndices, u32 NumLodIndices, f32 LodError, u16* Density, u32 DensityResX, u32 DensityResY,
+                                   u32 DensityResZ)
+{
+    Assert(Writer->NumChunks < Writer->MaxChunks);
+    chunk_archive_entry* Entry = Writer->Entries + Writer->NumChunks++;
+    *Entry = {};
+    Entry->Key = Key;
+    Entry->NumVertices = NumVertices;
+    Entry->NumIndices = NumIndices;
+    Entry->VertexOffset = ChunkArchiveWriteBlob(Writer, Vertices, sizeof(v4)*NumVertices);
+    Entry->IndexOffset = ChunkArchiveWriteBlob(Writer, Indices, sizeof(u32)*NumIndices);
+    Entry->NumLodIndices = NumLodIndices;
+    Entry->LodError = LodError;
+    Entry->LodIndexOffset = ChunkArchiveWriteBlob(Writer, LodIndices, sizeof(u32)*NumLodIndices);
+
+    if (Density)
+    {
+        Entry->DensityResX = DensityResX;
+        Entry->DensityResY = DensityResY;
+        Entry->DensityResZ = DensityResZ;
+        Entry->DensitySize = u64(sizeof(u16))*DensityResX*DensityResY*DensityResZ;
+        Entry->DensityOffset = ChunkArchiveWriteBlob(Writer, Density, Entry->DensitySize);
+    }
+}
+
+inline void ChunkArchiveWriterEnd(chunk_archive_writer* Writer)
+{
+    // NOTE: Sort the index by key (insertion sort, chunk counts are small and mostly arrive in order)
+    for (u32 EntryId = 1; EntryId < Writer->NumChunks; ++EntryId)
+    {
+        chunk_archive_entry Entry = Writer->Entries[EntryId];
+        u32 InsertId = EntryId;
+        while (InsertId > 0 && ChunkKeyCompare(Writer->Entries[InsertId - 1].Key, Entry.Key) > 0)
+        {
+            Writer->Entries[InsertId] = Writer->Entries[InsertId - 1];
+            InsertId -= 1;
+        }
+        Writer->Entries[InsertId] = Entry;
+    }
+
+    chunk_archive_header* Header = &Writer->Header;
+    Header->NumChunks = Writer->NumChunks;
+    Header->IndexOffset = ChunkArchiveWriteBlob(Writer, Writer->Entries, sizeof(chunk_archive_entry)*Writer->NumChunks);
+    Header->FileSize = Writer->CurrOffset;
+
+    fseek(Writer->File, 0, SEEK_SET);
+    fwrite(Header, sizeof(*Header), 1, Writer->File);
+    fclose(Writer->File);
+    Writer->File = 0;
+}
+
+//
+// NOTE: Archive Reader
+//
+
+// NOTE: Offset + Size can wrap on a corrupt header, so compare against what is left after Offset
+inline b32 ChunkArchiveRangeValid(u64 Offset, u64 Size, u64 FileSize)
+{
+    b32 Result = Offset <= FileSize && Size <= FileSize - Offset;
+    return Result;
+}
+
+inline b32 ChunkArchiveOpen(char* FileName, chunk_archive* Archive)
+{
+    *Archive = {};
+    if (!DemoFileMapOpen(FileName, &Archive->Map))
+    {
+        return false;
+    }
+
+    // NOTE: Validate before trusting any offsets in the file
+    chunk_archive_header* Header = (chunk_archive_header*)Archive->Map.Memory;
+    u64 FileSize = Archive->Map.Size;
+    b32 Valid = (FileSize >= sizeof(chunk_archive_header) &&
+                 Header->Magic == CHUNK_ARCHIVE_MAGIC &&
+                 Header->Version == CHUNK_ARCHIVE_VERSION &&
+                 Header->Alignment == CHUNK_ARCHIVE_ALIGNMENT &&
+                 Header->FileSize == FileSize &&
+                 Header->VertexStride == sizeof(v4) &&
+                 Header->IndexStride == sizeof(u32) &&
+                 ChunkArchiveRangeValid(Header->IndexOffset, u64(Header->NumChunks)*sizeof(chunk_archive_entry), FileSize));
+
+    if (Valid)
+    {
+        chunk_archive_entry* Entries = (chunk_archive_entry*)(Archive->Map.Memory + Header->IndexOffset);
+        for (u32 EntryId = 0; EntryId < Header->NumChunks && Valid; ++EntryId)
+        {
+            chunk_archive_entry* Entry = Entries + EntryId;
+            Valid = (ChunkArchiveRangeValid(Entry->VertexOffset, u64(Entry->NumVertices)*sizeof(v4), FileSize) &&
+                     ChunkArchiveRangeValid(Entry->IndexOffset, u64(Entry->NumIndices)*sizeof(u32), FileSize) &&
+                     ChunkArchiveRangeValid(Entry->LodIndexOffset, u64(Entry->NumLodIndices)*sizeof(u32), FileSize) &&
+                     ChunkArchiveRangeValid(Entry->DensityOffset, Entry->DensitySize, FileSize));
+        }
+    }
+
+    if (!Valid)
+    {
+        DemoFileMapClose(&Archive->Map);
+        *Archive = {};
+        return false;
+    }
+
+    Archive->Header = Header;
+    Archive->Entries = (chunk_archive_entry*)(Archive->Map.Memory + Header->IndexOffset);
+    return true;
+}
+
+inline void ChunkArchiveClose(chunk_archive* Archive)
+{
+    DemoFileMapClose(&Archive->Map);
+    *Archive = {};
+}
+
+inline chunk_archive_entry* ChunkArchiveFind(chunk_archive* Archive, chunk_key Key)
+{
+    chunk_archive_entry* Result = 0;
+    if (Archive->Header)
+    {
+        u32 Min = 0;
+        u32 Max = Archive->Header->NumChunks;
+        while (Min < Max)
+        {
+            u32 Mid = (Min + Max) / 2;
+            i32 Compare = ChunkKeyCompare(Archive->Entries[Mid].Key, Key);
+            if (Compare == 0)
+            {
+                Result = Archive->Entries + Mid;
+                break;
+            }
+            else if (Compare < 0)
+            {
+                Min = Mid + 1;
+            }
+            else
+            {
+                Max = Mid;
+            }
+        }
+    }
+
+    return Result;
+}
+
+inline void* ChunkArchiveGetBlob(chunk_archive* Archive, u64 Offset)
+{
+    void* Result = Archive->Map.Memory + Offset;
+    return Result;
+}
+
+//
+// NOTE: Mesh Welding
+//
+
+/*
+
+  NOTE: GENERATE_TRIANGLES writes a triangle soup where neighbouring cells emit the exact same packed vertex for a shared edge (both
+        cells interpolate between the same two corners). For the archive we weld these into an indexed mesh by hashing the raw bits
+        of the packed vertex, which is both smaller on disk and what later cache optimisation passes need.
+
+ */
+
+inline u32 ChunkVertexHash(v4 Vertex)
+{
+    // NOTE: memcpy instead of a pointer cast, strict aliasing lets GCC/Clang hash stale bits otherwise
+    u32 Bits[4];
+    memcpy(Bits, &Vertex, sizeof(Bits));
+    u32 Result = 2166136261u;
+    for (u32 WordId = 0; WordId < 4; ++WordId)
+    {
+        Result = (Result ^ Bits[WordId]) * 16777619u;
+    }
+
+    // NOTE: The table is indexed by the low bits, which FNV over whole words barely mixes, so finish with an avalanche step
+    Result ^= Result >> 16;
+    Result *= 0x85EBCA6Bu;
+    Result ^= Result >> 13;
+    Result *= 0xC2B2AE35u;
+    Result ^= Result >> 16;
+    
+    return Result;
+}
+
+inline b32 ChunkVertexEqual(v4 A, v4 B)
+{
+    b32 Result = memcmp(&A, &B, sizeof(v4)) == 0;
+    return Result;
+}
+
+// NOTE: Returns the number of unique vertices written to OutVertices. OutIndices receives NumSoupVertices indices.
+inline u32 ChunkMeshWeld(v4* SoupVertices, u32 NumSoupVertices, v4* OutVertices, u32* OutIndices)
+{
+    u32 NumSlots = 1;
+    while (NumSlots < 2*NumSoupVertices)
+    {
+        NumSlots <<= 1;
+    }
+
+    u64 TableSize = sizeof(u32)*NumSlots;
+    u32* HashTable = (u32*)DemoMemoryAlloc(TableSize);
+    if (!HashTable)
+    {
+        // NOTE: Out of scratch memory, keep the soup as is (every vertex used once) instead of failing the bake
+        for (u32 SoupId = 0; SoupId < NumSoupVertices; ++SoupId)
+        {
+            OutVertices[SoupId] = SoupVertices[SoupId];
+            OutIndices[SoupId] = SoupId;
+        }
+        return NumSoupVertices;
+    }
+    memset(HashTable, 0xFF, TableSize);
+
+    u32 NumVertices = 0;
+    for (u32 SoupId = 0; SoupId < NumSoupVertices; ++SoupId)
+    {
+        v4 Vertex = SoupVertices[SoupId];
+        u32 SlotId = ChunkVertexHash(Vertex) & (NumSlots - 1);
+        while (true)
+        {
+            u32 VertexId = HashTable[SlotId];
+            if (VertexId == 0xFFFFFFFF)
+            {
+                VertexId = NumVertices++;
+                HashTable[SlotId] = VertexId;
+                OutVertices[VertexId] = Vertex;
+                OutIndices[SoupId] = VertexId;
+                break;
+            }
+            else if (ChunkVertexEqual(OutVertices[VertexId], Vertex))
+            {
+                OutIndices[SoupId] = VertexId;
+                break;
+            }
+
+            SlotId = (SlotId + 1) & (NumSlots - 1);
+        }
+    }
+
+    DemoMemoryFree(HashTable, TableSize);
+
+    return NumVertices;
+}
+
+//
+// NOTE: Mesh Optimization
+//
+
+/*
+
+  NOTE: The mesher emits triangles in whatever order the GPU threads won their atomics, so neighbouring triangles in the index buffer
+        are rarely neighbours on the surface. Baked chunks are static so we can afford to fix that once on the CPU:
+
+        - ChunkMeshOptimizeVertexCache is Tom Forsyth's "Linear-Speed Vertex Cache Optimisation". Vertices are scored by their
+          position in a simulated LRU cache and by how many unemitted triangles still use them, and we greedily emit the best scoring
+          triangle touching the cache.
+        - ChunkMeshOptimizeVertexFetch then renumbers vertices in the order the reordered index buffer first touches them.
+
+ */
+
+inline chunk_mesh_cache_stats ChunkMeshCacheStatsCompute(u32* Indices, u32 NumIndices, u32 NumVertices)
+{
+    chunk_mesh_cache_stats Result = {};
+    Result.NumTriangles = NumIndices / 3;
+    Result.NumVertices = NumVertices;
+    if (NumIndices == 0)
+    {
+        return Result;
+    }
+
+    // NOTE: FIFO simulation, a vertex is in the cache if fewer than CacheSize misses happened since it was loaded
+    u64 TimestampSize = sizeof(u32)*NumVertices;
+    u32* Timestamps = (u32*)DemoMemoryAlloc(TimestampSize);
+    memset(Timestamps, 0, TimestampSize);
+
+    u32 Time = CHUNK_MESH_FIFO_CACHE_SIZE + 1;
+    for (u32 IndexId = 0; IndexId < NumIndices; ++IndexId)
+    {
+        u32 VertexId = Indices[IndexId];
+        if (Time - Timestamps[VertexId] > CHUNK_MESH_FIFO_CACHE_SIZE)
+        {
+            Timestamps[VertexId] = Time++;
+            Result.NumTransformed += 1;
+        }
+    }
+
+    DemoMemoryFree(Timestamps, TimestampSize);
+
+    Result.Acmr = f32(f64(Result.NumTransformed) / f64(Result.NumTriangles));
+    Result.Atvr = f32(f64(Result.NumTransformed) / f64(Result.NumVertices));
+    return Result;
+}
+
+inline void ChunkMeshCacheStatsAccumulate(chunk_mesh_cache_stats* Total, chunk_mesh_cache_stats Stats)
+{
+    Total->NumTriangles += Stats.NumTriangles;
+    Total->NumVertices += Stats.NumVertices;
+    Total->NumTransformed += Stats.NumTransformed;
+    Total->Acmr = Total->NumTriangles ? f32(f64(Total->NumTransformed) / f64(Total->NumTriangles)) : 0.0f;
+    Total->Atvr = Total->NumVertices ? f32(f64(Total->NumTransformed) / f64(Total->NumVertices)) : 0.0f;
+}
+
+inline f32 ChunkMeshForsythVertexScore(i32 CachePos, u32 NumRemainingTriangles)
+{
+    if (NumRemainingTriangles == 0)
+    {
+        // NOTE: Nothing left to emit with this vertex
+        return -1.0f;
+    }
+
+    f32 Result = 0.0f;
+    if (CachePos >= 0)
+    {
+        if (CachePos < 3)
+        {
+            // NOTE: Vertices of the last triangle get a fixed score so we don't just strip along
+            Result = 0.75f;
+        }
+        else
+        {
+            Assert(CachePos < CHUNK_MESH_FORSYTH_CACHE_SIZE);
+            f32 Scaler = 1.0f / f32(CHUNK_MESH_FORSYTH_CACHE_SIZE - 3);
+            Result = 1.0f - f32(CachePos - 3)*Scaler;
+            Result = powf(Result, 1.5f);
+        }
+    }
+
+    // NOTE: Boost vertices with few triangles left so we finish them off instead of leaving lone triangles behind
+    Result += 2.0f * powf(f32(NumRemainingTriangles), -0.5f);
+    return Result;
+}
+
+inline void ChunkMeshOptimizeVertexCache(u32* Indices, u32 NumIndices, u32 NumVertices, u32* OutIndices)
+{
+    u32 NumTriangles = NumIndices / 3;
+    if (NumTriangles == 0)
+    {
+        return;
+    }
+
+    // NOTE: Scratch layout, all of it lives for the duration of the reorder
+    u64 ScratchSize = (sizeof(u32)*NumVertices +      // NOTE: AdjacencyOffsets
+                       sizeof(u32)*NumVertices +      // NOTE: NumRemaining
+                       sizeof(i32)*NumVertices +      // NOTE: CachePos
+                       sizeof(f32)*NumVertices +      // NOTE: VertexScores
+                       sizeof(u32)*NumIndices +       // NOTE: Adjacency
+                       sizeof(f32)*NumTriangles +     // NOTE: TriangleScores
+                       sizeof(u8)*NumTriangles);      // NOTE: Emitted
+    u8* Scratch = (u8*)DemoMemoryAlloc(ScratchSize);
+    u8* CurrScratch = Scratch;
+    u32* AdjacencyOffsets = (u32*)CurrScratch; CurrScratch += sizeof(u32)*NumVertices;
+    u32* NumRemaining = (u32*)CurrScratch; CurrScratch += sizeof(u32)*NumVertices;
+    i32* CachePos = (i32*)CurrScratch; CurrScratch += sizeof(i32)*NumVertices;
+    f32* VertexScores = (f32*)CurrScratch; CurrScratch += sizeof(f32)*NumVertices;
+    u32* Adjacency = (u32*)CurrScratch; CurrScratch += sizeof(u32)*NumIndices;
+    f32* TriangleScores = (f32*)CurrScratch; CurrScratch += sizeof(f32)*NumTriangles;
+    u8* Emitted = (u8*)CurrScratch;
+
+    // NOTE: Build vertex -> triangle adjacency. NumRemaining doubles as the fill cursor and ends up as each vertex's valence
+    memset(NumRemaining, 0, sizeof(u32)*NumVertices);
+    for (u32 IndexId = 0; IndexId < NumIndices; ++IndexId)
+    {
+        NumRemaining[Indices[IndexId]] += 1;
+    }
+
+    u32 CurrOffset = 0;
+    for (u32 VertexId = 0; VertexId < NumVertices; ++VertexId)
+    {
+        AdjacencyOffsets[VertexId] = CurrOffset;
+        CurrOffset += NumRemaining[VertexId];
+        NumRemaining[VertexId] = 0;
+    }
+
+    for (u32 TriangleId = 0; TriangleId < NumTriangles; ++TriangleId)
+    {
+        for (u32 CornerId = 0; CornerId < 3; ++CornerId)
+        {
+            u32 VertexId = Indices[3*TriangleId + CornerId];
+            Adjacency[AdjacencyOffsets[VertexId] + NumRemaining[VertexId]++] = TriangleId;
+        }
+    }
+
+    for (u32 VertexId = 0; VertexId < NumVertices; ++VertexId)
+    {
+        CachePos[VertexId] = -1;
+        VertexScores[VertexId] = ChunkMeshForsythVertexScore(-1, NumRemaining[VertexId]);
+    }
+
+    for (u32 TriangleId = 0; TriangleId < NumTriangles; ++TriangleId)
+    {
+        Emitted[TriangleId] = 0;
+        TriangleScores[TriangleId] = (VertexScores[Indices[3*TriangleId + 0]] +
+                                      VertexScores[Indices[3*TriangleId + 1]] +
+                                      VertexScores[Indices[3*TriangleId + 2]]);
+    }
+
+    // NOTE: The cache holds up to 3 extra entries while we insert a triangle, the tail gets evicted afterwards
+    u32 Cache[CHUNK_MESH_FORSYTH_CACHE_SIZE + 3];
+    u32 NewCache[CHUNK_MESH_FORSYTH_CACHE_SIZE + 3];
+    u32 CacheCount = 0;
+
+    u32 BestTriangle = 0;
+    f32 BestScore = -1.0f;
+    for (u32 TriangleId = 0; TriangleId < NumTriangles; ++TriangleId)
+    {
+        if (TriangleScores[TriangleId] > BestScore)
+        {
+            BestScore = TriangleScores[TriangleId];
+            BestTriangle = TriangleId;
+        }
+    }
+
+    u32 ScanCursor = 0;
+    for (u32 OutTriangleId = 0; OutTriangleId < NumTriangles; ++OutTriangleId)
+    {
+        if (BestScore < 0.0f)
+        {
+            // NOTE: Nothing in the cache touches an unemitted triangle, continue with the next unemitted triangle in input order
+            while (Emitted[ScanCursor])
+            {
+                ScanCursor += 1;
+            }
+            BestTriangle = ScanCursor;
+        }
+
+        u32* Triangle = Indices + 3*BestTriangle;
+        OutIndices[3*OutTriangleId + 0] = Triangle[0];
+        OutIndices[3*OutTriangleId + 1] = Triangle[1];
+        OutIndices[3*OutTriangleId + 2] = Triangle[2];
+        Emitted[BestTriangle] = 1;
+
+        // NOTE: Remove the triangle from its vertices adjacency lists
+        for (u32 CornerId = 0; CornerId < 3; ++CornerId)
+        {
+            u32 VertexId = Triangle[CornerId];
+            u32* VertexTriangles = Adjacency + AdjacencyOffsets[VertexId];
+            for (u32 AdjacentId = 0; AdjacentId < NumRemaining[VertexId]; ++AdjacentId)
+            {
+                if (VertexTriangles[AdjacentId] == BestTriangle)
+                {
+                    VertexTriangles[AdjacentId] = VertexTriangles[NumRemaining[VertexId] - 1];
+                    break;
+                }
+            }
+            NumRemaining[VertexId] -= 1;
+        }
+
+        // NOTE: Move the triangles vertices to the front of the LRU cache
+        u32 NewCacheCount = 0;
+        NewCache[NewCacheCount++] = Triangle[0];
+        NewCache[NewCacheCount++] = Triangle[1];
+        NewCache[NewCacheCount++] = Triangle[2];
+        for (u32 CacheId = 0; CacheId < CacheCount; ++CacheId)
+        {
+            u32 VertexId = Cache[CacheId];
+            if (VertexId != Triangle[0] && VertexId != Triangle[1] && VertexId != Triangle[2])
+            {
+                NewCache[NewCacheCount++] = VertexId;
+            }
+        }
+
+        // NOTE: Rescore everything that was in the cache, evicted vertices included since their cache bonus is gone
+        for (u32 CacheId = 0; CacheId < NewCacheCount; ++CacheId)
+        {
+            u32 VertexId = NewCache[CacheId];
+            i32 NewPos = CacheId < CHUNK_MESH_FORSYTH_CACHE_SIZE ? i32(CacheId) : -1;
+            CachePos[VertexId] = NewPos;
+
+            f32 NewScore = ChunkMeshForsythVertexScore(NewPos, NumRemaining[VertexId]);
+            f32 ScoreDelta = NewScore - VertexScores[VertexId];
+            VertexScores[VertexId] = NewScore;
+
+            u32* VertexTriangles = Adjacency + AdjacencyOffsets[VertexId];
+            for (u32 AdjacentId = 0; AdjacentId < NumRemaining[VertexId]; ++AdjacentId)
+            {
+                TriangleScores[VertexTriangles[AdjacentId]] += ScoreDelta;
+            }
+        }
+
+        CacheCount = NewCacheCount < CHUNK_MESH_FORSYTH_CACHE_SIZE ? NewCacheCount : CHUNK_MESH_FORSYTH_CACHE_SIZE;
+        for (u32 CacheId = 0; CacheId < CacheCount; ++CacheId)
+        {
+            Cache[CacheId] = NewCache[CacheId];
+        }
+
+        // NOTE: Only triangles touching the cache changed score, so the next best one is among them
+        BestScore = -1.0f;
+        for (u32 CacheId = 0; CacheId < CacheCount; ++CacheId)
+        {
+            u32 VertexId = Cache[CacheId];
+            u32* VertexTriangles = Adjacency + AdjacencyOffsets[VertexId];
+            for (u32 AdjacentId = 0; AdjacentId < NumRemaining[VertexId]; ++AdjacentId)
+            {
+                u32 TriangleId = VertexTriangles[AdjacentId];
+                if (TriangleScores[TriangleId] > BestScore)
+                {
+                    BestScore = TriangleScores[TriangleId];
+                    BestTriangle = TriangleId;
+                }
+            }
+        }
+    }
+
+    DemoMemoryFree(Scratch, ScratchSize);
+}
+
+// NOTE: Renumbers vertices in first use order, Indices (and LodIndices which index the same vertices) are rewritten in place. Returns
+// the number of referenced vertices.
+inline u32 ChunkMeshOptimizeVertexFetch(v4* Vertices, u32 NumVertices, u32* Indices, u32 NumIndices, u32* LodIndices, u32 NumLodIndices,
+                                        v4* OutVertices)
+{
+    u64 RemapSize = sizeof(u32)*NumVertices;
+    u32* Remap = (u32*)DemoMemoryAlloc(RemapSize);
+    memset(Remap, 0xFF, RemapSize);
+
+    u32 NumOutVertices = 0;
+    for (u32 IndexId = 0; IndexId < NumIndices; ++IndexId)
+    {
+        u32 VertexId = Indices[IndexId];
+        if (Remap[VertexId] == 0xFFFFFFFF)
+        {
+            Remap[VertexId] = NumOutVertices;
+            OutVertices[NumOutVertices++] = Vertices[VertexId];
+        }
+
+        Indices[IndexId] = Remap[VertexId];
+    }
+
+    for (u32 IndexId = 0; IndexId < NumLodIndices; ++IndexId)
+    {
+        Assert(Remap[LodIndices[IndexId]] != 0xFFFFFFFF);
+        LodIndices[IndexId] = Remap[LodIndices[IndexId]];
+    }
+    
+    DemoMemoryFree(Remap, RemapSize);
+
+    return NumOutVertices;
+}
+
+//
+// NOTE: Mesh Simplification
+//
+
+/*
+
+  NOTE: Garland-Heckbert quadric error simplification, restricted to half edge collapses (v -> u moves v onto u). That keeps every
+        surviving vertex bit exact, so the LOD can share the full meshes vertex blob and packed positions/normals never get re-encoded.
+
+        - Vertices on the chunk bounds are locked (never the v of a collapse) so the LOD border matches the neighbouring chunks.
+        - Collapses are popped from a lazy min heap, stale entries are detected with per vertex versions.
+        - A collapse is rejected if it would flip or degenerate any triangle around v.
+        - We stop at the target triangle count or when the cheapest collapse exceeds the error tolerance.
+
+        The reported error is a vertex sampled Hausdorff distance: every original vertex is measured against the triangles around the
+        vertex it was collapsed into. Surviving vertices lie on the original surface so the other direction is covered by the samples.
+
+ */
+
+struct chunk_quadric
+{
+    f64 A00, A01, A02, A11, A12, A22;
+    f64 B0, B1, B2;
+    f64 C;
+};
+
+struct chunk_collapse
+{
+    f32 Cost; // NOTE: Quadric error + a small edge length term so flat areas (all zero error) collapse short edges first
+    f32 Error;
+    u32 V;
+    u32 U;
+    u32 VersionV;
+    u32 VersionU;
+};
+
+struct chunk_collapse_heap
+{
+    u32 NumEntries;
+    u32 MaxEntries;
+    chunk_collapse* Entries;
+};
+
+inline v3 ChunkVertexUnpackPosition(v4 Vertex)
+{
+    // NOTE: Mirrors the unpack in forward_shader.cpp
+    u32 Words[2];
+    memcpy(Words, &Vertex, sizeof(Words));
+    u64 Packed = u64(Words[0]) | (u64(Words[1]) << 32);
+
+    i32 PosX = i32(u32((Packed >> 0) & 0x1FFFFF) << 11);
+    i32 PosY = i32(u32((Packed >> 21) & 0x1FFFFF) << 11);
+    i32 PosZ = i32(u32((Packed >> 42) & 0x0FFFFF) << 12);
+
+    f32 Scale = 1.0f / 2147483648.0f;
+    v3 Result = V3(f32(PosX)*Scale, f32(PosY)*Scale, f32(PosZ)*Scale);
+    return Result;
+}
+
+inline chunk_quadric ChunkQuadricFromPlane(v3 Normal, f32 Distance, f32 Weight)
+{
+    chunk_quadric Result = {};
+    Result.A00 = Weight*Normal.x*Normal.x;
+    Result.A01 = Weight*Normal.x*Normal.y;
+    Result.A02 = Weight*Normal.x*Normal.z;
+    Result.A11 = Weight*Normal.y*Normal.y;
+    Result.A12 = Weight*Normal.y*Normal.z;
+    Result.A22 = Weight*Normal.z*Normal.z;
+    Result.B0 = Weight*Normal.x*Distance;
+    Result.B1 = Weight*Normal.y*Distance;
+    Result.B2 = Weight*Normal.z*Distance;
+    Result.C = Weight*Distance*Distance;
+    return Result;
+}
+
+inline void ChunkQuadricAdd(chunk_quadric* A, chunk_quadric* B)
+{
+    A->A00 += B->A00; A->A01 += B->A01; A->A02 += B->A02;
+    A->A11 += B->A11; A->A12 += B->A12; A->A22 += B->A22;
+    A->B0 += B->B0; A->B1 += B->B1; A->B2 += B->B2;
+    A->C += B->C;
+}
+
+inline f64 ChunkQuadricEval(chunk_quadric* Q, v3 P)
+{
+    f64 X = P.x, Y = P.y, Z = P.z;
+    f64 Result = (Q->A00*X*X + 2.0*Q->A01*X*Y + 2.0*Q->A02*X*Z +
+                  Q->A11*Y*Y + 2.0*Q->A12*Y*Z + Q->A22*Z*Z +
+                  2.0*(Q->B0*X + Q->B1*Y + Q->B2*Z) + Q->C);
+    return Result > 0.0 ? Result : 0.0;
+}
+
+inline void ChunkCollapseHeapPush(chunk_collapse_heap* Heap, chunk_collapse Collapse)
+{
+    if (Heap->NumEntries == Heap->MaxEntries)
+    {
+        u32 NewMaxEntries = 2*Heap->MaxEntries;
+        chunk_collapse* NewEntries = (chunk_collapse*)DemoMemoryAlloc(sizeof(chunk_collapse)*NewMaxEntries);
+        Copy(Heap->Entries, NewEntries, sizeof(chunk_collapse)*Heap->NumEntries);
+        DemoMemoryFree(Heap->Entries, sizeof(chunk_collapse)*Heap->MaxEntries);
+        Heap->Entries = NewEntries;
+        Heap->MaxEntries = NewMaxEntries;
+    }
+
+    u32 EntryId = Heap->NumEntries++;
+    while (EntryId > 0)
+    {
+        u32 ParentId = (EntryId - 1) / 2;
+        if (Heap->Entries[ParentId].Cost <= Collapse.Cost)
+        {
+            break;
+        }
+        Heap->Entries[EntryId] = Heap->Entries[ParentId];
+        EntryId = ParentId;
+    }
+    Heap->Entries[EntryId] = Collapse;
+}
+
+inline chunk_collapse ChunkCollapseHeapPop(chunk_collapse_heap* Heap)
+{
+    chunk_collapse Result = Heap->Entries[0];
+    chunk_collapse Last = Heap->Entries[--Heap->NumEntries];
+
+    u32 EntryId = 0;
+    while (true)
+    {
+        u32 ChildId = 2*EntryId + 1;
+        if (ChildId >= Heap->NumEntries)
+        {
+            break;
+        }
+        if (ChildId + 1 < Heap->NumEntries && Heap->Entries[ChildId + 1].Cost < Heap->Entries[ChildId].Cost)
+        {
+            ChildId += 1;
+        }
+        if (Last.Cost <= Heap->Entries[ChildId].Cost)
+        {
+            break;
+        }
+        Heap->Entries[EntryId] = Heap->Entries[ChildId];
+        EntryId = ChildId;
+    }
+    if (Heap->NumEntries > 0)
+    {
+        Heap->Entries[EntryId] = Last;
+    }
+
+    return Result;
+}
+
+inline f32 ChunkPointTriangleDistance(v3 P, v3 A, v3 B, v3 C)
+{
+    // NOTE: Closest point on triangle, Ericson - Real-Time Collision Detection 5.1.5
+    v3 AB = B - A;
+    v3 AC = C - A;
+    v3 AP = P - A;
+    f32 D1 = Dot(AB, AP);
+    f32 D2 = Dot(AC, AP);
+    if (D1 <= 0.0f && D2 <= 0.0f) return Length(P - A);
+
+    v3 BP = P - B;
+    f32 D3 = Dot(AB, BP);
+    f32 D4 = Dot(AC, BP);
+    if (D3 >= 0.0f && D4 <= D3) return Length(P - B);
+
+    f32 VC = D1*D4 - D3*D2;
+    if (VC <= 0.0f && D1 >= 0.0f && D3 <= 0.0f) return Length(P - (A + AB*(D1 / (D1 - D3))));
+
+    v3 CP = P - C;
+    f32 D5 = Dot(AB, CP);
+    f32 D6 = Dot(AC, CP);
+    if (D6 >= 0.0f && D5 <= D6) return Length(P - C);
+
+    f32 VB = D5*D2 - D1*D6;
+    if (VB <= 0.0f && D2 >= 0.0f && D6 <= 0.0f) return Length(P - (A + AC*(D2 / (D2 - D6))));
+
+    f32 VA = D3*D6 - D5*D4;
+    if (VA <= 0.0f && (D4 - D3) >= 0.0f && (D5 - D6) >= 0.0f) return Length(P - (B + (C - B)*((D4 - D3) / ((D4 - D3) + (D5 - D6)))));
+
+    f32 Denom = 1.0f / (VA + VB + VC);
+    v3 Closest = A + AB*(VB*Denom) + AC*(VC*Denom);
+    return Length(P - Closest);
+}
+
+inline u32 ChunkGridCell(f32 Coord, u32 GridDim)
+{
+    i32 Result = i32(Coord);
+    Result = Result < 0 ? 0 : Result;
+    Result = Result > i32(GridDim) - 1 ? i32(GridDim) - 1 : Result;
+    return u32(Result);
+}
+
+// NOTE: Writes the simplified triangles to OutIndices (NumIndices capacity) and returns the number of indices written
+inline u32 ChunkMeshSimplify(v4* Vertices, u32 NumVertices, u32* Indices, u32 NumIndices, v3 BoundsMin, v3 BoundsMax, u32 TargetTriangles,
+                             f32 MaxError, u32* OutIndices, f32* OutError)
+{
+    *OutError = 0.0f;
+    u32 NumTriangles = NumIndices / 3;
+    if (NumTriangles == 0)
+    {
+        return 0;
+    }
+    
+    u64 ScratchSize = (sizeof(v3)*NumVertices +            // NOTE: Positions
+                       sizeof(chunk_quadric)*NumVertices + // NOTE: Quadrics
+                       sizeof(u32)*NumVertices +           // NOTE: Remap
+                       sizeof(u32)*NumVertices +           // NOTE: Versions
+                       sizeof(u32)*NumVertices +           // NOTE: FirstCorner
+                       sizeof(u8)*NumVertices +            // NOTE: Locked
+                       sizeof(u32)*NumIndices +            // NOTE: Corners (working index buffer)
+                       sizeof(u32)*NumIndices +            // NOTE: NextCorner
+                       sizeof(u8)*NumTriangles);           // NOTE: Dead
+    u8* Scratch = (u8*)DemoMemoryAlloc(ScratchSize);
+    u8* CurrScratch = Scratch;
+    v3* Positions = (v3*)CurrScratch; CurrScratch += sizeof(v3)*NumVertices;
+    chunk_quadric* Quadrics = (chunk_quadric*)CurrScratch; CurrScratch += sizeof(chunk_quadric)*NumVertices;
+    u32* Remap = (u32*)CurrScratch; CurrScratch += sizeof(u32)*NumVertices;
+    u32* Versions = (u32*)CurrScratch; CurrScratch += sizeof(u32)*NumVertices;
+    u32* FirstCorner = (u32*)CurrScratch; CurrScratch += sizeof(u32)*NumVertices;
+    u8* Locked = (u8*)CurrScratch; CurrScratch += sizeof(u8)*NumVertices;
+    u32* Corners = (u32*)CurrScratch; CurrScratch += sizeof(u32)*NumIndices;
+    u32* NextCorner = (u32*)CurrScratch; CurrScratch += sizeof(u32)*NumIndices;
+    u8* Dead = (u8*)CurrScratch;
+
+    // NOTE: Positions, locks and per vertex corner lists (corner c is vertex Corners[c] of triangle c / 3)
+    f32 LockEpsilon = 1e-5f;
+    for (u32 VertexId = 0; VertexId < NumVertices; ++VertexId)
+    {
+        v3 Pos = ChunkVertexUnpackPosition(Vertices[VertexId]);
+        Positions[VertexId] = Pos;
+        Quadrics[VertexId] = {};
+        Remap[VertexId] = VertexId;
+        Versions[VertexId] = 0;
+        FirstCorner[VertexId] = 0xFFFFFFFF;
+        Locked[VertexId] = (Pos.x - BoundsMin.x <= LockEpsilon || BoundsMax.x - Pos.x <= LockEpsilon ||
+                            Pos.y - BoundsMin.y <= LockEpsilon || BoundsMax.y - Pos.y <= LockEpsilon ||
+                            Pos.z - BoundsMin.z <= LockEpsilon || BoundsMax.z - Pos.z <= LockEpsilon);
+    }
+
+    for (u32 CornerId = 0; CornerId < NumIndices; ++CornerId)
+    {
+        u32 VertexId = Indices[CornerId];
+        Corners[CornerId] = VertexId;
+        NextCorner[CornerId] = FirstCorner[VertexId];
+        FirstCorner[VertexId] = CornerId;
+    }
+
+    // NOTE: Plane quadrics
+    u32 NumLiveTriangles = 0;
+    for (u32 TriangleId = 0; TriangleId < NumTriangles; ++TriangleId)
+    {
+        u32* Triangle = Corners + 3*TriangleId;
+        v3 Normal = Cross(Positions[Triangle[1]] - Positions[Triangle[0]], Positions[Triangle[2]] - Positions[Triangle[0]]);
+        f32 DoubleArea = Length(Normal);
+        Dead[TriangleId] = (Triangle[0] == Triangle[1] || Triangle[1] == Triangle[2] || Triangle[0] == Triangle[2]);
+        if (Dead[TriangleId] || DoubleArea <= 0.0f)
+        {
+            continue;
+        }
+        NumLiveTriangles += 1;
+        
+        Normal = Normal / DoubleArea;
+        // NOTE: Unweighted planes, so a cost <= MaxError^2 bounds the distance to every plane the vertex touched
+        chunk_quadric Quadric = ChunkQuadricFromPlane(Normal, -Dot(Normal, Positions[Triangle[0]]), 1.0f);
+        ChunkQuadricAdd(Quadrics + Triangle[0], &Quadric);
+        ChunkQuadricAdd(Quadrics + Triangle[1], &Quadric);
+        ChunkQuadricAdd(Quadrics + Triangle[2], &Quadric);
+    }
+
+    f32 EdgeLengthWeight = 1e-3f;
+    chunk_collapse_heap Heap = {};
+    Heap.MaxEntries = 2*NumIndices;
+    Heap.Entries = (chunk_collapse*)DemoMemoryAlloc(sizeof(chunk_collapse)*Heap.MaxEntries);
+
+#define CHUNK_COLLAPSE_PUSH(FromId, ToId)                               \
+    if (!Locked[FromId])                                                \
+    {                                                                   \
+        chunk_quadric Sum = Quadrics[FromId];                           \
+        ChunkQuadricAdd(&Sum, Quadrics + (ToId));                       \
+        chunk_collapse Collapse = {};                                   \
+        Collapse.Error = f32(ChunkQuadricEval(&Sum, Positions[ToId]));  \
+        Collapse.Cost = (Collapse.Error +                               \
+                         EdgeLengthWeight*LengthSquared(Positions[ToId] - Positions[FromId])); \
+        Collapse.V = FromId;                                            \
+        Collapse.U = ToId;                                              \
+        Collapse.VersionV = Versions[FromId];                           \
+        Collapse.VersionU = Versions[ToId];                             \
+        ChunkCollapseHeapPush(&Heap, Collapse);                         \
+    }
+
+    for (u32 TriangleId = 0; TriangleId < NumTriangles; ++TriangleId)
+    {
+        if (Dead[TriangleId])
+        {
+            continue;
+        }
+        
+        for (u32 EdgeId = 0; EdgeId < 3; ++EdgeId)
+        {
+            u32 A = Corners[3*TriangleId + EdgeId];
+            u32 B = Corners[3*TriangleId + (EdgeId + 1) % 3];
+            CHUNK_COLLAPSE_PUSH(A, B);
+            CHUNK_COLLAPSE_PUSH(B, A);
+        }
+    }
+
+    // NOTE: Quadrics are sums of squared distances so compare against the squared tolerance
+    f32 MaxCost = MaxError*MaxError;
+    while (NumLiveTriangles > TargetTriangles && Heap.NumEntries > 0)
+    {
+        chunk_collapse Collapse = ChunkCollapseHeapPop(&Heap);
+        u32 V = Collapse.V;
+        u32 U = Collapse.U;
+        if (Remap[V] != V || Remap[U] != U || Versions[V] != Collapse.VersionV || Versions[U] != Collapse.VersionU)
+        {
+            continue;
+        }
+
+        if (Collapse.Error > MaxCost)
+        {
+            continue;
+        }
+
+        // NOTE: Reject collapses that flip or squash a triangle that survives it
+        b32 Valid = true;
+        for (u32 CornerId = FirstCorner[V]; CornerId != 0xFFFFFFFF && Valid; CornerId = NextCorner[CornerId])
+        {
+            u32 TriangleId = CornerId / 3;
+            u32* Triangle = Corners + 3*TriangleId;
+            if (Dead[TriangleId] || Triangle[0] == U || Triangle[1] == U || Triangle[2] == U)
+            {
+                continue;
+            }
+
+            v3 P0 = Positions[Triangle[0]];
+            v3 P1 = Positions[Triangle[1]];
+            v3 P2 = Positions[Triangle[2]];
+            v3 OldNormal = Cross(P1 - P0, P2 - P0);
+            v3* Moved = (Triangle[0] == V) ? &P0 : (Triangle[1] == V) ? &P1 : &P2;
+            *Moved = Positions[U];
+            v3 NewNormal = Cross(P1 - P0, P2 - P0);
+
+            f32 OldLength = Length(OldNormal);
+            f32 NewLength = Length(NewNormal);
+            Valid = (NewLength > 1e-12f && Dot(OldNormal, NewNormal) > 0.2f*OldLength*NewLength);
+        }
+
+        if (!Valid)
+        {
+            continue;
+        }
+
+        // NOTE: Move v's corners onto u, triangles containing both die
+        u32 LastCorner = 0xFFFFFFFF;
+        for (u32 CornerId = FirstCorner[V]; CornerId != 0xFFFFFFFF; CornerId = NextCorner[CornerId])
+        {
+            u32 TriangleId = CornerId / 3;
+            u32* Triangle = Corners + 3*TriangleId;
+            if (!Dead[TriangleId] && (Triangle[0] == U || Triangle[1] == U || Triangle[2] == U))
+            {
+                Dead[TriangleId] = true;
+                NumLiveTriangles -= 1;
+            }
+            
+            Corners[CornerId] = U;
+            LastCorner = CornerId;
+        }
+
+        if (LastCorner != 0xFFFFFFFF)
+        {
+            NextCorner[LastCorner] = FirstCorner[U];
+            FirstCorner[U] = FirstCorner[V];
+        }
+        FirstCorner[V] = 0xFFFFFFFF;
+        
+        ChunkQuadricAdd(Quadrics + U, Quadrics + V);
+        Remap[V] = U;
+        Versions[V] += 1;
+        Versions[U] += 1;
+
+        // NOTE: Every edge touching u changed cost. Dead corners get unlinked here so u's list doesn't keep growing.
+        u32* PrevLink = FirstCorner + U;
+        for (u32 CornerId = FirstCorner[U]; CornerId != 0xFFFFFFFF; CornerId = NextCorner[CornerId])
+        {
+            u32 TriangleId = CornerId / 3;
+            if (Dead[TriangleId])
+            {
+                *PrevLink = NextCorner[CornerId];
+                continue;
+            }
+            PrevLink = NextCorner + CornerId;
+
+            for (u32 OtherId = 0; OtherId < 3; ++OtherId)
+            {
+                u32 W = Corners[3*TriangleId + OtherId];
+                if (W != U)
+                {
+                    CHUNK_COLLAPSE_PUSH(W, U);
+                    CHUNK_COLLAPSE_PUSH(U, W);
+                }
+            }
+        }
+    }
+
+#undef CHUNK_COLLAPSE_PUSH
+
+    DemoMemoryFree(Heap.Entries, sizeof(chunk_collapse)*Heap.MaxEntries);
+
+    u32 NumOutIndices = 0;
+    for (u32 TriangleId = 0; TriangleId < NumTriangles; ++TriangleId)
+    {
+        if (!Dead[TriangleId])
+        {
+            OutIndices[NumOutIndices++] = Corners[3*TriangleId + 0];
+            OutIndices[NumOutIndices++] = Corners[3*TriangleId + 1];
+            OutIndices[NumOutIndices++] = Corners[3*TriangleId + 2];
+        }
+    }
+
+    // NOTE: Vertex sampled Hausdorff error. Surviving triangles are binned into a uniform grid and every removed vertex searches it ring
+    // by ring for the closest triangle
+    f32 MaxDistance = 0.0f;
+    u32 NumOutTriangles = NumOutIndices / 3;
+    if (NumOutTriangles > 0)
+    {
+        u32 GridDim = CHUNK_MESH_ERROR_GRID_DIM;
+        u32 NumCells = GridDim*GridDim*GridDim;
+        v3 GridMin = BoundsMin - V3(LockEpsilon);
+        v3 GridSize = (BoundsMax + V3(LockEpsilon)) - GridMin;
+        v3 CellDim = GridSize / f32(GridDim);
+        f32 MinCellDim = CellDim.x < CellDim.y ? CellDim.x : CellDim.y;
+        MinCellDim = CellDim.z < MinCellDim ? CellDim.z : MinCellDim;
+
+        u64 GridScratchSize = sizeof(u32)*(NumCells + 1) + sizeof(u32)*6*NumOutTriangles;
+        u8* GridScratch = (u8*)DemoMemoryAlloc(GridScratchSize);
+        u32* CellOffsets = (u32*)GridScratch;
+        u32* TriangleCells = CellOffsets + NumCells + 1; // NOTE: Min/max cell per triangle
+        memset(CellOffsets, 0, sizeof(u32)*(NumCells + 1));
+
+#define CHUNK_GRID_CELL(Axis, Value) ChunkGridCell((Value - GridMin.Axis) / CellDim.Axis, GridDim)
+        
+        for (u32 TriangleId = 0; TriangleId < NumOutTriangles; ++TriangleId)
+        {
+            v3 P0 = Positions[OutIndices[3*TriangleId + 0]];
+            v3 P1 = Positions[OutIndices[3*TriangleId + 1]];
+            v3 P2 = Positions[OutIndices[3*TriangleId + 2]];
+            v3 TriMin = P0;
+            v3 TriMax = P0;
+            for (u32 AxisId = 0; AxisId < 3; ++AxisId)
+            {
+                TriMin.e[AxisId] = P1.e[AxisId] < TriMin.e[AxisId] ? P1.e[AxisId] : TriMin.e[AxisId];
+                TriMin.e[AxisId] = P2.e[AxisId] < TriMin.e[AxisId] ? P2.e[AxisId] : TriMin.e[AxisId];
+                TriMax.e[AxisId] = P1.e[AxisId] > TriMax.e[AxisId] ? P1.e[AxisId] : TriMax.e[AxisId];
+                TriMax.e[AxisId] = P2.e[AxisId] > TriMax.e[AxisId] ? P2.e[AxisId] : TriMax.e[AxisId];
+            }
+            
+            u32* Cells = TriangleCells + 6*TriangleId;
+            Cells[0] = CHUNK_GRID_CELL(x, TriMin.x);
+            Cells[1] = CHUNK_GRID_CELL(y, TriMin.y);
+            Cells[2] = CHUNK_GRID_CELL(z, TriMin.z);
+            Cells[3] = CHUNK_GRID_CELL(x, TriMax.x);
+            Cells[4] = CHUNK_GRID_CELL(y, TriMax.y);
+            Cells[5] = CHUNK_GRID_CELL(z, TriMax.z);
+            for (u32 Z = Cells[2]; Z <= Cells[5]; ++Z)
+                for (u32 Y = Cells[1]; Y <= Cells[4]; ++Y)
+                    for (u32 X = Cells[0]; X <= Cells[3]; ++X)
+                    {
+                        CellOffsets[(Z*GridDim + Y)*GridDim + X + 1] += 1;
+                    }
+        }
+
+        for (u32 CellId = 0; CellId < NumCells; ++CellId)
+        {
+            CellOffsets[CellId + 1] += CellOffsets[CellId];
+        }
+
+        u64 CellTrianglesSize = sizeof(u32)*CellOffsets[NumCells];
+        u64 CellFillSize = sizeof(u32)*NumCells;
+        u32* CellTriangles = (u32*)DemoMemoryAlloc(CellTrianglesSize);
+        u32* CellFill = (u32*)DemoMemoryAlloc(CellFillSize);
+        memset(CellFill, 0, CellFillSize);
+        for (u32 TriangleId = 0; TriangleId < NumOutTriangles; ++TriangleId)
+        {
+            u32* Cells = TriangleCells + 6*TriangleId;
+            for (u32 Z = Cells[2]; Z <= Cells[5]; ++Z)
+                for (u32 Y = Cells[1]; Y <= Cells[4]; ++Y)
+                    for (u32 X = Cells[0]; X <= Cells[3]; ++X)
+                    {
+                        u32 CellId = (Z*GridDim + Y)*GridDim + X;
+                        CellTriangles[CellOffsets[CellId] + CellFill[CellId]++] = TriangleId;
+                    }
+        }
+        
+        for (u32 VertexId = 0; VertexId < NumVertices; ++VertexId)
+        {
+            if (Remap[VertexId] == VertexId)
+            {
+                // NOTE: Surviving vertices are on both surfaces
+                continue;
+            }
+
+            v3 Pos = Positions[VertexId];
+            i32 CellX = CHUNK_GRID_CELL(x, Pos.x);
+            i32 CellY = CHUNK_GRID_CELL(y, Pos.y);
+            i32 CellZ = CHUNK_GRID_CELL(z, Pos.z);
+            f32 MinDistance = -1.0f;
+            for (i32 Ring = 0; Ring < i32(GridDim); ++Ring)
+            {
+                for (i32 Z = CellZ - Ring; Z <= CellZ + Ring; ++Z)
+                    for (i32 Y = CellY - Ring; Y <= CellY + Ring; ++Y)
+                        for (i32 X = CellX - Ring; X <= CellX + Ring; ++X)
+                        {
+                            b32 OnRing = (X == CellX - Ring || X == CellX + Ring || Y == CellY - Ring || Y == CellY + Ring ||
+                                          Z == CellZ - Ring || Z == CellZ + Ring);
+                            b32 InGrid = (X >= 0 && Y >= 0 && Z >= 0 && X < i32(GridDim) && Y < i32(GridDim) && Z < i32(GridDim));
+                            if (!OnRing || !InGrid)
+                            {
+                                continue;
+                            }
+
+                            u32 CellId = (Z*GridDim + Y)*GridDim + X;
+                            for (u32 EntryId = CellOffsets[CellId]; EntryId < CellOffsets[CellId + 1]; ++EntryId)
+                            {
+                                u32* Triangle = OutIndices + 3*CellTriangles[EntryId];
+                                f32 Distance = ChunkPointTriangleDistance(Pos, Positions[Triangle[0]], Positions[Triangle[1]],
+                                                                          Positions[Triangle[2]]);
+                                MinDistance = (MinDistance < 0.0f || Distance < MinDistance) ? Distance : MinDistance;
+                            }
+                        }
+
+                // NOTE: Anything in the next ring is at least Ring cells away
+                if (MinDistance >= 0.0f && MinDistance <= f32(Ring)*MinCellDim)
+                {
+                    break;
+                }
+            }
+
+            MaxDistance = MinDistance > MaxDistance ? MinDistance : MaxDistance;
+        }
+
+#undef CHUNK_GRID_CELL
+        
+        DemoMemoryFree(CellFill, CellFillSize);
+        DemoMemoryFree(CellTriangles, CellTrianglesSize);
+        DemoMemoryFree(GridScratch, GridScratchSize);
+    }
+    *OutError = MaxDistance;
+    
+    DemoMemoryFree(Scratch, ScratchSize);
+    
+    return NumOutIndices;
+}
+
+//
+// NOTE: Chunk Mesh Jobs
+//
+
+inline void ChunkMeshJobCallback(void* Data, u32 ThreadId)
+{
+    chunk_mesh_job* Job = (chunk_mesh_job*)Data;
+    Job->NumIndices = Job->NumSoupVertices;
+    if (Job->NumSoupVertices == 0)
+    {
+        return;
+    }
+
+    u64 VertexSize = sizeof(v4)*Job->NumSoupVertices;
+    u64 IndexSize = sizeof(u32)*Job->NumSoupVertices;
+    Job->Vertices = (v4*)DemoMemoryAlloc(VertexSize);
+    Job->Indices = (u32*)DemoMemoryAlloc(IndexSize);
+    Job->NumVertices = ChunkMeshWeld(Job->SoupVertices, Job->NumSoupVertices, Job->Vertices, Job->Indices);
+    Job->Before = ChunkMeshCacheStatsCompute(Job->Indices, Job->NumIndices, Job->NumVertices);
+
+    if (Job->Simplify)
+    {
+        u64 StartTime = DemoTimerGet();
+        u32 TargetTriangles = u32(f32(Job->NumIndices / 3) * CHUNK_MESH_SIMPLIFY_TARGET_RATIO);
+        Job->LodIndices = (u32*)DemoMemoryAlloc(IndexSize);
+        Job->NumLodIndices = ChunkMeshSimplify(Job->Vertices, Job->NumVertices, Job->Indices, Job->NumIndices, Job->BoundsMin, Job->BoundsMax,
+                                               TargetTriangles, CHUNK_MESH_SIMPLIFY_MAX_ERROR*Job->CellSize, Job->LodIndices,
+                                               &Job->LodError);
+        Job->SimplifyMs = DemoTimerElapsedMs(StartTime);
+    }
+    
+    if (Job->Optimize)
+    {
+        u32* CacheIndices = (u32*)DemoMemoryAlloc(IndexSize);
+        ChunkMeshOptimizeVertexCache(Job->Indices, Job->NumIndices, Job->NumVertices, CacheIndices);
+        DemoMemoryFree(Job->Indices, IndexSize);
+        Job->Indices = CacheIndices;
+
+        if (Job->LodIndices)
+        {
+            CacheIndices = (u32*)DemoMemoryAlloc(IndexSize);
+            ChunkMeshOptimizeVertexCache(Job->LodIndices, Job->NumLodIndices, Job->NumVertices, CacheIndices);
+            DemoMemoryFree(Job->LodIndices, IndexSize);
+            Job->LodIndices = CacheIndices;
+        }
+        
+        v4* FetchVertices = (v4*)DemoMemoryAlloc(VertexSize);
+        Job->NumVertices = ChunkMeshOptimizeVertexFetch(Job->Vertices, Job->NumVertices, Job->Indices, Job->NumIndices, Job->LodIndices,
+                                                        Job->NumLodIndices, FetchVertices);
+        DemoMemoryFree(Job->Vertices, VertexSize);
+        Job->Vertices = FetchVertices;
+    }
+
+    Job->After = ChunkMeshCacheStatsCompute(Job->Indices, Job->NumIndices, Job->NumVertices);
+}
+
+inline void ChunkMeshJobFree(chunk_mesh_job* Job)
+{
+    if (Job->Vertices)
+    {
+        DemoMemoryFree(Job->Vertices, sizeof(v4)*Job->NumSoupVertices);
+        DemoMemoryFree(Job->Indices, sizeof(u32)*Job->NumSoupVertices);
+    }
+    if (Job->LodIndices)
+    {
+        DemoMemoryFree(Job->LodIndices, sizeof(u32)*Job->NumSoupVertices);
+    }
+    Job->LodIndices = 0;
+    Job->Vertices = 0;
+    Job->Indices = 0;
+}
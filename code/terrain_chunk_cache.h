@@ -0,0 +1,168 @@
+#pragma once
+
+/*
+
+  NOTE: Chunk Archive Format
+
+    The archive lets us skip terrain generation for baked worlds. The file is laid out so that it can be memory mapped and every blob
+    handed straight to the staging buffer without any parsing or intermediate copies:
+
+    [chunk_archive_header]   - padded to CHUNK_ARCHIVE_ALIGNMENT
+    [blobs]                  - vertex, index and density blobs per chunk, each starting on a CHUNK_ARCHIVE_ALIGNMENT boundary
+    [chunk_archive_entry[]]  - the chunk index, sorted by chunk_key so lookups are a binary search
+
+    Vertices are stored in the same packed format TerrainTriangles uses (vec4 of 21:21:20 fixed point position + normal xy), indices are
+    u32 and density is the raw R16F contents of the chunks TerrainDensity atlas slot, border samples included.
+
+    Every chunk can also carry a simplified LOD index buffer. The simplifier only collapses vertices onto existing ones so the LOD
+    indexes into the same vertex blob as the full mesh.
+
+ */
+
+#define CHUNK_ARCHIVE_FILE_NAME "terrain_chunks.tca"
+#define CHUNK_ARCHIVE_MAGIC 0x4B484354 // NOTE: "TCHK"
+#define CHUNK_ARCHIVE_VERSION 4
+#define CHUNK_ARCHIVE_ALIGNMENT 4096
+
+struct chunk_key
+{
+    i32 X;
+    i32 Y;
+    i32 Z;
+    u32 Lod;
+};
+
+struct chunk_archive_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 Alignment;
+    u32 NumChunks;
+    u64 IndexOffset;
+    u64 FileSize;
+
+    // NOTE: Terrain parameters the archive was baked with
+    u32 VertexStride;
+    u32 IndexStride;
+    u32 DensityTexelSize;
+    u32 Pad0;
+    v3 TerrainPos;
+    u32 Pad1;
+    v3 TerrainRadius;
+    u32 Pad2;
+};
+
+struct chunk_archive_entry
+{
+    chunk_key Key;
+
+    u32 NumVertices;
+    u32 NumIndices;
+    u32 DensityResX;
+    u32 DensityResY;
+    u32 DensityResZ;
+    u32 NumLodIndices;
+    f32 LodError; // NOTE: Hausdorff distance of the LOD mesh to the full mesh, in terrain space
+    u32 Pad;
+
+    u64 VertexOffset;
+    u64 IndexOffset;
+    u64 LodIndexOffset;
+    u64 DensityOffset;
+    u64 DensitySize;
+};
+
+struct chunk_archive
+{
+    demo_file_map Map;
+    chunk_archive_header* Header;
+    chunk_archive_entry* Entries;
+};
+
+struct chunk_archive_writer
+{
+    FILE* File;
+    u64 CurrOffset;
+    chunk_archive_header Header;
+
+    u32 MaxChunks;
+    u32 NumChunks;
+    chunk_archive_entry* Entries;
+};
+
+//
+// NOTE: Mesh optimization for persisted chunks. Triangles are reordered for the post transform cache (Forsyth) and vertices are then
+// remapped into first use order so vertex fetch walks memory linearly.
+//
+
+#define CHUNK_MESH_OPTIMIZE 1
+#define CHUNK_MESH_FORSYTH_CACHE_SIZE 32 // NOTE: Size of the LRU cache the reorder scores against
+#define CHUNK_MESH_FIFO_CACHE_SIZE 16 // NOTE: FIFO cache we measure ACMR/ATVR with, close to what current hardware behaves like
+
+// NOTE: QEM simplification for the LOD index buffer. Collapses stop at whichever of the two limits is hit first.
+#define CHUNK_MESH_SIMPLIFY 1
+#define CHUNK_MESH_SIMPLIFY_TARGET_RATIO 0.25f // NOTE: Target triangle count as a fraction of the full mesh
+#define CHUNK_MESH_SIMPLIFY_MAX_ERROR 0.5f // NOTE: Error tolerance in cells
+#define CHUNK_MESH_ERROR_GRID_DIM 16 // NOTE: Grid the Hausdorff measurement bins the simplified triangles into
+
+struct chunk_mesh_cache_stats
+{
+    u64 NumTriangles;
+    u64 NumVertices;
+    u64 NumTransformed; // NOTE: Cache misses in the simulated FIFO
+
+    // NOTE: Transformed vertices per triangle (0.5 is the best a regular grid can do) and per unique vertex (1.0 is ideal)
+    f32 Acmr;
+    f32 Atvr;
+};
+
+struct chunk_mesh_job
+{
+    // NOTE: Inputs
+    v4* SoupVertices;
+    u32 NumSoupVertices;
+    b32 Optimize;
+    b32 Simplify;
+    v3 BoundsMin; // NOTE: Chunk bounds in terrain space, vertices on them are locked so neighbours still stitch
+    v3 BoundsMax;
+    f32 CellSize;
+
+    // NOTE: Outputs, owned by the job until the bake writes them out
+    v4* Vertices;
+    u32* Indices;
+    u32 NumVertices;
+    u32 NumIndices;
+    u32* LodIndices;
+    u32 NumLodIndices;
+    f32 LodError;
+    f64 SimplifyMs;
+    chunk_mesh_cache_stats Before;
+    chunk_mesh_cache_stats After;
+};
+
+//
+// NOTE: Bake state, we read back the generated terrain over a couple of frames so that we only copy the vertices that got written
+//
+
+enum chunk_bake_stage
+{
+    ChunkBakeStage_None,
+    ChunkBakeStage_ReadbackCount,
+    ChunkBakeStage_ReadbackMesh,
+};
+
+struct chunk_bake_state
+{
+    chunk_bake_stage Stage;
+    b32 CopyRecorded;
+    gpu_buffer Readback;
+
+    // NOTE: Where each chunk slot lands in the readback buffer
+    u32 NumChunks;
+    u32* NumVertices;
+    u64* MeshOffsets;
+    u64* DensityOffsets;
+    u32 NumMeshRegions;
+    VkBufferCopy* MeshRegions;
+    VkBufferImageCopy* DensityRegions;
+};
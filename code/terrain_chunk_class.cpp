@@ -0,0 +1,282 @@
+
+//
+// NOTE: Table
+//
+
+// NOTE: Everything besides the seed that changes the density of a chunk key
+inline u32 ChunkClassGeneratorHash(u32 ResX, u32 ResY, u32 ResZ, v3 Center, v3 Radius, u32 NoiseDim)
+{
+    f32 Words[] =
+        {
+            f32(ResX), f32(ResY), f32(ResZ), Center.x, Center.y, Center.z, Radius.x, Radius.y, Radius.z, f32(NoiseDim),
+            f32(TERRAIN_CHUNK_RES), CHUNK_CLASS_NOISE_AMPLITUDE, CHUNK_CLASS_DENSITY_OFFSET,
+        };
+
+    // NOTE: FNV-1a
+    u32 Result = 2166136261u;
+    u8* Bytes = (u8*)Words;
+    for (u32 ByteId = 0; ByteId < sizeof(Words); ++ByteId)
+    {
+        Result = (Result ^ Bytes[ByteId]) * 16777619u;
+    }
+    return Result;
+}
+
+inline void ChunkClassCacheCreate(chunk_class_cache* Cache, linear_arena* Arena, u32 NumSlots, u32 Seed, u32 GeneratorHash)
+{
+    *Cache = {};
+    Cache->Seed = Seed;
+    Cache->GeneratorHash = GeneratorHash;
+
+    // NOTE: Room for a few seeds worth of our grid, at most half full so probe sequences stay short
+    Cache->Capacity = 1;
+    while (Cache->Capacity < 8*NumSlots)
+    {
+        Cache->Capacity <<= 1;
+    }
+    Cache->Entries = PushArray(Arena, chunk_class_entry, Cache->Capacity);
+    for (u32 EntryId = 0; EntryId < Cache->Capacity; ++EntryId)
+    {
+        Cache->Entries[EntryId] = {};
+    }
+
+    Cache->NumSlots = NumSlots;
+    Cache->SlotClass = PushArray(Arena, chunk_class, NumSlots);
+    Cache->SlotMeasure = PushArray(Arena, b32, NumSlots);
+    Cache->FillSlots = PushArray(Arena, u32, NumSlots);
+    for (u32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        Cache->SlotClass[Slot] = ChunkClass_Unknown;
+        Cache->SlotMeasure[Slot] = false;
+    }
+}
+
+inline chunk_class_entry* ChunkClassProbe(chunk_class_cache* Cache, u64 PackedKey, u32 Seed)
+{
+    chunk_class_entry* Result = 0;
+    u32 Mask = Cache->Capacity - 1;
+    u32 EntryId = ChunkResidencyHash(PackedKey ^ (u64(Seed) * 0x9E3779B97F4A7C15ull)) & Mask;
+    for (u32 ProbeId = 0; ProbeId < Cache->Capacity; ++ProbeId)
+    {
+        chunk_class_entry* Entry = Cache->Entries + EntryId;
+        if (Entry->Key == 0 || (Entry->Key == PackedKey && Entry->Seed == Seed))
+        {
+            Result = Entry;
+            break;
+        }
+        EntryId = (EntryId + 1) & Mask;
+    }
+
+    return Result;
+}
+
+// NOTE: Returns ChunkClass_Unknown if the chunk isn't in the table
+inline chunk_class ChunkClassGet(chunk_class_cache* Cache, chunk_key Key, f32* OutFill)
+{
+    chunk_class Result = ChunkClass_Unknown;
+    chunk_class_entry* Entry = ChunkClassProbe(Cache, ChunkResidencyKeyPack(Key), Cache->Seed);
+    if (Entry && Entry->Key != 0)
+    {
+        Result = chunk_class(Entry->Class);
+        *OutFill = Entry->FillDensity;
+    }
+
+    return Result;
+}
+
+// NOTE: Returns true if the table changed, false if it already had the class or is full
+inline b32 ChunkClassAddPacked(chunk_class_cache* Cache, u64 PackedKey, u32 Seed, chunk_class Class, f32 FillDensity)
+{
+    b32 Result = false;
+    chunk_class_entry* Entry = ChunkClassProbe(Cache, PackedKey, Seed);
+    if (Entry && Entry->Key != 0)
+    {
+        Result = Entry->Class != u32(Class);
+        Entry->Class = Class;
+        Entry->FillDensity = Result ? FillDensity : Entry->FillDensity;
+    }
+    else if (Entry && 2*(Cache->NumEntries + 1) <= Cache->Capacity)
+    {
+        *Entry = {};
+        Entry->Key = PackedKey;
+        Entry->Seed = Seed;
+        Entry->Class = Class;
+        Entry->FillDensity = FillDensity;
+        Cache->NumEntries += 1;
+        Result = true;
+    }
+
+    return Result;
+}
+
+inline b32 ChunkClassAdd(chunk_class_cache* Cache, chunk_key Key, chunk_class Class, f32 FillDensity)
+{
+    Assert(Class == ChunkClass_Air || Class == ChunkClass_Solid);
+    b32 Result = ChunkClassAddPacked(Cache, ChunkResidencyKeyPack(Key), Cache->Seed, Class, FillDensity);
+    Cache->Dirty = Cache->Dirty || Result;
+    return Result;
+}
+
+//
+// NOTE: Classification
+//
+
+/*
+  NOTE: MinY and MaxY are the generator space y range of every sample the slot holds (TerrainGlobals.Center.y + Uv.y*Radius.y in the
+        shader). Returns ChunkClass_Unknown if the bound can't rule out a surface
+ */
+inline chunk_class ChunkClassFromBound(f32 MinY, f32 MaxY, f32* OutFill)
+{
+    chunk_class Result = ChunkClass_Unknown;
+    f32 DensityMin = -MaxY - CHUNK_CLASS_DENSITY_OFFSET;
+    f32 DensityMax = -MinY + CHUNK_CLASS_NOISE_AMPLITUDE - CHUNK_CLASS_DENSITY_OFFSET;
+    if (DensityMax < 0.0f)
+    {
+        Result = ChunkClass_Air;
+        *OutFill = DensityMax;
+    }
+    else if (DensityMin >= 0.0f)
+    {
+        Result = ChunkClass_Solid;
+        *OutFill = DensityMin;
+    }
+
+    return Result;
+}
+
+// NOTE: Range is the chunk node of the density pyramid, same test as DensityHasSurface (>= 0 is solid)
+inline chunk_class ChunkClassFromRange(v2 Range, f32* OutFill)
+{
+    chunk_class Result = ChunkClass_Surface;
+    if (Range.y < 0.0f)
+    {
+        Result = ChunkClass_Air;
+        *OutFill = Range.y;
+    }
+    else if (Range.x >= 0.0f)
+    {
+        Result = ChunkClass_Solid;
+        *OutFill = Range.x;
+    }
+
+    return Result;
+}
+
+inline b32 ChunkClassEmpty(chunk_class Class)
+{
+    b32 Result = Class == ChunkClass_Air || Class == ChunkClass_Solid;
+    return Result;
+}
+
+// NOTE: Call after DensityPyramidReadbackRead, the readback holds the slots that were flagged last frame
+inline void ChunkClassMeasure(chunk_class_cache* Cache, u32 Slot, chunk_key Key, v2 Range)
+{
+    Cache->SlotMeasure[Slot] = false;
+
+    f32 Fill = 0.0f;
+    chunk_class Class = ChunkClassFromRange(Range, &Fill);
+    Cache->SlotClass[Slot] = Class;
+    if (ChunkClassEmpty(Class) && ChunkClassAdd(Cache, Key, Class, Fill))
+    {
+        Cache->NumMeasured += 1;
+    }
+}
+
+// NOTE: Rounds towards 0 so the magnitude never grows, our fills are far from the fp16 limits
+inline u16 ChunkClassF16FromF32(f32 Value)
+{
+    u32 Bits;
+    Copy(&Value, &Bits, sizeof(u32));
+    u16 Sign = u16((Bits >> 16) & 0x8000);
+    i32 Exponent = i32((Bits >> 23) & 0xFF) - 127 + 15;
+    u16 Mantissa = u16((Bits >> 13) & 0x3FF);
+
+    u16 Result = Sign;
+    if (Exponent >= 31)
+    {
+        Result = Sign | 0x7BFF;
+    }
+    else if (Exponent > 0)
+    {
+        Result = Sign | u16(Exponent << 10) | Mantissa;
+    }
+    return Result;
+}
+
+//
+// NOTE: File
+//
+
+inline void ChunkClassCacheLoad(chunk_class_cache* Cache, char* FileName)
+{
+    u64 FileSize = 0;
+    u8* FileData = DemoFileReadAll(FileName, &FileSize);
+    if (FileData && FileSize >= sizeof(chunk_class_file_header))
+    {
+        // NOTE: Classes of another terrain shape say nothing about this one
+        chunk_class_file_header* Header = (chunk_class_file_header*)FileData;
+        b32 Valid = (Header->Magic == CHUNK_CLASS_MAGIC &&
+                     Header->Version == CHUNK_CLASS_VERSION &&
+                     Header->GeneratorHash == Cache->GeneratorHash &&
+                     FileSize == sizeof(chunk_class_file_header) + sizeof(chunk_class_entry)*u64(Header->NumEntries));
+
+        chunk_class_entry* Entries = (chunk_class_entry*)(Header + 1);
+        for (u32 EntryId = 0; Valid && EntryId < Header->NumEntries; ++EntryId)
+        {
+            chunk_class_entry* Entry = Entries + EntryId;
+            if (Entry->Key != 0 && ChunkClassEmpty(chunk_class(Entry->Class)) &&
+                ChunkClassAddPacked(Cache, Entry->Key, Entry->Seed, chunk_class(Entry->Class), Entry->FillDensity))
+            {
+                Cache->NumLoaded += 1;
+            }
+        }
+    }
+
+    DemoMemoryFree(FileData, FileSize);
+}
+
+inline void ChunkClassCacheSave(chunk_class_cache* Cache, char* FileName)
+{
+    u64 FileSize = sizeof(chunk_class_file_header) + sizeof(chunk_class_entry)*u64(Cache->NumEntries);
+    u8* FileData = (u8*)DemoMemoryAlloc(FileSize);
+
+    chunk_class_file_header* Header = (chunk_class_file_header*)FileData;
+    Header->Magic = CHUNK_CLASS_MAGIC;
+    Header->Version = CHUNK_CLASS_VERSION;
+    Header->GeneratorHash = Cache->GeneratorHash;
+    Header->NumEntries = Cache->NumEntries;
+
+    chunk_class_entry* Entries = (chunk_class_entry*)(Header + 1);
+    u32 NumWritten = 0;
+    for (u32 EntryId = 0; EntryId < Cache->Capacity; ++EntryId)
+    {
+        if (Cache->Entries[EntryId].Key != 0)
+        {
+            Entries[NumWritten++] = Cache->Entries[EntryId];
+        }
+    }
+    Assert(NumWritten == Cache->NumEntries);
+
+    if (DemoFileWriteAll(FileName, FileData, FileSize))
+    {
+        Cache->Dirty = false;
+    }
+    DemoMemoryFree(FileData, FileSize);
+}
+
+inline void ChunkClassPanel(ui_panel* Panel, chunk_class_cache* Cache)
+{
+    u32 NumAir = 0;
+    u32 NumSolid = 0;
+    for (u32 Slot = 0; Slot < Cache->NumSlots; ++Slot)
+    {
+        NumAir += Cache->SlotClass[Slot] == ChunkClass_Air ? 1 : 0;
+        NumSolid += Cache->SlotClass[Slot] == ChunkClass_Solid ? 1 : 0;
+    }
+
+    char Text[256];
+    snprintf(Text, sizeof(Text), "Chunk Classes: %u air, %u solid of %u (%u loaded, %u proven, %u measured), %u jobs skipped",
+             NumAir, NumSolid, Cache->NumSlots, Cache->NumLoaded, Cache->NumProven, Cache->NumMeasured, Cache->NumSkipped);
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+}
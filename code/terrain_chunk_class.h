@@ -0,0 +1,88 @@
+#pragma once
+
+/*
+
+  NOTE: Chunk classification cache. Most chunks of the grid are all air or all rock, generating one costs a density pass and a
+        triangle pass only to find out it has no triangles. We remember which chunks are empty, keyed by chunk key and terrain seed,
+        and never schedule them.
+
+        - A chunk is proven empty without evaluating it when the density bound of its samples can't cross 0. The density is
+          -WorldY + noise octaves - offset with noise in [0, 1], so over a slot it lies within [-MaxY - Offset, -MinY + Amplitude -
+          Offset]. Only the y range of the slot matters, the high ground chunks are air and the deep ones rock
+        - Everything else is measured. The chunk node of the density pyramid readback is the min/max over the chunk, a chunk that
+          came back with max < 0 or min >= 0 is remembered as air or solid. FP16 generation isn't measured, its rounding could
+          flip a sign right at 0
+        - The table is written to CHUNK_CLASS_FILE_NAME on exit and loaded at startup. The header carries a hash of everything
+          besides the seed that shapes the density (terrain size, chunk size, noise size, the bound constants), a mismatch throws
+          the file away
+
+        Skipped chunks still need something in their atlas region and pyramid nodes, the far field and the bake read every slot. We
+        copy a constant slot of air or solid density into the atlas and fill the pyramid nodes with the same value. The constants are
+        the weakest bound of the chunks known at startup, they only have to get the sign right.
+
+ */
+
+#define CHUNK_CLASS_FILE_NAME "chunk_classes.bin"
+#define CHUNK_CLASS_MAGIC 0x53414C43 // NOTE: "CLAS"
+#define CHUNK_CLASS_VERSION 2
+
+// IMPORTANT: Has to match TerrainDensityEvaluate in procedural_3d_terrain_shaders.cpp, the sum of the octave amplitudes and the
+// constant we subtract at the end
+#define CHUNK_CLASS_NOISE_AMPLITUDE 5.5f
+#define CHUNK_CLASS_DENSITY_OFFSET 3.5f
+
+// NOTE: Smallest magnitude of a fill value, so rounding to fp16 can't turn air into -0 (which reads as solid)
+#define CHUNK_CLASS_MIN_FILL (1.0f / 1024.0f)
+
+enum chunk_class
+{
+    ChunkClass_Unknown, // NOTE: Also marks an empty table entry
+    ChunkClass_Surface, // NOTE: Measured with surface, never stored
+    ChunkClass_Air,
+    ChunkClass_Solid,
+};
+
+struct chunk_class_entry
+{
+    u64 Key; // NOTE: ChunkResidencyKeyPack, 0 is empty
+    u32 Seed;
+    u32 Class;
+    f32 FillDensity; // NOTE: Density bound closest to 0, negative for air
+    u32 Pad;
+};
+
+struct chunk_class_file_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 GeneratorHash;
+    u32 NumEntries;
+};
+
+struct chunk_class_cache
+{
+    u32 Seed;
+    u32 GeneratorHash;
+    b32 Dirty; // NOTE: Holds entries the file doesn't have yet
+
+    u32 Capacity; // NOTE: Power of 2
+    u32 NumEntries;
+    chunk_class_entry* Entries;
+
+    // NOTE: Per slot, Measure is set for slots generated in fp32 this frame and read back next frame
+    u32 NumSlots;
+    chunk_class* SlotClass;
+    b32* SlotMeasure;
+
+    // NOTE: Slots skipped this frame that need their atlas region and pyramid nodes filled
+    u32 NumFillSlots;
+    u32* FillSlots;
+    f32 AirFill;
+    f32 SolidFill;
+
+    // NOTE: Stats since startup
+    u32 NumLoaded;
+    u32 NumProven;
+    u32 NumMeasured;
+    u32 NumSkipped;
+};
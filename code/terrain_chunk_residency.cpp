@@ -0,0 +1,520 @@
+
+inline u64 ChunkResidencyKeyPack(chunk_key Key)
+{
+    // NOTE: 18 bits per axis and 6 for the lod, the top bit keeps a valid key from ever being 0
+    u64 Result = ((1ull << 63) | (u64(Key.Lod & 0x3F) << 54) | (u64(u32(Key.X) & 0x3FFFF) << 36) | (u64(u32(Key.Y) & 0x3FFFF) << 18) |
+                  u64(u32(Key.Z) & 0x3FFFF));
+    return Result;
+}
+
+inline u32 ChunkResidencyHash(u64 PackedKey)
+{
+    u64 Hash = PackedKey;
+    Hash ^= Hash >> 33;
+    Hash *= 0xFF51AFD7ED558CCDull;
+    Hash ^= Hash >> 33;
+    Hash *= 0xC4CEB9FE1A85EC53ull;
+    Hash ^= Hash >> 33;
+    u32 Result = u32(Hash);
+    return Result;
+}
+
+inline u64 ChunkResidencyStatePack(u32 Version, u32 Slot, chunk_residency_state State)
+{
+    u64 Result = (u64(Version) << 32) | (u64(Slot & 0xFFFFFF) << 8) | u64(State);
+    return Result;
+}
+
+inline chunk_residency_state ChunkResidencyStateGet(u64 Packed)
+{
+    chunk_residency_state Result = chunk_residency_state(Packed & 0xFF);
+    return Result;
+}
+
+inline u32 ChunkResidencySlotGet(u64 Packed)
+{
+    u32 Result = u32(Packed >> 8) & 0xFFFFFF;
+    return Result;
+}
+
+//
+// NOTE: Free Slots
+//
+
+inline void ChunkResidencySlotPush(chunk_residency* Table, u32 Slot)
+{
+    while (true)
+    {
+        u64 Head = Table->FreeHead;
+        Table->NextFree[Slot] = u32(Head);
+        DemoMemoryFence();
+        u64 NewHead = (((Head >> 32) + 1) << 32) | u64(Slot + 1);
+        if (DemoAtomicCompareExchangeU64(&Table->FreeHead, NewHead, Head) == Head)
+        {
+            break;
+        }
+    }
+}
+
+// NOTE: Returns CHUNK_RESIDENCY_NO_SLOT when every slot is taken, the caller has to evict something first
+inline u32 ChunkResidencySlotPop(chunk_residency* Table)
+{
+    while (true)
+    {
+        u64 Head = Table->FreeHead;
+        u32 Top = u32(Head);
+        if (Top == 0)
+        {
+            return CHUNK_RESIDENCY_NO_SLOT;
+        }
+
+        // NOTE: NextFree of a slot someone else popped can be stale here, the version in the head makes our CAS fail then
+        u64 NewHead = (((Head >> 32) + 1) << 32) | u64(Table->NextFree[Top - 1]);
+        if (DemoAtomicCompareExchangeU64(&Table->FreeHead, NewHead, Head) == Head)
+        {
+            return Top - 1;
+        }
+    }
+}
+
+//
+// NOTE: Epochs
+//
+
+inline void ChunkResidencyEpochEnter(chunk_residency* Table, u32 ThreadId)
+{
+    // NOTE: The announcement has to be visible before we read any entry
+    Table->Threads[ThreadId].Epoch = Table->GlobalEpoch;
+    DemoMemoryFence();
+}
+
+inline void ChunkResidencyEpochExit(chunk_residency* Table, u32 ThreadId)
+{
+    DemoMemoryFence();
+    Table->Threads[ThreadId].Epoch = 0;
+}
+
+// NOTE: The epoch can only move once every thread inside the table has seen the current one
+inline void ChunkResidencyEpochTryAdvance(chunk_residency* Table)
+{
+    u64 Epoch = Table->GlobalEpoch;
+    for (u32 ThreadId = 0; ThreadId < Table->MaxThreads; ++ThreadId)
+    {
+        u64 ThreadEpoch = Table->Threads[ThreadId].Epoch;
+        if (ThreadEpoch != 0 && ThreadEpoch != Epoch)
+        {
+            return;
+        }
+    }
+
+    DemoAtomicCompareExchangeU64(&Table->GlobalEpoch, Epoch + 1, Epoch);
+}
+
+/*
+  NOTE: A slot retired in epoch E can still be used by threads that entered in E (or E - 1 if they read the global epoch just before
+        it moved). Once the global epoch is E + 2 every active thread entered after the retire so nobody can hold the slot
+ */
+inline void ChunkResidencyReclaim(chunk_residency* Table, u32 ThreadId)
+{
+    ChunkResidencyEpochTryAdvance(Table);
+
+    chunk_residency_thread* Thread = Table->Threads + ThreadId;
+    u64 Epoch = Table->GlobalEpoch;
+    u32 NumKept = 0;
+    for (u32 RetiredId = 0; RetiredId < Thread->NumRetired; ++RetiredId)
+    {
+        chunk_residency_retired Retired = Thread->Retired[RetiredId];
+        if (Retired.Epoch + 2 <= Epoch)
+        {
+            ChunkResidencySlotPush(Table, Retired.Slot);
+        }
+        else
+        {
+            Thread->Retired[NumKept++] = Retired;
+        }
+    }
+    Thread->NumRetired = NumKept;
+}
+
+//
+// NOTE: Table
+//
+
+inline void ChunkResidencyCreate(chunk_residency* Table, linear_arena* Arena, u32 MaxKeys, u32 NumSlots, u32 MaxThreads)
+{
+    *Table = {};
+
+    // NOTE: At most half full so probe sequences stay short
+    Table->Capacity = 1;
+    while (Table->Capacity < 2*MaxKeys)
+    {
+        Table->Capacity <<= 1;
+    }
+    Table->Keys = PushArray(Arena, u64, Table->Capacity);
+    Table->States = PushArray(Arena, u64, Table->Capacity);
+    for (u32 EntryId = 0; EntryId < Table->Capacity; ++EntryId)
+    {
+        Table->Keys[EntryId] = 0;
+        Table->States[EntryId] = ChunkResidencyStatePack(0, CHUNK_RESIDENCY_NO_SLOT, ChunkResidencyState_Free);
+    }
+
+    // NOTE: Pushed in reverse so a single thread pops slots in order
+    Assert(NumSlots < CHUNK_RESIDENCY_NO_SLOT);
+    Table->NumSlots = NumSlots;
+    Table->NextFree = PushArray(Arena, u32, NumSlots);
+    Table->FreeHead = 0;
+    for (u32 Slot = NumSlots; Slot > 0; --Slot)
+    {
+        ChunkResidencySlotPush(Table, Slot - 1);
+    }
+
+    Assert(MaxThreads <= CHUNK_RESIDENCY_MAX_THREADS);
+    Table->GlobalEpoch = 1;
+    Table->MaxThreads = MaxThreads;
+    Table->Threads = PushArray(Arena, chunk_residency_thread, MaxThreads);
+    for (u32 ThreadId = 0; ThreadId < MaxThreads; ++ThreadId)
+    {
+        Table->Threads[ThreadId].Epoch = 0;
+        Table->Threads[ThreadId].NumRetired = 0;
+        Table->Threads[ThreadId].NumCasRetries = 0;
+    }
+}
+
+inline u32 ChunkResidencyFind(chunk_residency* Table, chunk_key Key)
+{
+    u64 PackedKey = ChunkResidencyKeyPack(Key);
+    u32 Mask = Table->Capacity - 1;
+    u32 EntryId = ChunkResidencyHash(PackedKey) & Mask;
+    for (u32 ProbeId = 0; ProbeId < Table->Capacity; ++ProbeId)
+    {
+        u64 EntryKey = Table->Keys[EntryId];
+        if (EntryKey == PackedKey)
+        {
+            return EntryId;
+        }
+        if (EntryKey == 0)
+        {
+            break;
+        }
+        EntryId = (EntryId + 1) & Mask;
+    }
+
+    return CHUNK_RESIDENCY_NOT_FOUND;
+}
+
+// NOTE: Claims an entry for the key if it doesn't have one yet, returns CHUNK_RESIDENCY_NOT_FOUND if the table is full
+inline u32 ChunkResidencyFindOrAdd(chunk_residency* Table, u32 ThreadId, chunk_key Key)
+{
+    u64 PackedKey = ChunkResidencyKeyPack(Key);
+    u32 Mask = Table->Capacity - 1;
+    u32 EntryId = ChunkResidencyHash(PackedKey) & Mask;
+    for (u32 ProbeId = 0; ProbeId < Table->Capacity; ++ProbeId)
+    {
+        u64 EntryKey = Table->Keys[EntryId];
+        if (EntryKey == 0)
+        {
+            EntryKey = DemoAtomicCompareExchangeU64(Table->Keys + EntryId, PackedKey, 0);
+            if (EntryKey == 0)
+            {
+                return EntryId;
+            }
+            Table->Threads[ThreadId].NumCasRetries += 1;
+        }
+        if (EntryKey == PackedKey)
+        {
+            return EntryId;
+        }
+        EntryId = (EntryId + 1) & Mask;
+    }
+
+    return CHUNK_RESIDENCY_NOT_FOUND;
+}
+
+inline chunk_residency_state ChunkResidencyGetState(chunk_residency* Table, u32 EntryId, u32* OutSlot)
+{
+    u64 Packed = Table->States[EntryId];
+    *OutSlot = ChunkResidencySlotGet(Packed);
+    chunk_residency_state Result = ChunkResidencyStateGet(Packed);
+    return Result;
+}
+
+// NOTE: Moves a resident entry along, fails if another thread changed its state first
+inline b32 ChunkResidencyTransition(chunk_residency* Table, u32 ThreadId, u32 EntryId, chunk_residency_state From, chunk_residency_state To)
+{
+    Assert(From != ChunkResidencyState_Free && To != ChunkResidencyState_Free);
+    while (true)
+    {
+        u64 Packed = Table->States[EntryId];
+        if (ChunkResidencyStateGet(Packed) != From)
+        {
+            return false;
+        }
+
+        u64 NewPacked = ChunkResidencyStatePack(u32(Packed >> 32) + 1, ChunkResidencySlotGet(Packed), To);
+        if (DemoAtomicCompareExchangeU64(Table->States + EntryId, NewPacked, Packed) == Packed)
+        {
+            return true;
+        }
+        Table->Threads[ThreadId].NumCasRetries += 1;
+    }
+}
+
+/*
+  NOTE: Gives the key a slot and queues it. Returns false if the key is already resident (OutSlot is its slot then) or if there is no
+        free slot (OutSlot is CHUNK_RESIDENCY_NO_SLOT)
+ */
+inline b32 ChunkResidencyRequest(chunk_residency* Table, u32 ThreadId, chunk_key Key, u32* OutEntryId, u32* OutSlot)
+{
+    *OutSlot = CHUNK_RESIDENCY_NO_SLOT;
+    u32 EntryId = ChunkResidencyFindOrAdd(Table, ThreadId, Key);
+    *OutEntryId = EntryId;
+    if (EntryId == CHUNK_RESIDENCY_NOT_FOUND)
+    {
+        return false;
+    }
+
+    u32 Slot = CHUNK_RESIDENCY_NO_SLOT;
+    b32 Result = false;
+    while (true)
+    {
+        u64 Packed = Table->States[EntryId];
+        if (ChunkResidencyStateGet(Packed) != ChunkResidencyState_Free)
+        {
+            *OutSlot = ChunkResidencySlotGet(Packed);
+            break;
+        }
+
+        if (Slot == CHUNK_RESIDENCY_NO_SLOT)
+        {
+            Slot = ChunkResidencySlotPop(Table);
+            if (Slot == CHUNK_RESIDENCY_NO_SLOT)
+            {
+                break;
+            }
+        }
+
+        u64 NewPacked = ChunkResidencyStatePack(u32(Packed >> 32) + 1, Slot, ChunkResidencyState_Queued);
+        if (DemoAtomicCompareExchangeU64(Table->States + EntryId, NewPacked, Packed) == Packed)
+        {
+            *OutSlot = Slot;
+            Slot = CHUNK_RESIDENCY_NO_SLOT;
+            Result = true;
+            break;
+        }
+        Table->Threads[ThreadId].NumCasRetries += 1;
+    }
+
+    // NOTE: Someone else made the key resident while we held a slot, nobody saw ours so it goes straight back
+    if (Slot != CHUNK_RESIDENCY_NO_SLOT)
+    {
+        ChunkResidencySlotPush(Table, Slot);
+    }
+
+    return Result;
+}
+
+inline b32 ChunkResidencyRetiredFull(chunk_residency* Table, u32 ThreadId)
+{
+    b32 Result = Table->Threads[ThreadId].NumRetired == CHUNK_RESIDENCY_MAX_RETIRED;
+    return Result;
+}
+
+/*
+  NOTE: Only uploaded chunks get evicted, the ones still in flight finish first. The slot is retired into this threads list and comes
+        back through ChunkResidencyReclaim. Call between ChunkResidencyEpochEnter / Exit like every other access.
+
+        Returns false if the entry isn't uploaded or if this threads retired list is full. We don't reclaim in here, the retired list
+        only drains once our own announced epoch stops holding the global one back, so the caller reclaims after
+        ChunkResidencyEpochExit and tries again (see ChunkResidencyRetiredFull)
+ */
+inline b32 ChunkResidencyEvict(chunk_residency* Table, u32 ThreadId, u32 EntryId)
+{
+    if (ChunkResidencyRetiredFull(Table, ThreadId))
+    {
+        return false;
+    }
+
+    if (!ChunkResidencyTransition(Table, ThreadId, EntryId, ChunkResidencyState_Uploaded, ChunkResidencyState_Evicting))
+    {
+        return false;
+    }
+
+    // NOTE: Only we can leave Evicting so this can't fail
+    chunk_residency_thread* Thread = Table->Threads + ThreadId;
+    u64 Packed = Table->States[EntryId];
+    u32 Slot = ChunkResidencySlotGet(Packed);
+    Table->States[EntryId] = ChunkResidencyStatePack(u32(Packed >> 32) + 1, CHUNK_RESIDENCY_NO_SLOT, ChunkResidencyState_Free);
+
+    chunk_residency_retired* Retired = Thread->Retired + Thread->NumRetired++;
+    Retired->Slot = Slot;
+    Retired->Epoch = Table->GlobalEpoch;
+
+    return true;
+}
+
+inline u32 ChunkResidencyCasRetries(chunk_residency* Table)
+{
+    u32 Result = 0;
+    for (u32 ThreadId = 0; ThreadId < Table->MaxThreads; ++ThreadId)
+    {
+        Result += Table->Threads[ThreadId].NumCasRetries;
+    }
+    return Result;
+}
+
+//
+// NOTE: Benchmark
+//
+
+struct chunk_residency_bench_thread
+{
+    chunk_residency* Table;
+    u32 ThreadId;
+    u32 NumKeys;
+    u32 KeysPerAxis;
+    volatile u32* StartFlag;
+    u32 NumOps;
+};
+
+inline void ChunkResidencyBenchThread(void* Data)
+{
+    chunk_residency_bench_thread* Bench = (chunk_residency_bench_thread*)Data;
+    chunk_residency* Table = Bench->Table;
+    u32 Random = 0x9E3779B9 ^ (Bench->ThreadId*0x85EBCA6B);
+    while (*Bench->StartFlag == 0)
+    {
+    }
+
+    // NOTE: Like the frame loop, 80% lookups, the rest moves chunks through their states or evicts them
+    for (u32 OpId = 0; OpId < Bench->NumOps; ++OpId)
+    {
+        Random ^= Random << 13;
+        Random ^= Random >> 17;
+        Random ^= Random << 5;
+        u32 KeyId = Random % Bench->NumKeys;
+        chunk_key Key = {};
+        Key.X = i32(KeyId % Bench->KeysPerAxis);
+        Key.Y = i32((KeyId / Bench->KeysPerAxis) % Bench->KeysPerAxis);
+        Key.Z = i32(KeyId / (Bench->KeysPerAxis*Bench->KeysPerAxis));
+        u32 Op = (Random >> 24) % 100;
+
+        b32 RetryEvict = false;
+        ChunkResidencyEpochEnter(Table, Bench->ThreadId);
+        if (Op < 80)
+        {
+            u32 EntryId = ChunkResidencyFind(Table, Key);
+            if (EntryId != CHUNK_RESIDENCY_NOT_FOUND)
+            {
+                u32 Slot;
+                ChunkResidencyGetState(Table, EntryId, &Slot);
+            }
+        }
+        else if (Op < 95)
+        {
+            u32 EntryId, Slot;
+            ChunkResidencyRequest(Table, Bench->ThreadId, Key, &EntryId, &Slot);
+            if (EntryId != CHUNK_RESIDENCY_NOT_FOUND)
+            {
+                u32 CurrSlot;
+                chunk_residency_state State = ChunkResidencyGetState(Table, EntryId, &CurrSlot);
+                if (State >= ChunkResidencyState_Queued && State < ChunkResidencyState_Uploaded)
+                {
+                    ChunkResidencyTransition(Table, Bench->ThreadId, EntryId, State, chunk_residency_state(State + 1));
+                }
+            }
+        }
+        else
+        {
+            u32 EntryId = ChunkResidencyFind(Table, Key);
+            if (EntryId != CHUNK_RESIDENCY_NOT_FOUND)
+            {
+                RetryEvict = !ChunkResidencyEvict(Table, Bench->ThreadId, EntryId) && ChunkResidencyRetiredFull(Table, Bench->ThreadId);
+            }
+        }
+        ChunkResidencyEpochExit(Table, Bench->ThreadId);
+
+        // NOTE: Out of retired space, drain it outside the table and evict once more. If nothing could be reclaimed yet the chunk just
+        // stays resident
+        if (RetryEvict)
+        {
+            ChunkResidencyReclaim(Table, Bench->ThreadId);
+            ChunkResidencyEpochEnter(Table, Bench->ThreadId);
+            ChunkResidencyEvict(Table, Bench->ThreadId, ChunkResidencyFind(Table, Key));
+            ChunkResidencyEpochExit(Table, Bench->ThreadId);
+        }
+
+        if ((OpId & 255) == 0)
+        {
+            ChunkResidencyReclaim(Table, Bench->ThreadId);
+        }
+    }
+}
+
+inline void ChunkResidencyBenchmark(benchmark_state* Bench, linear_arena* Arena)
+{
+    // NOTE: 16^3 keys competing for half as many slots so requests keep running into evictions
+    u32 KeysPerAxis = 16;
+    u32 NumKeys = KeysPerAxis*KeysPerAxis*KeysPerAxis;
+    u32 NumSlots = NumKeys / 2;
+    demo_thread* Threads = PushArray(Arena, demo_thread, CHUNK_RESIDENCY_BENCH_MAX_THREADS);
+    chunk_residency_bench_thread* ThreadData = PushArray(Arena, chunk_residency_bench_thread, CHUNK_RESIDENCY_BENCH_MAX_THREADS);
+
+    for (u32 NumThreads = 1; NumThreads <= CHUNK_RESIDENCY_BENCH_MAX_THREADS; NumThreads *= 2)
+    {
+        u64 TableSize = (sizeof(u64)*2*2*NumKeys + sizeof(u32)*NumSlots + sizeof(chunk_residency_thread)*NumThreads + MegaBytes(1));
+        void* TableMemory = DemoMemoryAlloc(TableSize);
+        linear_arena TableArena = LinearArenaCreate(TableMemory, TableSize);
+        chunk_residency Table;
+        ChunkResidencyCreate(&Table, &TableArena, NumKeys, NumSlots, NumThreads);
+
+        volatile u32 StartFlag = 0;
+        for (u32 ThreadId = 0; ThreadId < NumThreads; ++ThreadId)
+        {
+            chunk_residency_bench_thread* Data = ThreadData + ThreadId;
+            Data->Table = &Table;
+            Data->ThreadId = ThreadId;
+            Data->NumKeys = NumKeys;
+            Data->KeysPerAxis = KeysPerAxis;
+            Data->StartFlag = &StartFlag;
+            Data->NumOps = CHUNK_RESIDENCY_BENCH_OPS;
+            DemoThreadCreate(Threads + ThreadId, ChunkResidencyBenchThread, Data);
+        }
+
+        u64 StartTime = DemoTimerGet();
+        DemoMemoryFence();
+        StartFlag = 1;
+        for (u32 ThreadId = 0; ThreadId < NumThreads; ++ThreadId)
+        {
+            DemoThreadJoin(Threads + ThreadId);
+        }
+        f64 ElapsedMs = DemoTimerElapsedMs(StartTime);
+
+        char Name[64];
+        f64 NumOps = f64(NumThreads)*f64(CHUNK_RESIDENCY_BENCH_OPS);
+        snprintf(Name, sizeof(Name), "chunk_residency_mops_%u_threads", NumThreads);
+        BenchmarkRecord(Bench, Name, NumOps / (ElapsedMs*1000.0), "Mops/s");
+        snprintf(Name, sizeof(Name), "chunk_residency_cas_retry_ratio_%u_threads", NumThreads);
+        BenchmarkRecord(Bench, Name, f64(ChunkResidencyCasRetries(&Table)) / NumOps, "ratio");
+
+        DemoMemoryFree(TableMemory, TableSize);
+    }
+}
+
+inline void ChunkResidencyPanel(ui_panel* Panel, chunk_residency* Table)
+{
+    u32 NumPerState[ChunkResidencyState_Evicting + 1] = {};
+    for (u32 EntryId = 0; EntryId < Table->Capacity; ++EntryId)
+    {
+        if (Table->Keys[EntryId] != 0)
+        {
+            NumPerState[ChunkResidencyStateGet(Table->States[EntryId])] += 1;
+        }
+    }
+
+    char Text[256];
+    snprintf(Text, sizeof(Text), "Residency: %u queued, %u generating, %u meshed, %u uploaded, %u evicting, %u CAS retries",
+             NumPerState[ChunkResidencyState_Queued], NumPerState[ChunkResidencyState_Generating], NumPerState[ChunkResidencyState_Meshed],
+             NumPerState[ChunkResidencyState_Uploaded], NumPerState[ChunkResidencyState_Evicting], ChunkResidencyCasRetries(Table));
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+/*
+
+  NOTE: Chunk residency table, maps a chunk key (coordinate + lod) to the slot that holds it and where that slot is in its life
+        (queued, generating, meshed, uploaded, evicting). Worker threads and the render thread use it at the same time without locks.
+
+        - Fixed capacity open addressing with linear probing. A key is claimed with a CAS from empty and never removed, an evicted
+          chunk keeps its entry without a slot so asking for it again is a CAS on the same entry. Capacity has to cover every key the
+          world can stream, which for us is the chunk grid
+        - State, slot and a version count share one 64 bit word so every transition is a single CAS and a stale From never succeeds
+          after the entry went around the state machine
+        - Evicted slots don't go back to the free list right away, a reader that found the entry before the eviction may still use
+          the slot. Every thread announces the global epoch while it touches the table, evicted slots are retired with the epoch of
+          the eviction and only reclaimed once every active thread announced a later epoch (two advances, see
+          ChunkResidencyReclaim)
+        - Free slots are a lock free stack with a version tag in the head
+
+        In the demo the main thread (ThreadId 0) mirrors what the chunk scheduler decided once per frame and requests / evicts, the job
+        queue workers (ThreadId 1 + worker index, see job_callback) move the chunks they load from the archive to meshed while the
+        main thread reads the same entries. Only the main thread evicts, so only its retired list ever fills.
+
+        The benchmark hammers one table with a lookup heavy mix from 1 to 64 threads.
+
+ */
+
+#define CHUNK_RESIDENCY_NOT_FOUND 0xFFFFFFFF
+#define CHUNK_RESIDENCY_NO_SLOT 0xFFFFFF // NOTE: Slots are stored in 24 bits
+#define CHUNK_RESIDENCY_MAX_THREADS 65 // NOTE: Job queue workers + the main thread
+#define CHUNK_RESIDENCY_MAX_RETIRED 1024 // NOTE: Per thread
+
+// NOTE: Benchmark
+#define CHUNK_RESIDENCY_BENCH_OPS 200000 // NOTE: Per thread
+#define CHUNK_RESIDENCY_BENCH_MAX_THREADS 64
+
+enum chunk_residency_state
+{
+    ChunkResidencyState_Free, // NOTE: Key is known but has no slot
+    ChunkResidencyState_Queued,
+    ChunkResidencyState_Generating,
+    ChunkResidencyState_Meshed,
+    ChunkResidencyState_Uploaded,
+    ChunkResidencyState_Evicting,
+};
+
+struct chunk_residency_retired
+{
+    u32 Slot;
+    u64 Epoch;
+};
+
+// NOTE: One per thread that touches the table, padded so announcing an epoch doesn't share a cache line
+struct chunk_residency_thread
+{
+    volatile u64 Epoch; // NOTE: 0 while outside the table
+    u32 NumRetired;
+    u32 NumCasRetries;
+    chunk_residency_retired Retired[CHUNK_RESIDENCY_MAX_RETIRED];
+    u8 Pad[64];
+};
+
+struct chunk_residency
+{
+    u32 Capacity; // NOTE: Power of 2
+    volatile u64* Keys; // NOTE: 0 is empty, see ChunkResidencyKeyPack
+    volatile u64* States; // NOTE: Version << 32 | Slot << 8 | State
+
+    u32 NumSlots;
+    u32* NextFree;
+    volatile u64 FreeHead; // NOTE: Version << 32 | (Slot + 1), 0 in the low half is empty
+
+    volatile u64 GlobalEpoch;
+    u32 MaxThreads;
+    chunk_residency_thread* Threads;
+};
@@ -0,0 +1,277 @@
+
+inline void ChunkSchedulerCreate(chunk_scheduler* Scheduler, linear_arena* Arena, u32 NumSlots, f32 BudgetMs)
+{
+    *Scheduler = {};
+    Scheduler->BudgetMs = BudgetMs;
+    Scheduler->NumSlots = NumSlots;
+    Scheduler->SlotWorldMin = PushArray(Arena, v3, NumSlots);
+    Scheduler->SlotWorldMax = PushArray(Arena, v3, NumSlots);
+    Scheduler->SlotPending = PushArray(Arena, b32, NumSlots);
+    Scheduler->SlotVisibleTime = PushArray(Arena, u64, NumSlots);
+    Scheduler->Heap = PushArray(Arena, chunk_schedule_entry, NumSlots);
+    Scheduler->IssuedSlots = PushArray(Arena, u32, NumSlots);
+    Scheduler->JobMs = CHUNK_SCHEDULER_INITIAL_JOB_MS;
+
+    for (u32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        Scheduler->SlotPending[Slot] = true;
+        Scheduler->SlotVisibleTime[Slot] = 0;
+    }
+    Scheduler->NumPending = NumSlots;
+}
+
+inline void ChunkSchedulerSlotBoundsSet(chunk_scheduler* Scheduler, u32 Slot, v3 WorldMin, v3 WorldMax)
+{
+    Scheduler->SlotWorldMin[Slot] = WorldMin;
+    Scheduler->SlotWorldMax[Slot] = WorldMax;
+}
+
+// NOTE: Every slot needs new geometry, e.g. the mesher changed
+inline void ChunkSchedulerInvalidateAll(chunk_scheduler* Scheduler)
+{
+    for (u32 Slot = 0; Slot < Scheduler->NumSlots; ++Slot)
+    {
+        Scheduler->SlotPending[Slot] = true;
+    }
+    Scheduler->NumPending = Scheduler->NumSlots;
+}
+
+// NOTE: The caller generated every slot this frame without going through the queue
+inline void ChunkSchedulerReadyAll(chunk_scheduler* Scheduler)
+{
+    for (u32 Slot = 0; Slot < Scheduler->NumSlots; ++Slot)
+    {
+        Scheduler->SlotPending[Slot] = false;
+        Scheduler->SlotVisibleTime[Slot] = 0;
+    }
+    Scheduler->NumPending = 0;
+    Scheduler->NumVisiblePending = 0;
+}
+
+// NOTE: The caller took care of a pending slot without a job, e.g. it knows the slot has no geometry
+inline void ChunkSchedulerSlotReady(chunk_scheduler* Scheduler, u32 Slot)
+{
+    if (Scheduler->SlotPending[Slot])
+    {
+        Scheduler->SlotPending[Slot] = false;
+        Scheduler->NumPending -= 1;
+    }
+    Scheduler->SlotVisibleTime[Slot] = 0;
+}
+
+inline b32 ChunkSchedulerAllReady(chunk_scheduler* Scheduler)
+{
+    b32 Result = Scheduler->NumPending == 0;
+    return Result;
+}
+
+// NOTE: Call at the start of the frame, folds the timing of the last frame that issued jobs into the per job estimate
+inline void ChunkSchedulerTimingsUpdate(chunk_scheduler* Scheduler, gpu_timestamps* Timestamps)
+{
+    if (!Scheduler->TimedTimer)
+    {
+        return;
+    }
+
+    f64 Ms = GpuTimerGetMs(Timestamps, Scheduler->TimedTimer);
+    if (Ms > 0.0 && Scheduler->TimedJobs > 0)
+    {
+        f32 Sample = f32(Ms) / f32(Scheduler->TimedJobs);
+        Scheduler->JobMs += CHUNK_SCHEDULER_JOB_MS_FILTER*(Sample - Scheduler->JobMs);
+    }
+    Scheduler->TimedTimer = 0;
+    Scheduler->TimedJobs = 0;
+}
+
+// NOTE: Remembers which timer the jobs we issued this frame run under
+inline void ChunkSchedulerJobsTimed(chunk_scheduler* Scheduler, char* TimerName, u32 NumJobs)
+{
+    Scheduler->TimedTimer = TimerName;
+    Scheduler->TimedJobs = NumJobs;
+}
+
+/*
+  NOTE: Conservative, the box is only outside when all 8 corners are past the same side plane or behind the camera. The far plane is
+        ignored, the far field draws past the chunks anyway
+ */
+inline b32 ChunkSchedulerBoxVisible(m4 VPTransform, v3 WorldMin, v3 WorldMax)
+{
+    u32 OutsideMask = 0x1F;
+    for (u32 CornerId = 0; CornerId < 8; ++CornerId)
+    {
+        v3 Corner = V3((CornerId & 1) ? WorldMax.x : WorldMin.x,
+                       (CornerId & 2) ? WorldMax.y : WorldMin.y,
+                       (CornerId & 4) ? WorldMax.z : WorldMin.z);
+        v4 Clip = VPTransform * V4(Corner, 1.0f);
+
+        u32 CornerMask = 0;
+        CornerMask |= Clip.x < -Clip.w ? 0x1 : 0;
+        CornerMask |= Clip.x > Clip.w ? 0x2 : 0;
+        CornerMask |= Clip.y < -Clip.w ? 0x4 : 0;
+        CornerMask |= Clip.y > Clip.w ? 0x8 : 0;
+        CornerMask |= Clip.w <= 0.0f ? 0x10 : 0;
+        OutsideMask &= CornerMask;
+    }
+
+    b32 Result = OutsideMask == 0;
+    return Result;
+}
+
+//
+// NOTE: Queue
+//
+
+inline void ChunkScheduleHeapPush(chunk_scheduler* Scheduler, chunk_schedule_entry Entry)
+{
+    chunk_schedule_entry* Heap = Scheduler->Heap;
+    u32 Id = Scheduler->HeapSize++;
+    while (Id > 0)
+    {
+        u32 ParentId = (Id - 1) / 2;
+        if (Heap[ParentId].Score >= Entry.Score)
+        {
+            break;
+        }
+        Heap[Id] = Heap[ParentId];
+        Id = ParentId;
+    }
+    Heap[Id] = Entry;
+}
+
+inline chunk_schedule_entry ChunkScheduleHeapPop(chunk_scheduler* Scheduler)
+{
+    Assert(Scheduler->HeapSize > 0);
+    chunk_schedule_entry* Heap = Scheduler->Heap;
+    chunk_schedule_entry Result = Heap[0];
+    chunk_schedule_entry Last = Heap[--Scheduler->HeapSize];
+
+    u32 Id = 0;
+    while (true)
+    {
+        u32 ChildId = 2*Id + 1;
+        if (ChildId >= Scheduler->HeapSize)
+        {
+            break;
+        }
+        if (ChildId + 1 < Scheduler->HeapSize && Heap[ChildId + 1].Score > Heap[ChildId].Score)
+        {
+            ChildId += 1;
+        }
+        if (Last.Score >= Heap[ChildId].Score)
+        {
+            break;
+        }
+        Heap[Id] = Heap[ChildId];
+        Id = ChildId;
+    }
+    if (Scheduler->HeapSize > 0)
+    {
+        Heap[Id] = Last;
+    }
+
+    return Result;
+}
+
+/*
+  NOTE: Scores every pending slot against this frames camera and starts the latency clock of pending slots that came into view
+ */
+inline void ChunkSchedulerQueueBuild(chunk_scheduler* Scheduler, m4 VPTransform, v3 CameraPos, f32 RenderHeight)
+{
+    u64 CurrTime = DemoTimerGet();
+    Scheduler->HeapSize = 0;
+    Scheduler->NumVisiblePending = 0;
+    for (u32 Slot = 0; Slot < Scheduler->NumSlots; ++Slot)
+    {
+        v3 WorldMin = Scheduler->SlotWorldMin[Slot];
+        v3 WorldMax = Scheduler->SlotWorldMax[Slot];
+        if (!Scheduler->SlotPending[Slot])
+        {
+            continue;
+        }
+
+        b32 Visible = ChunkSchedulerBoxVisible(VPTransform, WorldMin, WorldMax);
+        if (Visible)
+        {
+            Scheduler->NumVisiblePending += 1;
+            if (Scheduler->SlotVisibleTime[Slot] == 0)
+            {
+                Scheduler->SlotVisibleTime[Slot] = CurrTime;
+            }
+        }
+        else
+        {
+            Scheduler->SlotVisibleTime[Slot] = 0;
+        }
+
+        // NOTE: Distance to the box, the chunk the camera is in gets the largest score any chunk can have
+        v3 Closest = CameraPos;
+        Closest.x = Closest.x < WorldMin.x ? WorldMin.x : (Closest.x > WorldMax.x ? WorldMax.x : Closest.x);
+        Closest.y = Closest.y < WorldMin.y ? WorldMin.y : (Closest.y > WorldMax.y ? WorldMax.y : Closest.y);
+        Closest.z = Closest.z < WorldMin.z ? WorldMin.z : (Closest.z > WorldMax.z ? WorldMax.z : Closest.z);
+        f32 Distance = Length(Closest - CameraPos);
+        Distance = Distance < 0.001f ? 0.001f : Distance;
+
+        chunk_schedule_entry Entry = {};
+        Entry.Slot = Slot;
+        Entry.Score = RenderHeight * Length(WorldMax - WorldMin) / Distance;
+        if (!Visible)
+        {
+            Entry.Score *= CHUNK_SCHEDULER_HIDDEN_WEIGHT;
+        }
+        ChunkScheduleHeapPush(Scheduler, Entry);
+    }
+}
+
+/*
+  NOTE: Pops the best slots that fit the budget into IssuedSlots and marks them ready, returns how many. The caller generates them
+        this frame
+ */
+inline u32 ChunkSchedulerIssue(chunk_scheduler* Scheduler)
+{
+    u32 MaxJobs = u32(Scheduler->BudgetMs / Scheduler->JobMs);
+    MaxJobs = MaxJobs < 1 ? 1 : MaxJobs;
+
+    u32 NumIssued = 0;
+    while (NumIssued < MaxJobs && Scheduler->HeapSize > 0)
+    {
+        chunk_schedule_entry Entry = ChunkScheduleHeapPop(Scheduler);
+        Scheduler->IssuedSlots[NumIssued++] = Entry.Slot;
+
+        u64 VisibleTime = Scheduler->SlotVisibleTime[Entry.Slot];
+        if (VisibleTime != 0)
+        {
+            Scheduler->NumVisiblePending -= 1;
+            Scheduler->LastLatencyMs = f32(DemoTimerElapsedMs(VisibleTime));
+            Scheduler->MaxLatencyMs = Scheduler->LastLatencyMs > Scheduler->MaxLatencyMs ? Scheduler->LastLatencyMs : Scheduler->MaxLatencyMs;
+            Scheduler->TotalLatencyMs += Scheduler->LastLatencyMs;
+            Scheduler->NumLatencySamples += 1;
+        }
+
+        Scheduler->SlotPending[Entry.Slot] = false;
+        Scheduler->SlotVisibleTime[Entry.Slot] = 0;
+        Scheduler->NumPending -= 1;
+    }
+    Scheduler->NumIssued = NumIssued;
+
+    return NumIssued;
+}
+
+inline f32 ChunkSchedulerAvgLatencyMs(chunk_scheduler* Scheduler)
+{
+    f32 Result = Scheduler->NumLatencySamples > 0 ? f32(Scheduler->TotalLatencyMs / f64(Scheduler->NumLatencySamples)) : 0.0f;
+    return Result;
+}
+
+inline void ChunkSchedulerPanel(ui_panel* Panel, chunk_scheduler* Scheduler)
+{
+    char Text[256];
+    snprintf(Text, sizeof(Text), "Chunk Queue: %u pending (%u visible), %u issued, %.3f ms / job, budget %.1f ms", Scheduler->NumPending,
+             Scheduler->NumVisiblePending, Scheduler->NumIssued, Scheduler->JobMs, Scheduler->BudgetMs);
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+
+    snprintf(Text, sizeof(Text), "Chunk Latency: last %.1f ms, avg %.1f ms, max %.1f ms", Scheduler->LastLatencyMs,
+             ChunkSchedulerAvgLatencyMs(Scheduler), Scheduler->MaxLatencyMs);
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+/*
+
+  NOTE: Chunk generation scheduler. Slots that need new geometry sit in a pending set, every frame we score them and generate the
+        best ones first until the frame's generation budget is used up. The rest stay pending and keep drawing what they had (or
+        nothing, the draw args of a never generated slot are reset at init).
+
+        - Score is the chunk's projected size, its world diagonal over the distance from the camera to its box scaled to render
+          pixels. Near chunks score high, the fov scale is the same for every chunk so it is left out. Chunks outside the frustum
+          get their score multiplied by CHUNK_SCHEDULER_HIDDEN_WEIGHT, they still get generated but only after what is on screen
+        - The queue is a binary max heap rebuilt from the pending set each frame, the grid is small enough that rescoring is cheaper
+          than keeping scores valid while the camera moves
+        - The budget is in GPU ms. Each frame's generation timer divided by the jobs it ran feeds a running per job estimate, we
+          issue as many jobs as the estimate says fit and always at least one so the queue can't stall on a bad estimate
+        - Latency is CPU time from the first frame a pending chunk is inside the frustum to the frame its job is issued, the draw of
+          that same frame already uses the new mesh
+
+ */
+
+#define CHUNK_SCHEDULER_BUDGET_MS 2.0f // NOTE: Default for DemoState->ChunkScheduler.BudgetMs
+#define CHUNK_SCHEDULER_INITIAL_JOB_MS 0.1f // NOTE: Used until the first generation timer comes back
+#define CHUNK_SCHEDULER_JOB_MS_FILTER 0.2f // NOTE: Weight of the newest sample in the per job average
+#define CHUNK_SCHEDULER_HIDDEN_WEIGHT 0.05f
+
+struct chunk_schedule_entry
+{
+    f32 Score;
+    u32 Slot;
+};
+
+struct chunk_scheduler
+{
+    f32 BudgetMs;
+    u32 NumSlots;
+    v3* SlotWorldMin;
+    v3* SlotWorldMax;
+    b32* SlotPending;
+    u64* SlotVisibleTime; // NOTE: DemoTimerGet of when a pending slot entered the frustum, 0 if it hasn't
+
+    u32 HeapSize;
+    chunk_schedule_entry* Heap;
+    u32* IssuedSlots; // NOTE: This frames jobs in priority order
+
+    // NOTE: Per job GPU time, the timer of the frame that issued jobs comes back the next frame
+    f32 JobMs;
+    char* TimedTimer;
+    u32 TimedJobs;
+
+    // NOTE: Stats for the last frame
+    u32 NumPending;
+    u32 NumVisiblePending;
+    u32 NumIssued;
+    f32 LastLatencyMs;
+    f32 MaxLatencyMs;
+    f64 TotalLatencyMs;
+    u32 NumLatencySamples;
+};
@@ -0,0 +1,285 @@
+
+inline void TerrainCpuMesherCreate(terrain_cpu_mesher* Mesher, terrain_density_field* Field, u32 ResX, u32 ResY, u32 ResZ)
+{
+    *Mesher = {};
+    Mesher->Field = Field;
+    Mesher->ResX = ResX;
+    Mesher->ResY = ResY;
+    Mesher->ResZ = ResZ;
+    Mesher->Densities = (f32*)DemoMemoryAlloc(sizeof(f32)*TERRAIN_CPU_MESHER_NUM_ROWS*TERRAIN_CPU_MESHER_ROW_STRIDE);
+    Mesher->SignMasks = (u64*)DemoMemoryAlloc(sizeof(u64)*TERRAIN_CPU_MESHER_NUM_ROWS);
+    Mesher->MaxVertices = TERRAIN_CPU_MESHER_MAX_VERTICES;
+    Mesher->Vertices = (v3*)DemoMemoryAlloc(sizeof(v3)*Mesher->MaxVertices);
+}
+
+inline void TerrainCpuMesherDestroy(terrain_cpu_mesher* Mesher)
+{
+    DemoMemoryFree(Mesher->Densities, sizeof(f32)*TERRAIN_CPU_MESHER_NUM_ROWS*TERRAIN_CPU_MESHER_ROW_STRIDE);
+    DemoMemoryFree(Mesher->SignMasks, sizeof(u64)*TERRAIN_CPU_MESHER_NUM_ROWS);
+    DemoMemoryFree(Mesher->Vertices, sizeof(v3)*Mesher->MaxVertices);
+    *Mesher = {};
+}
+
+inline f32* TerrainCpuMesherRow(terrain_cpu_mesher* Mesher, u32 Y, u32 Z)
+{
+    f32* Result = Mesher->Densities + (Z*TERRAIN_CPU_MESHER_ROW_SAMPLES + Y)*TERRAIN_CPU_MESHER_ROW_STRIDE;
+    return Result;
+}
+
+// NOTE: Corner samples of the chunk, same sample positions as the GPU chunk at that key
+inline void TerrainCpuMesherDensities(terrain_cpu_mesher* Mesher, chunk_key Key)
+{
+    Mesher->Step = f32(1 << Key.Lod);
+    Mesher->Origin = V3(f32(Key.X), f32(Key.Y), f32(Key.Z))*f32(TERRAIN_CHUNK_RES)*Mesher->Step;
+
+    __m128 UvScaleX = _mm_set1_ps(2.0f*Mesher->Step / f32(Mesher->ResX));
+    __m128 UvOffsetX = _mm_set1_ps(2.0f*Mesher->Origin.x / f32(Mesher->ResX) - 1.0f);
+    __m128 LaneX = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    for (u32 Z = 0; Z < TERRAIN_CPU_MESHER_ROW_SAMPLES; ++Z)
+    {
+        __m128 UvZ = _mm_set1_ps(2.0f*(Mesher->Origin.z + f32(Z)*Mesher->Step) / f32(Mesher->ResZ) - 1.0f);
+        for (u32 Y = 0; Y < TERRAIN_CPU_MESHER_ROW_SAMPLES; ++Y)
+        {
+            __m128 UvY = _mm_set1_ps(2.0f*(Mesher->Origin.y + f32(Y)*Mesher->Step) / f32(Mesher->ResY) - 1.0f);
+            f32* Row = TerrainCpuMesherRow(Mesher, Y, Z);
+            for (u32 X = 0; X < TERRAIN_CPU_MESHER_ROW_STRIDE; X += 4)
+            {
+                __m128 UvX = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_set1_ps(f32(X)), LaneX), UvScaleX), UvOffsetX);
+                _mm_storeu_ps(Row + X, TerrainDensityEvaluate4(Mesher->Field, UvX, UvY, UvZ));
+            }
+        }
+    }
+}
+
+// NOTE: Bit x of a rows mask is set when sample x is solid, the padding samples are masked off
+inline void TerrainCpuMesherSignMasks(terrain_cpu_mesher* Mesher)
+{
+    __m128 Zero = _mm_setzero_ps();
+    u64 RowMask = (u64(1) << TERRAIN_CPU_MESHER_ROW_SAMPLES) - 1;
+    for (u32 RowId = 0; RowId < TERRAIN_CPU_MESHER_NUM_ROWS; ++RowId)
+    {
+        f32* Row = Mesher->Densities + RowId*TERRAIN_CPU_MESHER_ROW_STRIDE;
+        u64 Mask = 0;
+        for (u32 X = 0; X < TERRAIN_CPU_MESHER_ROW_STRIDE; X += 4)
+        {
+            u32 Bits = u32(_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(Row + X), Zero)));
+            Mask |= u64(Bits) << X;
+        }
+        Mesher->SignMasks[RowId] = Mask & RowMask;
+    }
+}
+
+// NOTE: Same triangles as TerrainCellEmit in procedural_3d_terrain_shaders.cpp
+inline void TerrainCpuMesherCellEmit(terrain_cpu_mesher* Mesher, u32 CellX, u32 CellY, u32 CellZ, u32 CaseByte)
+{
+    f32 Densities[8];
+    v3 Corners[8];
+    for (u32 CornerId = 0; CornerId < 8; ++CornerId)
+    {
+        u32 X = CellX + (CornerId & 1);
+        u32 Y = CellY + ((CornerId >> 1) & 1);
+        u32 Z = CellZ + ((CornerId >> 2) & 1);
+        Densities[CornerId] = TerrainCpuMesherRow(Mesher, Y, Z)[X];
+        Corners[CornerId] = V3(f32(X), f32(Y), f32(Z));
+    }
+
+    const regular_cell_data* RegularCell = GlobalRegularCellData + GlobalRegularCellClasses[CaseByte];
+    u32 NumCellVertices = RegularCell->GeometryCounts >> 4;
+    u32 NumTriangles = RegularCell->GeometryCounts & 0x0F;
+
+    v3 Vertices[12];
+    for (u32 VertexId = 0; VertexId < NumCellVertices; ++VertexId)
+    {
+        u32 Edge = GlobalRegularVertexData[CaseByte][VertexId];
+        u32 FirstVertexId = Edge & 0xF;
+        u32 SecondVertexId = (Edge >> 4) & 0xF;
+
+        f32 FirstDensity = Densities[FirstVertexId];
+        f32 SecondDensity = Densities[SecondVertexId];
+        f32 T = SecondDensity / (SecondDensity - FirstDensity);
+        v3 Vertex = Corners[FirstVertexId] + (Corners[SecondVertexId] - Corners[FirstVertexId])*T;
+        Vertices[VertexId] = Vertex*Mesher->Step + Mesher->Origin;
+    }
+
+    Assert(Mesher->NumVertices + 3*NumTriangles <= Mesher->MaxVertices);
+    for (u32 IndexId = 0; IndexId < 3*NumTriangles; ++IndexId)
+    {
+        Mesher->Vertices[Mesher->NumVertices++] = Vertices[RegularCell->VertexIndex[IndexId]];
+    }
+}
+
+/*
+  NOTE: Walks the cells a row at a time. Corner c of cell x is bit x of one of the 4 neighbouring row masks, shifted down by one for
+        the corners at x + 1, so OR/AND over the 8 shifted masks says which cells of the row see both signs. Only those get a case byte
+ */
+inline void TerrainCpuMesherExtract(terrain_cpu_mesher* Mesher)
+{
+    Mesher->NumVertices = 0;
+    Mesher->NumSurfaceCells = 0;
+    Mesher->NumSkippedRows = 0;
+
+    u64 CellMask = (u64(1) << TERRAIN_CHUNK_RES) - 1;
+    for (u32 CellZ = 0; CellZ < TERRAIN_CHUNK_RES; ++CellZ)
+    {
+        for (u32 CellY = 0; CellY < TERRAIN_CHUNK_RES; ++CellY)
+        {
+            u64* Rows = Mesher->SignMasks + CellZ*TERRAIN_CPU_MESHER_ROW_SAMPLES + CellY;
+            u64 Corner0 = Rows[0];
+            u64 Corner2 = Rows[1];
+            u64 Corner4 = Rows[TERRAIN_CPU_MESHER_ROW_SAMPLES];
+            u64 Corner6 = Rows[TERRAIN_CPU_MESHER_ROW_SAMPLES + 1];
+
+            // NOTE: Any solid corner and any air corner per cell, rows that are all air or all solid words drop out here
+            u64 AnySolid = Corner0 | Corner2 | Corner4 | Corner6;
+            u64 AllSolid = Corner0 & Corner2 & Corner4 & Corner6;
+            AnySolid = (AnySolid | (AnySolid >> 1)) & CellMask;
+            AllSolid = (AllSolid & (AllSolid >> 1)) & CellMask;
+            u64 SurfaceCells = AnySolid & ~AllSolid;
+            if (SurfaceCells == 0)
+            {
+                Mesher->NumSkippedRows += 1;
+                continue;
+            }
+
+            u64 Corner1 = Corner0 >> 1;
+            u64 Corner3 = Corner2 >> 1;
+            u64 Corner5 = Corner4 >> 1;
+            u64 Corner7 = Corner6 >> 1;
+            while (SurfaceCells)
+            {
+                u32 CellX = DemoBitScanForwardU64(SurfaceCells);
+                SurfaceCells &= SurfaceCells - 1;
+
+                u32 CaseByte = u32((((Corner0 >> CellX) & 1) << 0) | (((Corner1 >> CellX) & 1) << 1) |
+                                   (((Corner2 >> CellX) & 1) << 2) | (((Corner3 >> CellX) & 1) << 3) |
+                                   (((Corner4 >> CellX) & 1) << 4) | (((Corner5 >> CellX) & 1) << 5) |
+                                   (((Corner6 >> CellX) & 1) << 6) | (((Corner7 >> CellX) & 1) << 7));
+                TerrainCpuMesherCellEmit(Mesher, CellX, CellY, CellZ, CaseByte);
+                Mesher->NumSurfaceCells += 1;
+            }
+        }
+    }
+}
+
+// NOTE: Meshes a chunk into Mesher->Vertices
+inline void TerrainCpuMesherChunk(terrain_cpu_mesher* Mesher, chunk_key Key)
+{
+    TerrainCpuMesherDensities(Mesher, Key);
+    TerrainCpuMesherSignMasks(Mesher);
+    TerrainCpuMesherExtract(Mesher);
+}
+
+//
+// NOTE: Benchmark
+//
+
+// NOTE: Reference, every cell loads its 8 corners and builds its case byte on its own
+inline void TerrainCpuMesherExtractPerCell(terrain_cpu_mesher* Mesher)
+{
+    Mesher->NumVertices = 0;
+    Mesher->NumSurfaceCells = 0;
+    Mesher->NumSkippedRows = 0;
+
+    for (u32 CellZ = 0; CellZ < TERRAIN_CHUNK_RES; ++CellZ)
+    {
+        for (u32 CellY = 0; CellY < TERRAIN_CHUNK_RES; ++CellY)
+        {
+            for (u32 CellX = 0; CellX < TERRAIN_CHUNK_RES; ++CellX)
+            {
+                u32 CaseByte = 0;
+                for (u32 CornerId = 0; CornerId < 8; ++CornerId)
+                {
+                    f32 Density = TerrainCpuMesherRow(Mesher, CellY + ((CornerId >> 1) & 1), CellZ + ((CornerId >> 2) & 1))[CellX + (CornerId & 1)];
+                    CaseByte |= (Density >= 0.0f ? 1 : 0) << CornerId;
+                }
+
+                if (CaseByte != 0 && CaseByte != 0xFF)
+                {
+                    TerrainCpuMesherCellEmit(Mesher, CellX, CellY, CellZ, CaseByte);
+                    Mesher->NumSurfaceCells += 1;
+                }
+            }
+        }
+    }
+}
+
+inline u32 TerrainCpuMesherVertexHash(terrain_cpu_mesher* Mesher)
+{
+    // NOTE: FNV-1a, both extractors emit the cells in the same order so the lists have to match bit for bit
+    u32 Result = 2166136261u;
+    u8* Bytes = (u8*)Mesher->Vertices;
+    for (u64 ByteId = 0; ByteId < sizeof(v3)*u64(Mesher->NumVertices); ++ByteId)
+    {
+        Result = (Result ^ Bytes[ByteId]) * 16777619u;
+    }
+    return Result;
+}
+
+inline void TerrainCpuMesherBenchmark(terrain_queries* Queries, benchmark_state* Bench)
+{
+    terrain_cpu_mesher Mesher;
+    TerrainCpuMesherCreate(&Mesher, &Queries->Field, Queries->ResX, Queries->ResY, Queries->ResZ);
+
+    u32 ChunksX = Queries->ResX / TERRAIN_CHUNK_RES;
+    u32 ChunksY = Queries->ResY / TERRAIN_CHUNK_RES;
+    u32 ChunksZ = Queries->ResZ / TERRAIN_CHUNK_RES;
+    f64 DensityMs = 0.0;
+    f64 SignMaskMs = 0.0;
+    f64 PerCellMs = 0.0;
+    u64 NumSurfaceCells = 0;
+    u64 NumSkippedRows = 0;
+    u64 NumTriangles = 0;
+    u32 NumMismatches = 0;
+    for (u32 ChunkZ = 0; ChunkZ < ChunksZ; ++ChunkZ)
+    {
+        for (u32 ChunkY = 0; ChunkY < ChunksY; ++ChunkY)
+        {
+            for (u32 ChunkX = 0; ChunkX < ChunksX; ++ChunkX)
+            {
+                {
+                    u64 StartTime = DemoTimerGet();
+                    TerrainCpuMesherDensities(&Mesher, ChunkKey(ChunkX, ChunkY, ChunkZ, 0));
+                    DensityMs += DemoTimerElapsedMs(StartTime);
+                }
+
+                u32 PerCellVertices = 0;
+                u32 PerCellHash = 0;
+                {
+                    u64 StartTime = DemoTimerGet();
+                    TerrainCpuMesherExtractPerCell(&Mesher);
+                    PerCellMs += DemoTimerElapsedMs(StartTime);
+                    PerCellVertices = Mesher.NumVertices;
+                    PerCellHash = TerrainCpuMesherVertexHash(&Mesher);
+                }
+
+                {
+                    u64 StartTime = DemoTimerGet();
+                    TerrainCpuMesherSignMasks(&Mesher);
+                    TerrainCpuMesherExtract(&Mesher);
+                    SignMaskMs += DemoTimerElapsedMs(StartTime);
+                }
+
+                NumSurfaceCells += Mesher.NumSurfaceCells;
+                NumSkippedRows += Mesher.NumSkippedRows;
+                NumTriangles += Mesher.NumVertices / 3;
+                if (Mesher.NumVertices != PerCellVertices || TerrainCpuMesherVertexHash(&Mesher) != PerCellHash)
+                {
+                    NumMismatches += 1;
+                }
+            }
+        }
+    }
+
+    f64 NumCells = f64(ChunksX*ChunksY*ChunksZ)*f64(TERRAIN_CHUNK_RES*TERRAIN_CHUNK_RES*TERRAIN_CHUNK_RES);
+    f64 NumRows = f64(ChunksX*ChunksY*ChunksZ)*f64(TERRAIN_CHUNK_RES*TERRAIN_CHUNK_RES);
+    BenchmarkRecord(Bench, "cpu_mesher_density_ms", DensityMs, "ms");
+    BenchmarkRecord(Bench, "cpu_mesher_per_cell_extract_ms", PerCellMs, "ms");
+    BenchmarkRecord(Bench, "cpu_mesher_sign_mask_extract_ms", SignMaskMs, "ms");
+    BenchmarkRecord(Bench, "cpu_mesher_sign_mask_speedup", PerCellMs / SignMaskMs, "x");
+    BenchmarkRecord(Bench, "cpu_mesher_surface_cell_ratio", f64(NumSurfaceCells) / NumCells, "ratio");
+    BenchmarkRecord(Bench, "cpu_mesher_skipped_row_ratio", f64(NumSkippedRows) / NumRows, "ratio");
+    BenchmarkRecord(Bench, "cpu_mesher_triangles", f64(NumTriangles), "triangles");
+    BenchmarkRecord(Bench, "cpu_mesher_chunk_mismatches", NumMismatches, "chunks");
+
+    TerrainCpuMesherDestroy(&Mesher);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+/*
+
+  NOTE: CPU chunk mesher, marching cubes with the same transvoxel tables and case bytes as GENERATE_TRIANGLES but over densities
+        from the CPU copy of the density function (terrain_queries). Almost every cell of a chunk is all air or all solid, so finding
+        the few surface cells is most of the work, the mesher never looks at cells one by one for that:
+
+        - Sign masks: every x row of corner samples is packed into a u64, bit x set when the sample is solid (>= 0 like
+          TerrainCellCaseByte). SSE compares + movemask turn 4 samples into 4 bits at a time
+        - Case bits: the 8 corners of the cells along a row come from 4 row masks (y, y + 1, z, z + 1) and the same 4 shifted down by
+          one for the x + 1 corners. A row has surface cells where the OR of the 8 corner masks is 1 and the AND is 0, rows where
+          that is 0 for every cell (all air or all solid words) are skipped with a single test
+        - Emit: only the surviving bits get a case byte (one bit of each corner mask) and go through GlobalRegularCellClasses,
+          GlobalRegularCellData and GlobalRegularVertexData. Vertices are in terrain samples and there is no vertex reuse, same as the
+          GPU path
+
+        The benchmark meshes the whole grid with the sign masks and with a plain per cell loop over the same densities and checks that
+        both emit the same triangles.
+
+ */
+
+#define TERRAIN_CPU_MESHER_ROW_SAMPLES (TERRAIN_CHUNK_RES + 1)
+#define TERRAIN_CPU_MESHER_ROW_STRIDE ((TERRAIN_CPU_MESHER_ROW_SAMPLES + 3) & ~3) // NOTE: Rows are evaluated 4 samples at a time
+#define TERRAIN_CPU_MESHER_NUM_ROWS (TERRAIN_CPU_MESHER_ROW_SAMPLES*TERRAIN_CPU_MESHER_ROW_SAMPLES)
+#define TERRAIN_CPU_MESHER_MAX_VERTICES (TERRAIN_CHUNK_RES*TERRAIN_CHUNK_RES*TERRAIN_CHUNK_RES*15) // NOTE: At most 5 triangles a cell
+
+// IMPORTANT: A row of corner samples has to fit in one mask
+#if TERRAIN_CPU_MESHER_ROW_SAMPLES > 64
+#error "Chunk rows don't fit in a u64 sign mask"
+#endif
+
+struct terrain_cpu_mesher
+{
+    terrain_density_field* Field;
+    u32 ResX; // NOTE: Density samples of the GPU terrain
+    u32 ResY;
+    u32 ResZ;
+
+    // NOTE: Chunk that is in Densities, positions are Origin + corner*Step in terrain samples
+    v3 Origin;
+    f32 Step;
+
+    // NOTE: Rows are indexed by (z, y) of the chunk, the padding samples past the last corner are never read
+    f32* Densities;
+    u64* SignMasks;
+
+    u32 MaxVertices;
+    u32 NumVertices;
+    v3* Vertices; // NOTE: Triangle list in terrain samples
+
+    // NOTE: Stats of the last chunk
+    u32 NumSurfaceCells;
+    u32 NumSkippedRows;
+};
@@ -0,0 +1,107 @@
+
+inline void TerrainFp16Create(terrain_fp16* Fp16, gpu_allocator* Allocator, b32 ShaderFloat16, b32 Enabled)
+{
+    *Fp16 = {};
+
+    // NOTE: Needs fp16 arithmetic enabled at device creation, fp16 storage isn't used since the kernels
+    // load and store fp32 / r16f like before
+    Fp16->Supported = ShaderFloat16;
+    Fp16->Enabled = Enabled && Fp16->Supported;
+    Fp16->Errors = GpuBufferCreate(Allocator, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(terrain_fp16_errors), GpuMemoryCategory_Debug);
+    Fp16->ErrorsReadback = GpuBufferCreate(Allocator, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                           (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+                                            VK_MEMORY_PROPERTY_HOST_CACHED_BIT),
+                                           sizeof(terrain_fp16_errors), GpuMemoryCategory_Readback);
+}
+
+// NOTE: Only the first fp16 generation gets probed, the terrain doesn't change after that
+inline b32 TerrainFp16ProbeNeeded(terrain_fp16* Fp16)
+{
+    b32 Result = !Fp16->HasErrors && !Fp16->ReadbackPending;
+    return Result;
+}
+
+/*
+  NOTE: Records FP16_ERROR_PROBE over the jobs ChunkBatchRecord just generated, the probe reads the noise and job buffer but writes
+        nothing the terrain uses. Uses the density bricks dispatch shape
+ */
+inline void TerrainFp16ProbeRecord(terrain_fp16* Fp16, vk_commands* Commands, vk_pipeline* ProbePso, VkDescriptorSet TerrainDescriptor,
+                                   u32 NumJobs, VkBuffer DispatchArgs, VkDeviceSize DispatchArgsOffset)
+{
+    vkCmdFillBuffer(Commands->Buffer, Fp16->Errors.Buffer, 0, VK_WHOLE_SIZE, 0);
+    VkBarrierBufferAdd(Commands, Fp16->Errors.Buffer,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    chunk_push_constants PushConstants = {};
+    PushConstants.NumJobs = NumJobs;
+    vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, ProbePso->Handle);
+    vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, ProbePso->Layout, 0, 1, &TerrainDescriptor, 0, 0);
+    vkCmdPushConstants(Commands->Buffer, ProbePso->Layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &PushConstants);
+    vkCmdDispatchIndirect(Commands->Buffer, DispatchArgs, DispatchArgsOffset);
+
+    VkBarrierBufferAdd(Commands, Fp16->Errors.Buffer,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    VkBufferCopy Region = {};
+    Region.size = sizeof(terrain_fp16_errors);
+    vkCmdCopyBuffer(Commands->Buffer, Fp16->Errors.Buffer, Fp16->ErrorsReadback.Buffer, 1, &Region);
+    VkBarrierBufferAdd(Commands, Fp16->ErrorsReadback.Buffer,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    Fp16->ReadbackPending = true;
+}
+
+// NOTE: Called after VkCommandsBegin waited on last frames fence
+inline b32 TerrainFp16ReadbackRead(terrain_fp16* Fp16)
+{
+    if (!Fp16->ReadbackPending)
+    {
+        return false;
+    }
+    Fp16->ReadbackPending = false;
+
+    terrain_fp16_errors* Errors = (terrain_fp16_errors*)Fp16->ErrorsReadback.Allocation.Mapped;
+    Copy(&Errors->MaxVertexError, &Fp16->MaxVertexError, sizeof(f32));
+    Copy(&Errors->MaxNormalError, &Fp16->MaxNormalError, sizeof(f32));
+    Fp16->SurfaceCells = Errors->SurfaceCells;
+    Fp16->MismatchCells = Errors->MismatchCells;
+    Fp16->HasErrors = true;
+
+    return true;
+}
+
+inline f32 TerrainFp16MismatchRatio(terrain_fp16* Fp16)
+{
+    f32 Result = Fp16->SurfaceCells ? f32(Fp16->MismatchCells) / f32(Fp16->SurfaceCells) : 0.0f;
+    return Result;
+}
+
+inline void TerrainFp16Panel(ui_panel* Panel, terrain_fp16* Fp16)
+{
+    char Text[256];
+    if (!Fp16->Supported)
+    {
+        UiPanelText(Panel, "FP16 Generation: not supported, using fp32");
+        UiPanelNextRow(Panel);
+        return;
+    }
+
+    snprintf(Text, sizeof(Text), "FP16 Generation: %s", Fp16->Enabled ? "on" : "off");
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+
+    if (Fp16->HasErrors)
+    {
+        snprintf(Text, sizeof(Text), "FP16 Error: vertex %.4f cells, normal %.2f deg, %u / %u cells change case", Fp16->MaxVertexError,
+                 Fp16->MaxNormalError, Fp16->MismatchCells, Fp16->SurfaceCells);
+        UiPanelText(Panel, Text);
+        UiPanelNextRow(Panel);
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+/*
+
+  NOTE: Opt-in fp16 arithmetic for chunk generation. GENERATE_3D_TERRAIN, GENERATE_TRIANGLES and FUSED_GENERATE get a second build
+        with GL_EXT_shader_explicit_arithmetic_types_float16 where the octave sum runs as packed half2 math (two octaves per f16vec2),
+        the normal gradients and the edge interpolation factor are fp16 too. Sample positions, noise uvs and the final vertex position
+        stay fp32, the atlas is r16f already so density storage doesn't change.
+
+        - Devices where shaderFloat16 wasn't enabled never create the fp16 pipelines and always run fp32, FP16_GENERATION is only a
+          request. The framework creates the device without a feature chain, so for now that is every device
+        - FP16_ERROR_PROBE meshes every cell with both precisions (fp32 rounded to fp16 like the atlas) and keeps the largest vertex
+          error in cells, the largest normal error in degrees and how many surface cells pick a different case. It runs once over the
+          first batch the fp16 path generates, the result is read back like the density pyramid
+
+ */
+
+struct terrain_fp16_errors
+{
+    u32 MaxVertexError; // NOTE: f32 bits, atomicMax on the GPU
+    u32 MaxNormalError;
+    u32 SurfaceCells;
+    u32 MismatchCells;
+};
+
+struct terrain_fp16
+{
+    b32 Supported;
+    b32 Enabled;
+
+    gpu_buffer Errors;
+    gpu_buffer ErrorsReadback;
+    b32 ReadbackPending;
+    b32 HasErrors;
+    f32 MaxVertexError; // NOTE: In cells
+    f32 MaxNormalError; // NOTE: In degrees
+    u32 SurfaceCells;
+    u32 MismatchCells;
+};
@@ -0,0 +1,117 @@
+
+inline u32 TerrainPreviewRegion(terrain_preview* Preview, chunk_key Key)
+{
+    u32 RegionX = u32(Key.X) >> Preview->Lod;
+    u32 RegionY = u32(Key.Y) >> Preview->Lod;
+    u32 RegionZ = u32(Key.Z) >> Preview->Lod;
+    u32 Result = RegionX + RegionY*Preview->RegionsX + RegionZ*Preview->RegionsX*Preview->RegionsY;
+    return Result;
+}
+
+inline chunk_key TerrainPreviewRegionKey(terrain_preview* Preview, u32 Region)
+{
+    chunk_key Result = ChunkKey(Region % Preview->RegionsX, (Region / Preview->RegionsX) % Preview->RegionsY,
+                                Region / (Preview->RegionsX*Preview->RegionsY), Preview->Lod);
+    return Result;
+}
+
+// NOTE: Every region draws its grid chunks right away, e.g. the whole grid gets generated in one go
+inline void TerrainPreviewSkip(terrain_preview* Preview)
+{
+    Preview->Generated = true;
+    for (u32 Region = 0; Region < Preview->NumRegions; ++Region)
+    {
+        Preview->RegionRefined[Region] = true;
+    }
+    Preview->NumRefined = Preview->NumRegions;
+}
+
+inline void TerrainPreviewCreate(terrain_preview* Preview, linear_arena* Arena, b32 Enabled, u32 Lod, u32 ChunksX, u32 ChunksY,
+                                 u32 ChunksZ, u64 StartTime)
+{
+    *Preview = {};
+    Preview->Enabled = Enabled;
+    Preview->Lod = Lod;
+    Preview->StartTime = StartTime;
+
+    u32 RegionSize = 1 << Lod;
+    Preview->RegionsX = (ChunksX + RegionSize - 1) / RegionSize;
+    Preview->RegionsY = (ChunksY + RegionSize - 1) / RegionSize;
+    Preview->RegionsZ = (ChunksZ + RegionSize - 1) / RegionSize;
+    Preview->NumRegions = Preview->RegionsX*Preview->RegionsY*Preview->RegionsZ;
+    Preview->FirstSlot = ChunksX*ChunksY*ChunksZ;
+    Preview->RegionRefined = PushArray(Arena, b32, Preview->NumRegions);
+    Preview->RegionPending = PushArray(Arena, u32, Preview->NumRegions);
+    for (u32 Region = 0; Region < Preview->NumRegions; ++Region)
+    {
+        Preview->RegionRefined[Region] = false;
+        Preview->RegionPending[Region] = 0;
+    }
+
+    Preview->NumGridSlots = ChunksX*ChunksY*ChunksZ;
+    Preview->SlotRegion = PushArray(Arena, u32, Preview->NumGridSlots);
+
+    if (!Enabled)
+    {
+        TerrainPreviewSkip(Preview);
+    }
+}
+
+// NOTE: SlotPending is the schedulers pending set over the grid slots
+inline void TerrainPreviewRefine(terrain_preview* Preview, b32* SlotPending)
+{
+    for (u32 Region = 0; Region < Preview->NumRegions; ++Region)
+    {
+        Preview->RegionPending[Region] = 0;
+    }
+    for (u32 Slot = 0; Slot < Preview->NumGridSlots; ++Slot)
+    {
+        Preview->RegionPending[Preview->SlotRegion[Slot]] += SlotPending[Slot] ? 1 : 0;
+    }
+
+    for (u32 Region = 0; Region < Preview->NumRegions; ++Region)
+    {
+        if (!Preview->RegionRefined[Region] && Preview->RegionPending[Region] == 0)
+        {
+            Preview->RegionRefined[Region] = true;
+            Preview->NumRefined += 1;
+        }
+    }
+}
+
+inline b32 TerrainPreviewSlotDrawn(terrain_preview* Preview, u32 GridSlot)
+{
+    b32 Result = Preview->RegionRefined[Preview->SlotRegion[GridSlot]];
+    return Result;
+}
+
+// NOTE: Call after VkCommandsBegin waited on last frames fence
+inline void TerrainPreviewFrameBegin(terrain_preview* Preview, benchmark_state* Bench)
+{
+    if (Preview->FirstFrameSubmitted && Preview->FirstFrameMs == 0.0f)
+    {
+        Preview->FirstFrameMs = f32(DemoTimerElapsedMs(Preview->StartTime));
+        BenchmarkRecord(Bench, "time_to_first_frame_ms", Preview->FirstFrameMs, "ms");
+    }
+    if (Preview->FullDetailSubmitted && Preview->FullDetailMs == 0.0f)
+    {
+        Preview->FullDetailMs = f32(DemoTimerElapsedMs(Preview->StartTime));
+        BenchmarkRecord(Bench, "time_to_full_detail_ms", Preview->FullDetailMs, "ms");
+    }
+}
+
+// NOTE: Call once the frame is recorded, FullDetail is true once every grid chunk is ready
+inline void TerrainPreviewFrameEnd(terrain_preview* Preview, b32 FullDetail)
+{
+    Preview->FirstFrameSubmitted = true;
+    Preview->FullDetailSubmitted = Preview->FullDetailSubmitted || FullDetail;
+}
+
+inline void TerrainPreviewPanel(ui_panel* Panel, terrain_preview* Preview)
+{
+    char Text[256];
+    snprintf(Text, sizeof(Text), "Startup: preview lod %u, %u / %u regions refined, first frame %.1f ms, full detail %.1f ms",
+             Preview->Lod, Preview->NumRefined, Preview->NumRegions, Preview->FirstFrameMs, Preview->FullDetailMs);
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+}
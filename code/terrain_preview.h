@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+
+  NOTE: Progressive startup. The first frame generates the whole terrain as a handful of coarse chunks (TERRAIN_PREVIEW_LOD, every
+        chunk still has TERRAIN_CHUNK_RES cells per axis) so something is on screen right away, the scheduler then refines the grid
+        chunks around the camera within its budget over the next frames.
+
+        - The preview chunks live in their own slots after the grid slots, one per region of 2^Lod grid chunks per axis. A region
+          draws its preview chunk until every grid chunk inside it is ready and only then switches to them, so the two never draw
+          on top of each other. A region never goes back, later invalidations keep drawing the old grid meshes like everywhere else
+        - Lod 3 gives one 32^3 chunk for our 256^3 terrain, but then nothing refines until every chunk is done. Lod 2 is 8 regions
+          of 64^3 samples over the whole terrain which is still a single frame of generation
+        - Preview chunks are standalone so there are cracks along the border of a refined and an unrefined region until both refine
+        - Time to first frame and time to full detail are CPU time from the start of Init to the start of the frame after the
+          milestone got submitted, that frame waited on its fence so the GPU work is included
+
+        Cached terrain and full regenerations (workgroup tuner, benchmark) skip the preview, their first frame is full detail.
+
+ */
+
+#define PROGRESSIVE_STARTUP 1 // NOTE: Default for DemoState->Preview.Enabled
+#define TERRAIN_PREVIEW_LOD 2
+
+struct terrain_preview
+{
+    b32 Enabled;
+    b32 Generated;
+    u32 Lod;
+
+    u32 RegionsX;
+    u32 RegionsY;
+    u32 RegionsZ;
+    u32 NumRegions;
+    u32 FirstSlot; // NOTE: Preview chunk of region i lives in slot FirstSlot + i
+    b32* RegionRefined;
+    u32* RegionPending; // NOTE: Grid chunks of the region that aren't ready yet
+    u32 NumRefined;
+
+    u32 NumGridSlots;
+    u32* SlotRegion;
+
+    // NOTE: Startup milestones, see the note at the top
+    u64 StartTime;
+    b32 FirstFrameSubmitted;
+    b32 FullDetailSubmitted;
+    f32 FirstFrameMs;
+    f32 FullDetailMs;
+};
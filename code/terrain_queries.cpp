@@ -0,0 +1,971 @@
+
+//
+// NOTE: Density Evaluation
+//
+
+// IMPORTANT: Has to match GENERATE_3D_TERRAIN in procedural_3d_terrain_shaders.cpp
+#define TERRAIN_DENSITY_OFFSET 3.5f
+global terrain_noise_octave GlobalTerrainOctaves[] =
+{
+    { 0, 9.53f, 0.07f },
+    { 1, 6.03f, 0.13f },
+    { 0, 4.03f, 0.25f },
+    { 1, 1.96f, 0.50f },
+    { 2, 1.01f, 1.00f },
+    { 3, 0.87f, 1.00f },
+    { 0, 0.54f, 1.00f },
+    { 1, 0.32f, 1.55f },
+};
+
+inline f32 TerrainQueryLerp(f32 A, f32 B, f32 T)
+{
+    f32 Result = A + (B - A)*T;
+    return Result;
+}
+
+inline f32 TerrainNoiseTexel(terrain_density_field* Field, u32 TextureId, u32 X, u32 Y, u32 Z)
+{
+    f32 Result = Field->Noise[TextureId][(Z << (2*Field->NoiseDimShift)) + (Y << Field->NoiseDimShift) + X];
+    return Result;
+}
+
+// NOTE: Same as a linear filtered REPEAT sampler, texel centers sit at (i + 0.5) / Dim and the mask wraps negative coords too
+inline f32 TerrainNoiseSample(terrain_density_field* Field, u32 TextureId, v3 Uvw)
+{
+    f32 Dim = f32(Field->NoiseDim);
+    u32 Mask = Field->NoiseDim - 1;
+    v3 Texel = Uvw*Dim - V3(0.5f);
+    f32 FloorX = floorf(Texel.x);
+    f32 FloorY = floorf(Texel.y);
+    f32 FloorZ = floorf(Texel.z);
+    f32 FracX = Texel.x - FloorX;
+    f32 FracY = Texel.y - FloorY;
+    f32 FracZ = Texel.z - FloorZ;
+    u32 X0 = u32(i32(FloorX)) & Mask;
+    u32 Y0 = u32(i32(FloorY)) & Mask;
+    u32 Z0 = u32(i32(FloorZ)) & Mask;
+    u32 X1 = (X0 + 1) & Mask;
+    u32 Y1 = (Y0 + 1) & Mask;
+    u32 Z1 = (Z0 + 1) & Mask;
+
+    f32 C00 = TerrainQueryLerp(TerrainNoiseTexel(Field, TextureId, X0, Y0, Z0), TerrainNoiseTexel(Field, TextureId, X1, Y0, Z0), FracX);
+    f32 C10 = TerrainQueryLerp(TerrainNoiseTexel(Field, TextureId, X0, Y1, Z0), TerrainNoiseTexel(Field, TextureId, X1, Y1, Z0), FracX);
+    f32 C01 = TerrainQueryLerp(TerrainNoiseTexel(Field, TextureId, X0, Y0, Z1), TerrainNoiseTexel(Field, TextureId, X1, Y0, Z1), FracX);
+    f32 C11 = TerrainQueryLerp(TerrainNoiseTexel(Field, TextureId, X0, Y1, Z1), TerrainNoiseTexel(Field, TextureId, X1, Y1, Z1), FracX);
+    f32 Result = TerrainQueryLerp(TerrainQueryLerp(C00, C10, FracY), TerrainQueryLerp(C01, C11, FracY), FracZ);
+    return Result;
+}
+
+inline f32 TerrainDensityEvaluate(terrain_density_field* Field, v3 Uv)
+{
+    f32 Result = -(Field->GeneratorCenter.y + Uv.y*Field->GeneratorRadius.y);
+    for (u32 OctaveId = 0; OctaveId < ArrayCount(GlobalTerrainOctaves); ++OctaveId)
+    {
+        terrain_noise_octave* Octave = GlobalTerrainOctaves + OctaveId;
+        Result += TerrainNoiseSample(Field, Octave->TextureId, Uv*Octave->Frequency)*Octave->Amplitude;
+    }
+    Result -= TERRAIN_DENSITY_OFFSET;
+
+    return Result;
+}
+
+// NOTE: SSE2 only truncates, step down where truncating rounded up (negative values)
+inline __m128 TerrainQueryFloor4(__m128 Value, __m128i* OutInt)
+{
+    __m128i Int = _mm_cvttps_epi32(Value);
+    __m128 RoundedUp = _mm_cmpgt_ps(_mm_cvtepi32_ps(Int), Value);
+    Int = _mm_add_epi32(Int, _mm_castps_si128(RoundedUp));
+    *OutInt = Int;
+
+    __m128 Result = _mm_cvtepi32_ps(Int);
+    return Result;
+}
+
+inline __m128 TerrainQueryLerp4(__m128 A, __m128 B, __m128 T)
+{
+    __m128 Result = _mm_add_ps(A, _mm_mul_ps(_mm_sub_ps(B, A), T));
+    return Result;
+}
+
+inline __m128 TerrainNoiseGather4(f32* Noise, __m128i Index)
+{
+    u32 Indices[4];
+    _mm_storeu_si128((__m128i*)Indices, Index);
+    __m128 Result = _mm_setr_ps(Noise[Indices[0]], Noise[Indices[1]], Noise[Indices[2]], Noise[Indices[3]]);
+    return Result;
+}
+
+// NOTE: TerrainNoiseSample for 4 points, SSE2 has no gather so the texel loads are scalar and the addressing + filtering is SIMD
+inline __m128 TerrainNoiseSample4(terrain_density_field* Field, u32 TextureId, __m128 U, __m128 V, __m128 W)
+{
+    __m128 Dim = _mm_set1_ps(f32(Field->NoiseDim));
+    __m128 Half = _mm_set1_ps(0.5f);
+    __m128 TexelX = _mm_sub_ps(_mm_mul_ps(U, Dim), Half);
+    __m128 TexelY = _mm_sub_ps(_mm_mul_ps(V, Dim), Half);
+    __m128 TexelZ = _mm_sub_ps(_mm_mul_ps(W, Dim), Half);
+
+    __m128i IntX, IntY, IntZ;
+    __m128 FracX = _mm_sub_ps(TexelX, TerrainQueryFloor4(TexelX, &IntX));
+    __m128 FracY = _mm_sub_ps(TexelY, TerrainQueryFloor4(TexelY, &IntY));
+    __m128 FracZ = _mm_sub_ps(TexelZ, TerrainQueryFloor4(TexelZ, &IntZ));
+
+    // NOTE: No 32 bit mullo in SSE2, the dim is a power of 2 so rows and slices are shifts
+    __m128i Mask = _mm_set1_epi32(i32(Field->NoiseDim - 1));
+    __m128i One = _mm_set1_epi32(1);
+    __m128i RowShift = _mm_cvtsi32_si128(i32(Field->NoiseDimShift));
+    __m128i SliceShift = _mm_cvtsi32_si128(i32(2*Field->NoiseDimShift));
+    __m128i X0 = _mm_and_si128(IntX, Mask);
+    __m128i X1 = _mm_and_si128(_mm_add_epi32(IntX, One), Mask);
+    __m128i Y0 = _mm_sll_epi32(_mm_and_si128(IntY, Mask), RowShift);
+    __m128i Y1 = _mm_sll_epi32(_mm_and_si128(_mm_add_epi32(IntY, One), Mask), RowShift);
+    __m128i Z0 = _mm_sll_epi32(_mm_and_si128(IntZ, Mask), SliceShift);
+    __m128i Z1 = _mm_sll_epi32(_mm_and_si128(_mm_add_epi32(IntZ, One), Mask), SliceShift);
+
+    f32* Noise = Field->Noise[TextureId];
+    __m128i Z0Y0 = _mm_add_epi32(Z0, Y0);
+    __m128i Z0Y1 = _mm_add_epi32(Z0, Y1);
+    __m128i Z1Y0 = _mm_add_epi32(Z1, Y0);
+    __m128i Z1Y1 = _mm_add_epi32(Z1, Y1);
+    __m128 C00 = TerrainQueryLerp4(TerrainNoiseGather4(Noise, _mm_add_epi32(Z0Y0, X0)), TerrainNoiseGather4(Noise, _mm_add_epi32(Z0Y0, X1)), FracX);
+    __m128 C10 = TerrainQueryLerp4(TerrainNoiseGather4(Noise, _mm_add_epi32(Z0Y1, X0)), TerrainNoiseGather4(Noise, _mm_add_epi32(Z0Y1, X1)), FracX);
+    __m128 C01 = TerrainQueryLerp4(TerrainNoiseGather4(Noise, _mm_add_epi32(Z1Y0, X0)), TerrainNoiseGather4(Noise, _mm_add_epi32(Z1Y0, X1)), FracX);
+    __m128 C11 = TerrainQueryLerp4(TerrainNoiseGather4(Noise, _mm_add_epi32(Z1Y1, X0)), TerrainNoiseGather4(Noise, _mm_add_epi32(Z1Y1, X1)), FracX);
+    __m128 Result = TerrainQueryLerp4(TerrainQueryLerp4(C00, C10, FracY), TerrainQueryLerp4(C01, C11, FracY), FracZ);
+    return Result;
+}
+
+inline __m128 TerrainDensityEvaluate4(terrain_density_field* Field, __m128 X, __m128 Y, __m128 Z)
+{
+    __m128 Result = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_set1_ps(Field->GeneratorCenter.y),
+                                                            _mm_mul_ps(Y, _mm_set1_ps(Field->GeneratorRadius.y))));
+    for (u32 OctaveId = 0; OctaveId < ArrayCount(GlobalTerrainOctaves); ++OctaveId)
+    {
+        terrain_noise_octave* Octave = GlobalTerrainOctaves + OctaveId;
+        __m128 Frequency = _mm_set1_ps(Octave->Frequency);
+        __m128 Noise = TerrainNoiseSample4(Field, Octave->TextureId, _mm_mul_ps(X, Frequency), _mm_mul_ps(Y, Frequency),
+                                           _mm_mul_ps(Z, Frequency));
+        Result = _mm_add_ps(Result, _mm_mul_ps(Noise, _mm_set1_ps(Octave->Amplitude)));
+    }
+    Result = _mm_sub_ps(Result, _mm_set1_ps(TERRAIN_DENSITY_OFFSET));
+
+    return Result;
+}
+
+//
+// NOTE: Density Intervals
+//
+
+inline void TerrainNoiseTexelRange(f32 Min, f32 Max, u32 NoiseDim, i32* OutFirst, i32* OutCount)
+{
+    // NOTE: Every texel a filter footprint between Min and Max touches, capped at the whole texture
+    f32 Dim = f32(NoiseDim);
+    i32 First = i32(floorf(Min*Dim - 0.5f));
+    i32 Count = i32(floorf(Max*Dim - 0.5f)) + 2 - First;
+    *OutFirst = First;
+    *OutCount = Count < i32(NoiseDim) ? Count : i32(NoiseDim);
+}
+
+inline terrain_query_node TerrainNoiseInterval(terrain_density_field* Field, u32 TextureId, v3 UvwMin, v3 UvwMax)
+{
+    i32 FirstX, FirstY, FirstZ, CountX, CountY, CountZ;
+    TerrainNoiseTexelRange(UvwMin.x, UvwMax.x, Field->NoiseDim, &FirstX, &CountX);
+    TerrainNoiseTexelRange(UvwMin.y, UvwMax.y, Field->NoiseDim, &FirstY, &CountY);
+    TerrainNoiseTexelRange(UvwMin.z, UvwMax.z, Field->NoiseDim, &FirstZ, &CountZ);
+
+    terrain_query_node Result = {};
+    Result.Min = Field->NoiseMin[TextureId];
+    Result.Max = Field->NoiseMax[TextureId];
+    if (CountX == i32(Field->NoiseDim) && CountY == i32(Field->NoiseDim) && CountZ == i32(Field->NoiseDim))
+    {
+        return Result;
+    }
+
+    // NOTE: Trilinear filtering is a convex combination of the texels it touches so their min/max bound the noise in the box
+    u32 Mask = Field->NoiseDim - 1;
+    Result.Min = 1e30f;
+    Result.Max = -1e30f;
+    for (i32 Z = 0; Z < CountZ; ++Z)
+    {
+        for (i32 Y = 0; Y < CountY; ++Y)
+        {
+            for (i32 X = 0; X < CountX; ++X)
+            {
+                f32 Texel = TerrainNoiseTexel(Field, TextureId, u32(FirstX + X) & Mask, u32(FirstY + Y) & Mask, u32(FirstZ + Z) & Mask);
+                Result.Min = Texel < Result.Min ? Texel : Result.Min;
+                Result.Max = Texel > Result.Max ? Texel : Result.Max;
+            }
+        }
+    }
+
+    return Result;
+}
+
+inline terrain_query_node TerrainDensityInterval(terrain_density_field* Field, v3 UvMin, v3 UvMax)
+{
+    terrain_query_node Result = {};
+    Result.Min = -(Field->GeneratorCenter.y + UvMax.y*Field->GeneratorRadius.y) - TERRAIN_DENSITY_OFFSET;
+    Result.Max = -(Field->GeneratorCenter.y + UvMin.y*Field->GeneratorRadius.y) - TERRAIN_DENSITY_OFFSET;
+    for (u32 OctaveId = 0; OctaveId < ArrayCount(GlobalTerrainOctaves); ++OctaveId)
+    {
+        terrain_noise_octave* Octave = GlobalTerrainOctaves + OctaveId;
+        terrain_query_node Noise = TerrainNoiseInterval(Field, Octave->TextureId, UvMin*Octave->Frequency, UvMax*Octave->Frequency);
+        Result.Min += Noise.Min*Octave->Amplitude;
+        Result.Max += Noise.Max*Octave->Amplitude;
+    }
+
+    return Result;
+}
+
+//
+// NOTE: Acceleration Structure
+//
+
+inline void TerrainQueryBuildSlice(terrain_queries* Queries, u32 BlockZ)
+{
+    v3 BlockUv = V3(2.0f / f32(Queries->BlocksX), 2.0f / f32(Queries->BlocksY), 2.0f / f32(Queries->BlocksZ));
+    for (u32 BlockY = 0; BlockY < Queries->BlocksY; ++BlockY)
+    {
+        for (u32 BlockX = 0; BlockX < Queries->BlocksX; ++BlockX)
+        {
+            v3 UvMin = V3(-1.0f + f32(BlockX)*BlockUv.x, -1.0f + f32(BlockY)*BlockUv.y, -1.0f + f32(BlockZ)*BlockUv.z);
+            v3 UvMax = UvMin + BlockUv;
+            u32 BlockId = (BlockZ*Queries->BlocksY + BlockY)*Queries->BlocksX + BlockX;
+            Queries->Blocks[BlockId] = TerrainDensityInterval(&Queries->Field, UvMin, UvMax);
+        }
+    }
+}
+
+inline void TerrainQueryBuildJobCallback(void* Data, u32 ThreadId)
+{
+    terrain_query_job* Job = (terrain_query_job*)Data;
+    TerrainQueryBuildSlice(Job->Queries, Job->Slice);
+}
+
+// NOTE: Noise data is referenced, not copied. Needs the job queue to be idle
+inline void TerrainQueriesCreate(terrain_queries* Queries, linear_arena* Arena, job_queue* JobQueue, f32** NoiseData, u32 NoiseDim,
+                                 v3 GeneratorCenter, v3 GeneratorRadius, v3 WorldMin, v3 WorldMax, u32 ResX, u32 ResY, u32 ResZ,
+                                 b32 PanelEnabled)
+{
+    *Queries = {};
+    Queries->JobQueue = JobQueue;
+    Queries->PanelEnabled = PanelEnabled;
+    Queries->WorldMin = WorldMin;
+    Queries->WorldMax = WorldMax;
+    Queries->ResX = ResX;
+    Queries->ResY = ResY;
+    Queries->ResZ = ResZ;
+    v3 WorldSize = WorldMax - WorldMin;
+    Queries->UvPerWorld = V3(2.0f / WorldSize.x, 2.0f / WorldSize.y, 2.0f / WorldSize.z);
+    Queries->VoxelUv = 2.0f / f32(ResX);
+    Queries->VoxelUv = 2.0f / f32(ResY) < Queries->VoxelUv ? 2.0f / f32(ResY) : Queries->VoxelUv;
+    Queries->VoxelUv = 2.0f / f32(ResZ) < Queries->VoxelUv ? 2.0f / f32(ResZ) : Queries->VoxelUv;
+
+    terrain_density_field* Field = &Queries->Field;
+    Assert((NoiseDim & (NoiseDim - 1)) == 0);
+    Field->NoiseDim = NoiseDim;
+    while ((1u << Field->NoiseDimShift) < NoiseDim)
+    {
+        Field->NoiseDimShift += 1;
+    }
+    Field->GeneratorCenter = GeneratorCenter;
+    Field->GeneratorRadius = GeneratorRadius;
+    for (u32 TextureId = 0; TextureId < TERRAIN_QUERY_NUM_NOISE_TEXTURES; ++TextureId)
+    {
+        Field->Noise[TextureId] = NoiseData[TextureId];
+        Field->NoiseMin[TextureId] = 1e30f;
+        Field->NoiseMax[TextureId] = -1e30f;
+        for (u32 TexelId = 0; TexelId < NoiseDim*NoiseDim*NoiseDim; ++TexelId)
+        {
+            f32 Texel = NoiseData[TextureId][TexelId];
+            Field->NoiseMin[TextureId] = Texel < Field->NoiseMin[TextureId] ? Texel : Field->NoiseMin[TextureId];
+            Field->NoiseMax[TextureId] = Texel > Field->NoiseMax[TextureId] ? Texel : Field->NoiseMax[TextureId];
+        }
+    }
+
+    // NOTE: Linear filtered noise changes by at most one per texel along each axis, so sqrt(3) * Dim per unit of uvw
+    Field->Lipschitz = GeneratorRadius.y;
+    for (u32 OctaveId = 0; OctaveId < ArrayCount(GlobalTerrainOctaves); ++OctaveId)
+    {
+        terrain_noise_octave* Octave = GlobalTerrainOctaves + OctaveId;
+        Field->Lipschitz += 1.7320508f*f32(NoiseDim)*Octave->Frequency*Octave->Amplitude;
+    }
+
+    Assert((ResX % (TERRAIN_QUERY_BLOCK_RES*TERRAIN_QUERY_CHUNK_BLOCKS)) == 0);
+    Assert((ResY % (TERRAIN_QUERY_BLOCK_RES*TERRAIN_QUERY_CHUNK_BLOCKS)) == 0);
+    Assert((ResZ % (TERRAIN_QUERY_BLOCK_RES*TERRAIN_QUERY_CHUNK_BLOCKS)) == 0);
+    Queries->BlocksX = ResX / TERRAIN_QUERY_BLOCK_RES;
+    Queries->BlocksY = ResY / TERRAIN_QUERY_BLOCK_RES;
+    Queries->BlocksZ = ResZ / TERRAIN_QUERY_BLOCK_RES;
+    Queries->ChunksX = Queries->BlocksX / TERRAIN_QUERY_CHUNK_BLOCKS;
+    Queries->ChunksY = Queries->BlocksY / TERRAIN_QUERY_CHUNK_BLOCKS;
+    Queries->ChunksZ = Queries->BlocksZ / TERRAIN_QUERY_CHUNK_BLOCKS;
+    Queries->Blocks = PushArray(Arena, terrain_query_node, Queries->BlocksX*Queries->BlocksY*Queries->BlocksZ);
+    Queries->Chunks = PushArray(Arena, terrain_query_node, Queries->ChunksX*Queries->ChunksY*Queries->ChunksZ);
+
+    Assert(Queries->BlocksZ <= TERRAIN_QUERY_MAX_JOBS);
+    for (u32 BlockZ = 0; BlockZ < Queries->BlocksZ; ++BlockZ)
+    {
+        terrain_query_job* Job = Queries->Jobs + BlockZ;
+        *Job = {};
+        Job->Queries = Queries;
+        Job->Slice = BlockZ;
+        JobQueueAdd(JobQueue, TerrainQueryBuildJobCallback, Job);
+    }
+    JobQueueCompleteAll(JobQueue);
+
+    for (u32 ChunkZ = 0; ChunkZ < Queries->ChunksZ; ++ChunkZ)
+    {
+        for (u32 ChunkY = 0; ChunkY < Queries->ChunksY; ++ChunkY)
+        {
+            for (u32 ChunkX = 0; ChunkX < Queries->ChunksX; ++ChunkX)
+            {
+                terrain_query_node* Chunk = Queries->Chunks + (ChunkZ*Queries->ChunksY + ChunkY)*Queries->ChunksX + ChunkX;
+                Chunk->Min = 1e30f;
+                Chunk->Max = -1e30f;
+                for (u32 BlockId = 0; BlockId < TERRAIN_QUERY_CHUNK_BLOCKS*TERRAIN_QUERY_CHUNK_BLOCKS*TERRAIN_QUERY_CHUNK_BLOCKS; ++BlockId)
+                {
+                    u32 BlockX = ChunkX*TERRAIN_QUERY_CHUNK_BLOCKS + BlockId % TERRAIN_QUERY_CHUNK_BLOCKS;
+                    u32 BlockY = ChunkY*TERRAIN_QUERY_CHUNK_BLOCKS + (BlockId / TERRAIN_QUERY_CHUNK_BLOCKS) % TERRAIN_QUERY_CHUNK_BLOCKS;
+                    u32 BlockZ = ChunkZ*TERRAIN_QUERY_CHUNK_BLOCKS + BlockId / (TERRAIN_QUERY_CHUNK_BLOCKS*TERRAIN_QUERY_CHUNK_BLOCKS);
+                    terrain_query_node* Block = Queries->Blocks + (BlockZ*Queries->BlocksY + BlockY)*Queries->BlocksX + BlockX;
+                    Chunk->Min = Block->Min < Chunk->Min ? Block->Min : Chunk->Min;
+                    Chunk->Max = Block->Max > Chunk->Max ? Block->Max : Chunk->Max;
+                }
+            }
+        }
+    }
+}
+
+inline u32 TerrainQueryCell(f32 Coord, u32 NumCells)
+{
+    i32 Cell = i32(floorf(Coord));
+    u32 Result = Cell < 0 ? 0 : (Cell >= i32(NumCells) ? NumCells - 1 : u32(Cell));
+    return Result;
+}
+
+inline f32 TerrainQueryAxisExit(f32 Pos, f32 Dir, f32 Min, f32 Max)
+{
+    f32 Result = Dir > 0.0f ? (Max - Pos) / Dir : (Dir < 0.0f ? (Min - Pos) / Dir : 1e30f);
+    return Result;
+}
+
+/*
+  NOTE: How far along the ray we can jump because the node under Uv is all air (max < 0). Margin (uv) shrinks the node first, sweeps
+        pass their radius so the whole sphere stays inside of it. Returns 0 when we have to sample
+ */
+inline f32 TerrainQueryEmptySkip(terrain_queries* Queries, v3 Uv, v3 Dir, f32 Margin)
+{
+    // NOTE: Block coords, one unit per block
+    v3 Scale = V3(0.5f*f32(Queries->BlocksX), 0.5f*f32(Queries->BlocksY), 0.5f*f32(Queries->BlocksZ));
+    v3 Pos = V3((Uv.x + 1.0f)*Scale.x, (Uv.y + 1.0f)*Scale.y, (Uv.z + 1.0f)*Scale.z);
+    v3 BlockDir = V3(Dir.x*Scale.x, Dir.y*Scale.y, Dir.z*Scale.z);
+    v3 BlockMargin = V3(Margin*Scale.x, Margin*Scale.y, Margin*Scale.z);
+    u32 BlockX = TerrainQueryCell(Pos.x, Queries->BlocksX);
+    u32 BlockY = TerrainQueryCell(Pos.y, Queries->BlocksY);
+    u32 BlockZ = TerrainQueryCell(Pos.z, Queries->BlocksZ);
+    u32 ChunkX = BlockX / TERRAIN_QUERY_CHUNK_BLOCKS;
+    u32 ChunkY = BlockY / TERRAIN_QUERY_CHUNK_BLOCKS;
+    u32 ChunkZ = BlockZ / TERRAIN_QUERY_CHUNK_BLOCKS;
+
+    v3 BoxMin = {};
+    v3 BoxMax = {};
+    if (Queries->Chunks[(ChunkZ*Queries->ChunksY + ChunkY)*Queries->ChunksX + ChunkX].Max < 0.0f)
+    {
+        BoxMin = V3(f32(ChunkX), f32(ChunkY), f32(ChunkZ))*f32(TERRAIN_QUERY_CHUNK_BLOCKS);
+        BoxMax = BoxMin + V3(f32(TERRAIN_QUERY_CHUNK_BLOCKS));
+    }
+    else if (Queries->Blocks[(BlockZ*Queries->BlocksY + BlockY)*Queries->BlocksX + BlockX].Max < 0.0f)
+    {
+        BoxMin = V3(f32(BlockX), f32(BlockY), f32(BlockZ));
+        BoxMax = BoxMin + V3(1.0f);
+    }
+    else
+    {
+        return 0.0f;
+    }
+
+    BoxMin = BoxMin + BlockMargin;
+    BoxMax = BoxMax - BlockMargin;
+    if (Pos.x < BoxMin.x || Pos.y < BoxMin.y || Pos.z < BoxMin.z || Pos.x > BoxMax.x || Pos.y > BoxMax.y || Pos.z > BoxMax.z)
+    {
+        return 0.0f;
+    }
+
+    f32 Result = TerrainQueryAxisExit(Pos.x, BlockDir.x, BoxMin.x, BoxMax.x);
+    f32 ExitY = TerrainQueryAxisExit(Pos.y, BlockDir.y, BoxMin.y, BoxMax.y);
+    f32 ExitZ = TerrainQueryAxisExit(Pos.z, BlockDir.z, BoxMin.z, BoxMax.z);
+    Result = ExitY < Result ? ExitY : Result;
+    Result = ExitZ < Result ? ExitZ : Result;
+    return Result;
+}
+
+//
+// NOTE: Ray Marching
+//
+
+inline void TerrainQueryClipAxis(f32 Pos, f32 Dir, f32 Min, f32 Max, f32* TEnter, f32* TExit)
+{
+    if (Dir == 0.0f)
+    {
+        if (Pos < Min || Pos > Max)
+        {
+            *TExit = -1.0f;
+        }
+        return;
+    }
+
+    f32 T0 = (Min - Pos) / Dir;
+    f32 T1 = (Max - Pos) / Dir;
+    f32 Near = T0 < T1 ? T0 : T1;
+    f32 Far = T0 < T1 ? T1 : T0;
+    *TEnter = Near > *TEnter ? Near : *TEnter;
+    *TExit = Far < *TExit ? Far : *TExit;
+}
+
+inline b32 TerrainQueryLaneBegin(terrain_queries* Queries, terrain_ray* Ray, terrain_query_lane* Lane)
+{
+    *Lane = {};
+    v3 UvPerWorld = Queries->UvPerWorld;
+    Lane->Origin = V3((Ray->Origin.x - Queries->WorldMin.x)*UvPerWorld.x - 1.0f, (Ray->Origin.y - Queries->WorldMin.y)*UvPerWorld.y - 1.0f,
+                      (Ray->Origin.z - Queries->WorldMin.z)*UvPerWorld.z - 1.0f);
+    Lane->Dir = V3(Ray->Dir.x*UvPerWorld.x, Ray->Dir.y*UvPerWorld.y, Ray->Dir.z*UvPerWorld.z);
+
+    // NOTE: T stays in world units since the uv ray is the world ray scaled
+    f32 TEnter = 0.0f;
+    f32 TExit = Ray->MaxT;
+    TerrainQueryClipAxis(Lane->Origin.x, Lane->Dir.x, -1.0f, 1.0f, &TEnter, &TExit);
+    TerrainQueryClipAxis(Lane->Origin.y, Lane->Dir.y, -1.0f, 1.0f, &TEnter, &TExit);
+    TerrainQueryClipAxis(Lane->Origin.z, Lane->Dir.z, -1.0f, 1.0f, &TEnter, &TExit);
+
+    f32 DirLength = Length(Lane->Dir);
+    Lane->T = TEnter;
+    Lane->PrevT = TEnter;
+    Lane->TEnd = TExit;
+    Lane->InvLipschitz = 1.0f / (Queries->Field.Lipschitz*DirLength);
+    Lane->MinStep = TERRAIN_QUERY_MIN_STEP*Queries->VoxelUv / DirLength;
+    Lane->Active = TEnter <= TExit;
+    return Lane->Active;
+}
+
+inline v3 TerrainQueryLanePos(terrain_query_lane* Lane, f32 T)
+{
+    v3 Result = Lane->Origin + T*Lane->Dir;
+    return Result;
+}
+
+// NOTE: Jumps over all air nodes, the exit point is on the node so it is still a valid PrevT. Returns false once the ray is done
+inline b32 TerrainQueryLaneSkip(terrain_queries* Queries, terrain_query_lane* Lane, f32 Margin)
+{
+    f32 Skip = TerrainQueryEmptySkip(Queries, TerrainQueryLanePos(Lane, Lane->T), Lane->Dir, Margin);
+    if (Skip > 0.0f)
+    {
+        Lane->PrevT = Lane->T + Skip;
+        Lane->T = Lane->PrevT + 0.01f*Lane->MinStep;
+        if (Lane->PrevT >= Lane->TEnd)
+        {
+            Lane->Active = false;
+        }
+        Lane->T = Lane->T < Lane->TEnd ? Lane->T : Lane->TEnd;
+    }
+
+    return Lane->Active;
+}
+
+// NOTE: Sample was outside of the surface, take the next step. Returns false once the ray is done
+inline b32 TerrainQueryLaneStep(terrain_query_lane* Lane, f32 SafeDistance)
+{
+    f32 Step = SafeDistance > Lane->MinStep ? SafeDistance : Lane->MinStep;
+    Lane->PrevT = Lane->T;
+    Lane->T += Step;
+    if (Lane->PrevT >= Lane->TEnd)
+    {
+        Lane->Active = false;
+    }
+
+    // NOTE: Always take one last sample at the end of the ray
+    Lane->T = Lane->T < Lane->TEnd ? Lane->T : Lane->TEnd;
+    return Lane->Active;
+}
+
+inline v3 TerrainQueryGradient(terrain_queries* Queries, v3 Uv)
+{
+    // NOTE: Per world unit, density grows into the ground
+    f32 H = 0.5f*Queries->VoxelUv;
+    terrain_density_field* Field = &Queries->Field;
+    v3 Result = {};
+    Result.x = (TerrainDensityEvaluate(Field, Uv + V3(H, 0, 0)) - TerrainDensityEvaluate(Field, Uv - V3(H, 0, 0))) / (2.0f*H);
+    Result.y = (TerrainDensityEvaluate(Field, Uv + V3(0, H, 0)) - TerrainDensityEvaluate(Field, Uv - V3(0, H, 0))) / (2.0f*H);
+    Result.z = (TerrainDensityEvaluate(Field, Uv + V3(0, 0, H)) - TerrainDensityEvaluate(Field, Uv - V3(0, 0, H))) / (2.0f*H);
+    Result = V3(Result.x*Queries->UvPerWorld.x, Result.y*Queries->UvPerWorld.y, Result.z*Queries->UvPerWorld.z);
+    return Result;
+}
+
+/*
+  NOTE: >= 0 means hit. Rays use the density itself, sweeps use the first order signed distance (density / |gradient|) against the radius
+ */
+inline f32 TerrainQuerySurfaceValue(terrain_queries* Queries, v3 Uv, f32 Radius)
+{
+    f32 Result = TerrainDensityEvaluate(&Queries->Field, Uv);
+    if (Radius > 0.0f)
+    {
+        Result += Radius*Length(TerrainQueryGradient(Queries, Uv));
+    }
+    return Result;
+}
+
+inline void TerrainQueryHit(terrain_queries* Queries, terrain_ray* Ray, terrain_query_lane* Lane, f32 Radius, terrain_ray_hit* Hit)
+{
+    // NOTE: PrevT is outside and T inside, bisect between them
+    f32 Lo = Lane->PrevT;
+    f32 Hi = Lane->T;
+    for (u32 StepId = 0; StepId < TERRAIN_QUERY_REFINE_STEPS && Lo < Hi; ++StepId)
+    {
+        f32 Mid = 0.5f*(Lo + Hi);
+        if (TerrainQuerySurfaceValue(Queries, TerrainQueryLanePos(Lane, Mid), Radius) >= 0.0f)
+        {
+            Hi = Mid;
+        }
+        else
+        {
+            Lo = Mid;
+        }
+    }
+
+    Hit->Hit = true;
+    Hit->T = Hi;
+    Hit->Pos = Ray->Origin + Hi*Ray->Dir;
+    Hit->Normal = Normalize(-1.0f*TerrainQueryGradient(Queries, TerrainQueryLanePos(Lane, Hi)));
+    Lane->Active = false;
+}
+
+inline void TerrainQueryRaycastPacket(terrain_queries* Queries, terrain_ray* Rays, terrain_ray_hit* Hits, u32 NumRays)
+{
+    Assert(NumRays <= TERRAIN_QUERY_LANES);
+    terrain_query_lane Lanes[TERRAIN_QUERY_LANES] = {};
+    u32 NumActive = 0;
+    for (u32 LaneId = 0; LaneId < NumRays; ++LaneId)
+    {
+        Hits[LaneId] = {};
+        NumActive += TerrainQueryLaneBegin(Queries, Rays + LaneId, Lanes + LaneId) ? 1 : 0;
+    }
+
+    while (NumActive > 0)
+    {
+        f32 X[TERRAIN_QUERY_LANES] = {};
+        f32 Y[TERRAIN_QUERY_LANES] = {};
+        f32 Z[TERRAIN_QUERY_LANES] = {};
+        for (u32 LaneId = 0; LaneId < NumRays; ++LaneId)
+        {
+            terrain_query_lane* Lane = Lanes + LaneId;
+            if (Lane->Active && TerrainQueryLaneSkip(Queries, Lane, 0.0f))
+            {
+                v3 Pos = TerrainQueryLanePos(Lane, Lane->T);
+                X[LaneId] = Pos.x;
+                Y[LaneId] = Pos.y;
+                Z[LaneId] = Pos.z;
+            }
+        }
+
+        // NOTE: Finished lanes still evaluate, the packet costs the same either way
+        f32 Density[TERRAIN_QUERY_LANES];
+        _mm_storeu_ps(Density, TerrainDensityEvaluate4(&Queries->Field, _mm_loadu_ps(X), _mm_loadu_ps(Y), _mm_loadu_ps(Z)));
+
+        NumActive = 0;
+        for (u32 LaneId = 0; LaneId < NumRays; ++LaneId)
+        {
+            terrain_query_lane* Lane = Lanes + LaneId;
+            if (!Lane->Active)
+            {
+                continue;
+            }
+
+            if (Density[LaneId] >= 0.0f)
+            {
+                TerrainQueryHit(Queries, Rays + LaneId, Lane, 0.0f, Hits + LaneId);
+            }
+            else if (TerrainQueryLaneStep(Lane, -Density[LaneId]*Lane->InvLipschitz))
+            {
+                NumActive += 1;
+            }
+        }
+    }
+}
+
+// NOTE: |TerrainQueryGradient| for 4 points, per world unit
+inline __m128 TerrainQueryGradientLength4(terrain_queries* Queries, __m128 X, __m128 Y, __m128 Z)
+{
+    terrain_density_field* Field = &Queries->Field;
+    __m128 H = _mm_set1_ps(0.5f*Queries->VoxelUv);
+    __m128 Scale = _mm_set1_ps(1.0f / Queries->VoxelUv);
+    __m128 GradX = _mm_mul_ps(_mm_sub_ps(TerrainDensityEvaluate4(Field, _mm_add_ps(X, H), Y, Z),
+                                         TerrainDensityEvaluate4(Field, _mm_sub_ps(X, H), Y, Z)), Scale);
+    __m128 GradY = _mm_mul_ps(_mm_sub_ps(TerrainDensityEvaluate4(Field, X, _mm_add_ps(Y, H), Z),
+                                         TerrainDensityEvaluate4(Field, X, _mm_sub_ps(Y, H), Z)), Scale);
+    __m128 GradZ = _mm_mul_ps(_mm_sub_ps(TerrainDensityEvaluate4(Field, X, Y, _mm_add_ps(Z, H)),
+                                         TerrainDensityEvaluate4(Field, X, Y, _mm_sub_ps(Z, H))), Scale);
+    GradX = _mm_mul_ps(GradX, _mm_set1_ps(Queries->UvPerWorld.x));
+    GradY = _mm_mul_ps(GradY, _mm_set1_ps(Queries->UvPerWorld.y));
+    GradZ = _mm_mul_ps(GradZ, _mm_set1_ps(Queries->UvPerWorld.z));
+    __m128 Result = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(GradX, GradX), _mm_mul_ps(GradY, GradY)), _mm_mul_ps(GradZ, GradZ)));
+    return Result;
+}
+
+/*
+  NOTE: Sweeps march the sphere center. Far from the surface the Lipschitz bound minus the radius is a safe step, once a center gets
+        within reach we pay for the gradient to test the first order distance. The gradient is evaluated for the whole packet as soon
+        as one lane needs it. Centers are clipped to the terrain box like rays
+ */
+inline void TerrainQuerySphereSweepPacket(terrain_queries* Queries, terrain_ray* Rays, terrain_ray_hit* Hits, u32 NumRays)
+{
+    Assert(NumRays <= TERRAIN_QUERY_LANES);
+    f32 MaxUvPerWorld = Queries->UvPerWorld.x;
+    MaxUvPerWorld = Queries->UvPerWorld.y > MaxUvPerWorld ? Queries->UvPerWorld.y : MaxUvPerWorld;
+    MaxUvPerWorld = Queries->UvPerWorld.z > MaxUvPerWorld ? Queries->UvPerWorld.z : MaxUvPerWorld;
+    f32 LipschitzWorld = Queries->Field.Lipschitz*MaxUvPerWorld;
+
+    terrain_query_lane Lanes[TERRAIN_QUERY_LANES] = {};
+    u32 NumActive = 0;
+    for (u32 LaneId = 0; LaneId < NumRays; ++LaneId)
+    {
+        Hits[LaneId] = {};
+        NumActive += TerrainQueryLaneBegin(Queries, Rays + LaneId, Lanes + LaneId) ? 1 : 0;
+    }
+
+    while (NumActive > 0)
+    {
+        f32 X[TERRAIN_QUERY_LANES] = {};
+        f32 Y[TERRAIN_QUERY_LANES] = {};
+        f32 Z[TERRAIN_QUERY_LANES] = {};
+        for (u32 LaneId = 0; LaneId < NumRays; ++LaneId)
+        {
+            terrain_query_lane* Lane = Lanes + LaneId;
+            if (Lane->Active && TerrainQueryLaneSkip(Queries, Lane, Rays[LaneId].Radius*MaxUvPerWorld))
+            {
+                v3 Pos = TerrainQueryLanePos(Lane, Lane->T);
+                X[LaneId] = Pos.x;
+                Y[LaneId] = Pos.y;
+                Z[LaneId] = Pos.z;
+            }
+        }
+
+        __m128 PosX = _mm_loadu_ps(X);
+        __m128 PosY = _mm_loadu_ps(Y);
+        __m128 PosZ = _mm_loadu_ps(Z);
+        f32 Density[TERRAIN_QUERY_LANES];
+        _mm_storeu_ps(Density, TerrainDensityEvaluate4(&Queries->Field, PosX, PosY, PosZ));
+
+        b32 GradientNeeded = false;
+        for (u32 LaneId = 0; LaneId < NumRays; ++LaneId)
+        {
+            GradientNeeded = GradientNeeded || (Lanes[LaneId].Active && Density[LaneId] >= -Rays[LaneId].Radius*LipschitzWorld);
+        }
+
+        f32 GradientLength[TERRAIN_QUERY_LANES] = {};
+        if (GradientNeeded)
+        {
+            _mm_storeu_ps(GradientLength, TerrainQueryGradientLength4(Queries, PosX, PosY, PosZ));
+        }
+
+        NumActive = 0;
+        for (u32 LaneId = 0; LaneId < NumRays; ++LaneId)
+        {
+            terrain_query_lane* Lane = Lanes + LaneId;
+            terrain_ray* Ray = Rays + LaneId;
+            if (!Lane->Active)
+            {
+                continue;
+            }
+
+            if (Density[LaneId] >= -Ray->Radius*LipschitzWorld && Density[LaneId] + Ray->Radius*GradientLength[LaneId] >= 0.0f)
+            {
+                TerrainQueryHit(Queries, Ray, Lane, Ray->Radius, Hits + LaneId);
+            }
+            else if (TerrainQueryLaneStep(Lane, -Density[LaneId]*Lane->InvLipschitz - Ray->Radius))
+            {
+                NumActive += 1;
+            }
+        }
+    }
+}
+
+//
+// NOTE: Batches
+//
+
+inline void TerrainQueryRange(terrain_queries* Queries, terrain_query_type Type, terrain_ray* Rays, terrain_ray_hit* Hits, u32 NumRays)
+{
+    switch (Type)
+    {
+        case TerrainQueryType_Raycast:
+        {
+            for (u32 RayId = 0; RayId < NumRays; RayId += TERRAIN_QUERY_LANES)
+            {
+                u32 NumLanes = NumRays - RayId < TERRAIN_QUERY_LANES ? NumRays - RayId : TERRAIN_QUERY_LANES;
+                TerrainQueryRaycastPacket(Queries, Rays + RayId, Hits + RayId, NumLanes);
+            }
+        } break;
+
+        case TerrainQueryType_SphereSweep:
+        {
+            for (u32 RayId = 0; RayId < NumRays; RayId += TERRAIN_QUERY_LANES)
+            {
+                u32 NumLanes = NumRays - RayId < TERRAIN_QUERY_LANES ? NumRays - RayId : TERRAIN_QUERY_LANES;
+                TerrainQuerySphereSweepPacket(Queries, Rays + RayId, Hits + RayId, NumLanes);
+            }
+        } break;
+
+        case TerrainQueryType_GroundHeight:
+        {
+            // NOTE: Straight down from the top of the box
+            for (u32 RayId = 0; RayId < NumRays; RayId += TERRAIN_QUERY_LANES)
+            {
+                u32 NumLanes = NumRays - RayId < TERRAIN_QUERY_LANES ? NumRays - RayId : TERRAIN_QUERY_LANES;
+                terrain_ray DownRays[TERRAIN_QUERY_LANES];
+                for (u32 LaneId = 0; LaneId < NumLanes; ++LaneId)
+                {
+                    terrain_ray* DownRay = DownRays + LaneId;
+                    *DownRay = {};
+                    DownRay->Origin = V3(Rays[RayId + LaneId].Origin.x, Queries->WorldMax.y, Rays[RayId + LaneId].Origin.z);
+                    DownRay->Dir = V3(0.0f, -1.0f, 0.0f);
+                    DownRay->MaxT = Queries->WorldMax.y - Queries->WorldMin.y;
+                }
+                TerrainQueryRaycastPacket(Queries, DownRays, Hits + RayId, NumLanes);
+            }
+        } break;
+
+        default:
+        {
+            InvalidCodePath;
+        } break;
+    }
+}
+
+inline void TerrainQueryJobCallback(void* Data, u32 ThreadId)
+{
+    terrain_query_job* Job = (terrain_query_job*)Data;
+    TerrainQueryRange(Job->Queries, Job->Type, Job->Rays, Job->Hits, Job->NumRays);
+}
+
+// NOTE: Multithreaded batches go through the job queue, so like every job queue user they have to come from the main thread
+inline void TerrainQueryBatch(terrain_queries* Queries, terrain_query_type Type, terrain_ray* Rays, terrain_ray_hit* Hits, u32 NumRays,
+                              b32 Multithreaded)
+{
+    if (!Multithreaded || NumRays <= TERRAIN_QUERY_JOB_RAYS)
+    {
+        TerrainQueryRange(Queries, Type, Rays, Hits, NumRays);
+        return;
+    }
+
+    u32 RaysPerJob = (NumRays + TERRAIN_QUERY_MAX_JOBS - 1) / TERRAIN_QUERY_MAX_JOBS;
+    RaysPerJob = RaysPerJob > TERRAIN_QUERY_JOB_RAYS ? RaysPerJob : TERRAIN_QUERY_JOB_RAYS;
+    RaysPerJob = (RaysPerJob + TERRAIN_QUERY_LANES - 1) / TERRAIN_QUERY_LANES * TERRAIN_QUERY_LANES;
+
+    u32 NumJobs = 0;
+    for (u32 FirstRay = 0; FirstRay < NumRays; FirstRay += RaysPerJob)
+    {
+        terrain_query_job* Job = Queries->Jobs + NumJobs++;
+        *Job = {};
+        Job->Queries = Queries;
+        Job->Type = Type;
+        Job->Rays = Rays + FirstRay;
+        Job->Hits = Hits + FirstRay;
+        Job->NumRays = NumRays - FirstRay < RaysPerJob ? NumRays - FirstRay : RaysPerJob;
+        JobQueueAdd(Queries->JobQueue, TerrainQueryJobCallback, Job);
+    }
+    JobQueueCompleteAll(Queries->JobQueue);
+}
+
+//
+// NOTE: Benchmark
+//
+
+// NOTE: The rendered surface is marching cubes over the sample grid, trilinear interpolation of the grid is the field it approximates
+inline f32 TerrainQueryGridDensity(terrain_queries* Queries, v3 Uv)
+{
+    v3 Sample = V3((Uv.x + 1.0f)*0.5f*f32(Queries->ResX), (Uv.y + 1.0f)*0.5f*f32(Queries->ResY), (Uv.z + 1.0f)*0.5f*f32(Queries->ResZ));
+    v3 Floor = V3(floorf(Sample.x), floorf(Sample.y), floorf(Sample.z));
+    v3 Frac = Sample - Floor;
+
+    f32 Corners[8];
+    for (u32 CornerId = 0; CornerId < 8; ++CornerId)
+    {
+        v3 Corner = Floor + V3(f32(CornerId & 1), f32((CornerId >> 1) & 1), f32((CornerId >> 2) & 1));
+        v3 CornerUv = V3(2.0f*Corner.x / f32(Queries->ResX) - 1.0f, 2.0f*Corner.y / f32(Queries->ResY) - 1.0f,
+                         2.0f*Corner.z / f32(Queries->ResZ) - 1.0f);
+        Corners[CornerId] = TerrainDensityEvaluate(&Queries->Field, CornerUv);
+    }
+
+    f32 C00 = TerrainQueryLerp(Corners[0], Corners[1], Frac.x);
+    f32 C10 = TerrainQueryLerp(Corners[2], Corners[3], Frac.x);
+    f32 C01 = TerrainQueryLerp(Corners[4], Corners[5], Frac.x);
+    f32 C11 = TerrainQueryLerp(Corners[6], Corners[7], Frac.x);
+    f32 Result = TerrainQueryLerp(TerrainQueryLerp(C00, C10, Frac.y), TerrainQueryLerp(C01, C11, Frac.y), Frac.z);
+    return Result;
+}
+
+inline f32 TerrainQueryReferenceDensity(terrain_queries* Queries, v3 Uv, b32 GridField)
+{
+    f32 Result = GridField ? TerrainQueryGridDensity(Queries, Uv) : TerrainDensityEvaluate(&Queries->Field, Uv);
+    return Result;
+}
+
+// NOTE: Slow reference, fixed tenth of a voxel steps. Skips keep a one voxel margin since grid cells reach past nodes
+inline f32 TerrainQueryReferenceRaycast(terrain_queries* Queries, terrain_ray* Ray, b32 GridField)
+{
+    terrain_query_lane Lane;
+    if (!TerrainQueryLaneBegin(Queries, Ray, &Lane))
+    {
+        return -1.0f;
+    }
+
+    Lane.MinStep *= 0.1f / TERRAIN_QUERY_MIN_STEP;
+    while (TerrainQueryLaneSkip(Queries, &Lane, Queries->VoxelUv))
+    {
+        if (TerrainQueryReferenceDensity(Queries, TerrainQueryLanePos(&Lane, Lane.T), GridField) >= 0.0f)
+        {
+            f32 Lo = Lane.PrevT;
+            f32 Hi = Lane.T;
+            for (u32 StepId = 0; StepId < TERRAIN_QUERY_REFINE_STEPS; ++StepId)
+            {
+                f32 Mid = 0.5f*(Lo + Hi);
+                if (TerrainQueryReferenceDensity(Queries, TerrainQueryLanePos(&Lane, Mid), GridField) >= 0.0f)
+                {
+                    Hi = Mid;
+                }
+                else
+                {
+                    Lo = Mid;
+                }
+            }
+            return Hi;
+        }
+
+        TerrainQueryLaneStep(&Lane, 0.0f);
+    }
+
+    return -1.0f;
+}
+
+inline f32 TerrainQueryRandom(u32* State)
+{
+    // NOTE: xorshift32, keeps the benchmark rays independent of rand() and of the noise generator
+    u32 X = *State;
+    X ^= X << 13;
+    X ^= X >> 17;
+    X ^= X << 5;
+    *State = X;
+    f32 Result = f32(X >> 8) / f32(1 << 24);
+    return Result;
+}
+
+inline void TerrainQueryBenchmark(terrain_queries* Queries, benchmark_state* Bench)
+{
+    u32 NumRays = TERRAIN_QUERY_BENCH_RAYS;
+    terrain_ray* Rays = (terrain_ray*)DemoMemoryAlloc(sizeof(terrain_ray)*NumRays);
+    terrain_ray_hit* Hits = (terrain_ray_hit*)DemoMemoryAlloc(sizeof(terrain_ray_hit)*NumRays);
+
+    // NOTE: Rays start in the upper half of the box and look down at random, like picking or projectiles
+    u32 Random = 0x9E3779B9;
+    v3 WorldSize = Queries->WorldMax - Queries->WorldMin;
+    for (u32 RayId = 0; RayId < NumRays; ++RayId)
+    {
+        terrain_ray* Ray = Rays + RayId;
+        Ray->Origin = Queries->WorldMin + V3(TerrainQueryRandom(&Random)*WorldSize.x, (0.5f + 0.5f*TerrainQueryRandom(&Random))*WorldSize.y,
+                                             TerrainQueryRandom(&Random)*WorldSize.z);
+        Ray->Dir = Normalize(V3(2.0f*TerrainQueryRandom(&Random) - 1.0f, -0.1f - TerrainQueryRandom(&Random), 2.0f*TerrainQueryRandom(&Random) - 1.0f));
+        Ray->MaxT = Length(WorldSize);
+        Ray->Radius = 0.01f*WorldSize.x;
+    }
+
+    {
+        u64 StartTime = DemoTimerGet();
+        TerrainQueryBatch(Queries, TerrainQueryType_Raycast, Rays, Hits, NumRays, false);
+        BenchmarkRecord(Bench, "cpu_query_rays_per_sec_single_thread", f64(NumRays) / (DemoTimerElapsedMs(StartTime) / 1000.0), "rays/s");
+    }
+    {
+        u64 StartTime = DemoTimerGet();
+        TerrainQueryBatch(Queries, TerrainQueryType_Raycast, Rays, Hits, NumRays, true);
+        BenchmarkRecord(Bench, "cpu_query_rays_per_sec", f64(NumRays) / (DemoTimerElapsedMs(StartTime) / 1000.0), "rays/s");
+    }
+
+    /*
+      NOTE: Accuracy, before the other query types overwrite the hits. Against the exact field this is the error of the marcher, against
+            the grid field it also includes what the sample grid can't resolve (the top octave is close to the grid frequency)
+     */
+    {
+        u32 NumHits = 0;
+        for (u32 RayId = 0; RayId < NumRays; ++RayId)
+        {
+            NumHits += Hits[RayId].Hit ? 1 : 0;
+        }
+        BenchmarkRecord(Bench, "cpu_query_hit_ratio", f64(NumHits) / f64(NumRays), "ratio");
+
+        f32 VoxelWorld = Queries->VoxelUv / Queries->UvPerWorld.x;
+        for (u32 GridField = 0; GridField < 2; ++GridField)
+        {
+            f64 MaxError = 0.0;
+            u32 NumMismatches = 0;
+            for (u32 RayId = 0; RayId < TERRAIN_QUERY_BENCH_REFERENCE_RAYS; ++RayId)
+            {
+                f32 ReferenceT = TerrainQueryReferenceRaycast(Queries, Rays + RayId, GridField);
+                if ((ReferenceT >= 0.0f) != b32(Hits[RayId].Hit))
+                {
+                    NumMismatches += 1;
+                }
+                else if (Hits[RayId].Hit)
+                {
+                    f64 Error = fabs(f64(Hits[RayId].T - ReferenceT)) / f64(VoxelWorld);
+                    MaxError = Error > MaxError ? Error : MaxError;
+                }
+            }
+            BenchmarkRecord(Bench, GridField ? "cpu_query_max_grid_error_voxels" : "cpu_query_max_error_voxels", MaxError, "voxels");
+            BenchmarkRecord(Bench, GridField ? "cpu_query_grid_hit_mismatches" : "cpu_query_hit_mismatches", NumMismatches, "rays");
+        }
+    }
+
+    {
+        u64 StartTime = DemoTimerGet();
+        TerrainQueryBatch(Queries, TerrainQueryType_GroundHeight, Rays, Hits, NumRays, true);
+        BenchmarkRecord(Bench, "cpu_query_ground_heights_per_sec", f64(NumRays) / (DemoTimerElapsedMs(StartTime) / 1000.0), "queries/s");
+    }
+    {
+        u32 NumSweeps = NumRays / 8;
+        u64 StartTime = DemoTimerGet();
+        TerrainQueryBatch(Queries, TerrainQueryType_SphereSweep, Rays, Hits, NumSweeps, true);
+        BenchmarkRecord(Bench, "cpu_query_sphere_sweeps_per_sec", f64(NumSweeps) / (DemoTimerElapsedMs(StartTime) / 1000.0), "sweeps/s");
+    }
+
+    DemoMemoryFree(Rays, sizeof(terrain_ray)*NumRays);
+    DemoMemoryFree(Hits, sizeof(terrain_ray_hit)*NumRays);
+}
+
+inline void TerrainQueriesPanel(ui_panel* Panel, terrain_queries* Queries, v3 CameraPos)
+{
+    if (!Queries->PanelEnabled)
+    {
+        return;
+    }
+
+    terrain_ray_hit* Hit = &Queries->PanelHit;
+    if (!Queries->PanelValid || CameraPos.x != Queries->PanelCameraPos.x || CameraPos.y != Queries->PanelCameraPos.y ||
+        CameraPos.z != Queries->PanelCameraPos.z)
+    {
+        terrain_ray Ray = {};
+        Ray.Origin = CameraPos;
+        TerrainQueryBatch(Queries, TerrainQueryType_GroundHeight, &Ray, Hit, 1, false);
+        Queries->PanelValid = true;
+        Queries->PanelCameraPos = CameraPos;
+    }
+
+    char Text[256];
+    if (Hit->Hit)
+    {
+        snprintf(Text, sizeof(Text), "CPU Queries: ground at y = %.2f, camera is %.2f above it", Hit->Pos.y, CameraPos.y - Hit->Pos.y);
+    }
+    else
+    {
+        snprintf(Text, sizeof(Text), "CPU Queries: no ground under the camera");
+    }
+    UiPanelText(Panel, Text);
+    UiPanelNextRow(Panel);
+}
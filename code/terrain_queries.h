@@ -0,0 +1,138 @@
+#pragma once
+
+/*
+
+  NOTE: CPU terrain queries. The game side needs raycasts, sphere sweeps and ground heights against the terrain we draw, so the CPU
+        keeps a copy of the noise textures and evaluates the same density function as GENERATE_3D_TERRAIN (same octaves, same linear
+        REPEAT filtering). Everything here works in generator uv space, [-1, 1] over the terrain box.
+
+        - Acceleration: the box is split into blocks of TERRAIN_QUERY_BLOCK_RES samples, grouped into chunks of
+          TERRAIN_QUERY_CHUNK_BLOCKS^3 blocks that line up with the GPU chunks. Every node stores a conservative density interval, trilinear
+          noise is a convex combination of the texels it touches so the min/max of those texels bounds an octave exactly. Rays jump over
+          nodes that are all air
+        - Marching: sphere tracing with the density Lipschitz bound, never less than TERRAIN_QUERY_MIN_STEP voxels, then bisection
+          between the last air and first solid sample. Hits land well within a voxel of the density isosurface, the benchmark measures it
+          against a fine fixed step march (and reports how far the sample grid the GPU meshes drifts from it)
+        - Batches: rays and sweeps go through in packets of TERRAIN_QUERY_LANES, the density is evaluated with SSE over the packet. Large
+          batches are split into jobs for the job queue
+
+ */
+
+#include <emmintrin.h>
+
+#define TERRAIN_QUERY_PANEL 0 // NOTE: Default for DemoState->Queries.PanelEnabled
+#define TERRAIN_QUERY_NUM_NOISE_TEXTURES 4
+#define TERRAIN_QUERY_BLOCK_RES 8
+#define TERRAIN_QUERY_CHUNK_BLOCKS 4
+#define TERRAIN_QUERY_LANES 4
+#define TERRAIN_QUERY_MIN_STEP 0.25f // NOTE: In voxels
+#define TERRAIN_QUERY_REFINE_STEPS 16
+#define TERRAIN_QUERY_JOB_RAYS 512
+#define TERRAIN_QUERY_MAX_JOBS 256
+
+// NOTE: Benchmark
+#define TERRAIN_QUERY_BENCH_RAYS 65536
+#define TERRAIN_QUERY_BENCH_REFERENCE_RAYS 64
+
+enum terrain_query_type
+{
+    TerrainQueryType_Raycast,
+    TerrainQueryType_SphereSweep,
+    TerrainQueryType_GroundHeight, // NOTE: Only Origin.xz of the ray is used
+};
+
+struct terrain_noise_octave
+{
+    u32 TextureId;
+    f32 Frequency;
+    f32 Amplitude;
+};
+
+struct terrain_ray
+{
+    v3 Origin;
+    v3 Dir; // NOTE: Normalized
+    f32 MaxT;
+    f32 Radius; // NOTE: Sphere sweeps only
+};
+
+struct terrain_ray_hit
+{
+    b32 Hit;
+    f32 T;
+    v3 Pos; // NOTE: Sphere center at contact for sweeps
+    v3 Normal;
+};
+
+struct terrain_query_node
+{
+    f32 Min;
+    f32 Max;
+};
+
+struct terrain_density_field
+{
+    u32 NoiseDim; // NOTE: Power of 2
+    u32 NoiseDimShift;
+    f32* Noise[TERRAIN_QUERY_NUM_NOISE_TEXTURES];
+    f32 NoiseMin[TERRAIN_QUERY_NUM_NOISE_TEXTURES];
+    f32 NoiseMax[TERRAIN_QUERY_NUM_NOISE_TEXTURES];
+    v3 GeneratorCenter;
+    v3 GeneratorRadius;
+    f32 Lipschitz; // NOTE: Bound on |grad density| per unit of uv
+};
+
+// NOTE: Per ray march state, in uv space
+struct terrain_query_lane
+{
+    b32 Active;
+    v3 Origin;
+    v3 Dir;
+    f32 T;
+    f32 PrevT; // NOTE: Last T known to be outside of the surface
+    f32 TEnd;
+    f32 InvLipschitz; // NOTE: T per unit of density
+    f32 MinStep;
+};
+
+struct terrain_queries;
+struct terrain_query_job
+{
+    terrain_queries* Queries;
+    terrain_query_type Type;
+    u32 Slice; // NOTE: Acceleration build, block z slice
+    terrain_ray* Rays;
+    terrain_ray_hit* Hits;
+    u32 NumRays;
+};
+
+struct terrain_queries
+{
+    terrain_density_field Field;
+    job_queue* JobQueue;
+
+    v3 WorldMin;
+    v3 WorldMax;
+    v3 UvPerWorld;
+    u32 ResX; // NOTE: Density samples of the GPU terrain
+    u32 ResY;
+    u32 ResZ;
+    f32 VoxelUv; // NOTE: Smallest sample spacing in uv
+
+    u32 BlocksX;
+    u32 BlocksY;
+    u32 BlocksZ;
+    terrain_query_node* Blocks;
+    u32 ChunksX;
+    u32 ChunksY;
+    u32 ChunksZ;
+    terrain_query_node* Chunks;
+
+    terrain_query_job Jobs[TERRAIN_QUERY_MAX_JOBS];
+
+    // NOTE: Ground under the camera for the panel, only queried again once the camera moves
+    b32 PanelEnabled;
+    b32 PanelValid;
+    v3 PanelCameraPos;
+    terrain_ray_hit PanelHit;
+};